@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include "host/i2c_bus.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+#include "extapps_lz.h"
+
+// the real ext apps stored LZSS compressed like in the firmware, streamed to the portapack with COMMAND_APP_TRANSFER_STREAM
+// (decoded in the isr) and with COMMAND_APP_TRANSFER_STREAM_LZ (the compressed image as is, the pp decodes).
+// the time is the host cpu of the whole transfer, bus_ms is what it takes on the wire at 400 kHz
+
+typedef struct {
+    const char* name;
+    const uint8_t* lz;
+    uint32_t lz_size;
+    uint32_t raw_size;
+} extapp_t;
+
+static const extapp_t extapps[] = {
+    {"sattrack", sattrack_lz, sizeof(sattrack_lz), sattrack_raw_size},
+    {"wifisettings", wifisettings_lz, sizeof(wifisettings_lz), wifisettings_raw_size},
+    {"tirapp", tirapp_lz, sizeof(tirapp_lz), tirapp_raw_size},
+    {"espmanager", espmanager_lz, sizeof(espmanager_lz), espmanager_raw_size},
+    {"espapps", espapps_lz, sizeof(espapps_lz), espapps_raw_size},
+};
+
+// the apps' index in PPHandler
+static uint16_t extapp_index(size_t i) {
+    static uint16_t first = 0xFFFF;
+    if (first == 0xFFFF) {
+        pp_master_init();
+        first = PPHandler::get_appCount();
+        for (const extapp_t& app : extapps) PPHandler::add_app_compressed(app.lz, app.lz_size, app.raw_size);
+    }
+    return first + i;
+}
+
+static void transfer(benchmark::State& state, Command command) {
+    const extapp_t& app = extapps[state.range(0)];
+    app_stream_request_t req = {extapp_index(state.range(0)), 0, 0};
+    app_stream_chunk_t chunk;
+    uint64_t bytes = 0;
+    host_i2c_slave_reset_stats();
+    for (auto _ : state) {
+        pp_send((uint16_t)command, &req, sizeof(req));
+        do {
+            pp_receive(&chunk, sizeof(chunk));
+            bytes += chunk.len;
+        } while (!(chunk.flags & (APP_STREAM_LAST | APP_STREAM_ERROR)));
+        if (chunk.flags & APP_STREAM_ERROR) {
+            state.SkipWithError("stream error");
+            break;
+        }
+    }
+    host_i2c_stats_t st = host_i2c_slave_get_stats();
+    state.SetLabel(app.name);
+    state.counters["raw_bytes"] = app.raw_size;
+    state.counters["lz_bytes"] = app.lz_size;
+    state.counters["sent_bytes"] = (double)bytes / state.iterations();
+    state.counters["bus_ms"] = st.bus_us / 1000 / state.iterations();
+    state.SetBytesProcessed(app.raw_size * state.iterations());
+}
+
+static void BM_AppStream(benchmark::State& state) {
+    transfer(state, Command::COMMAND_APP_TRANSFER_STREAM);
+}
+BENCHMARK(BM_AppStream)->DenseRange(0, 4)->Unit(benchmark::kMillisecond);
+
+static void BM_AppStreamLz(benchmark::State& state) {
+    transfer(state, Command::COMMAND_APP_TRANSFER_STREAM_LZ);
+}
+BENCHMARK(BM_AppStreamLz)->DenseRange(0, 4)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+#include "groundtrack.hpp"
+
+// a full recompute of the iss ground track (+-1 orbit), and its websocket message.
+// the window moves a quarter orbit per iteration, like it does every ~23 minutes on the esp
+
+static void BM_GroundTrackUpdate(benchmark::State& state) {
+    char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+    char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+    Sgp4 sat;
+    sat.init("ISS", l1, l2);
+    GroundTrack track;
+    double period = 2.0 * pi / sat.satrec.no / 1440.0;
+    double jd = 2460538.0;
+    static uint8_t buf[GroundTrack::encoded_size(2 * GROUNDTRACK_POINTS_PER_ORBIT + 1)];
+    size_t len = 0;
+    uint64_t points = 0;
+    for (auto _ : state) {
+        track.update(sat.satrec, jd);
+        len = track.encode(buf, sizeof(buf));
+        points += track.size();
+        jd += period / 3;
+    }
+    state.counters["points_per_s"] = benchmark::Counter(points, benchmark::Counter::kIsRate);
+    state.counters["encoded_bytes"] = len;
+    state.counters["bytes_per_point"] = (double)len / track.size();
+}
+BENCHMARK(BM_GroundTrackUpdate)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,183 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "esp_timer.h"
+#include "host/task_sim.h"
+#include "nmea_gen.h"
+#include "nmea_parser.h"
+#include "nmealog.hpp"
+
+// the parser task replaying lines from a source: the cpu time of the parser task per sentence (the iteration time),
+// and the lines/s the task loop lets through (NMEA_SOURCE_BURST per event loop run)
+
+struct Replay {
+    std::vector<std::string> lines;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> done{false};
+};
+
+static int replay_source(void* arg, char* buff, size_t size) {
+    Replay* r = (Replay*)arg;
+    size_t i = r->next;
+    if (i >= r->lines.size()) {
+        r->done = true;
+        return -1;
+    }
+    r->next = i + 1;
+    size_t len = r->lines[i].size() < size ? r->lines[i].size() : size;
+    memcpy(buff, r->lines[i].data(), len);
+    return (int)len;
+}
+
+static std::atomic<uint32_t> updates{0};
+
+static void on_update(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    (void)arg;
+    (void)base;
+    (void)data;
+    if (id == GPS_UPDATE) updates++;
+}
+
+static nmea_parser_handle_t parser() {
+    static nmea_parser_handle_t hdl = nullptr;
+    if (!hdl) {
+        nmea_parser_config_t config = NMEA_PARSER_CONFIG_DEFAULT();
+        hdl = nmea_parser_init(&config);
+        nmea_parser_add_handler(hdl, on_update, nullptr);
+    }
+    return hdl;
+}
+
+static std::vector<std::string> split_lines(const std::string& s) {
+    std::vector<std::string> ret;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t end = s.find('\n', pos);
+        if (end == std::string::npos) end = s.size() - 1;
+        ret.push_back(s.substr(pos, end - pos + 1));
+        pos = end + 1;
+    }
+    return ret;
+}
+
+// replays the lines state.iterations() times. the iteration time is the cpu time of the parser task, so items_per_second is the sentences/s it can parse
+static void run_replay(benchmark::State& state, Replay& replay) {
+    nmea_parser_handle_t hdl = parser();
+    TaskHandle_t task = xTaskGetHandle("nmea_parser");
+    uint64_t lines = 0;
+    int64_t wall_us = 0;
+    for (auto _ : state) {
+        replay.next = 0;
+        replay.done = false;
+        uint64_t cpu0 = host_task_cpu_ns(task);
+        int64_t t0 = esp_timer_get_time();
+        nmea_parser_set_source(hdl, replay_source, &replay);
+        while (!replay.done) vTaskDelay(1);
+        vTaskDelay(pdMS_TO_TICKS(60));  // the last burst's events
+        wall_us += esp_timer_get_time() - t0;
+        state.SetIterationTime((host_task_cpu_ns(task) - cpu0) * 1e-9);
+        lines += replay.lines.size();
+    }
+    state.counters["lines"] = (double)lines;
+    state.counters["lines_per_s_loop"] = lines * 1e6 / wall_us;
+    state.SetItemsProcessed(lines);
+}
+
+static void BM_NmeaParserTask(benchmark::State& state) {
+    std::vector<nmea_sat_t> sats;
+    for (int i = 0; i < state.range(0); i++) sats.push_back({i + 1, 10 + i * 5, i * 30, i % 3 ? 35 : 0});
+    nmea_fix_t fix = nmea_default_fix();
+    std::string text;
+    for (int e = 0; e < 4; e++) {
+        fix.second = e;
+        text += nmea_epoch(fix, sats);
+    }
+    Replay replay;
+    replay.lines = split_lines(text);
+    run_replay(state, replay);
+}
+BENCHMARK(BM_NmeaParserTask)->Arg(4)->Arg(12)->UseManualTime()->Iterations(2)->Unit(benchmark::kMicrosecond);
+
+// 1 s of a 10 hz multi constellation receiver: rmc, gga, vtg, gll, a gsa per system and the gsv groups of gps, glonass, galileo and beidou
+static std::string capture_10hz() {
+    const char* talkers[4] = {"GP", "GL", "GA", "GB"};
+    const int first_prn[4] = {1, 65, 301, 401};
+    std::vector<nmea_sat_t> sats[4];
+    std::vector<int> prns[4];
+    for (int s = 0; s < 4; s++) {
+        for (int i = 0; i < 8; i++) {
+            sats[s].push_back({first_prn[s] + i, 10 + i * 9, (s * 45 + i * 40) % 360, i % 4 ? 30 + i : 0});
+            if (i % 4) prns[s].push_back(first_prn[s] + i);
+        }
+    }
+    nmea_fix_t fix = nmea_default_fix();
+    std::string text;
+    for (int e = 0; e < 10; e++) {
+        fix.second = e / 10.0;
+        text += nmea_rmc(fix) + nmea_gga(fix);
+        text += nmea_sentence("GNVTG,45.00,T,,M,10.00,N,18.52,K,A");
+        text += nmea_sentence("GNGLL,4729.8740,N,01902.4120,E,100000.00,A,A");
+        for (int s = 0; s < 4; s++) text += nmea_gsa(prns[s], s + 1);
+        for (int s = 0; s < 4; s++) text += nmea_gsv(sats[s], talkers[s]);
+    }
+    return text;
+}
+
+static void BM_NmeaParser10HzCapture(benchmark::State& state) {
+    Replay replay;
+    replay.lines = split_lines(capture_10hz());
+    run_replay(state, replay);
+}
+BENCHMARK(BM_NmeaParser10HzCapture)->UseManualTime()->Iterations(1)->Unit(benchmark::kMicrosecond);
+
+static uint32_t now_ms() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// the same second recorded with NmeaLog and replayed fast from the files: the parser task's cpu time now has the file reads and
+// the delta decoding too, against BM_NmeaParser10HzCapture
+static void BM_NmeaLogReplay10Hz(benchmark::State& state) {
+    static std::string path0 = (std::filesystem::temp_directory_path() / "bench_nmea0.log").string();
+    static std::string path1 = (std::filesystem::temp_directory_path() / "bench_nmea1.log").string();
+    NmeaLog log(now_ms, path0.c_str(), path1.c_str());
+    std::vector<std::string> lines = split_lines(capture_10hz());
+    log.start();
+    for (size_t i = 0; i < lines.size(); i++) {
+        NmeaLog::tap(&log, lines[i].data(), lines[i].size());
+        if (i % 16 == 15) log.flush();  // job_nmealog, the ring holds less than the second
+    }
+    log.stop();
+    if (log.get_dropped()) {
+        state.SkipWithError("lines dropped from the recording");
+        return;
+    }
+    size_t text_bytes = 0;
+    for (const std::string& l : lines) text_bytes += l.size();
+
+    nmea_parser_handle_t hdl = parser();
+    TaskHandle_t task = xTaskGetHandle("nmea_parser");
+    uint64_t replayed = 0;
+    int64_t wall_us = 0;
+    for (auto _ : state) {
+        uint64_t cpu0 = host_task_cpu_ns(task);
+        int64_t t0 = esp_timer_get_time();
+        if (!log.replay_start(false) || nmea_parser_set_source(hdl, NmeaLog::source, &log) != ESP_OK) {
+            state.SkipWithError("replay didn't start");
+            break;
+        }
+        while (log.replaying()) vTaskDelay(1);
+        vTaskDelay(pdMS_TO_TICKS(60));  // the last burst's events
+        wall_us += esp_timer_get_time() - t0;
+        state.SetIterationTime((host_task_cpu_ns(task) - cpu0) * 1e-9);
+        replayed += lines.size();
+    }
+    remove(path0.c_str());
+    remove(path1.c_str());
+    state.counters["log_bytes_per_line"] = (double)log.get_size() / lines.size();
+    state.counters["text_bytes_per_line"] = (double)text_bytes / lines.size();
+    state.counters["lines_per_s_loop"] = wall_us ? replayed * 1e6 / wall_us : 0;
+    state.SetItemsProcessed(replayed);
+}
+BENCHMARK(BM_NmeaLogReplay10Hz)->UseManualTime()->Iterations(1)->Unit(benchmark::kMicrosecond);
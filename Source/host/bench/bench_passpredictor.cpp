@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+#include "esp_timer.h"
+#include "host/task_sim.h"
+#include "passpredictor.hpp"
+
+// a full pass list of the iss (PP_SAT_PASS_MAX passes) on the predictor task, the site moved every time so the cache never hits.
+// the time is the cpu of the predictor task per list
+
+static void BM_PassPredictor(benchmark::State& state) {
+    static bool started = false;
+    if (!started) PassPredictor::init();
+    started = true;
+    TaskHandle_t task = xTaskGetHandle("passpredict");
+    char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+    char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+    Sgp4 sat;
+    sat.init("ISS", l1, l2);
+    static double lat = 47.4979;  // a new key in every iteration, also across the runs
+    uint64_t passes = 0;
+    sat_passes_t list;
+    for (auto _ : state) {
+        lat = lat > 50 ? 40 : lat + 0.5;
+        uint32_t seq = PassPredictor::sequence();
+        uint64_t cpu0 = host_task_cpu_ns(task);
+        PassPredictor::update(sat, lat, 19.0402, 110, 2460538.0);
+        while (!(PassPredictor::sequence() != seq && PassPredictor::read(list) && !list.computing)) vTaskDelay(1);
+        state.SetIterationTime((host_task_cpu_ns(task) - cpu0) * 1e-9);
+        passes += list.count;
+    }
+    state.counters["passes_per_s"] = benchmark::Counter(passes, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PassPredictor)->UseManualTime()->Unit(benchmark::kMillisecond);
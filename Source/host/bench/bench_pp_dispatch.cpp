@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "pp_handler.hpp"
+#include "pp_master.h"
+
+// custom command dispatch: a pp query of the last registered custom command with 10, 50 and 200 commands registered.
+// PPHandler's table has no unregister, so the runs only add commands (10, then 40 more, then 150 more).
+// BM_PPCustomLinearScan is the old lookup (list scanned by value) on the same set, for comparison
+
+#define BENCH_COMMAND_BASE 0xa020  // clear of the real commands of pp_commands.hpp
+
+static uint16_t registered = 0;
+
+static void send_byte(pp_command_data_t data) {
+    data.data->resize(1);
+    (*data.data)[0] = 0x42;
+}
+
+static void register_up_to(uint16_t count) {
+    for (; registered < count; ++registered) {
+        // every 4th outside of the dense range, so the hash gets some load too (it holds 32)
+        uint16_t command = (registered % 4 == 3 && registered < 100) ? 0xb000 + registered : BENCH_COMMAND_BASE + registered;
+        PPHandler::add_custom_command(command, nullptr, send_byte);
+    }
+}
+
+static uint16_t last_command(uint16_t count) {
+    uint16_t i = count - 1;
+    return (i % 4 == 3 && i < 100) ? 0xb000 + i : BENCH_COMMAND_BASE + i;
+}
+
+static void BM_PPCustomDispatch(benchmark::State& state) {
+    pp_master_init();
+    register_up_to(state.range(0));
+    uint16_t command = last_command(state.range(0));
+    uint8_t reply;
+    for (auto _ : state) {
+        pp_send(command);
+        benchmark::DoNotOptimize(pp_receive(&reply, 1));
+    }
+}
+BENCHMARK(BM_PPCustomDispatch)->Arg(10)->Arg(50)->Arg(200);
+
+static void BM_PPCustomLinearScan(benchmark::State& state) {
+    std::vector<pp_custom_command_list_element_t> list;
+    for (uint16_t i = 0; i < state.range(0); ++i) list.push_back({last_command(i + 1), nullptr, send_byte});
+    uint16_t command = last_command(state.range(0));
+    for (auto _ : state) {
+        pp_i2c_command found = nullptr;
+        for (auto element : list) {
+            if (element.command == command) {
+                found = element.send_command;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+    }
+}
+BENCHMARK(BM_PPCustomLinearScan)->Arg(10)->Arg(50)->Arg(200);
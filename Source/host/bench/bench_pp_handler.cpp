@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include "alloc_count.h"
+#include "host/i2c_bus.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+
+// one portapack query (command write, then the reply read), through the slave callbacks like from the i2c isr.
+// the time is the host cpu of the whole simulated transaction, bus_us is what the two transactions take on the wire at 400 kHz
+
+static void gps_cb(ppgpssmall_t& gps) {
+    gps.latitude = 47.5f;
+    gps.sats_in_use = 7;
+}
+
+static void query(benchmark::State& state, Command command, size_t reply_len) {
+    pp_master_init();
+    PPHandler::set_get_gps_data_CB(gps_cb);
+    uint8_t reply[PP_I2C_BUFFER_SIZE];
+    host_i2c_slave_reset_stats();
+    for (auto _ : state) {
+        pp_send((uint16_t)command);
+        benchmark::DoNotOptimize(pp_receive(reply, reply_len));
+    }
+    host_i2c_stats_t st = host_i2c_slave_get_stats();
+    state.counters["bus_us"] = st.bus_us / state.iterations();
+    PPHandler::set_get_gps_data_CB(nullptr);
+}
+
+static void BM_PPQueryInfo(benchmark::State& state) {
+    query(state, Command::COMMAND_INFO, sizeof(device_info));
+}
+BENCHMARK(BM_PPQueryInfo);
+
+static void BM_PPQueryGps(benchmark::State& state) {
+    query(state, Command::COMMAND_GETFEAT_DATA_GPS, sizeof(ppgpssmall_t));
+}
+BENCHMARK(BM_PPQueryGps);
+
+static void BM_PPQueryDataAll(benchmark::State& state) {
+    query(state, Command::COMMAND_GETFEAT_DATA_ALL, sizeof(feat_data_all_t));
+}
+BENCHMARK(BM_PPQueryDataAll);
+
+// the mixed command trace of pp_replay_mix(): the heap use per transaction, which must be 0 in the isr path
+static void BM_PPCommandMix(benchmark::State& state) {
+    pp_master_init();
+    PPHandler::set_get_gps_data_CB(gps_cb);
+    uint64_t transactions = 0;
+    host_i2c_slave_reset_stats();
+    host_alloc_reset_stats();
+    for (auto _ : state) transactions += pp_replay_mix();
+    host_alloc_stats_t allocs = host_alloc_get_stats();
+    host_i2c_stats_t st = host_i2c_slave_get_stats();
+    PPHandler::set_get_gps_data_CB(nullptr);
+    if (allocs.isr_news || allocs.isr_deletes) state.SkipWithError("heap use in the isr path");
+    state.counters["isr_allocs_per_transaction"] = (double)(allocs.isr_news + allocs.isr_deletes) / transactions;
+    state.counters["bus_us_per_transaction"] = st.bus_us / transactions;
+    state.SetItemsProcessed(transactions);
+}
+BENCHMARK(BM_PPCommandMix);
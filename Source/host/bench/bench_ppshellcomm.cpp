@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <vector>
+#include "host/i2c_bus.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+#include "ppshellcomm.h"
+
+// esp -> pp shell throughput: a full tx ring drained by the portapack at the old 64 byte frame and at PP_SHELL_FRAME_MAX,
+// polling like its shell bridge (size query when idle, frames while hasmore is set).
+// the time is the host cpu, bytes_per_s_bus is what the bus allows at 400 kHz
+
+static void shell_init() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        pp_master_init();
+        PPShellComm::init();
+    });
+    // the same wiring as in main.cpp
+    PPHandler::set_get_shell_data_size_CB([]() -> uint16_t { return PPShellComm::get_i2c_tx_queue_size(); });
+    PPHandler::set_send_shell_data_CB([](PPSpan& data, bool& hasmore) {
+        uint32_t size = PPShellComm::read_i2c_tx_queue_ISR(data.data() + data.size(), data.capacity() - data.size());
+        data.commit(size);
+        hasmore = PPShellComm::get_i2c_tx_queue_size() > 0;
+    });
+    PPShellComm::set_i2c_connected(true);
+}
+
+static void BM_ShellToPP(benchmark::State& state) {
+    shell_init();
+    uint8_t frame = (uint8_t)state.range(0);
+    pp_send((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, &frame, 1);
+    std::vector<uint8_t> text(SHELL_TX_RING_SIZE);
+    for (size_t i = 0; i < text.size(); ++i) text[i] = (uint8_t)(' ' + i % 95);
+    uint8_t buf[1 + PP_SHELL_FRAME_MAX];
+    uint64_t bytes = 0;
+    host_i2c_slave_reset_stats();
+    for (auto _ : state) {
+        if (!PPShellComm::write(text.data(), text.size(), false, true)) {
+            state.SkipWithError("tx ring not empty");
+            break;
+        }
+        size_t got = 0;
+        bool more = false;
+        while (got < text.size()) {
+            if (!more && pp_query_as<shell_data_size_t>((uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA_SIZE).size == 0) break;
+            pp_send((uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA);
+            pp_receive(buf, 1 + frame);
+            got += buf[0] & 0x7F;
+            more = buf[0] & 0x80;
+        }
+        bytes += got;
+    }
+    host_i2c_stats_t st = host_i2c_slave_get_stats();
+    frame = 0;  // back to the default
+    pp_send((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, &frame, 1);
+    PPHandler::set_get_shell_data_size_CB(nullptr);
+    PPHandler::set_send_shell_data_CB(nullptr);
+    state.counters["bytes_per_s_bus"] = bytes / st.bus_us * 1e6;
+    state.counters["transactions_per_kb"] = st.transactions * 1024.0 / bytes;
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ShellToPP)->Arg(PP_SHELL_FRAME_DEFAULT)->Arg(PP_SHELL_FRAME_MAX)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include "satbatch.hpp"
+#include "tle_gen.h"
+
+// one tick of the whole catalog: SatBatch::propagate() (float kernel, one transform per tick, one rise search)
+// against the per satellite Sgp4::findsat() it replaces (sgp4() and rv2azel() for every satellite)
+
+static const double jd0 = 2460539.0;
+
+static std::vector<std::string> catalog_lines(uint32_t count) {
+    std::istringstream catalog(tle_catalog(count, 3));
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(catalog, line)) lines.push_back(line);
+    return lines;
+}
+
+static void BM_SatBatchPropagate(benchmark::State& state) {
+    std::vector<std::string> lines = catalog_lines(state.range(0));
+    SatBatch batch;
+    for (size_t i = 0; i + 2 < lines.size(); i += 3) {
+        tle_db_record_t rec;
+        if (TleDb::parse(lines[i].c_str(), lines[i + 1].c_str(), lines[i + 2].c_str(), rec)) batch.add(rec);
+    }
+    double jd = jd0;
+    for (auto _ : state) {
+        batch.propagate(jd, 47.4979, 19.0402, 110);
+        jd += 1.0 / 86400;
+    }
+    state.counters["sats_per_s"] = benchmark::Counter((double)batch.size() * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SatBatchPropagate)->Arg(100)->Arg(200)->Arg(500)->Unit(benchmark::kMicrosecond);
+
+static void BM_Sgp4PerSatellite(benchmark::State& state) {
+    std::vector<std::string> lines = catalog_lines(state.range(0));
+    std::vector<Sgp4> sats(lines.size() / 3);
+    for (size_t i = 0; i < sats.size(); i++) {
+        char l1[130], l2[130];
+        strlcpy(l1, lines[i * 3 + 1].c_str(), sizeof(l1));
+        strlcpy(l2, lines[i * 3 + 2].c_str(), sizeof(l2));
+        sats[i].init(lines[i * 3].c_str(), l1, l2);
+        sats[i].site(47.4979, 19.0402, 110);
+    }
+    double jd = jd0;
+    for (auto _ : state) {
+        for (Sgp4& sat : sats) sat.findsat(jd);
+        jd += 1.0 / 86400;
+    }
+    state.counters["sats_per_s"] = benchmark::Counter((double)sats.size() * state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Sgp4PerSatellite)->Arg(100)->Arg(200)->Arg(500)->Unit(benchmark::kMicrosecond);
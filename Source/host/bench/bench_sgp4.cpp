@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include "sgp4/Sgp4.h"
+
+// the sgp4 propagator and the prediction on top of it, host cpu time. the s3 is roughly 20-50x slower, the ratios are what matter
+
+static const char* ISS_L1 = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+static const char* ISS_L2 = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+static const double JD_EPOCH = 2460538.0;
+
+static void init_iss(Sgp4& sat) {
+    char l1[130], l2[130];
+    strncpy(l1, ISS_L1, sizeof(l1));
+    strncpy(l2, ISS_L2, sizeof(l2));
+    sat.init("ISS", l1, l2);
+    sat.site(47.4979, 19.0402, 110);
+}
+
+static void BM_Sgp4Propagate(benchmark::State& state) {
+    Sgp4 sat;
+    init_iss(sat);
+    double r[3], v[3];
+    double t = 0;
+    for (auto _ : state) {
+        sgp4(wgs84, sat.satrec, t, r, v);
+        benchmark::DoNotOptimize(r);
+        t += 1.0;
+        if (t > 4320) t = 0;
+    }
+}
+BENCHMARK(BM_Sgp4Propagate);
+
+static void BM_Sgp4Findsat(benchmark::State& state) {
+    Sgp4 sat;
+    init_iss(sat);
+    double jd = JD_EPOCH;
+    for (auto _ : state) {
+        sat.findsat(jd);
+        benchmark::DoNotOptimize(sat.satEl);
+        jd += 1.0 / 1440;
+        if (jd > JD_EPOCH + 3) jd = JD_EPOCH;
+    }
+}
+BENCHMARK(BM_Sgp4Findsat);
+
+static void BM_Sgp4NextPass(benchmark::State& state) {
+    Sgp4 sat;
+    init_iss(sat);
+    passinfo pass;
+    for (auto _ : state) {
+        sat.initpredpoint(JD_EPOCH, 0.0);
+        bool ok = sat.nextpass(&pass, 20);
+        benchmark::DoNotOptimize(ok);
+    }
+}
+BENCHMARK(BM_Sgp4NextPass);
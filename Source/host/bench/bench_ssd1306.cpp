@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include "sdkconfig.h"
+#include "ssd1306.h"
+#include "ssd1306_model.h"
+
+// a full frame to the panel. bus_us is the i2c time of the frame at the driver's clock, that is what limits the frame rate
+
+static void BM_Ssd1306DisplayPages(benchmark::State& state) {
+    static Ssd1306Model panel;
+    host_i2c_attach(I2C_NUM_0, I2C_SSD1306_DEV_ADDR, &panel);
+    i2c_dev_t bus = {};
+    ssd1306_init_desc(&bus, I2C_SSD1306_DEV_ADDR, I2C_NUM_0, (gpio_num_t)CONFIG_IC2SDAPIN, (gpio_num_t)CONFIG_IC2SCLPIN);
+    ssd1306_config_t cfg = I2C_SSD1306_128x64_CONFIG_DEFAULT;
+    ssd1306_handle_t dev = nullptr;
+    ssd1306_init(bus, &cfg, &dev);
+    host_i2c_reset_stats(I2C_NUM_0);
+    for (auto _ : state) {
+        ssd1306_display_pages(dev);
+    }
+    host_i2c_stats_t st = host_i2c_get_stats(I2C_NUM_0);
+    state.counters["bus_us"] = st.bus_us / state.iterations();
+    state.counters["max_fps"] = 1e6 * state.iterations() / st.bus_us;
+    host_i2c_attach(I2C_NUM_0, I2C_SSD1306_DEV_ADDR, nullptr);
+    free(dev);
+}
+BENCHMARK(BM_Ssd1306DisplayPages);
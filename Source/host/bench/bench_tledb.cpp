@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include "tle_gen.h"
+#include "tledb.hpp"
+
+// tle lookup by name: the indexed db against the line scan of the text file it replaced (load_satellite_tle before the db).
+// the last satellite of the file, the scan's worst case. the host's page cache hides most of the spiffs read cost, so the scan is flattered
+
+static std::string catalog_path(uint32_t count, bool db) {
+    static std::map<uint32_t, std::string> built;
+    auto it = built.find(count);
+    if (it == built.end()) {
+        std::string base = (std::filesystem::temp_directory_path() / ("esp32pp_bench_" + std::to_string(count))).string();
+        std::ofstream(base + ".tle") << tle_catalog(count, 7);
+        TleDb::build((base + ".tle").c_str(), (base + ".db").c_str());
+        it = built.emplace(count, base).first;
+    }
+    return it->second + (db ? ".db" : ".tle");
+}
+
+static std::string last_name(uint32_t count) {
+    return "SAT " + std::to_string(40000 + count - 1);
+}
+
+static void BM_TleLineScan(benchmark::State& state) {
+    std::string path = catalog_path(state.range(0), false);
+    std::string name = last_name(state.range(0));
+    for (auto _ : state) {
+        std::ifstream file(path);
+        std::string line, l1, l2;
+        while (std::getline(file, line)) {
+            if (line.find(name) == 0) {
+                std::getline(file, l1);
+                std::getline(file, l2);
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(l2);
+    }
+}
+BENCHMARK(BM_TleLineScan)->Arg(200)->Arg(2000)->Unit(benchmark::kMicrosecond);
+
+static void BM_TleDbFindName(benchmark::State& state) {
+    TleDb db;
+    if (!db.open(catalog_path(state.range(0), true).c_str())) {
+        state.SkipWithError("no db");
+        return;
+    }
+    std::string name = last_name(state.range(0));
+    tle_db_record_t rec;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.find_name(name.c_str(), rec));
+    }
+    db.close();
+}
+BENCHMARK(BM_TleDbFindName)->Arg(200)->Arg(2000)->Unit(benchmark::kMicrosecond);
+
+static void BM_TleDbFindNorad(benchmark::State& state) {
+    TleDb db;
+    if (!db.open(catalog_path(state.range(0), true).c_str())) {
+        state.SkipWithError("no db");
+        return;
+    }
+    tle_db_record_t rec;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.find_norad(40000 + state.range(0) - 1, rec));
+    }
+    db.close();
+}
+BENCHMARK(BM_TleDbFindNorad)->Arg(200)->Arg(2000)->Unit(benchmark::kMicrosecond);
+
+static void BM_TleDbFindPrefix(benchmark::State& state) {
+    TleDb db;
+    if (!db.open(catalog_path(state.range(0), true).c_str())) {
+        state.SkipWithError("no db");
+        return;
+    }
+    char names[10][TLE_DB_NAME_LEN];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.find_prefix("sat 401", names, 10));
+    }
+    db.close();
+}
+BENCHMARK(BM_TleDbFindPrefix)->Arg(200)->Arg(2000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,130 @@
+#include "esp_event.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// the same dispatch as esp_event: the posts are copied to a queue, esp_event_loop_run() runs the handlers
+
+namespace {
+
+struct Handler {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void* arg;
+};
+
+struct Post {
+    esp_event_base_t base;
+    int32_t id;
+    void* data;
+};
+
+struct Loop {
+    QueueHandle_t queue;
+    std::mutex m;
+    std::vector<Handler> handlers;
+};
+
+void dispatch(Loop* loop, Post& post) {
+    std::vector<Handler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(loop->m);
+        handlers = loop->handlers;
+    }
+    for (auto& h : handlers) {
+        if ((h.base == ESP_EVENT_ANY_BASE || h.base == post.base) && (h.id == ESP_EVENT_ANY_ID || h.id == post.id)) {
+            h.fn(h.arg, post.base, post.id, post.data);
+        }
+    }
+    free(post.data);
+}
+
+void loop_task(void* arg) {
+    while (1) esp_event_loop_run(arg, portMAX_DELAY);
+}
+
+}  // namespace
+
+extern "C" {
+
+esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, esp_event_loop_handle_t* event_loop) {
+    if (!event_loop_args || !event_loop || event_loop_args->queue_size <= 0) return ESP_ERR_INVALID_ARG;
+    Loop* loop = new Loop();
+    loop->queue = xQueueCreate(event_loop_args->queue_size, sizeof(Post));
+    *event_loop = loop;
+    if (event_loop_args->task_name) {
+        xTaskCreate(loop_task, event_loop_args->task_name, event_loop_args->task_stack_size, loop, event_loop_args->task_priority, NULL);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop) {
+    Loop* loop = (Loop*)event_loop;
+    Post post;
+    while (xQueueReceive(loop->queue, &post, 0)) free(post.data);
+    vQueueDelete(loop->queue);
+    delete loop;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run) {
+    Loop* loop = (Loop*)event_loop;
+    int64_t remaining_ticks = ticks_to_run;
+    TickType_t marker = xTaskGetTickCount();
+    Post post;
+    while (xQueueReceive(loop->queue, &post, ticks_to_run) == pdTRUE) {
+        dispatch(loop, post);
+        if (ticks_to_run != portMAX_DELAY) {
+            TickType_t end = xTaskGetTickCount();
+            remaining_ticks -= end - marker;
+            if (remaining_ticks <= 0) break;
+            marker = end;
+            ticks_to_run = remaining_ticks;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register_with(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler, void* event_handler_arg) {
+    Loop* loop = (Loop*)event_loop;
+    if (!loop || !event_handler) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(loop->m);
+    loop->handlers.push_back({event_base, event_id, event_handler, event_handler_arg});
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_unregister_with(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler) {
+    Loop* loop = (Loop*)event_loop;
+    if (!loop) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(loop->m);
+    for (auto it = loop->handlers.begin(); it != loop->handlers.end(); ++it) {
+        if (it->base == event_base && it->id == event_id && it->fn == event_handler) {
+            loop->handlers.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id, const void* event_data, size_t event_data_size, TickType_t ticks_to_wait) {
+    Loop* loop = (Loop*)event_loop;
+    if (!loop) return ESP_ERR_INVALID_ARG;
+    Post post = {event_base, event_id, NULL};
+    if (event_data && event_data_size) {
+        post.data = malloc(event_data_size);
+        if (!post.data) return ESP_ERR_NO_MEM;
+        memcpy(post.data, event_data, event_data_size);
+    }
+    if (xQueueSend(loop->queue, &post, ticks_to_wait) != pdTRUE) {
+        free(post.data);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+}  // extern "C"
@@ -0,0 +1,239 @@
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include "esp_rom_sys.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/temperature_sensor.h"
+#include "host/compat.h"
+#include "host/sensors_sim.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+
+namespace {
+
+std::mutex& log_lock() {
+    static std::mutex* m = new std::mutex();
+    return *m;
+}
+
+esp_log_level_t& log_level() {
+    static esp_log_level_t level = [] {
+        const char* env = getenv("ESP32PP_HOST_LOG");
+        return env ? (esp_log_level_t)atoi(env) : ESP_LOG_WARN;
+    }();
+    return level;
+}
+
+std::atomic<float> temperature{25.0f};
+std::atomic<uint8_t> gpio_levels[GPIO_NUM_MAX];
+
+}  // namespace
+
+extern "C" {
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    (void)tag;  // one level for all tags on the host
+    log_level() = level;
+}
+
+esp_log_level_t esp_log_level_get(const char* tag) {
+    (void)tag;
+    return log_level();
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    if (level > log_level() || level == ESP_LOG_NONE) return;
+    static const char letters[] = "NEWIDV";
+    std::lock_guard<std::mutex> lock(log_lock());
+    fprintf(stderr, "%c (%u) %s: ", letters[level], esp_log_timestamp(), tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void esp_log_buffer_hexdump_internal(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level) {
+    if (level > log_level() || level == ESP_LOG_NONE) return;
+    const uint8_t* p = (const uint8_t*)buffer;
+    std::lock_guard<std::mutex> lock(log_lock());
+    for (uint16_t i = 0; i < buff_len; i += 16) {
+        fprintf(stderr, "%s: %04x:", tag, i);
+        for (uint16_t j = i; j < i + 16 && j < buff_len; j++) fprintf(stderr, " %02x", p[j]);
+        fputc('\n', stderr);
+    }
+}
+
+int esp_rom_printf(const char* fmt, ...) {
+    if (log_level() < ESP_LOG_WARN) return 0;
+    std::lock_guard<std::mutex> lock(log_lock());
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(stderr, fmt, args);
+    va_end(args);
+    return n;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:
+            return "ESP_OK";
+        case ESP_FAIL:
+            return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:
+            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:
+            return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:
+            return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:
+            return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:
+            return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:
+            return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:
+            return "ESP_ERR_INVALID_CRC";
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const* buf, uint32_t len) {
+    static uint32_t table[256];
+    static std::once_flag once;
+    std::call_once(once, [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    });
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t esp_random(void) {
+    static thread_local std::mt19937 gen(std::random_device{}());
+    return gen();
+}
+
+void esp_fill_random(void* buf, size_t len) {
+    uint8_t* p = (uint8_t*)buf;
+    for (size_t i = 0; i < len; i++) p[i] = (uint8_t)esp_random();
+}
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type) {
+    static const uint8_t base[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+    memcpy(mac, base, 6);
+    mac[5] += (uint8_t)type;
+    return ESP_OK;
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t* mac) {
+    return esp_read_mac(mac, ESP_MAC_WIFI_STA);
+}
+
+void esp_restart(void) {
+    fprintf(stderr, "esp_restart() called\n");
+    abort();
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return 256 * 1024;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return 256 * 1024;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    return gpio_set_level(gpio_num, 0);
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    (void)mode;
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    gpio_levels[gpio_num] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return 0;
+    return gpio_levels[gpio_num];
+}
+
+esp_err_t temperature_sensor_install(const temperature_sensor_config_t* tsens_config, temperature_sensor_handle_t* ret_tsens) {
+    (void)tsens_config;
+    static int dummy;
+    *ret_tsens = (temperature_sensor_handle_t)&dummy;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_uninstall(temperature_sensor_handle_t tsens) {
+    (void)tsens;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_enable(temperature_sensor_handle_t tsens) {
+    (void)tsens;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_disable(temperature_sensor_handle_t tsens) {
+    (void)tsens;
+    return ESP_OK;
+}
+
+esp_err_t temperature_sensor_get_celsius(temperature_sensor_handle_t tsens, float* out_celsius) {
+    (void)tsens;
+    *out_celsius = temperature;
+    return ESP_OK;
+}
+
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t dlen = strnlen(dst, size);
+    if (dlen == size) return size + strlen(src);
+    return dlen + strlcpy(dst + dlen, src, size - dlen);
+}
+#endif
+
+}  // extern "C"
+
+void host_temperature_set(float celsius) {
+    temperature = celsius;
+}
@@ -0,0 +1,373 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "host/task_sim.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// tasks are detached pthreads (vTaskDelete(NULL) is a pthread_exit), queues and semaphores are a ring under a mutex.
+// deleting another task waits till it stops at its next blocking call, its owner frees what it used right after.
+// nothing here is ever freed at exit: tasks may still run while the test binary shuts down.
+
+struct HostTask {
+    std::string name;
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+    std::atomic<bool> deleted{false};
+    TaskFunction_t fn = nullptr;
+    void* arg = nullptr;
+    pthread_t thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> exited{false};
+};
+
+struct HostQueue {
+    std::mutex m;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    size_t item_size = 0;
+    size_t length = 0;
+    size_t head = 0;
+    size_t count = 0;
+    std::vector<uint8_t> storage;
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point& start_time() {
+    static const Clock::time_point t = Clock::now();
+    return t;
+}
+
+thread_local HostTask* current_task = nullptr;
+thread_local int isr_depth = 0;
+
+std::mutex tasks_lock;
+std::vector<HostTask*> tasks;  // for xTaskGetHandle
+
+std::recursive_mutex& critical_lock() {
+    static std::recursive_mutex* m = new std::recursive_mutex();
+    return *m;
+}
+
+Clock::time_point deadline(TickType_t ticks) {
+    return Clock::now() + std::chrono::microseconds((uint64_t)ticks * 1000000ULL / configTICK_RATE_HZ);
+}
+
+[[noreturn]] void task_exit() {
+    if (current_task) {
+        current_task->running = false;
+        current_task->exited = true;
+    }
+    pthread_exit(nullptr);
+}
+
+void exit_if_deleted() {
+    if (current_task && current_task->deleted) task_exit();
+}
+
+// waits till pred() or the timeout, false on timeout. a task being deleted exits from the wait
+template <typename Pred>
+bool wait_for(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Pred pred) {
+    if (pred()) return true;
+    if (ticks == 0) return false;
+    const Clock::time_point end = ticks == portMAX_DELAY ? Clock::time_point::max() : deadline(ticks);
+    while (!pred()) {
+        if (current_task && current_task->deleted) {
+            lock.unlock();
+            task_exit();
+        }
+        if (Clock::now() >= end) return false;
+        cv.wait_until(lock, std::min(end, Clock::now() + std::chrono::milliseconds(10)));
+    }
+    return true;
+}
+
+void* task_entry(void* p) {
+    HostTask* task = (HostTask*)p;
+    current_task = task;
+    task->thread = pthread_self();
+    task->running = true;
+    pthread_setname_np(pthread_self(), task->name.substr(0, 15).c_str());
+    if (!task->deleted) task->fn(task->arg);
+    task->running = false;
+    task->exited = true;
+    return nullptr;  // a FreeRTOS task must not return, the shim allows it
+}
+
+BaseType_t queue_send(QueueHandle_t q, const void* item, TickType_t ticks, bool front) {
+    if (!q) return pdFALSE;
+    exit_if_deleted();
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!wait_for(q->not_full, lock, ticks, [q] { return q->count < q->length; })) return errQUEUE_FULL;
+    size_t slot;
+    if (front) {
+        q->head = (q->head + q->length - 1) % q->length;
+        slot = q->head;
+    } else {
+        slot = (q->head + q->count) % q->length;
+    }
+    if (q->item_size) memcpy(&q->storage[slot * q->item_size], item, q->item_size);
+    q->count++;
+    lock.unlock();
+    q->not_empty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t queue_receive(QueueHandle_t q, void* buffer, TickType_t ticks, bool peek) {
+    if (!q) return pdFALSE;
+    exit_if_deleted();
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!wait_for(q->not_empty, lock, ticks, [q] { return q->count > 0; })) return errQUEUE_EMPTY;
+    if (q->item_size && buffer) memcpy(buffer, &q->storage[q->head * q->item_size], q->item_size);
+    if (!peek) {
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+    }
+    lock.unlock();
+    if (!peek) q->not_full.notify_one();
+    return pdTRUE;
+}
+
+}  // namespace
+
+extern "C" {
+
+int64_t esp_timer_get_time(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time()).count();
+}
+
+void vHostEnterCritical(portMUX_TYPE*) {
+    critical_lock().lock();
+}
+
+void vHostExitCritical(portMUX_TYPE*) {
+    critical_lock().unlock();
+}
+
+void vHostYield(void) {
+    sched_yield();
+}
+
+BaseType_t xPortInIsrContext(void) {
+    return isr_depth > 0;
+}
+
+void host_isr_enter(void) {
+    isr_depth++;
+}
+
+void host_isr_exit(void) {
+    isr_depth--;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask) {
+    (void)usStackDepth;
+    (void)uxPriority;
+    HostTask* task = new HostTask();
+    task->name = pcName ? pcName : "";
+    task->fn = pxTaskCode;
+    task->arg = pvParameters;
+    if (pxCreatedTask) *pxCreatedTask = task;
+    {
+        std::lock_guard<std::mutex> lock(tasks_lock);
+        tasks.push_back(task);
+    }
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    int err = pthread_create(&thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    return err == 0 ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask, BaseType_t xCoreID) {
+    (void)xCoreID;
+    return xTaskCreate(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask);
+}
+
+void vTaskDelete(TaskHandle_t xTask) {
+    if (!xTask || xTask == current_task) task_exit();
+    xTask->deleted = true;
+    xTask->cv.notify_all();
+    // a task that never blocks again is left running after a second, like before
+    Clock::time_point end = Clock::now() + std::chrono::seconds(1);
+    while (!xTask->exited && Clock::now() < end) std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    exit_if_deleted();
+    if (xTicksToDelay == 0) {
+        sched_yield();
+        return;
+    }
+    std::this_thread::sleep_until(deadline(xTicksToDelay));
+    exit_if_deleted();
+}
+
+TaskHandle_t xTaskGetHandle(const char* pcNameToQuery) {
+    std::lock_guard<std::mutex> lock(tasks_lock);
+    for (auto it = tasks.rbegin(); it != tasks.rend(); ++it)
+        if (!(*it)->deleted && (*it)->name == pcNameToQuery) return *it;
+    return nullptr;
+}
+
+uint64_t host_task_cpu_ns(TaskHandle_t task) {
+    if (!task || !task->running) return 0;
+    clockid_t clock;
+    struct timespec ts;
+    if (pthread_getcpuclockid(task->thread, &clock) != 0 || clock_gettime(clock, &ts) != 0) return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)((uint64_t)esp_timer_get_time() * configTICK_RATE_HZ / 1000000ULL);
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (!current_task) {
+        // a thread the shim did not start (the test's main thread), it gets a task on first use
+        current_task = new HostTask();
+        current_task->name = "host";
+    }
+    return current_task;
+}
+
+const char* pcTaskGetName(TaskHandle_t xTask) {
+    if (!xTask) xTask = xTaskGetCurrentTaskHandle();
+    return xTask->name.c_str();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    {
+        std::lock_guard<std::mutex> lock(xTaskToNotify->m);
+        xTaskToNotify->notify++;
+    }
+    xTaskToNotify->cv.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    HostTask* task = xTaskGetCurrentTaskHandle();
+    exit_if_deleted();
+    std::unique_lock<std::mutex> lock(task->m);
+    wait_for(task->cv, lock, xTicksToWait, [task] { return task->notify > 0 || task->deleted; });
+    uint32_t value = task->notify;
+    if (value) task->notify = xClearCountOnExit ? 0 : value - 1;
+    lock.unlock();
+    exit_if_deleted();
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    if (uxQueueLength == 0) return nullptr;
+    HostQueue* q = new HostQueue();
+    q->length = uxQueueLength;
+    q->item_size = uxItemSize;
+    q->storage.resize((size_t)uxQueueLength * uxItemSize);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    delete xQueue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queue_send(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void* pvItemToQueue, BaseType_t* pxHigherPriorityTaskWoken) {
+    BaseType_t ret = queue_send(xQueue, pvItemToQueue, 0, false);
+    if (pxHigherPriorityTaskWoken && ret) *pxHigherPriorityTaskWoken = pdTRUE;
+    return ret;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t xQueue, const void* pvItemToQueue) {
+    {
+        std::lock_guard<std::mutex> lock(xQueue->m);
+        xQueue->head = 0;
+        xQueue->count = 0;
+    }
+    return queue_send(xQueue, pvItemToQueue, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void* pvBuffer, BaseType_t* pxHigherPriorityTaskWoken) {
+    BaseType_t ret = queue_receive(xQueue, pvBuffer, 0, false);
+    if (pxHigherPriorityTaskWoken && ret) *pxHigherPriorityTaskWoken = pdTRUE;
+    return ret;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queue_receive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue) {
+    {
+        std::lock_guard<std::mutex> lock(xQueue->m);
+        xQueue->head = 0;
+        xQueue->count = 0;
+    }
+    xQueue->not_full.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(xQueue->m);
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(xQueue->m);
+    return xQueue->length - xQueue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t sem = xQueueCreate(1, 0);
+    xSemaphoreGive(sem);
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    SemaphoreHandle_t sem = xQueueCreate(uxMaxCount, 0);
+    for (UBaseType_t i = 0; i < uxInitialCount; i++) xSemaphoreGive(sem);
+    return sem;
+}
+
+}  // extern "C"
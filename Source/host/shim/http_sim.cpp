@@ -0,0 +1,119 @@
+#include "esp_http_client.h"
+#include "host/http_sim.h"
+
+#include <cstring>
+#include <mutex>
+
+struct esp_http_client {
+    esp_http_client_config_t config;
+    std::string url;
+    std::map<std::string, std::string> headers;
+    int status = 0;
+    int64_t content_length = -1;
+    bool complete = false;
+};
+
+namespace {
+
+std::mutex& server_lock() {
+    static std::mutex* m = new std::mutex();
+    return *m;
+}
+
+HostHttpServer& server() {
+    static HostHttpServer* s = new HostHttpServer();
+    return *s;
+}
+
+esp_err_t event(esp_http_client* client, esp_http_client_event_id_t id, const void* data, int len, const char* key, const char* value) {
+    if (!client->config.event_handler) return ESP_OK;
+    esp_http_client_event_t evt = {};
+    evt.event_id = id;
+    evt.client = client;
+    evt.data = (void*)data;
+    evt.data_len = len;
+    evt.user_data = client->config.user_data;
+    evt.header_key = (char*)key;
+    evt.header_value = (char*)value;
+    return client->config.event_handler(&evt);
+}
+
+}  // namespace
+
+void host_http_set_server(HostHttpServer s) {
+    std::lock_guard<std::mutex> lock(server_lock());
+    server() = s;
+}
+
+extern "C" {
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config) {
+    if (!config || !config->url) return nullptr;
+    esp_http_client* client = new esp_http_client();
+    client->config = *config;
+    client->url = config->url;
+    return client;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value) {
+    client->headers[key] = value;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    HostHttpServer handler;
+    {
+        std::lock_guard<std::mutex> lock(server_lock());
+        handler = server();
+    }
+    if (!handler) {
+        event(client, HTTP_EVENT_ERROR, nullptr, 0, nullptr, nullptr);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    HostHttpRequest request = {client->url, client->headers};
+    HostHttpResponse response = handler(request);
+    client->status = response.status;
+    event(client, HTTP_EVENT_ON_CONNECTED, nullptr, 0, nullptr, nullptr);
+    event(client, HTTP_EVENT_HEADERS_SENT, nullptr, 0, nullptr, nullptr);
+    bool has_body = response.status != 304 && response.status != 204;
+    client->content_length = has_body ? (int64_t)response.body.size() : 0;
+    for (auto& h : response.headers) event(client, HTTP_EVENT_ON_HEADER, nullptr, 0, h.first.c_str(), h.second.c_str());
+    if (has_body) {
+        std::string length = std::to_string(response.body.size());
+        event(client, HTTP_EVENT_ON_HEADER, nullptr, 0, "Content-Length", length.c_str());
+    }
+    size_t total = has_body ? response.body.size() : 0;
+    size_t sent_limit = total < response.cut_after ? total : response.cut_after;
+    size_t chunk = response.chunk ? response.chunk : 512;
+    for (size_t pos = 0; pos < sent_limit; pos += chunk) {
+        size_t n = sent_limit - pos < chunk ? sent_limit - pos : chunk;
+        event(client, HTTP_EVENT_ON_DATA, response.body.data() + pos, (int)n, nullptr, nullptr);
+    }
+    client->complete = sent_limit == total;
+    if (!client->complete) {
+        event(client, HTTP_EVENT_DISCONNECTED, nullptr, 0, nullptr, nullptr);
+        return ESP_FAIL;
+    }
+    event(client, HTTP_EVENT_ON_FINISH, nullptr, 0, nullptr, nullptr);
+    event(client, HTTP_EVENT_DISCONNECTED, nullptr, 0, nullptr, nullptr);
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+    return client->status;
+}
+
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client) {
+    return client->content_length;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client) {
+    return client->complete;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    delete client;
+    return ESP_OK;
+}
+
+}  // extern "C"
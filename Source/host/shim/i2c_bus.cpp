@@ -0,0 +1,330 @@
+#include "host/i2c_bus.h"
+#include "freertos/FreeRTOS.h"
+
+extern "C" {
+#include "i2c_slave_driver.h"
+}
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Op {
+    enum Type { START,
+                WRITE,
+                READ,
+                STOP } type;
+    std::vector<uint8_t> data;  // WRITE
+    uint8_t* dst;               // READ
+    size_t len;                 // READ
+};
+
+struct CmdLink {
+    std::vector<Op> ops;
+};
+
+struct MasterPort {
+    std::mutex m;
+    std::map<uint8_t, HostI2CDevice*> devices;
+    uint32_t clock_hz = 100000;
+    bool installed = false;
+    int timeout = 0;
+    host_i2c_stats_t stats = {};
+};
+
+MasterPort& master(i2c_port_t port) {
+    static MasterPort* ports = new MasterPort[I2C_NUM_MAX];
+    return ports[port < 0 || port >= I2C_NUM_MAX ? 0 : port];
+}
+
+struct Slave {
+    std::mutex m;  // one master transaction at a time
+    i2c_slave_callback_fn callback = nullptr;
+    i2c_slave_device_t dev = {};
+    bool created = false;
+    uint32_t clock_hz = 400000;
+    host_i2c_stats_t stats = {};
+};
+
+Slave& slave() {
+    static Slave* s = new Slave();
+    return *s;
+}
+
+void count(host_i2c_stats_t& stats, size_t bytes, uint32_t clock_hz) {
+    stats.transactions++;
+    stats.bytes += bytes;
+    stats.bus_us += host_i2c_transaction_us(bytes, clock_hz);
+}
+
+}  // namespace
+
+double host_i2c_transaction_us(size_t data_bytes, uint32_t clock_hz) {
+    // start + address byte and ack + 9 bits per data byte + stop
+    return (1.0 + 9.0 + 9.0 * data_bytes + 1.0) * 1e6 / clock_hz;
+}
+
+void host_i2c_attach(i2c_port_t port, uint8_t addr, HostI2CDevice* device) {
+    MasterPort& p = master(port);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (device)
+        p.devices[addr] = device;
+    else
+        p.devices.erase(addr);
+}
+
+host_i2c_stats_t host_i2c_get_stats(i2c_port_t port) {
+    MasterPort& p = master(port);
+    std::lock_guard<std::mutex> lock(p.m);
+    return p.stats;
+}
+
+void host_i2c_reset_stats(i2c_port_t port) {
+    MasterPort& p = master(port);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.stats = {};
+}
+
+extern "C" {
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len, int intr_alloc_flags) {
+    (void)mode;
+    (void)slv_rx_buf_len;
+    (void)slv_tx_buf_len;
+    (void)intr_alloc_flags;
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (p.installed) return ESP_FAIL;
+    p.installed = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num) {
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.installed = false;
+    return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t* i2c_conf) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (i2c_conf->mode == I2C_MODE_MASTER && i2c_conf->master.clk_speed) p.clock_hz = i2c_conf->master.clk_speed;
+    return ESP_OK;
+}
+
+esp_err_t i2c_set_timeout(i2c_port_t i2c_num, int timeout) {
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.timeout = timeout;
+    return ESP_OK;
+}
+
+esp_err_t i2c_get_timeout(i2c_port_t i2c_num, int* timeout) {
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    *timeout = p.timeout;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return new CmdLink();
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle) {
+    delete (CmdLink*)cmd_handle;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle) {
+    ((CmdLink*)cmd_handle)->ops.push_back({Op::START, {}, nullptr, 0});
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en) {
+    return i2c_master_write(cmd_handle, &data, 1, ack_en);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t* data, size_t data_len, bool ack_en) {
+    (void)ack_en;
+    ((CmdLink*)cmd_handle)->ops.push_back({Op::WRITE, std::vector<uint8_t>(data, data + data_len), nullptr, 0});
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t* data, size_t data_len, i2c_ack_type_t ack) {
+    (void)ack;
+    ((CmdLink*)cmd_handle)->ops.push_back({Op::READ, {}, data, data_len});
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t* data, i2c_ack_type_t ack) {
+    return i2c_master_read(cmd_handle, data, 1, ack);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle) {
+    ((CmdLink*)cmd_handle)->ops.push_back({Op::STOP, {}, nullptr, 0});
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    MasterPort& p = master(i2c_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (!p.installed) return ESP_ERR_INVALID_STATE;
+    CmdLink* link = (CmdLink*)cmd_handle;
+    // each start opens a segment: the first written byte is the address, then the data of one direction
+    HostI2CDevice* dev = nullptr;
+    bool reading = false;
+    bool addressed = false;
+    std::vector<uint8_t> out;
+    size_t seg_bytes = 0;
+    auto end_segment = [&]() -> bool {
+        bool ok = true;
+        if (addressed && !reading && dev && !out.empty()) ok = dev->write(out.data(), out.size());
+        if (addressed) count(p.stats, seg_bytes, p.clock_hz);
+        out.clear();
+        seg_bytes = 0;
+        addressed = false;
+        return ok;
+    };
+    for (Op& op : link->ops) {
+        switch (op.type) {
+            case Op::START:
+                if (!end_segment()) return ESP_FAIL;
+                break;
+            case Op::STOP:
+                if (!end_segment()) return ESP_FAIL;
+                break;
+            case Op::WRITE: {
+                size_t i = 0;
+                if (!addressed) {
+                    uint8_t a = op.data[0];
+                    auto it = p.devices.find(a >> 1);
+                    addressed = true;
+                    reading = a & 1;
+                    dev = it == p.devices.end() ? nullptr : it->second;
+                    if (!dev) {
+                        count(p.stats, 0, p.clock_hz);  // the address went out, then the nack
+                        return ESP_FAIL;
+                    }
+                    i = 1;
+                }
+                out.insert(out.end(), op.data.begin() + i, op.data.end());
+                seg_bytes += op.data.size() - i;
+                break;
+            }
+            case Op::READ:
+                if (!addressed || !reading || !dev) return ESP_ERR_INVALID_STATE;
+                if (!dev->read(op.dst, op.len)) return ESP_FAIL;
+                seg_bytes += op.len;
+                break;
+        }
+    }
+    end_segment();
+    return ESP_OK;
+}
+
+// the slave side, a replacement of i2c_slave_driver.c
+
+esp_err_t i2c_slave_new(i2c_slave_config_t* config, i2c_slave_device_t** result) {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (s.created) return ESP_ERR_INVALID_STATE;
+    s.callback = config->callback;
+    memset(&s.dev, 0, sizeof(s.dev));
+    s.dev.state = I2C_STATE_IDLE;
+    s.created = true;
+    *result = &s.dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_slave_del(i2c_slave_device_t* dev) {
+    (void)dev;
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    s.created = false;
+    s.callback = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t i2c_slave_send_data(i2c_slave_device_t* dev, uint8_t* buf, uint8_t* len) {
+    if (dev->state != I2C_STATE_SEND) return ESP_ERR_INVALID_STATE;
+    if (dev->bufstart == dev->bufend) dev->bufstart = dev->bufend = 0;
+    uint8_t nbytes = *len;
+    if (nbytes > sizeof(dev->buffer) - dev->bufend) nbytes = sizeof(dev->buffer) - dev->bufend;
+    memcpy(dev->buffer + dev->bufend, buf, nbytes);
+    dev->bufend += nbytes;
+    *len = nbytes;
+    return ESP_OK;
+}
+
+}  // extern "C"
+
+bool host_i2c_slave_write(const uint8_t* data, size_t len) {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (!s.created) return false;
+    i2c_slave_device_t* d = &s.dev;
+    // rx fifo to the buffer, the rest is thrown away
+    d->bufstart = d->bufend = 0;
+    size_t n = len < sizeof(d->buffer) ? len : sizeof(d->buffer);
+    memcpy(d->buffer, data, n);
+    d->bufend = n;
+    d->state = n ? I2C_STATE_RECV : I2C_STATE_IDLE;
+    host_isr_enter();
+    if (d->state != I2C_STATE_IDLE) s.callback(d, I2C_CALLBACK_DONE);
+    host_isr_exit();
+    d->bufstart = d->bufend = 0;
+    d->state = I2C_STATE_IDLE;
+    count(s.stats, len, s.clock_hz);
+    return true;
+}
+
+size_t host_i2c_slave_read(uint8_t* data, size_t len) {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (!s.created) return 0;
+    i2c_slave_device_t* d = &s.dev;
+    size_t supplied = 0;
+    host_isr_enter();
+    // address match: reset, then ask for the data
+    d->state = I2C_STATE_SEND;
+    d->bufstart = d->bufend = 0;
+    s.callback(d, I2C_CALLBACK_SEND_DATA);
+    while (supplied < len) {
+        if (d->bufstart == d->bufend) {
+            s.callback(d, I2C_CALLBACK_SEND_DATA);  // tx empty while the master clocks on
+            if (d->bufstart == d->bufend) break;
+        }
+        data[supplied++] = d->buffer[d->bufstart++];
+    }
+    s.callback(d, I2C_CALLBACK_DONE);  // bytes the master did not read stay in the buffer, so bufstart != bufend
+    host_isr_exit();
+    d->bufstart = d->bufend = 0;
+    d->state = I2C_STATE_IDLE;
+    for (size_t i = supplied; i < len; i++) data[i] = 0xFF;
+    count(s.stats, len, s.clock_hz);
+    return supplied;
+}
+
+void host_i2c_slave_set_clock(uint32_t hz) {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    s.clock_hz = hz;
+}
+
+host_i2c_stats_t host_i2c_slave_get_stats() {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    return s.stats;
+}
+
+void host_i2c_slave_reset_stats() {
+    Slave& s = slave();
+    std::lock_guard<std::mutex> lock(s.m);
+    s.stats = {};
+}
@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#pragma once
+
+// only the handle types, the drivers of this repo talk to the bus through i2cdev
+#include "driver/i2c.h"
+
+typedef struct i2c_master_bus_t* i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t* i2c_master_dev_handle_t;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the rmt api over a loopback, see host/rmt_sim.h
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "soc/gpio_num.h"
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef union {
+    struct {
+        uint16_t duration0 : 15;
+        uint16_t level0 : 1;
+        uint16_t duration1 : 15;
+        uint16_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef enum {
+    RMT_CLK_SRC_DEFAULT = 0,
+    RMT_CLK_SRC_APB = 0,
+    RMT_CLK_SRC_XTAL,
+} rmt_clock_source_t;
+
+typedef struct rmt_channel_t* rmt_channel_handle_t;
+
+typedef struct {
+    rmt_symbol_word_t* received_symbols;
+    size_t num_symbols;
+    struct {
+        uint32_t is_last : 1;
+    } flags;
+} rmt_rx_done_event_data_t;
+
+typedef bool (*rmt_rx_done_callback_t)(rmt_channel_handle_t rx_chan, const rmt_rx_done_event_data_t* edata, void* user_ctx);
+
+typedef struct {
+    uint32_t frequency_hz;
+    float duty_cycle;
+    struct {
+        uint32_t polarity_active_low : 1;
+        uint32_t always_on : 1;
+    } flags;
+} rmt_carrier_config_t;
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_apply_carrier(rmt_channel_handle_t channel, const rmt_carrier_config_t* config);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+
+#ifdef __cplusplus
+}
+#endif
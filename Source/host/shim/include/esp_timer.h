@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// microseconds since the start of the process, monotonic
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: FreeRTOS on std::thread. tasks are threads, the "ISR" functions are the task ones without blocking.
+// the tick runs at CONFIG_FREERTOS_HZ like on the device, counted from the process start.
+
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL ((BaseType_t)0)
+#define errQUEUE_EMPTY ((BaseType_t)0)
+
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES 25
+#define configASSERT(x) assert(x)
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define pdTICKS_TO_MS(xTicks) ((TickType_t)((uint64_t)(xTicks) * 1000 / configTICK_RATE_HZ))
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+// one global lock stands in for the spinlocks and the interrupt masking
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void vHostEnterCritical(portMUX_TYPE* mux);
+void vHostExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) vHostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vHostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vHostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vHostExitCritical(mux)
+#define taskENTER_CRITICAL(mux) vHostEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) vHostExitCritical(mux)
+#define portYIELD_FROM_ISR(x) ((void)(x))
+#define portYIELD() vHostYield()
+#define taskYIELD() vHostYield()
+void vHostYield(void);
+
+// true while a host_isr_enter() / host_isr_exit() pair is open on this thread (the simulated peripherals do this)
+BaseType_t xPortInIsrContext(void);
+void host_isr_enter(void);
+void host_isr_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
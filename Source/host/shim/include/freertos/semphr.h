@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#pragma once
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// like in FreeRTOS, a semaphore is a queue of empty items
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+#define xSemaphoreTake(xSemaphore, xBlockTime) xQueueReceive((xSemaphore), NULL, (xBlockTime))
+#define xSemaphoreTakeFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueReceiveFromISR((xSemaphore), NULL, (pxHigherPriorityTaskWoken))
+#define xSemaphoreGive(xSemaphore) xQueueSend((xSemaphore), NULL, 0)
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken) xQueueSendFromISR((xSemaphore), NULL, (pxHigherPriorityTaskWoken))
+#define vSemaphoreDelete(xSemaphore) vQueueDelete(xSemaphore)
+#define uxSemaphoreGetCount(xSemaphore) uxQueueMessagesWaiting(xSemaphore)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the server behind esp_http_client. the handler answers every request in the process.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HostHttpRequest {
+    std::string url;
+    std::map<std::string, std::string> headers;  // as set by the client
+};
+
+struct HostHttpResponse {
+    int status = 200;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    size_t cut_after = SIZE_MAX;  // the connection drops after this many body bytes
+    size_t chunk = 512;           // body bytes per HTTP_EVENT_ON_DATA
+};
+
+typedef std::function<HostHttpResponse(const HostHttpRequest&)> HostHttpServer;
+
+void host_http_set_server(HostHttpServer server);  // empty: every connection fails
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the simulated i2c buses.
+// master side (i2cdev.c and the sensor / display drivers): devices attached to an address answer the transactions.
+// slave side (ppi2c): the portapack is the master here, it runs the same callback sequence as i2c_slave_driver.c.
+// both count the bus time at the given clock: start, address byte, the data bytes with their ack, stop.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/i2c.h"
+
+class HostI2CDevice {
+   public:
+    virtual ~HostI2CDevice() = default;
+    virtual bool write(const uint8_t* data, size_t len) = 0;  // false: nack
+    virtual bool read(uint8_t* data, size_t len) = 0;
+};
+
+typedef struct {
+    uint64_t transactions;  // one per start / repeated start
+    uint64_t bytes;         // data bytes, without the address
+    double bus_us;          // at the bus clock
+} host_i2c_stats_t;
+
+void host_i2c_attach(i2c_port_t port, uint8_t addr, HostI2CDevice* device);  // nullptr detaches
+host_i2c_stats_t host_i2c_get_stats(i2c_port_t port);
+void host_i2c_reset_stats(i2c_port_t port);
+
+// slave side. one write or read transaction of the master, ended with a stop. the slave must be created by then.
+bool host_i2c_slave_write(const uint8_t* data, size_t len);
+size_t host_i2c_slave_read(uint8_t* data, size_t len);  // returns the bytes the slave supplied, the rest is 0xFF
+void host_i2c_slave_set_clock(uint32_t hz);              // 400 kHz by default, like the portapack
+host_i2c_stats_t host_i2c_slave_get_stats();
+void host_i2c_slave_reset_stats();
+double host_i2c_transaction_us(size_t data_bytes, uint32_t clock_hz);
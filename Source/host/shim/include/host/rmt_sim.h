@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the simulated rmt. a transmit encodes the whole frame at once and hands it to the tx hook,
+// host_rmt_receive() gives a frame to the armed rx channel like the receive done interrupt.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/rmt_types.h"
+
+typedef void (*host_rmt_tx_fn)(void* arg, const rmt_symbol_word_t* symbols, size_t count, uint32_t carrier_hz);
+
+void host_rmt_set_tx_hook(host_rmt_tx_fn fn, void* arg);
+bool host_rmt_receive(const rmt_symbol_word_t* symbols, size_t count);  // false if no rx channel is waiting
+bool host_rmt_rx_armed();
+void host_rmt_air(const rmt_symbol_word_t* tx, size_t count, rmt_symbol_word_t* rx);  // what a demodulating receiver sees: the levels inverted, the last gap open
@@ -0,0 +1,13 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the value of the simulated on-chip temperature sensor
+
+#pragma once
+
+void host_temperature_set(float celsius);
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: what the benchmarks can see of the tasks
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t host_task_cpu_ns(TaskHandle_t task);  // cpu time the task's thread used so far, 0 if it is not running
+
+#ifdef __cplusplus
+}
+#endif
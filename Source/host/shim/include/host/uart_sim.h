@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the far end of the simulated uarts.
+// received bytes go to the rx ring like from the fifo: a pattern char queues its position and a UART_PATTERN_DET
+// event, bytes that don't fit are dropped with a UART_BUFFER_FULL event, a full event queue drops the event.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/uart.h"
+
+typedef void (*host_uart_tx_fn)(void* arg, const uint8_t* data, size_t len);
+
+typedef struct {
+    uint64_t rx_bytes;          // accepted to the rx ring
+    uint64_t rx_dropped;        // did not fit to the rx ring
+    uint64_t patterns;          // pattern positions queued
+    uint64_t patterns_dropped;  // the pattern queue was full
+    uint64_t events_dropped;    // the event queue was full
+    uint64_t tx_bytes;
+} host_uart_stats_t;
+
+size_t host_uart_feed(uart_port_t port, const void* data, size_t len);                         // returns the accepted bytes
+size_t host_uart_feed_wait(uart_port_t port, const void* data, size_t len, uint32_t timeout_ms);  // waits for room in the rx ring instead of dropping
+bool host_uart_wait_drained(uart_port_t port, uint32_t timeout_ms);                              // till the ring and the event queue are empty
+void host_uart_set_tx_hook(uart_port_t port, host_uart_tx_fn fn, void* arg);                      // called with what the firmware writes
+uint32_t host_uart_get_baud(uart_port_t port);
+host_uart_stats_t host_uart_get_stats(uart_port_t port);
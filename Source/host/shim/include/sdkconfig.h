@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the options of Source/sdkconfig the portable code depends on
+
+#pragma once
+
+#define CONFIG_IDF_TARGET "esp32s3"
+#define CONFIG_IDF_TARGET_ESP32S3 1
+#define CONFIG_FREERTOS_HZ 100  // same tick as the device, so the timeouts round the same way
+#define CONFIG_LOG_MAXIMUM_LEVEL 3
+#define CONFIG_GPSTXPIN 6
+#define CONFIG_IC2SCLPIN 4
+#define CONFIG_IC2SDAPIN 5
+#define CONFIG_I2C_SLAVE_SCL_IO 10
+#define CONFIG_I2C_SLAVE_SDA_IO 11
+#define CONFIG_IR_RX_PIN 12
+#define CONFIG_IR_TX_PIN 13
@@ -0,0 +1,12 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#pragma once
+
+// the s3 bus timeout field, i2cdev.h uses it as the max clock stretch
+#define I2C_TIME_OUT_VALUE_V 0x0000001F
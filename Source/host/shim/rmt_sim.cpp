@@ -0,0 +1,232 @@
+#include "host/rmt_sim.h"
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_encoder.h"
+#include "freertos/FreeRTOS.h"
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+struct rmt_channel_t {
+    bool tx;
+    bool enabled = false;
+    uint32_t carrier_hz = 0;
+    // rx
+    rmt_rx_done_callback_t on_recv_done = nullptr;
+    void* user_data = nullptr;
+    rmt_symbol_word_t* buffer = nullptr;
+    size_t buffer_symbols = 0;
+    // tx
+    std::vector<rmt_symbol_word_t> frame;
+};
+
+namespace {
+
+struct CopyEncoder {
+    rmt_encoder_t base;
+};
+
+struct Sim {
+    std::mutex m;
+    std::vector<rmt_channel_t*> rx_channels;
+    host_rmt_tx_fn tx_fn = nullptr;
+    void* tx_arg = nullptr;
+};
+
+Sim& sim() {
+    static Sim* s = new Sim();
+    return *s;
+}
+
+size_t copy_encode(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* primary_data, size_t data_size, rmt_encode_state_t* ret_state) {
+    (void)encoder;
+    size_t n = data_size / sizeof(rmt_symbol_word_t);
+    const rmt_symbol_word_t* symbols = (const rmt_symbol_word_t*)primary_data;
+    channel->frame.insert(channel->frame.end(), symbols, symbols + n);
+    *ret_state = RMT_ENCODING_COMPLETE;  // the channel memory never fills up here
+    return n;
+}
+
+esp_err_t copy_reset(rmt_encoder_t* encoder) {
+    (void)encoder;
+    return ESP_OK;
+}
+
+esp_err_t copy_del(rmt_encoder_t* encoder) {
+    delete __containerof(encoder, CopyEncoder, base);
+    return ESP_OK;
+}
+
+}  // namespace
+
+void host_rmt_set_tx_hook(host_rmt_tx_fn fn, void* arg) {
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    s.tx_fn = fn;
+    s.tx_arg = arg;
+}
+
+bool host_rmt_rx_armed() {
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    for (auto* ch : s.rx_channels)
+        if (ch->enabled && ch->buffer) return true;
+    return false;
+}
+
+bool host_rmt_receive(const rmt_symbol_word_t* symbols, size_t count) {
+    Sim& s = sim();
+    rmt_channel_t* ch = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s.m);
+        for (auto* c : s.rx_channels) {
+            if (c->enabled && c->buffer) {
+                ch = c;
+                break;
+            }
+        }
+        if (!ch) return false;
+    }
+    size_t n = count < ch->buffer_symbols ? count : ch->buffer_symbols;
+    memcpy(ch->buffer, symbols, n * sizeof(rmt_symbol_word_t));
+    rmt_rx_done_event_data_t edata = {};
+    edata.received_symbols = ch->buffer;
+    edata.num_symbols = n;
+    edata.flags.is_last = 1;
+    ch->buffer = nullptr;  // one shot, rmt_receive() arms it again
+    host_isr_enter();
+    if (ch->on_recv_done) ch->on_recv_done(ch, &edata, ch->user_data);
+    host_isr_exit();
+    return true;
+}
+
+void host_rmt_air(const rmt_symbol_word_t* tx, size_t count, rmt_symbol_word_t* rx) {
+    for (size_t i = 0; i < count; i++) {
+        rx[i] = tx[i];
+        rx[i].level0 = !tx[i].level0;
+        rx[i].level1 = !tx[i].level1;
+    }
+    if (count) rx[count - 1].duration1 = 0;  // the receiver stops at the idle, the last gap has no end
+}
+
+extern "C" {
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t* config, rmt_channel_handle_t* ret_chan) {
+    (void)config;
+    rmt_channel_t* ch = new rmt_channel_t();
+    ch->tx = false;
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    s.rx_channels.push_back(ch);
+    *ret_chan = ch;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t* config, rmt_channel_handle_t* ret_chan) {
+    (void)config;
+    rmt_channel_t* ch = new rmt_channel_t();
+    ch->tx = true;
+    *ret_chan = ch;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    Sim& s = sim();
+    {
+        std::lock_guard<std::mutex> lock(s.m);
+        for (auto it = s.rx_channels.begin(); it != s.rx_channels.end(); ++it) {
+            if (*it == channel) {
+                s.rx_channels.erase(it);
+                break;
+            }
+        }
+    }
+    delete channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_apply_carrier(rmt_channel_handle_t channel, const rmt_carrier_config_t* config) {
+    channel->carrier_hz = config ? config->frequency_hz : 0;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    channel->enabled = false;
+    channel->buffer = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t rx_channel, const rmt_rx_event_callbacks_t* cbs, void* user_data) {
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    rx_channel->on_recv_done = cbs->on_recv_done;
+    rx_channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_receive(rmt_channel_handle_t rx_channel, void* buffer, size_t buffer_size, const rmt_receive_config_t* config) {
+    (void)config;
+    Sim& s = sim();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (!rx_channel->enabled) return ESP_ERR_INVALID_STATE;
+    rx_channel->buffer = (rmt_symbol_word_t*)buffer;
+    rx_channel->buffer_symbols = buffer_size / sizeof(rmt_symbol_word_t);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    (void)config;
+    CopyEncoder* enc = new CopyEncoder();
+    enc->base.encode = copy_encode;
+    enc->base.reset = copy_reset;
+    enc->base.del = copy_del;
+    *ret_encoder = &enc->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder) {
+    return encoder->reset(encoder);
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void* payload, size_t payload_bytes, const rmt_transmit_config_t* config) {
+    (void)config;
+    if (!tx_channel->enabled) return ESP_ERR_INVALID_STATE;
+    tx_channel->frame.clear();
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    for (int i = 0; i < 64 && !(state & RMT_ENCODING_COMPLETE); i++) {
+        encoder->encode(encoder, tx_channel, payload, payload_bytes, &state);
+    }
+    if (!(state & RMT_ENCODING_COMPLETE)) return ESP_FAIL;
+    Sim& s = sim();
+    host_rmt_tx_fn fn;
+    void* arg;
+    {
+        std::lock_guard<std::mutex> lock(s.m);
+        fn = s.tx_fn;
+        arg = s.tx_arg;
+    }
+    if (fn) fn(arg, tx_channel->frame.data(), tx_channel->frame.size(), tx_channel->carrier_hz);
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms) {
+    (void)tx_channel;
+    (void)timeout_ms;
+    return ESP_OK;
+}
+
+}  // extern "C"
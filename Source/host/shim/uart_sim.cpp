@@ -0,0 +1,301 @@
+#include "driver/uart.h"
+#include "host/uart_sim.h"
+#include "freertos/queue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Port {
+    std::mutex m;
+    std::condition_variable changed;
+    bool installed = false;
+    QueueHandle_t events = nullptr;
+    std::vector<uint8_t> ring;
+    uint64_t rd = 0;  // absolute byte counters, the ring index is counter % size
+    uint64_t wr = 0;
+    bool pattern_on = false;
+    char pattern_chr = '\n';
+    std::deque<uint64_t> patterns;  // absolute position of each pattern char
+    size_t pattern_cap = 0;
+    uint32_t baud = 115200;
+    host_uart_tx_fn tx_fn = nullptr;
+    void* tx_arg = nullptr;
+    host_uart_stats_t stats = {};
+};
+
+Port& port(uart_port_t num) {
+    static Port* ports = new Port[UART_NUM_MAX];
+    return ports[num < 0 || num >= UART_NUM_MAX ? 0 : num];
+}
+
+void post(Port& p, uart_event_type_t type, size_t size) {
+    uart_event_t event = {type, size, false};
+    if (xQueueSendFromISR(p.events, &event, NULL) != pdTRUE) p.stats.events_dropped++;
+}
+
+// "rx interrupt": copies what fits, returns the accepted count. called with p.m held
+size_t receive(Port& p, const uint8_t* data, size_t len) {
+    size_t space = p.ring.size() - (size_t)(p.wr - p.rd);
+    size_t n = len < space ? len : space;
+    size_t found = 0;
+    for (size_t i = 0; i < n; i++) {
+        p.ring[p.wr % p.ring.size()] = data[i];
+        if (p.pattern_on && (char)data[i] == p.pattern_chr) {
+            if (p.patterns.size() < p.pattern_cap) {
+                p.patterns.push_back(p.wr);
+                p.stats.patterns++;
+                found++;
+            } else {
+                p.stats.patterns_dropped++;
+            }
+        }
+        p.wr++;
+    }
+    p.stats.rx_bytes += n;
+    if (n) post(p, UART_DATA, n);
+    for (size_t i = 0; i < found; i++) post(p, UART_PATTERN_DET, 0);
+    if (n < len) {
+        p.stats.rx_dropped += len - n;
+        post(p, UART_BUFFER_FULL, 0);
+    }
+    return n;
+}
+
+}  // namespace
+
+size_t host_uart_feed(uart_port_t num, const void* data, size_t len) {
+    Port& p = port(num);
+    size_t n;
+    {
+        std::lock_guard<std::mutex> lock(p.m);
+        if (!p.installed) return 0;
+        n = receive(p, (const uint8_t*)data, len);
+    }
+    p.changed.notify_all();
+    return n;
+}
+
+size_t host_uart_feed_wait(uart_port_t num, const void* data, size_t len, uint32_t timeout_ms) {
+    Port& p = port(num);
+    const uint8_t* src = (const uint8_t*)data;
+    size_t done = 0;
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::unique_lock<std::mutex> lock(p.m);
+    while (done < len && p.installed) {
+        if (!p.changed.wait_until(lock, until, [&p] { return p.wr - p.rd < p.ring.size(); })) break;
+        size_t space = p.ring.size() - (size_t)(p.wr - p.rd);
+        size_t chunk = len - done < space ? len - done : space;
+        done += receive(p, src + done, chunk);
+        p.changed.notify_all();
+    }
+    return done;
+}
+
+bool host_uart_wait_drained(uart_port_t num, uint32_t timeout_ms) {
+    Port& p = port(num);
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < until) {
+        {
+            std::lock_guard<std::mutex> lock(p.m);
+            if (p.rd == p.wr && (!p.events || uxQueueMessagesWaiting(p.events) == 0)) return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void host_uart_set_tx_hook(uart_port_t num, host_uart_tx_fn fn, void* arg) {
+    Port& p = port(num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.tx_fn = fn;
+    p.tx_arg = arg;
+}
+
+uint32_t host_uart_get_baud(uart_port_t num) {
+    Port& p = port(num);
+    std::lock_guard<std::mutex> lock(p.m);
+    return p.baud;
+}
+
+host_uart_stats_t host_uart_get_stats(uart_port_t num) {
+    Port& p = port(num);
+    std::lock_guard<std::mutex> lock(p.m);
+    return p.stats;
+}
+
+extern "C" {
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size, QueueHandle_t* uart_queue, int intr_alloc_flags) {
+    (void)tx_buffer_size;
+    (void)intr_alloc_flags;
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX || rx_buffer_size <= 128) return ESP_ERR_INVALID_ARG;
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (p.installed) return ESP_FAIL;
+    p.ring.assign(rx_buffer_size, 0);
+    p.rd = p.wr = 0;
+    p.patterns.clear();
+    p.stats = {};
+    p.events = nullptr;
+    if (queue_size > 0 && uart_queue) {
+        p.events = xQueueCreate(queue_size, sizeof(uart_event_t));
+        *uart_queue = p.events;
+    }
+    p.installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    if (!p.installed) return ESP_OK;
+    p.installed = false;
+    if (p.events) vQueueDelete(p.events);
+    p.events = nullptr;
+    p.changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.baud = uart_config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    (void)uart_num;
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t uart_num, uint32_t baudrate) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.baud = baudrate;
+    return ESP_OK;
+}
+
+esp_err_t uart_get_baudrate(uart_port_t uart_num, uint32_t* baudrate) {
+    *baudrate = host_uart_get_baud(uart_num);
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void* buf, uint32_t length, TickType_t ticks_to_wait) {
+    Port& p = port(uart_num);
+    std::unique_lock<std::mutex> lock(p.m);
+    auto ready = [&p, length] { return p.wr - p.rd >= length || !p.installed; };
+    if (ticks_to_wait == portMAX_DELAY) {
+        p.changed.wait(lock, ready);
+    } else {
+        p.changed.wait_for(lock, std::chrono::microseconds((uint64_t)ticks_to_wait * 1000000ULL / configTICK_RATE_HZ), ready);
+    }
+    if (!p.installed) return -1;
+    size_t avail = (size_t)(p.wr - p.rd);
+    size_t n = length < avail ? length : avail;
+    uint8_t* dst = (uint8_t*)buf;
+    for (size_t i = 0; i < n; i++) dst[i] = p.ring[(p.rd + i) % p.ring.size()];
+    p.rd += n;
+    lock.unlock();
+    p.changed.notify_all();
+    return (int)n;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void* src, size_t size) {
+    Port& p = port(uart_num);
+    host_uart_tx_fn fn;
+    void* arg;
+    {
+        std::lock_guard<std::mutex> lock(p.m);
+        if (!p.installed) return -1;
+        p.stats.tx_bytes += size;
+        fn = p.tx_fn;
+        arg = p.tx_arg;
+    }
+    if (fn) fn(arg, (const uint8_t*)src, size);
+    return (int)size;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks_to_wait) {
+    (void)uart_num;
+    (void)ticks_to_wait;
+    return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    Port& p = port(uart_num);
+    {
+        std::lock_guard<std::mutex> lock(p.m);
+        p.rd = p.wr;
+        p.patterns.clear();
+    }
+    p.changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t uart_flush(uart_port_t uart_num) {
+    return uart_flush_input(uart_num);
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t* size) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    *size = (size_t)(p.wr - p.rd);
+    return ESP_OK;
+}
+
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t uart_num, char pattern_chr, uint8_t chr_num, int chr_tout, int post_idle, int pre_idle) {
+    (void)chr_tout;
+    (void)post_idle;
+    (void)pre_idle;
+    if (chr_num != 1) return ESP_ERR_NOT_SUPPORTED;  // the firmware only uses a single '\n'
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.pattern_on = true;
+    p.pattern_chr = pattern_chr;
+    return ESP_OK;
+}
+
+esp_err_t uart_disable_pattern_det_intr(uart_port_t uart_num) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.pattern_on = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_pattern_queue_reset(uart_port_t uart_num, int queue_length) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    p.patterns.clear();
+    p.pattern_cap = queue_length > 1 ? queue_length - 1 : 0;  // a ring of queue_length keeps one slot empty, like the driver
+    return ESP_OK;
+}
+
+int uart_pattern_pop_pos(uart_port_t uart_num) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    while (!p.patterns.empty() && p.patterns.front() < p.rd) p.patterns.pop_front();  // already read past it
+    if (p.patterns.empty()) return -1;
+    int pos = (int)(p.patterns.front() - p.rd);
+    p.patterns.pop_front();
+    return pos;
+}
+
+int uart_pattern_get_pos(uart_port_t uart_num) {
+    Port& p = port(uart_num);
+    std::lock_guard<std::mutex> lock(p.m);
+    while (!p.patterns.empty() && p.patterns.front() < p.rd) p.patterns.pop_front();
+    return p.patterns.empty() ? -1 : (int)(p.patterns.front() - p.rd);
+}
+
+}  // extern "C"
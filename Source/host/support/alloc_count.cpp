@@ -0,0 +1,41 @@
+#include "alloc_count.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "freertos/FreeRTOS.h"
+
+static std::atomic<uint64_t> news{0};
+static std::atomic<uint64_t> deletes{0};
+static std::atomic<uint64_t> isr_news{0};
+static std::atomic<uint64_t> isr_deletes{0};
+
+host_alloc_stats_t host_alloc_get_stats() {
+    return {news, deletes, isr_news, isr_deletes};
+}
+
+void host_alloc_reset_stats() {
+    news = 0;
+    deletes = 0;
+    isr_news = 0;
+    isr_deletes = 0;
+}
+
+// the array and nothrow forms of libstdc++ end up here too
+void* operator new(size_t size) {
+    news.fetch_add(1, std::memory_order_relaxed);
+    if (xPortInIsrContext()) isr_news.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    deletes.fetch_add(1, std::memory_order_relaxed);
+    if (xPortInIsrContext()) isr_deletes.fetch_add(1, std::memory_order_relaxed);
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
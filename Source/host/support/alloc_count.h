@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: counts the c++ heap use (the global operator new / delete are replaced in the test and benchmark binaries).
+// the ones made in the simulated isr context are counted separately, the i2c slave callbacks must not allocate
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t news;
+    uint64_t deletes;
+    uint64_t isr_news;  // while xPortInIsrContext()
+    uint64_t isr_deletes;
+} host_alloc_stats_t;
+
+host_alloc_stats_t host_alloc_get_stats();
+void host_alloc_reset_stats();
@@ -0,0 +1,77 @@
+#include "apps/appmanager.hpp"
+#include <mutex>
+#include "host_stubs.h"
+
+// the real app manager brings the wifi apps. none is running on the host
+
+EPApp* AppManager::currentApp = nullptr;
+uint16_t AppManager::currentAppId = 0;
+
+void AppManager::startApp(AppList app) {
+    (void)app;
+}
+
+void AppManager::stopApp() {}
+
+void AppManager::loop(uint32_t currentMillis) {
+    (void)currentMillis;
+}
+
+bool AppManager::handlePPAppmgrCommands(PPSpan& data) {
+    (void)data;
+    return false;
+}
+
+bool AppManager::handlePPReqAppmgrCommands(PPSpan& data) {
+    uint16_t none = (uint16_t)AppList::NONE;
+    data.assign(none);
+    return true;
+}
+
+bool AppManager::handlePPData(uint16_t command, PPSpan& data) {
+    (void)command;
+    (void)data;
+    return false;
+}
+
+bool AppManager::handlePPReqData(uint16_t command, PPSpan& data) {
+    (void)command;
+    (void)data;
+    return false;
+}
+
+bool AppManager::handleWebData(const char* data, size_t len) {
+    (void)data;
+    (void)len;
+    return false;
+}
+
+void AppManager::handleDisplayRequest(DisplayGeneric* display) {
+    (void)display;
+}
+
+void AppManager::sendCurrentAppToWeb() {}
+
+static std::mutex ws_mutex;
+static std::string ws_data;
+static bool ws_accept = true;
+
+bool ws_sendall(uint8_t* data, size_t len, bool asyncmsg) {
+    (void)asyncmsg;
+    std::lock_guard<std::mutex> lock(ws_mutex);
+    if (!ws_accept) return false;
+    ws_data.append((const char*)data, len);
+    return true;
+}
+
+std::string host_ws_sent() {
+    std::lock_guard<std::mutex> lock(ws_mutex);
+    std::string ret;
+    ret.swap(ws_data);
+    return ret;
+}
+
+void host_ws_set_accept(bool accept) {
+    std::lock_guard<std::mutex> lock(ws_mutex);
+    ws_accept = accept;
+}
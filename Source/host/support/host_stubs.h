@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: what the tested modules call outside of themselves (app manager, web socket, i2c sensors), recorded for the tests
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+std::string host_ws_sent();  // everything sent to the web sockets since the last call
+void host_ws_set_accept(bool accept);  // false: ws_sendall fails, like with no client connected
+
+// the sensors behind orientation.h and environment.h. every read returns the next value of a counter in all its fields
+// (heading and tilt, temperature pressure and humidity, light), so a torn copy shows up as different fields
+typedef enum {
+    HOST_SENSOR_ORIENTATION,
+    HOST_SENSOR_ENVIRONMENT,
+    HOST_SENSOR_LIGHT,
+    HOST_SENSOR_MAX
+} host_sensor_t;
+
+void host_sensor_set_present(host_sensor_t sensor, bool present);  // all present by default
+std::vector<int64_t> host_sensor_reads(host_sensor_t sensor);      // esp_timer times of the reads since the last call
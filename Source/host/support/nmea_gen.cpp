@@ -0,0 +1,106 @@
+#include "nmea_gen.h"
+#include <cmath>
+#include <cstdio>
+
+std::string nmea_sentence(const std::string& body) {
+    uint8_t cs = 0;
+    for (char c : body) cs ^= (uint8_t)c;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", cs);
+    return "$" + body + tail;
+}
+
+static std::string nmea_coord(double deg, bool lat) {
+    double a = fabs(deg);
+    int d = (int)a;
+    double m = (a - d) * 60.0;
+    char buf[32];
+    if (lat)
+        snprintf(buf, sizeof(buf), "%02d%08.5f,%c", d, m, deg < 0 ? 'S' : 'N');
+    else
+        snprintf(buf, sizeof(buf), "%03d%08.5f,%c", d, m, deg < 0 ? 'W' : 'E');
+    return buf;
+}
+
+static std::string nmea_time(const nmea_fix_t& fix) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d%02d%05.2f", fix.hour, fix.minute, fix.second);
+    return buf;
+}
+
+std::string nmea_rmc(const nmea_fix_t& fix, const char* talker) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%sRMC,%s,%c,%s,%s,%.2f,%.2f,%02d%02d%02d,,,A", talker, nmea_time(fix).c_str(), fix.fix ? 'A' : 'V',
+             nmea_coord(fix.lat, true).c_str(), nmea_coord(fix.lon, false).c_str(), fix.knots, fix.course, fix.day, fix.month, fix.year % 100);
+    return nmea_sentence(buf);
+}
+
+std::string nmea_gga(const nmea_fix_t& fix, const char* talker) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%sGGA,%s,%s,%s,%d,%02d,%.1f,%.1f,M,40.1,M,,", talker, nmea_time(fix).c_str(), nmea_coord(fix.lat, true).c_str(),
+             nmea_coord(fix.lon, false).c_str(), fix.fix, fix.sats_in_use, fix.hdop, fix.alt);
+    return nmea_sentence(buf);
+}
+
+std::string nmea_gsa(const std::vector<int>& prns, int system_id, const char* talker) {
+    std::string body = std::string(talker) + "GSA,A,3";
+    for (size_t i = 0; i < 12; i++) {
+        char buf[8];
+        if (i < prns.size())
+            snprintf(buf, sizeof(buf), ",%02d", prns[i]);
+        else
+            snprintf(buf, sizeof(buf), ",");
+        body += buf;
+    }
+    body += ",1.5,0.9,1.2";
+    if (system_id) body += "," + std::to_string(system_id);
+    return nmea_sentence(body);
+}
+
+std::string nmea_gsv(const std::vector<nmea_sat_t>& sats, const char* talker, int signal_id) {
+    std::string ret;
+    size_t n = sats.empty() ? 1 : (sats.size() + 3) / 4;
+    for (size_t k = 0; k < n; k++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%sGSV,%d,%d,%02d", talker, (int)n, (int)k + 1, (int)sats.size());
+        std::string body = buf;
+        for (size_t i = k * 4; i < sats.size() && i < k * 4 + 4; i++) {
+            const nmea_sat_t& s = sats[i];
+            if (s.snr)
+                snprintf(buf, sizeof(buf), ",%02d,%02d,%03d,%02d", s.prn, s.elevation, s.azimuth, s.snr);
+            else
+                snprintf(buf, sizeof(buf), ",%02d,%02d,%03d,", s.prn, s.elevation, s.azimuth);
+            body += buf;
+        }
+        if (signal_id) {
+            snprintf(buf, sizeof(buf), ",%X", signal_id);
+            body += buf;
+        }
+        ret += nmea_sentence(body);
+    }
+    return ret;
+}
+
+std::string nmea_epoch(const nmea_fix_t& fix, const std::vector<nmea_sat_t>& sats) {
+    std::vector<int> used;
+    for (const nmea_sat_t& s : sats)
+        if (s.snr > 30 && used.size() < 12) used.push_back(s.prn);
+    return nmea_rmc(fix) + nmea_gga(fix) + nmea_gsa(used) + nmea_gsv(sats);
+}
+
+nmea_fix_t nmea_default_fix() {
+    nmea_fix_t fix = {};
+    fix.hour = 10;
+    fix.day = 17;
+    fix.month = 8;
+    fix.year = 2024;
+    fix.lat = 47.485391;
+    fix.lon = 19.058869;
+    fix.alt = 110.0;
+    fix.knots = 10.0;
+    fix.course = 45.0;
+    fix.fix = 1;
+    fix.sats_in_use = 8;
+    fix.hdop = 0.9;
+    return fix;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: nmea sentences for the parser tests and benchmarks, with valid checksums
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+typedef struct {
+    int hour, minute;
+    double second;
+    int day, month, year;  // year 2000+
+    double lat, lon;       // degrees, negative south / west
+    double alt;            // m above msl
+    double knots;
+    double course;
+    int fix;  // gga fix quality, 0 none
+    int sats_in_use;
+    double hdop;
+} nmea_fix_t;
+
+typedef struct {
+    int prn;
+    int elevation;
+    int azimuth;
+    int snr;  // 0: not tracked, empty field
+} nmea_sat_t;
+
+std::string nmea_sentence(const std::string& body);  // $body*CS\r\n
+std::string nmea_rmc(const nmea_fix_t& fix, const char* talker = "GN");
+std::string nmea_gga(const nmea_fix_t& fix, const char* talker = "GN");
+std::string nmea_gsa(const std::vector<int>& prns, int system_id = 0, const char* talker = "GN");
+std::string nmea_gsv(const std::vector<nmea_sat_t>& sats, const char* talker = "GP", int signal_id = 0);  // nmea 4.10 signal id, 0: none
+std::string nmea_epoch(const nmea_fix_t& fix, const std::vector<nmea_sat_t>& sats);  // rmc, gga, gsa and the gsv group of one fix
+nmea_fix_t nmea_default_fix();  // budapest, 2024-08-17 10:00:00, moving at 10 knots
@@ -0,0 +1,71 @@
+#include "pp_master.h"
+#include <cstring>
+#include <mutex>
+#include "host/i2c_bus.h"
+#include "pp_handler.hpp"
+#include "sdkconfig.h"
+
+void pp_master_init() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        PPHandler::init((gpio_num_t)CONFIG_I2C_SLAVE_SCL_IO, (gpio_num_t)CONFIG_I2C_SLAVE_SDA_IO, ESP_SLAVE_ADDR);
+    });
+}
+
+bool pp_send(uint16_t command, const void* data, size_t len) {
+    uint8_t buf[2 + PP_I2C_BUFFER_SIZE];
+    if (len > PP_I2C_BUFFER_SIZE) return false;
+    buf[0] = command & 0xFF;
+    buf[1] = command >> 8;
+    if (len) memcpy(buf + 2, data, len);
+    return host_i2c_slave_write(buf, 2 + len);
+}
+
+size_t pp_receive(void* out, size_t len) {
+    return host_i2c_slave_read((uint8_t*)out, len);
+}
+
+std::vector<uint8_t> pp_query(uint16_t command, size_t reply_len, const void* data, size_t len) {
+    std::vector<uint8_t> ret(reply_len);
+    if (!pp_send(command, data, len)) return {};
+    ret.resize(pp_receive(ret.data(), reply_len));
+    return ret;
+}
+
+typedef struct {
+    Command command;
+    const char* data;  // written after the command
+    size_t len;
+    size_t reply_len;  // 0: no read transaction
+} pp_trace_step_t;
+
+// sensor polls, the shell bridge's size polls and frames, and the rarer setup queries
+static const pp_trace_step_t pp_trace[] = {
+    {Command::COMMAND_GETFEAT_DATA_ALL, nullptr, 0, sizeof(feat_data_all_t)},
+    {Command::COMMAND_SHELL_MODTOPP_DATA_SIZE, nullptr, 0, sizeof(shell_data_size_t)},
+    {Command::COMMAND_SHELL_PPTOMOD_DATA, "help\r\n", 6, 0},
+    {Command::COMMAND_SHELL_MODTOPP_DATA_SIZE, nullptr, 0, sizeof(shell_data_size_t)},
+    {Command::COMMAND_SHELL_MODTOPP_DATA, nullptr, 0, 1 + PP_SHELL_FRAME_DEFAULT},
+    {Command::COMMAND_GETFEATURE_MASK, nullptr, 0, sizeof(uint64_t)},
+    {Command::COMMAND_GETFEAT_DATA_GPS, nullptr, 0, sizeof(ppgpssmall_t)},
+    {Command::COMMAND_GETFEAT_DATA_ORIENTATION, nullptr, 0, sizeof(orientation_t)},
+    {Command::COMMAND_GETFEAT_DATA_ENVIRONMENT, nullptr, 0, sizeof(environment_t)},
+    {Command::COMMAND_GETFEAT_DATA_LIGHT, nullptr, 0, sizeof(uint16_t)},
+    {Command::COMMAND_SHELL_FRAME_SIZE, nullptr, 0, 1},
+    {Command::COMMAND_INFO, nullptr, 0, sizeof(device_info)},
+    {Command::COMMAND_SHELL_MODTOPP_DATA_SIZE, nullptr, 0, sizeof(shell_data_size_t)},
+};
+
+size_t pp_replay_mix() {
+    uint8_t reply[PP_I2C_BUFFER_SIZE];
+    size_t transactions = 0;
+    for (const pp_trace_step_t& step : pp_trace) {
+        pp_send((uint16_t)step.command, step.data, step.len);
+        transactions++;
+        if (step.reply_len) {
+            pp_receive(reply, step.reply_len);
+            transactions++;
+        }
+    }
+    return transactions;
+}
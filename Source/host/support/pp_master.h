@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: the portapack side of the ppi2c protocol, over the simulated slave bus.
+// a command is a write transaction (u16 command + data), the reply is the following read transaction.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+void pp_master_init();  // starts PPHandler on the simulated slave once, later calls do nothing
+bool pp_send(uint16_t command, const void* data = nullptr, size_t len = 0);
+size_t pp_receive(void* out, size_t len);  // bytes the module supplied
+std::vector<uint8_t> pp_query(uint16_t command, size_t reply_len, const void* data = nullptr, size_t len = 0);
+size_t pp_replay_mix();  // one round of a mixed command trace, like the pp's polling with the shell open. returns the transactions
+
+template <typename T>
+T pp_query_as(uint16_t command) {
+    T ret{};
+    pp_send(command);
+    pp_receive(&ret, sizeof(ret));
+    return ret;
+}
@@ -0,0 +1,58 @@
+#include <atomic>
+#include <mutex>
+#include "environment.h"
+#include "esp_timer.h"
+#include "host_stubs.h"
+#include "orientation.h"
+
+// the real modules probe the i2c sensors through the drivers, here they are always there and count their reads
+
+static std::atomic<bool> present[HOST_SENSOR_MAX] = {true, true, true};
+static std::atomic<uint32_t> counter[HOST_SENSOR_MAX] = {};
+static std::mutex reads_lock;
+static std::vector<int64_t> reads[HOST_SENSOR_MAX];
+
+static uint32_t next_read(host_sensor_t sensor) {
+    std::lock_guard<std::mutex> lock(reads_lock);
+    reads[sensor].push_back(esp_timer_get_time());
+    return ++counter[sensor];
+}
+
+void host_sensor_set_present(host_sensor_t sensor, bool is_present) {
+    present[sensor] = is_present;
+}
+
+std::vector<int64_t> host_sensor_reads(host_sensor_t sensor) {
+    std::lock_guard<std::mutex> lock(reads_lock);
+    std::vector<int64_t> ret;
+    ret.swap(reads[sensor]);
+    return ret;
+}
+
+bool is_orientation_sensor_present() {
+    return present[HOST_SENSOR_ORIENTATION];
+}
+
+float get_heading_degrees() {
+    return next_read(HOST_SENSOR_ORIENTATION);
+}
+
+float get_tilt() {
+    return counter[HOST_SENSOR_ORIENTATION];  // read right after the heading
+}
+
+bool is_environment_sensor_present() {
+    return present[HOST_SENSOR_ENVIRONMENT];
+}
+
+void get_environment_meas(float* temperature, float* pressure, float* humidity) {
+    *temperature = *pressure = *humidity = next_read(HOST_SENSOR_ENVIRONMENT);
+}
+
+bool is_environment_light_sensor_present() {
+    return present[HOST_SENSOR_LIGHT];
+}
+
+void get_environment_light(uint16_t* light) {
+    *light = next_read(HOST_SENSOR_LIGHT);
+}
@@ -0,0 +1,80 @@
+#include "ssd1306_model.h"
+
+size_t Ssd1306Model::command_len(uint8_t cmd) {
+    switch (cmd) {
+        case 0x81:  // contrast
+        case 0xA8:  // mux ratio
+        case 0xD3:  // display offset
+        case 0xD5:  // clock divider
+        case 0xD9:  // precharge
+        case 0xDA:  // com pins
+        case 0xDB:  // vcomh
+        case 0x20:  // memory addressing mode
+        case 0x8D:  // charge pump
+            return 2;
+        case 0x21:  // column range
+        case 0x22:  // page range
+        case 0xA3:  // vertical scroll area
+            return 3;
+        case 0x26:  // horizontal scroll
+        case 0x27:
+            return 7;
+        case 0x29:  // vertical and horizontal scroll
+        case 0x2A:
+            return 6;
+        default:
+            return 1;
+    }
+}
+
+void Ssd1306Model::command(const uint8_t* cmd, size_t len) {
+    (void)len;
+    commands++;
+    uint8_t c = cmd[0];
+    if (c <= 0x0F) {
+        column = (column & 0xF0) | c;
+    } else if (c <= 0x1F) {
+        column = (column & 0x0F) | ((c & 0x0F) << 4);
+    } else if (c >= 0xB0 && c <= 0xBF) {
+        page = c & 0x0F;
+    } else if (c == 0xAE) {
+        display_on = false;
+    } else if (c == 0xAF) {
+        display_on = true;
+    } else if (c == 0x81) {
+        contrast = cmd[1];
+    } else if (c == 0xA8) {
+        mux = cmd[1];
+    }
+}
+
+bool Ssd1306Model::write(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = data[i++];
+        bool single = control & 0x80;  // continuation: one byte, then an other control byte
+        bool is_data = control & 0x40;
+        size_t end = single ? (i + 1 < len ? i + 1 : len) : len;
+        if (is_data) {
+            for (; i < end; i++) {
+                if (page < PAGES) gddram[page][column] = data[i];
+                column = (column + 1) % COLUMNS;  // page mode wraps in the same page
+                data_bytes++;
+            }
+        } else {
+            while (i < end) {
+                size_t n = command_len(data[i]);
+                if (i + n > len) n = len - i;  // cut, the rest of the arguments never came
+                command(&data[i], n);
+                i += n;
+            }
+        }
+    }
+    return true;
+}
+
+bool Ssd1306Model::read(uint8_t* data, size_t len) {
+    // status byte: display off bit
+    for (size_t i = 0; i < len; i++) data[i] = display_on ? 0x00 : 0x40;
+    return true;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: an ssd1306 on the simulated i2c master bus. decodes the command and data streams of the driver
+// into the controller's gddram (page addressing mode), so the tests can compare it to the driver's framebuffer.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "host/i2c_bus.h"
+
+class Ssd1306Model : public HostI2CDevice {
+   public:
+    static constexpr int PAGES = 16;
+    static constexpr int COLUMNS = 128;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool read(uint8_t* data, size_t len) override;
+
+    uint8_t gddram[PAGES][COLUMNS] = {};
+    bool display_on = false;
+    uint8_t contrast = 0x7F;
+    uint8_t mux = 63;
+    uint8_t page = 0;
+    uint8_t column = 0;
+    uint32_t data_bytes = 0;  // gddram writes
+    uint32_t commands = 0;
+
+   private:
+    void command(const uint8_t* cmd, size_t len);
+    static size_t command_len(uint8_t cmd);
+};
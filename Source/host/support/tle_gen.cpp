@@ -0,0 +1,64 @@
+#include "tle_gen.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+int tle_checksum(const char* line) {
+    int sum = 0;
+    for (int i = 0; i < 68 && line[i]; i++) {
+        if (line[i] >= '0' && line[i] <= '9') sum += line[i] - '0';
+        if (line[i] == '-') sum++;
+    }
+    return sum % 10;
+}
+
+// the tle exponential format: " 12345-3" is 0.12345e-3
+static std::string tle_exp(double v) {
+    char buf[16];
+    if (v == 0) return " 00000-0";
+    int e = (int)floor(log10(fabs(v))) + 1;
+    int mant = (int)lround(fabs(v) / pow(10.0, e) * 100000.0);
+    if (mant >= 100000) {
+        mant /= 10;
+        e++;
+    }
+    snprintf(buf, sizeof(buf), "%c%05d%c%d", v < 0 ? '-' : ' ', mant, e < 0 ? '-' : '+', abs(e));
+    return buf;
+}
+
+std::string tle_make(const tle_elements_t& el) {
+    char l1[80], l2[80];
+    snprintf(l1, sizeof(l1), "1 %05uU 24001A   %02d%012.8f  .00001000  00000-0 %s 0  999", (unsigned)el.catnum, el.epoch_year, el.epoch_day,
+             tle_exp(el.bstar).c_str());
+    char ecc[16];
+    snprintf(ecc, sizeof(ecc), "%07ld", lround(el.eccentricity * 1e7));
+    snprintf(l2, sizeof(l2), "2 %05u %8.4f %8.4f %s %8.4f %8.4f %11.8f%5u", (unsigned)el.catnum, el.inclination, el.raan, ecc, el.arg_perigee,
+             el.mean_anomaly, el.mean_motion, (unsigned)(el.revs % 100000));
+    std::string ret = el.name + "\n";
+    ret += std::string(l1) + (char)('0' + tle_checksum(l1)) + "\n";
+    ret += std::string(l2) + (char)('0' + tle_checksum(l2)) + "\n";
+    return ret;
+}
+
+std::string tle_catalog(uint32_t count, uint32_t seed, uint32_t first_catnum) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::string ret;
+    for (uint32_t i = 0; i < count; i++) {
+        tle_elements_t el;
+        el.catnum = first_catnum + i;
+        el.name = "SAT " + std::to_string(el.catnum);
+        el.epoch_year = 24;
+        el.epoch_day = 230.0 + u(rng);
+        el.bstar = 1e-4 * (0.5 + u(rng));
+        el.inclination = 40.0 + 60.0 * u(rng);
+        el.raan = 360.0 * u(rng);
+        el.eccentricity = 0.02 * u(rng);
+        el.arg_perigee = 360.0 * u(rng);
+        el.mean_anomaly = 360.0 * u(rng);
+        el.mean_motion = 14.0 + 1.8 * u(rng);
+        el.revs = 1000 + i;
+        ret += tle_make(el);
+    }
+    return ret;
+}
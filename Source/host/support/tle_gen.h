@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+// host build: tle sets with valid checksums, for the tle db, the batch propagator and their benchmarks
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+typedef struct {
+    std::string name;
+    uint32_t catnum;
+    int epoch_year;  // 2 digits
+    double epoch_day;
+    double bstar;
+    double inclination;
+    double raan;
+    double eccentricity;
+    double arg_perigee;
+    double mean_anomaly;
+    double mean_motion;  // rev / day
+    uint32_t revs;
+} tle_elements_t;
+
+std::string tle_make(const tle_elements_t& el);  // name, line 1 and line 2, \n terminated
+std::string tle_catalog(uint32_t count, uint32_t seed, uint32_t first_catnum = 40000);  // random low earth orbits named "SAT <catnum>"
+int tle_checksum(const char* line);  // of the first 68 characters
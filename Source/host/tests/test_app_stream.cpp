@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "esp_rom_crc.h"
+#include "host/i2c_bus.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+
+// ext app transfer through the simulated i2c slave driver: the legacy 128 byte blocks and the v2 stream, with the bus cost of each
+
+static uint16_t add_test_app(uint32_t size) {
+    static std::vector<std::vector<uint8_t>> apps;  // PPHandler keeps the pointer
+    std::vector<uint8_t> bin(size);
+    for (uint32_t i = 0; i < size; ++i) bin[i] = (uint8_t)(i * 31 + i / 251);
+    apps.push_back(std::move(bin));
+    EXPECT_TRUE(PPHandler::add_app(apps.back().data(), size));
+    return PPHandler::get_appCount() - 1;
+}
+
+static bool chunk_ok(const app_stream_chunk_t& chunk) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&chunk, offsetof(app_stream_chunk_t, crc32)) == chunk.crc32;
+}
+
+static void stream_request(uint16_t app, uint16_t first_chunk, uint16_t chunk_count = 0) {
+    app_stream_request_t req = {app, first_chunk, chunk_count};
+    ASSERT_TRUE(pp_send((uint16_t)Command::COMMAND_APP_TRANSFER_STREAM, &req, sizeof(req)));
+}
+
+TEST(AppStream, WholeAppInOneRequest) {
+    pp_master_init();
+    const uint32_t size = 40 * 1024;
+    uint16_t app = add_test_app(size);
+    std::vector<uint8_t> got;
+    host_i2c_slave_reset_stats();
+    stream_request(app, 0);
+    app_stream_chunk_t chunk;
+    do {
+        ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+        ASSERT_TRUE(chunk_ok(chunk));
+        ASSERT_FALSE(chunk.flags & APP_STREAM_ERROR);
+        ASSERT_EQ(chunk.chunk * PP_APP_STREAM_CHUNK_SIZE, got.size());
+        got.insert(got.end(), chunk.data, chunk.data + chunk.len);
+    } while (!(chunk.flags & APP_STREAM_LAST));
+    host_i2c_stats_t stream = host_i2c_slave_get_stats();
+    ASSERT_EQ(got.size(), size);
+
+    // the same app in legacy blocks: a command write and a read for every 128 bytes
+    host_i2c_slave_reset_stats();
+    uint8_t block[128];
+    for (uint16_t b = 0; b < size / 128; ++b) {
+        uint16_t args[2] = {app, b};
+        pp_send((uint16_t)Command::COMMAND_APP_TRANSFER, args, sizeof(args));
+        ASSERT_EQ(pp_receive(block, sizeof(block)), sizeof(block));
+        ASSERT_EQ(memcmp(block, got.data() + b * 128, sizeof(block)), 0);
+    }
+    host_i2c_stats_t legacy = host_i2c_slave_get_stats();
+
+    RecordProperty("stream_transactions", (int)stream.transactions);
+    RecordProperty("legacy_transactions", (int)legacy.transactions);
+    RecordProperty("stream_bytes", (int)stream.bytes);
+    RecordProperty("legacy_bytes", (int)legacy.bytes);
+    EXPECT_EQ(stream.transactions, 1u + (size + PP_APP_STREAM_CHUNK_SIZE - 1) / PP_APP_STREAM_CHUNK_SIZE);
+    EXPECT_EQ(legacy.transactions, 2u * size / 128);
+    EXPECT_LT(stream.bus_us, legacy.bus_us);
+}
+
+TEST(AppStream, ShortReadGivesTheSameChunk) {
+    pp_master_init();
+    uint16_t app = add_test_app(1024);
+    stream_request(app, 1);
+    uint8_t part[16];
+    ASSERT_EQ(pp_receive(part, sizeof(part)), sizeof(part));  // master stopped early
+    app_stream_chunk_t chunk;
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    EXPECT_TRUE(chunk_ok(chunk));
+    EXPECT_EQ(chunk.chunk, 1);
+}
+
+TEST(AppStream, BadCrcIsRetriedWithANewRequest) {
+    pp_master_init();
+    uint16_t app = add_test_app(2048);
+    stream_request(app, 0);
+    app_stream_chunk_t chunk;
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    app_stream_chunk_t good = chunk;
+    chunk.data[7] ^= 0x10;  // hit on the bus, the slave clocked out the whole chunk
+    ASSERT_FALSE(chunk_ok(chunk));
+
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    EXPECT_EQ(chunk.chunk, 1);  // just reading again moves on
+
+    stream_request(app, 0);  // the documented retry
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    EXPECT_TRUE(chunk_ok(chunk));
+    EXPECT_EQ(chunk.chunk, 0);
+    EXPECT_EQ(memcmp(&chunk, &good, sizeof(chunk)), 0);
+}
+
+TEST(AppStream, ReadAfterTheRangeIsAnError) {
+    pp_master_init();
+    uint16_t app = add_test_app(1024);
+    stream_request(app, 2, 1);
+    app_stream_chunk_t chunk;
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    EXPECT_EQ(chunk.chunk, 2);
+    EXPECT_EQ(chunk.flags, APP_STREAM_LAST);
+    ASSERT_EQ(pp_receive(&chunk, sizeof(chunk)), sizeof(chunk));
+    EXPECT_TRUE(chunk_ok(chunk));
+    EXPECT_EQ(chunk.flags, APP_STREAM_ERROR | APP_STREAM_LAST);
+}
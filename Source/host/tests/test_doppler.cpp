@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "doppler.hpp"
+#include "sgp4/Sgp4.h"
+
+// Doppler::range_rate on the iss, seen from the point it flies over: the rate against the numeric derivative of the range,
+// zero at the closest approach, and the sign and the shifts on both sides of it
+
+static const double jd_over = 2460538.0;  // 2024-08-17 12:00 UTC, the site is the sub satellite point then
+
+class DopplerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+        char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+        ASSERT_TRUE(sat.init("ISS", l1, l2));
+        sat.findsat(jd_over);
+        lat = sat.satLat;
+        lon = sat.satLon;
+    }
+
+    void at(double jd, double& range, double& rate) {
+        double r[3], v[3];
+        ASSERT_TRUE(sgp4(wgs84, sat.satrec, (jd - sat.satrec.jdsatepoch) * 1440.0, r, v));
+        Doppler::range_rate(r, v, jd, lat, lon, 0, range, rate);
+    }
+
+    Sgp4 sat;
+    double lat = 0;
+    double lon = 0;
+};
+
+TEST_F(DopplerTest, RateIsTheRangeDerivative) {
+    const double h = 0.5 / 86400;  // 0.5 s
+    for (double dt = -400; dt <= 400; dt += 20) {
+        double jd = jd_over + dt / 86400;
+        double r0, r1, range, rate, unused;
+        at(jd - h, r0, unused);
+        at(jd + h, r1, unused);
+        at(jd, range, rate);
+        EXPECT_NEAR(rate, r1 - r0, 1e-3) << "t=" << dt;  // 1 m/s
+    }
+}
+
+TEST_F(DopplerTest, ZeroAtClosestApproach) {
+    // the closest approach by a 0.1 s scan of the range
+    double tca = 0;
+    double min_range = 1e9;
+    for (double dt = -60; dt <= 60; dt += 0.1) {
+        double range, rate;
+        at(jd_over + dt / 86400, range, rate);
+        if (range < min_range) {
+            min_range = range;
+            tca = dt;
+        }
+    }
+    EXPECT_NEAR(tca, 0, 2);  // right overhead
+    EXPECT_NEAR(min_range, sat.satAlt, 5);
+    double range, rate;
+    at(jd_over + tca / 86400, range, rate);
+    EXPECT_NEAR(rate, 0, 0.02);  // 20 m/s: the 0.1 s step at ~0.1 km/s^2 overhead
+    EXPECT_EQ(Doppler::downlink_shift(437800000, rate) / 100, 0);
+}
+
+TEST_F(DopplerTest, ApproachingIsNegative) {
+    double range, before, after;
+    at(jd_over - 60.0 / 86400, range, before);
+    at(jd_over + 60.0 / 86400, range, after);
+    EXPECT_LT(before, -3);  // km/s, most of the 7.7 km/s orbital speed a minute off the zenith
+    EXPECT_GT(after, 3);
+    // approaching: received higher, transmitted lower. receding: the other way
+    EXPECT_GT(Doppler::downlink_shift(437800000, before), 0);
+    EXPECT_LT(Doppler::uplink_shift(145990000, before), 0);
+    EXPECT_LT(Doppler::downlink_shift(437800000, after), 0);
+    EXPECT_GT(Doppler::uplink_shift(145990000, after), 0);
+}
+
+TEST(Doppler, Shift) {
+    // f * v / c: 437.8 MHz at 7 km/s is 10222 Hz
+    EXPECT_EQ(Doppler::downlink_shift(437800000, -7.0), 10222);
+    EXPECT_EQ(Doppler::downlink_shift(437800000, 7.0), -10222);
+    EXPECT_EQ(Doppler::downlink_shift(437800000, 0), 0);
+    // the uplink is pre compensated, so the satellite receives the nominal frequency
+    double rate = -7.0;
+    int32_t up = Doppler::uplink_shift(145990000, rate);
+    double received = (145990000.0 + up) * (1.0 - rate / SPEED_OF_LIGHT_KMS);
+    EXPECT_NEAR(received, 145990000.0, 1);
+    EXPECT_EQ(up, -3409);
+}
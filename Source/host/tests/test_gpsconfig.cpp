@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "gpsconfig.hpp"
+
+// the receiver handshake of GpsConfig against simulated u-blox, MediaTek, CASIC and plain nmea receivers, on a fake clock.
+// a receiver only understands the esp (and is understood) when both are on the same baud rate
+
+typedef struct {
+    GpsReceiver type;
+    uint32_t baud;       // what it starts on
+    uint8_t max_hz;      // what the chip can do
+    bool ignores_baud;   // doesn't know the baud command of its type
+    uint32_t switch_ms;  // applies a new baud rate this long after the command
+} sim_receiver_cfg_t;
+
+class SimReceiver {
+   public:
+    explicit SimReceiver(const sim_receiver_cfg_t& c) : cfg(c), baud(c.baud) {}
+
+    // what the esp wrote, parsed if the baud rates match
+    void receive(const uint8_t* data, size_t len, uint32_t now) {
+        writes++;
+        if (esp_baud != baud) return;
+        if (len >= 8 && data[0] == 0xb5 && data[1] == 0x62) {
+            receive_ubx(data, len, now);
+            return;
+        }
+        std::string line((const char*)data, len);
+        ASSERT_GE(line.size(), 6u);
+        ASSERT_EQ(line[0], '$');
+        ASSERT_EQ(line.substr(line.size() - 2), "\r\n");
+        size_t star = line.find('*');
+        ASSERT_NE(star, std::string::npos);
+        uint8_t crc = 0;
+        for (size_t i = 1; i < star; ++i) crc ^= (uint8_t)line[i];
+        ASSERT_EQ(strtoul(line.substr(star + 1, 2).c_str(), nullptr, 16), crc) << line;
+        command(line.substr(1, star - 1), now);
+    }
+
+    // 100 ms of output: the fixes, and the answers of the last queries
+    void tick(GpsConfig& gps, uint32_t now) {
+        if (pending_baud && now >= pending_baud_at) {
+            baud = pending_baud;
+            pending_baud = 0;
+        }
+        if (esp_baud != baud) {
+            answers.clear();  // garbage at the esp, fails the crc
+            return;
+        }
+        for (const std::string& a : answers) gps.on_sentence(a.c_str());
+        answers.clear();
+        // the fix rate, limited by the chip and by the line: ~150 bytes per fix + ~1000 bytes once a second
+        uint32_t line_hz = baud / 10 > 1150 ? (baud / 10 - 1000) / 150 : 1;
+        uint32_t hz = rate_hz < cfg.max_hz ? rate_hz : cfg.max_hz;
+        if (hz > line_hz) hz = line_hz;
+        fix_acc += hz;
+        while (fix_acc >= 10) {
+            gps.on_update();
+            fix_acc -= 10;
+        }
+    }
+
+    sim_receiver_cfg_t cfg;
+    uint32_t baud;
+    uint32_t esp_baud = 0;
+    uint8_t rate_hz = 1;
+    uint32_t writes = 0;
+
+   private:
+    void command(const std::string& body, uint32_t now) {
+        unsigned v = 0;
+        switch (cfg.type) {
+            case GpsReceiver_UBLOX:
+                if (body == "PUBX,00") answers.push_back("$PUBX,00,100000.00,4729.87,N,01902.41,E,110.0,G3,2.1,2.0,0.1,0.0,0.0,,1.0,1.2,0.9,9,0,0*5D");
+                if (sscanf(body.c_str(), "PUBX,41,1,0007,0003,%u,0", &v) == 1) set_baud(v, now);
+                break;
+            case GpsReceiver_MTK:
+                if (body == "PMTK605") answers.push_back("$PMTK705,AXN_5.1.7_3333_19020118,0027,Quectel-L80,1.0*6E");
+                if (sscanf(body.c_str(), "PMTK251,%u", &v) == 1) set_baud(v, now);
+                if (sscanf(body.c_str(), "PMTK220,%u", &v) == 1 && v) rate_hz = 1000 / v;
+                break;
+            case GpsReceiver_CASIC: {
+                const uint32_t rates[] = {4800, 9600, 19200, 38400, 57600, 115200};
+                if (body == "PCAS06,0") answers.push_back("$GPTXT,01,01,02,SW=URANUS5,V5.1.0.0*1F");
+                if (sscanf(body.c_str(), "PCAS01,%u", &v) == 1 && v < 6) set_baud(rates[v], now);
+                if (sscanf(body.c_str(), "PCAS02,%u", &v) == 1 && v) rate_hz = 1000 / v;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void receive_ubx(const uint8_t* data, size_t len, uint32_t now) {
+        uint16_t plen = data[4] | (data[5] << 8);
+        ASSERT_EQ(len, plen + 8u);
+        uint8_t ck_a = 0, ck_b = 0;
+        for (size_t i = 2; i < len - 2; ++i) {
+            ck_a += data[i];
+            ck_b += ck_a;
+        }
+        ASSERT_EQ(data[len - 2], ck_a);
+        ASSERT_EQ(data[len - 1], ck_b);
+        if (cfg.type != GpsReceiver_UBLOX) return;
+        const uint8_t* p = data + 6;
+        if (data[2] == 0x06 && data[3] == 0x08 && plen == 6) {  // CFG-RATE
+            uint16_t ms = p[0] | (p[1] << 8);
+            if (ms) rate_hz = 1000 / ms;
+        }
+        (void)now;
+    }
+
+    void set_baud(uint32_t b, uint32_t now) {
+        if (cfg.ignores_baud) return;
+        pending_baud = b;
+        pending_baud_at = now + cfg.switch_ms;
+    }
+
+    std::vector<std::string> answers;
+    uint32_t pending_baud = 0;
+    uint32_t pending_baud_at = 0;
+    uint32_t fix_acc = 0;
+};
+
+static SimReceiver* sim = nullptr;
+static uint32_t sim_now = 0;
+static std::vector<uint32_t> esp_bauds;
+
+static void sim_write(const uint8_t* data, size_t len) {
+    if (sim) sim->receive(data, len, sim_now);
+}
+
+static void sim_set_baud(uint32_t baud) {
+    esp_bauds.push_back(baud);
+    if (sim) sim->esp_baud = baud;
+}
+
+// runs the handshake like the main loop does, returns the ms it took
+static uint32_t run(SimReceiver* receiver, GpsConfig& gps, uint32_t baud, uint32_t last_baud, GpsReceiver last_receiver, uint8_t hz) {
+    sim = receiver;
+    sim_now = 1000;
+    esp_bauds.clear();
+    gps.start(sim_now, baud, last_baud, last_receiver, hz);
+    uint32_t start = sim_now;
+    while (!gps.finished() && sim_now - start < 120000) {
+        sim_now += GPSCFG_STEP_MS;
+        if (receiver) receiver->tick(gps, sim_now);
+        gps.step(sim_now);
+    }
+    sim = nullptr;
+    return sim_now - start;
+}
+
+TEST(GpsConfig, UbloxIsSwitchedTo115200And10Hz) {
+    SimReceiver rx({GpsReceiver_UBLOX, 9600, 10, false, 100});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(gps.get_receiver(), GpsReceiver_UBLOX);
+    EXPECT_EQ(gps.get_baud(), 115200u);
+    EXPECT_EQ(gps.get_hz(), 10);
+    EXPECT_EQ(rx.baud, 115200u);
+    EXPECT_EQ(rx.rate_hz, 10);
+}
+
+TEST(GpsConfig, MtkOnAnOtherBaudIsFound) {
+    SimReceiver rx({GpsReceiver_MTK, 38400, 10, false, 50});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, GPSCFG_HZ_DEFAULT);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(gps.get_receiver(), GpsReceiver_MTK);
+    ASSERT_GE(esp_bauds.size(), 2u);
+    EXPECT_EQ(esp_bauds[0], 9600u);  // the configured first
+    EXPECT_EQ(gps.get_baud(), 38400u);  // enough for 5 hz, not switched
+    EXPECT_EQ(rx.baud, 38400u);
+    EXPECT_EQ(gps.get_hz(), GPSCFG_HZ_DEFAULT);
+    EXPECT_EQ(rx.rate_hz, GPSCFG_HZ_DEFAULT);
+}
+
+TEST(GpsConfig, NoBaudSwitchFallsBackToTheOldBaudAndALowerRate) {
+    SimReceiver rx({GpsReceiver_CASIC, 9600, 10, true, 0});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(gps.get_receiver(), GpsReceiver_CASIC);
+    EXPECT_EQ(gps.get_baud(), 9600u);
+    EXPECT_EQ(rx.esp_baud, 9600u);
+    EXPECT_EQ(gps.get_hz(), 1);
+}
+
+TEST(GpsConfig, SlowChipFallsBackTo5Hz) {
+    SimReceiver rx({GpsReceiver_MTK, 9600, 5, false, 50});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(gps.get_baud(), 115200u);
+    EXPECT_EQ(gps.get_hz(), 5);
+    EXPECT_EQ(rx.rate_hz, 5);
+}
+
+TEST(GpsConfig, PlainNmeaReceiverOnlyGetsItsBaudFound) {
+    SimReceiver rx({GpsReceiver_UNKNOWN, 4800, 1, false, 0});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(gps.get_receiver(), GpsReceiver_UNKNOWN);
+    EXPECT_EQ(gps.get_baud(), 4800u);
+    EXPECT_EQ(gps.get_hz(), 1);
+    EXPECT_EQ(rx.baud, 4800u);
+}
+
+TEST(GpsConfig, NoReceiverFailsOnTheConfiguredBaud) {
+    GpsConfig gps(sim_write, sim_set_baud);
+    uint32_t took = run(nullptr, gps, 9600, 0, GpsReceiver_UNKNOWN, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_FAILED);
+    EXPECT_EQ(gps.get_baud(), 9600u);
+    EXPECT_EQ(esp_bauds.back(), 9600u);
+    EXPECT_LE(took, 7u * (GPSCFG_LISTEN_MS + 2 * GPSCFG_STEP_MS));  // every common baud rate once
+}
+
+TEST(GpsConfig, EspRestartStartsOnTheLastNegotiated) {
+    // only the esp restarted, the receiver is still on 115200 and 10 hz
+    SimReceiver rx({GpsReceiver_UBLOX, 115200, 10, false, 100});
+    rx.rate_hz = 10;
+    GpsConfig gps(sim_write, sim_set_baud);
+    uint32_t took = run(&rx, gps, 9600, 115200, GpsReceiver_UBLOX, 10);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_DONE);
+    EXPECT_EQ(esp_bauds.front(), 115200u);
+    EXPECT_EQ(gps.get_baud(), 115200u);
+    EXPECT_EQ(gps.get_hz(), 10);
+    EXPECT_LT(took, GPSCFG_LISTEN_MS + GPSCFG_PROBE_MS + GPSCFG_SETTLE_MS + GPSCFG_MEASURE_MS);  // no listening on the other rates
+}
+
+TEST(GpsConfig, ZeroHzLeavesTheReceiverAlone) {
+    SimReceiver rx({GpsReceiver_UBLOX, 9600, 10, false, 100});
+    GpsConfig gps(sim_write, sim_set_baud);
+    run(&rx, gps, 9600, 0, GpsReceiver_UNKNOWN, 0);
+    EXPECT_EQ(gps.get_state(), GpsCfgState_IDLE);
+    EXPECT_EQ(rx.writes, 0u);
+    EXPECT_TRUE(esp_bauds.empty());
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "gpsfilter.hpp"
+#include "host/uart_sim.h"
+#include "nmea_gen.h"
+#include "nmea_parser.h"
+
+// the filter fed from the parser like in main.cpp, with a recorded drive (parked, accelerating, a turn, braking) and noisy fixes.
+// the error is measured half way between the fixes, where predict() fills in for the pp and the web
+
+#define ORIGIN_LAT 47.4979
+#define ORIGIN_LON 19.0402
+#define EARTH_R 6371000.0
+#define DEG (M_PI / 180.0)
+
+typedef struct {
+    double n, e;    // m from the origin
+    double speed;   // m/s
+    double course;  // degrees
+} track_point_t;
+
+// truth every 0.1 s: 30 s parked, 0 -> 20 m/s east, 70 s straight, a 90 degree turn to the south, 80 s straight, braking, 50 s parked
+static std::vector<track_point_t> drive() {
+    std::vector<track_point_t> ret;
+    track_point_t p = {0, 0, 0, 90};
+    for (int i = 0; i <= 3000; ++i) {
+        double t = i / 10.0;
+        ret.push_back(p);
+        double accel = 0, turn = 0;
+        if (t >= 30 && t < 50) accel = 1;
+        if (t >= 120 && t < 150) turn = 3;
+        if (t >= 230 && t < 250) accel = -1;
+        p.speed = std::max(0.0, p.speed + accel * 0.1);
+        p.course += turn * 0.1;
+        p.n += p.speed * cos(p.course * DEG) * 0.1;
+        p.e += p.speed * sin(p.course * DEG) * 0.1;
+    }
+    return ret;
+}
+
+static double to_lat(double n) {
+    return ORIGIN_LAT + n / EARTH_R / DEG;
+}
+
+static double to_lon(double e) {
+    return ORIGIN_LON + e / (EARTH_R * cos(ORIGIN_LAT * DEG)) / DEG;
+}
+
+static double distance(double lat, double lon, const track_point_t& p) {
+    double n = (lat - ORIGIN_LAT) * DEG * EARTH_R;
+    double e = (lon - ORIGIN_LON) * DEG * EARTH_R * cos(ORIGIN_LAT * DEG);
+    return hypot(n - p.n, e - p.e);
+}
+
+class GpsFilterReplay : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        nmea_parser_config_t config = NMEA_PARSER_CONFIG_DEFAULT();
+        hdl = nmea_parser_init(&config);
+        ASSERT_NE(hdl, nullptr);
+        ASSERT_EQ(nmea_parser_add_handler(hdl, on_event, this), ESP_OK);
+    }
+
+    void TearDown() override {
+        if (hdl) nmea_parser_deinit(hdl);
+    }
+
+    static void on_event(void* arg, esp_event_base_t base, int32_t id, void* data) {
+        (void)base;
+        GpsFilterReplay* self = (GpsFilterReplay*)arg;
+        if (id != GPS_UPDATE) return;
+        std::lock_guard<std::mutex> lock(self->m);
+        self->fixes.push_back(*(gps_t*)data);
+        self->cv.notify_all();
+    }
+
+    // the recording through the uart and the parser, a fix at a time like from the receiver. the parsed fixes in order
+    std::vector<gps_t> parse(const std::vector<std::string>& recording) {
+        for (const std::string& nmea : recording) {
+            EXPECT_EQ(host_uart_feed_wait(UART_NUM_1, nmea.data(), nmea.size(), 3000), nmea.size());
+            EXPECT_TRUE(host_uart_wait_drained(UART_NUM_1, 3000));
+        }
+        std::unique_lock<std::mutex> lock(m);
+        EXPECT_TRUE(cv.wait_for(lock, std::chrono::milliseconds(3000), [&] { return fixes.size() >= recording.size(); }));
+        return fixes;
+    }
+
+    nmea_parser_handle_t hdl = nullptr;
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<gps_t> fixes;
+};
+
+TEST_F(GpsFilterReplay, ErrorBetweenTheFixes) {
+    std::vector<track_point_t> truth = drive();
+    std::mt19937 rng(5);
+    std::normal_distribution<double> pos_noise(0, 2.5);  // m, hdop 1
+    std::normal_distribution<double> speed_noise(0, 0.1);
+    std::normal_distribution<double> course_noise(0, 1.0);
+    std::vector<std::string> recording;
+    for (int t = 0; t < 299; ++t) {
+        const track_point_t& p = truth[t * 10];
+        nmea_fix_t fix = nmea_default_fix();
+        fix.minute = t / 60;
+        fix.second = t % 60;
+        fix.lat = to_lat(p.n + pos_noise(rng));
+        fix.lon = to_lon(p.e + pos_noise(rng));
+        fix.hdop = 1.0;
+        double speed = std::max(0.0, p.speed + speed_noise(rng));
+        fix.knots = speed / 0.514444;
+        fix.course = fmod(p.course + course_noise(rng) + 360, 360);
+        recording.push_back(nmea_rmc(fix) + nmea_gga(fix));
+    }
+    std::vector<gps_t> fixes = parse(recording);
+    ASSERT_EQ(fixes.size(), 299u);
+
+    GpsFilter filter;
+    double sum_raw = 0, sum_filtered = 0, sum_parked = 0;
+    int n_moving = 0, n_parked = 0;
+    for (int t = 0; t < 299; ++t) {
+        const track_point_t& p = truth[t * 10];
+        const gps_t& g = fixes[t];
+        uint32_t now = 1000 + t * 1000;
+        filter.update(now, g.latitude, g.longitude, g.altitude, g.dop_h, g.speed, g.cog, 400);  // no compass
+        if (t < 5) continue;  // settling
+        double lat, lon;
+        float alt;
+        ASSERT_TRUE(GpsFilter::predict(filter.state(), now + 500, lat, lon, alt));
+        const track_point_t& mid = truth[t * 10 + 5];
+        double err = distance(lat, lon, mid);
+        double raw = distance(g.latitude, g.longitude, mid);  // the last fix, held
+        if (p.speed > 5) {
+            sum_filtered += err * err;
+            sum_raw += raw * raw;
+            n_moving++;
+        } else if (p.speed == 0 && mid.speed == 0) {
+            sum_parked += err * err;
+            n_parked++;
+        }
+    }
+    double rms_moving = sqrt(sum_filtered / n_moving);
+    double rms_raw = sqrt(sum_raw / n_moving);
+    double rms_parked = sqrt(sum_parked / n_parked);
+    RecordProperty("rms_moving_cm", (int)(rms_moving * 100));
+    RecordProperty("rms_raw_cm", (int)(rms_raw * 100));
+    RecordProperty("rms_parked_cm", (int)(rms_parked * 100));
+    EXPECT_LT(rms_moving, 3.0);
+    EXPECT_LT(rms_moving, rms_raw / 3);
+    EXPECT_LT(rms_parked, 1.5);
+}
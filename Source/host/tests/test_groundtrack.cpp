@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "groundtrack.hpp"
+
+// the ground track websocket message decoded like index.html does, against Sgp4::findsat()'s sub satellite point at every time
+
+static const double jd_now = 2460538.0;  // 2024-08-17 12:00 UTC
+
+typedef struct {
+    ground_track_header_t header;
+    std::vector<ground_track_point_t> points;
+} decoded_track_t;
+
+static bool decode(const uint8_t* buf, size_t len, decoded_track_t& out) {
+    if (len < GROUNDTRACK_PREFIX_LEN + sizeof(ground_track_header_t) || memcmp(buf, GROUNDTRACK_PREFIX, GROUNDTRACK_PREFIX_LEN) != 0) return false;
+    memcpy(&out.header, buf + GROUNDTRACK_PREFIX_LEN, sizeof(out.header));
+    size_t pos = GROUNDTRACK_PREFIX_LEN + sizeof(out.header);
+    if (len != pos + out.header.count * sizeof(ground_track_point_t)) return false;
+    out.points.resize(out.header.count);
+    memcpy(out.points.data(), buf + pos, len - pos);
+    return true;
+}
+
+class GroundTrackTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+        char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+        ASSERT_TRUE(sat.init("ISS", l1, l2));
+    }
+
+    Sgp4 sat;
+    GroundTrack track;
+};
+
+TEST_F(GroundTrackTest, DecodedPointsAreTheSubSatellitePoints) {
+    ASSERT_TRUE(track.update(sat.satrec, jd_now));
+    uint8_t buf[GroundTrack::encoded_size(2 * GROUNDTRACK_POINTS_PER_ORBIT + 1)];
+    size_t len = track.encode(buf, sizeof(buf));
+    ASSERT_EQ(len, sizeof(buf));
+    decoded_track_t got;
+    ASSERT_TRUE(decode(buf, len, got));
+    EXPECT_EQ(got.header.satnum, 25544u);
+    ASSERT_EQ(got.header.count, 2 * GROUNDTRACK_POINTS_PER_ORBIT + 1);
+    // the window is +-1 orbit around now, on whole seconds
+    double mid = got.header.start + (double)GROUNDTRACK_POINTS_PER_ORBIT * got.header.step;
+    EXPECT_NEAR(mid, getUnixFromJulian(jd_now), 1);
+
+    double worst = 0;
+    for (uint16_t i = 0; i < got.header.count; i++) {
+        const ground_track_point_t& p = got.points[i];
+        SCOPED_TRACE(i);
+        ASSERT_NE(p.lat, GROUNDTRACK_NO_POINT);
+        sat.findsat(getJulianFromUnix(got.header.start + (double)i * got.header.step));
+        double dlat = p.lat / 100.0 - sat.satLat;
+        double dlon = fmod(p.lon / 100.0 - sat.satLon + 540.0, 360.0) - 180.0;
+        // the 0.01 degree resolution, and the float kernel's few tens of meters
+        EXPECT_NEAR(dlat, 0, 0.01);
+        EXPECT_NEAR(dlon, 0, 0.01);
+        worst = std::max(worst, std::max(fabs(dlat), fabs(dlon)));
+        double footprint = 6378.137 * acos(6378.137 / (6378.137 + sat.satAlt));
+        EXPECT_NEAR(p.footprint, footprint, 1.5);
+    }
+    RecordProperty("max_error_mdeg", (int)(worst * 1000));
+}
+
+TEST_F(GroundTrackTest, RecomputedOnlyAfterAQuarterOrbit) {
+    double period = 2.0 * pi / sat.satrec.no / 1440.0;
+    ASSERT_TRUE(track.update(sat.satrec, jd_now));
+    EXPECT_FALSE(track.update(sat.satrec, jd_now + period * 0.2));
+    EXPECT_TRUE(track.update(sat.satrec, jd_now + period * 0.3));
+    track.clear();
+    EXPECT_EQ(track.size(), 0);
+    uint8_t buf[64];
+    EXPECT_EQ(track.encode(buf, sizeof(buf)), 0u);
+    EXPECT_TRUE(track.update(sat.satrec, jd_now + period * 0.3));
+    EXPECT_EQ(track.encode(buf, sizeof(buf)), 0u);  // doesn't fit
+}
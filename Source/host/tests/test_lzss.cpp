@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "lzss_decoder.hpp"
+#include "extapps_lz.h"
+#include "../extapps/sattrack.h"
+
+// the LZSS decoder on a real ext app, compressed at build time by tools/lzss_extapps.py like for the firmware
+
+class LzssTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        blocks.resize(LzssDecoder::block_count(sattrack_raw_size));
+        ASSERT_EQ(LzssDecoder::index_blocks(sattrack_lz, sizeof(sattrack_lz), sattrack_raw_size, blocks.data(), blocks.size()), blocks.size());
+        dec.reset(sattrack_lz, sizeof(sattrack_lz), sattrack_raw_size, blocks.data());
+    }
+
+    void expect_at(uint32_t pos, uint32_t len) {
+        std::vector<uint8_t> out(len);
+        uint32_t got = dec.read_at(pos, out.data(), len);
+        ASSERT_EQ(got, std::min<uint32_t>(len, sattrack_raw_size - pos)) << "pos " << pos;
+        EXPECT_EQ(memcmp(out.data(), sattrack + pos, got), 0) << "pos " << pos;
+    }
+
+    std::vector<uint32_t> blocks;
+    LzssDecoder dec;
+};
+
+TEST_F(LzssTest, SizesMatch) {
+    ASSERT_EQ(sizeof(sattrack), sattrack_raw_size);
+    EXPECT_LT(sizeof(sattrack_lz), sattrack_raw_size);
+}
+
+TEST_F(LzssTest, ForwardInLegacyBlocks) {
+    for (uint32_t pos = 0; pos < sattrack_raw_size; pos += 128) expect_at(pos, 128);
+}
+
+TEST_F(LzssTest, RetryInsideTheWindow) {
+    expect_at(10000, 224);
+    expect_at(10000, 224);
+    expect_at(9000, 224);
+}
+
+TEST_F(LzssTest, RandomSeeks) {
+    std::mt19937 rng(1234);
+    for (int i = 0; i < 500; ++i) {
+        uint32_t pos = rng() % sattrack_raw_size;
+        expect_at(pos, 1 + rng() % 224);
+    }
+}
+
+TEST_F(LzssTest, SeekAcrossBlockBoundary) {
+    expect_at(LzssDecoder::BLOCK_SIZE * 3 - 100, 224);
+    expect_at(LzssDecoder::BLOCK_SIZE - 10, 20);  // back, before the block the decoder restarted in
+    expect_at(sattrack_raw_size - 32, 64);        // clamped at the end
+}
+
+TEST(Lzss, IndexRejectsCrossBlockMatch) {
+    // a literal block then a match that reaches back over the block start
+    std::vector<uint8_t> lz;
+    uint32_t raw = LzssDecoder::BLOCK_SIZE + 8;
+    for (uint32_t i = 0; i < LzssDecoder::BLOCK_SIZE; i += 8) {
+        lz.push_back(0xFF);
+        for (int j = 0; j < 8; ++j) lz.push_back((uint8_t)(i + j));
+    }
+    lz.push_back(0x00);
+    uint16_t v = (16 - 1) | ((8 - LzssDecoder::MIN_MATCH) << 11);
+    lz.push_back(v & 0xFF);
+    lz.push_back(v >> 8);
+    uint32_t blocks[2];
+    EXPECT_EQ(LzssDecoder::index_blocks(lz.data(), lz.size(), raw, blocks, 2), 0u);
+}
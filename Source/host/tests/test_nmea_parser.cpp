@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "host/uart_sim.h"
+#include "nmea_gen.h"
+#include "nmea_parser.h"
+
+// the parser task fed through the simulated uart, like from the gps module
+
+class NmeaParserTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        nmea_parser_config_t config = NMEA_PARSER_CONFIG_DEFAULT();
+        hdl = nmea_parser_init(&config);
+        ASSERT_NE(hdl, nullptr);
+        ASSERT_EQ(nmea_parser_add_handler(hdl, on_event, this), ESP_OK);
+    }
+
+    void TearDown() override {
+        if (hdl) nmea_parser_deinit(hdl);
+    }
+
+    static void on_event(void* arg, esp_event_base_t base, int32_t id, void* data) {
+        (void)base;
+        NmeaParserTest* self = (NmeaParserTest*)arg;
+        std::lock_guard<std::mutex> lock(self->m);
+        if (id == GPS_UPDATE) {
+            self->gps = *(gps_t*)data;
+            self->updates++;
+        } else if (id == GPS_SKYVIEW) {
+            self->skyview = *(gps_skyview_t*)data;
+            self->skyviews++;
+        } else if (id == GPS_DEBUG) {
+            self->lines.push_back((const char*)data);
+        }
+        self->cv.notify_all();
+    }
+
+    bool wait_updates(int n, int timeout_ms = 3000) {
+        std::unique_lock<std::mutex> lock(m);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return updates >= n; });
+    }
+
+    void feed(const std::string& s) {
+        ASSERT_EQ(host_uart_feed_wait(UART_NUM_1, s.data(), s.size(), 3000), s.size());
+    }
+
+    // the satellite of the last sky view, null if not in it
+    const gps_satellite_t* find(gps_system_t system, int num) {
+        for (uint8_t i = 0; i < skyview.count; i++)
+            if (skyview.sats[i].system == system && skyview.sats[i].num == num) return &skyview.sats[i];
+        return nullptr;
+    }
+
+    // the sentences of a gsv group, to interleave them
+    static std::vector<std::string> sentences(const std::string& s) {
+        std::vector<std::string> ret;
+        for (size_t pos = 0; pos < s.size();) {
+            size_t end = s.find('\n', pos) + 1;
+            ret.push_back(s.substr(pos, end - pos));
+            pos = end;
+        }
+        return ret;
+    }
+
+    nmea_parser_handle_t hdl = nullptr;
+    std::mutex m;
+    std::condition_variable cv;
+    gps_t gps = {};
+    gps_skyview_t skyview = {};
+    int updates = 0;
+    int skyviews = 0;
+    std::vector<std::string> lines;
+};
+
+TEST_F(NmeaParserTest, RmcAndGgaMakeAnUpdate) {
+    nmea_fix_t fix = nmea_default_fix();
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(1));
+    std::lock_guard<std::mutex> lock(m);
+    EXPECT_NEAR(gps.latitude, fix.lat, 1e-5);
+    EXPECT_NEAR(gps.longitude, fix.lon, 1e-5);
+    EXPECT_NEAR(gps.altitude, fix.alt + 40.1, 0.01);  // msl + geoid separation
+    EXPECT_EQ(gps.fix, GPS_FIX_GPS);
+    EXPECT_EQ(gps.sats_in_use, fix.sats_in_use);
+    EXPECT_EQ(gps.tim.hour, fix.hour);
+    EXPECT_EQ(gps.tim.minute, fix.minute);
+    EXPECT_EQ(gps.date.day, fix.day);
+    EXPECT_EQ(gps.date.month, fix.month);
+    EXPECT_EQ(gps.date.year, fix.year - YEAR_BASE);
+    EXPECT_TRUE(gps.valid);
+}
+
+TEST_F(NmeaParserTest, BadChecksumIsDropped) {
+    nmea_fix_t fix = nmea_default_fix();
+    std::string rmc = nmea_rmc(fix);
+    rmc[rmc.size() - 3] = rmc[rmc.size() - 3] == '0' ? '1' : '0';  // checksum digit
+    feed(rmc + nmea_gga(fix));
+    EXPECT_FALSE(wait_updates(1, 500));
+    feed(nmea_rmc(fix));  // the gga is still there from before
+    EXPECT_TRUE(wait_updates(1));
+}
+
+TEST_F(NmeaParserTest, GsvCycleMakesASkyview) {
+    nmea_fix_t fix = nmea_default_fix();
+    std::vector<nmea_sat_t> sats = {{1, 10, 20, 35}, {5, 45, 90, 40}, {12, 80, 180, 0}, {17, 30, 270, 25}, {23, 5, 300, 33}};
+    feed(nmea_epoch(fix, sats));
+    fix.second += 1;
+    feed(nmea_epoch(fix, sats));
+    ASSERT_TRUE(wait_updates(2));
+    std::lock_guard<std::mutex> lock(m);
+    ASSERT_GE(skyviews, 1);
+    EXPECT_EQ(skyview.count, sats.size());
+}
+
+TEST_F(NmeaParserTest, TalkersKeepTheirSystems) {
+    // the same numbers on gps, galileo and beidou are different satellites, the gngsa system id tells which one is used
+    nmea_fix_t fix = nmea_default_fix();
+    std::vector<nmea_sat_t> gp = {{5, 40, 100, 41}, {12, 20, 200, 35}, {24, 60, 300, 38}};
+    std::vector<nmea_sat_t> gl = {{65, 30, 50, 33}, {72, 15, 150, 0}};
+    std::vector<nmea_sat_t> ga = {{5, 70, 10, 44}, {12, 25, 250, 0}};
+    std::vector<nmea_sat_t> bd = {{5, 10, 330, 30}, {19, 55, 80, 39}};
+    std::string gsa = nmea_gsa({5, 24}, 1) + nmea_gsa({65}, 2) + nmea_gsa({12}, 3) + nmea_gsa({19}, 4);
+    std::string gsv = nmea_gsv(gp, "GP") + nmea_gsv(gl, "GL") + nmea_gsv(ga, "GA") + nmea_gsv(bd, "BD");
+    feed(nmea_rmc(fix) + nmea_gga(fix) + gsa + gsv);
+    fix.second += 1;
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(2));
+    std::lock_guard<std::mutex> lock(m);
+    ASSERT_GE(skyviews, 1);
+    EXPECT_EQ(skyview.count, gp.size() + gl.size() + ga.size() + bd.size());
+    const struct {
+        gps_system_t system;
+        const std::vector<nmea_sat_t>& sats;
+        std::vector<int> used;
+    } systems[] = {{GPS_SYSTEM_GPS, gp, {5, 24}}, {GPS_SYSTEM_GLONASS, gl, {65}}, {GPS_SYSTEM_GALILEO, ga, {12}}, {GPS_SYSTEM_BEIDOU, bd, {19}}};
+    for (const auto& sys : systems) {
+        for (const nmea_sat_t& s : sys.sats) {
+            SCOPED_TRACE(testing::Message() << "system " << sys.system << " sat " << s.prn);
+            const gps_satellite_t* sat = find(sys.system, s.prn);
+            ASSERT_NE(sat, nullptr);
+            EXPECT_EQ(sat->elevation, s.elevation);
+            EXPECT_EQ(sat->azimuth, s.azimuth);
+            EXPECT_EQ(sat->snr, s.snr);
+            EXPECT_EQ(sat->in_use, std::find(sys.used.begin(), sys.used.end(), s.prn) != sys.used.end());
+        }
+    }
+}
+
+TEST_F(NmeaParserTest, SignalGroupsAreMerged) {
+    // nmea 4.10: one gpgsv group per signal (1: L1 C/A, 8: L5). one satellite each, with its best snr
+    nmea_fix_t fix = nmea_default_fix();
+    std::vector<nmea_sat_t> l1 = {{3, 40, 100, 35}, {8, 20, 200, 30}, {14, 60, 300, 41}, {22, 10, 20, 0}, {31, 50, 120, 38}};
+    std::vector<nmea_sat_t> l5 = {{3, 40, 100, 39}, {8, 20, 200, 28}, {32, 45, 60, 33}};
+    feed(nmea_rmc(fix) + nmea_gga(fix) + nmea_gsv(l1, "GP", 1) + nmea_gsv(l5, "GP", 8));
+    fix.second += 1;
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(2));
+    {
+        std::lock_guard<std::mutex> lock(m);
+        EXPECT_EQ(skyview.count, 6);  // 3 and 8 once
+        ASSERT_NE(find(GPS_SYSTEM_GPS, 3), nullptr);
+        EXPECT_EQ(find(GPS_SYSTEM_GPS, 3)->snr, 39);
+        EXPECT_EQ(find(GPS_SYSTEM_GPS, 8)->snr, 30);
+        EXPECT_NE(find(GPS_SYSTEM_GPS, 32), nullptr);
+        EXPECT_NE(find(GPS_SYSTEM_GPS, 22), nullptr);
+    }
+    // the next L1 group starts a new cycle, 31 and 32 set
+    l1.pop_back();
+    l5.pop_back();
+    feed(nmea_gsv(l1, "GP", 1) + nmea_gsv(l5, "GP", 8));
+    fix.second += 1;
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(3));
+    std::lock_guard<std::mutex> lock(m);
+    EXPECT_EQ(skyview.count, 4);
+    EXPECT_EQ(find(GPS_SYSTEM_GPS, 31), nullptr);
+    EXPECT_EQ(find(GPS_SYSTEM_GPS, 32), nullptr);
+}
+
+TEST_F(NmeaParserTest, InterleavedCyclesStaySeparate) {
+    // gps and glonass groups sentence by sentence, like some receivers send them. each cycle only replaces its own system
+    nmea_fix_t fix = nmea_default_fix();
+    std::vector<nmea_sat_t> gp = {{1, 10, 10, 30}, {2, 20, 20, 31}, {3, 30, 30, 32}, {4, 40, 40, 33}, {5, 50, 50, 34}, {6, 60, 60, 35}};
+    std::vector<nmea_sat_t> gl = {{65, 15, 15, 36}, {66, 25, 25, 37}, {67, 35, 35, 38}, {68, 45, 45, 39}, {69, 55, 55, 40}};
+    for (int cycle = 0; cycle < 2; cycle++) {
+        std::vector<std::string> a = sentences(nmea_gsv(gp, "GP")), b = sentences(nmea_gsv(gl, "GL"));
+        std::string text = nmea_rmc(fix) + nmea_gga(fix);
+        for (size_t i = 0; i < a.size() || i < b.size(); i++) text += (i < a.size() ? a[i] : "") + (i < b.size() ? b[i] : "");
+        feed(text);
+        fix.second += 1;
+        // the second cycle: one gps satellite set, two glonass ones rose
+        gp.pop_back();
+        gl.push_back({70, 5, 70, 20});
+        gl.push_back({71, 6, 71, 21});
+    }
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(3));
+    std::lock_guard<std::mutex> lock(m);
+    int count[GPS_SYSTEM_MAX] = {};
+    for (uint8_t i = 0; i < skyview.count; i++) count[skyview.sats[i].system]++;
+    EXPECT_EQ(count[GPS_SYSTEM_GPS], 5);
+    EXPECT_EQ(count[GPS_SYSTEM_GLONASS], 7);
+    EXPECT_EQ(count[GPS_SYSTEM_UNKNOWN], 0);
+    EXPECT_EQ(skyview.count, 12);
+    EXPECT_EQ(find(GPS_SYSTEM_GPS, 6), nullptr);
+    EXPECT_NE(find(GPS_SYSTEM_GLONASS, 71), nullptr);
+}
+
+TEST_F(NmeaParserTest, SpeedIsKmhFromRmcAndVtg) {
+    nmea_fix_t fix = nmea_default_fix();  // 10 knots
+    feed(nmea_rmc(fix) + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(1));
+    {
+        std::lock_guard<std::mutex> lock(m);
+        EXPECT_NEAR(gps.speed, 18.52f, 0.01f);
+    }
+    // the vtg after the rmc overwrites it, with the same unit
+    fix.second += 1;
+    feed(nmea_rmc(fix) + nmea_sentence("GNVTG,45.00,T,,M,5.00,N,9.26,K,A") + nmea_gga(fix));
+    ASSERT_TRUE(wait_updates(2));
+    std::lock_guard<std::mutex> lock(m);
+    EXPECT_NEAR(gps.speed, 9.26f, 0.01f);
+}
+
+TEST_F(NmeaParserTest, EveryLineIsEchoedForTheDebug) {
+    nmea_fix_t fix = nmea_default_fix();
+    std::string rmc = nmea_rmc(fix), gga = nmea_gga(fix);
+    std::string bad = rmc;
+    bad[bad.size() - 3] = bad[bad.size() - 3] == '0' ? '1' : '0';
+    feed(bad + rmc + gga);
+    ASSERT_TRUE(wait_updates(1));
+    std::lock_guard<std::mutex> lock(m);
+    ASSERT_EQ(lines.size(), 3u);  // the bad one too, the web shows what the receiver sent
+    EXPECT_EQ(lines[0].substr(0, bad.size() - 2), bad.substr(0, bad.size() - 2));
+    EXPECT_EQ(lines[1].substr(0, rmc.size() - 2), rmc.substr(0, rmc.size() - 2));
+    EXPECT_EQ(lines[2].substr(0, gga.size() - 2), gga.substr(0, gga.size() - 2));
+}
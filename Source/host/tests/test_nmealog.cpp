@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host/uart_sim.h"
+#include "nmea_gen.h"
+#include "nmea_parser.h"
+#include "nmealog.hpp"
+
+// the recorder on the parser's tap, fed through the simulated uart, then the log replayed through a new parser:
+// the same lines, byte for byte, and the same fixes
+
+static uint32_t now_ms() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+class NmeaLogTest : public ::testing::Test {
+   protected:
+    void SetUp() override { start_parser(); }
+
+    void TearDown() override {
+        if (hdl) nmea_parser_deinit(hdl);
+        remove(path(0).c_str());
+        remove(path(1).c_str());
+    }
+
+    void start_parser() {
+        if (hdl) nmea_parser_deinit(hdl);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            fixes.clear();
+            times.clear();
+            lines.clear();
+        }
+        nmea_parser_config_t config = NMEA_PARSER_CONFIG_DEFAULT();
+        hdl = nmea_parser_init(&config);
+        ASSERT_NE(hdl, nullptr);
+        ASSERT_EQ(nmea_parser_add_handler(hdl, on_event, this), ESP_OK);
+        ASSERT_EQ(nmea_parser_set_tap(hdl, NmeaLog::tap, &log), ESP_OK);
+    }
+
+    static void on_event(void* arg, esp_event_base_t base, int32_t id, void* data) {
+        (void)base;
+        NmeaLogTest* self = (NmeaLogTest*)arg;
+        std::lock_guard<std::mutex> lock(self->m);
+        if (id == GPS_UPDATE) {
+            self->fixes.push_back(*(gps_t*)data);
+            self->times.push_back(esp_timer_get_time());
+        } else if (id == GPS_DEBUG) {
+            self->lines.push_back((const char*)data);
+        }
+        self->cv.notify_all();
+    }
+
+    bool wait_fixes(size_t n, int timeout_ms = 5000) {
+        std::unique_lock<std::mutex> lock(m);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return fixes.size() >= n; });
+    }
+
+    void feed(const std::string& s) {
+        ASSERT_EQ(host_uart_feed_wait(UART_NUM_1, s.data(), s.size(), 3000), s.size());
+    }
+
+    // the replay through the parser, till the log ends
+    void replay(bool realtime) {
+        ASSERT_TRUE(log.replay_start(realtime));
+        ASSERT_EQ(nmea_parser_set_source(hdl, NmeaLog::source, &log), ESP_OK);
+        for (int i = 0; i < 1000 && log.replaying(); i++) vTaskDelay(pdMS_TO_TICKS(10));
+        ASSERT_FALSE(log.replaying());
+        vTaskDelay(pdMS_TO_TICKS(50));  // the last burst's events
+    }
+
+    // ctest runs the tests in parallel processes, each has its own files
+    static std::string path(int i) {
+        return testing::TempDir() + "nmealog_" + testing::UnitTest::GetInstance()->current_test_info()->name() + std::to_string(i) + ".log";
+    }
+
+    std::string path0 = path(0), path1 = path(1);
+    NmeaLog log{now_ms, path0.c_str(), path1.c_str()};
+    nmea_parser_handle_t hdl = nullptr;
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<gps_t> fixes;
+    std::vector<int64_t> times;
+    std::vector<std::string> lines;
+};
+
+TEST_F(NmeaLogTest, ReplayIsByteExact) {
+    // what a receiver sends besides the clean sentences: a lowercase checksum, no checksum, a proprietary line, a bare "\n" end
+    std::vector<nmea_sat_t> gp = {{5, 40, 100, 41}, {12, 20, 200, 35}, {24, 60, 300, 38}, {29, 5, 20, 0}, {31, 70, 90, 44}};
+    std::vector<nmea_sat_t> gl = {{65, 30, 50, 33}, {72, 15, 150, 0}};
+    nmea_fix_t fix = nmea_default_fix();
+    std::vector<std::string> epochs;
+    for (int e = 0; e < 20; e++) {
+        std::string text;
+        fix.second = e;
+        fix.lat += 0.0001;
+        fix.alt += 0.5;
+        fix.sats_in_use = 6 + e % 3;
+        gp[e % gp.size()].snr += 1;
+        text += nmea_rmc(fix) + nmea_gga(fix) + nmea_gsa({5, 12, 24}, 1) + nmea_gsa({65}, 2);
+        text += nmea_gsv(gp, "GP") + nmea_gsv(gl, "GL");
+        epochs.push_back(text);
+    }
+    std::string vtg = nmea_sentence("GNVTG,45.00,T,,M,10.00,N,18.52,K,A");
+    vtg[vtg.size() - 3] = tolower(vtg[vtg.size() - 3]);
+    vtg[vtg.size() - 4] = tolower(vtg[vtg.size() - 4]);
+    epochs.back() += vtg + "$GNTXT,01,01,02,ANTENNA OK\r\n" + "$PUBX,00,100000.00,4729.12345,N,01903.53214,E,110.000,G3,2.1,2.0,0.1,45.0,0.0,,0.9,1.2,0.8,8,0,0*5C\n";
+    fix.second = 20;
+    epochs.push_back(nmea_rmc(fix) + nmea_gga(fix));
+
+    // an epoch at a time, the receiver's baud rate doesn't flood the uart's pattern queue either
+    ASSERT_TRUE(log.start());
+    std::string text;
+    for (size_t e = 0; e < epochs.size(); e++) {
+        feed(epochs[e]);
+        text += epochs[e];
+        ASSERT_TRUE(wait_fixes(e + 1));
+        vTaskDelay(pdMS_TO_TICKS(5));
+        ASSERT_TRUE(log.flush());  // job_nmealog, every second
+    }
+    log.stop();
+    EXPECT_EQ(log.get_dropped(), 0u);
+    std::vector<gps_t> recorded_fixes;
+    std::vector<std::string> recorded_lines;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        recorded_fixes = fixes;
+        recorded_lines = lines;
+    }
+    std::string joined;
+    for (const std::string& l : recorded_lines) joined += l;
+    ASSERT_EQ(joined, text);
+    RecordProperty("text_bytes", (int)text.size());
+    RecordProperty("log_bytes", (int)log.get_size());
+    EXPECT_LT(log.get_size(), text.size() * 6 / 10);  // the delta encoding, though every epoch moves here
+
+    // a new parser, so nothing is left over from the recording
+    start_parser();
+    replay(false);
+    std::lock_guard<std::mutex> lock(m);
+    ASSERT_EQ(lines.size(), recorded_lines.size());
+    for (size_t i = 0; i < lines.size(); i++) ASSERT_EQ(lines[i], recorded_lines[i]) << "line " << i;
+    ASSERT_EQ(fixes.size(), recorded_fixes.size());
+    for (size_t i = 0; i < fixes.size(); i++) EXPECT_EQ(memcmp(&fixes[i], &recorded_fixes[i], sizeof(gps_t)), 0) << "fix " << i;
+}
+
+TEST_F(NmeaLogTest, RealtimeReplayKeepsThePace) {
+    nmea_fix_t fix = nmea_default_fix();
+    ASSERT_TRUE(log.start());
+    for (int e = 0; e < 4; e++) {
+        fix.second = e;
+        feed(nmea_rmc(fix) + nmea_gga(fix));
+        ASSERT_TRUE(wait_fixes(e + 1));
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+    log.stop();
+    std::vector<int64_t> recorded;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        recorded = times;
+    }
+    start_parser();
+    replay(true);
+    std::lock_guard<std::mutex> lock(m);
+    ASSERT_EQ(times.size(), recorded.size());
+    for (size_t i = 1; i < times.size(); i++) {
+        // the source is polled every NMEA_SOURCE_POLL_MS
+        EXPECT_NEAR((times[i] - times[i - 1]) / 1000.0, (recorded[i] - recorded[i - 1]) / 1000.0, 30) << "fix " << i;
+    }
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "esp_timer.h"
+#include "passpredictor.hpp"
+
+// the pass predictor task against brute force: the iss from budapest, its elevation stepped by 1 s over the predicted window
+
+static const double site_lat = 47.4979;
+static const double site_lon = 19.0402;
+static const double site_alt = 110;
+static const double jd_start = 2460538.0;  // 2024-08-17 12:00 UTC
+
+typedef struct {
+    double aos;  // unix
+    double los;
+    double max_time;
+    double max_elevation;
+} brute_pass_t;
+
+static Sgp4 iss() {
+    char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+    char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+    Sgp4 sat;
+    sat.init("ISS", l1, l2);
+    sat.site(site_lat, site_lon, site_alt);
+    return sat;
+}
+
+// the passes starting after from, till the los of the last predicted one
+static std::vector<brute_pass_t> brute_force(Sgp4 sat, double from, double till) {
+    std::vector<brute_pass_t> ret;
+    bool up = false;
+    brute_pass_t pass = {};
+    for (double t = from; t <= till; t += 1) {
+        sat.findsat(getJulianFromUnix(t));
+        if (sat.satEl > 0 && !up) pass = {t, 0, t, sat.satEl};
+        if (sat.satEl > 0 && sat.satEl > pass.max_elevation) {
+            pass.max_elevation = sat.satEl;
+            pass.max_time = t;
+        }
+        if (sat.satEl <= 0 && up) {
+            pass.los = t - 1;
+            ret.push_back(pass);
+        }
+        up = sat.satEl > 0;
+    }
+    return ret;
+}
+
+// the list the task publishes for this request
+static sat_passes_t predict(const Sgp4& sat, double lat, double jd) {
+    static bool started = false;
+    if (!started) PassPredictor::init();
+    started = true;
+    uint32_t seq = PassPredictor::sequence();
+    PassPredictor::update(sat, lat, site_lon, site_alt, jd);
+    sat_passes_t passes = {};
+    int64_t end = esp_timer_get_time() + 10000000;
+    while (esp_timer_get_time() < end && !(PassPredictor::sequence() != seq && PassPredictor::read(passes) && !passes.computing)) vTaskDelay(pdMS_TO_TICKS(10));
+    return passes;
+}
+
+TEST(PassPredictor, MatchesBruteForce) {
+    Sgp4 sat = iss();
+    sat_passes_t passes = predict(sat, site_lat, jd_start);
+    ASSERT_EQ(passes.count, PP_SAT_PASS_MAX);
+    std::vector<brute_pass_t> brute = brute_force(sat, getUnixFromJulian(jd_start), passes.passes[passes.count - 1].los + 60);
+    ASSERT_EQ(brute.size(), passes.count);  // none missed, none made up
+    for (uint8_t i = 0; i < passes.count; i++) {
+        const sat_pass_t& p = passes.passes[i];
+        SCOPED_TRACE(i);
+        EXPECT_NEAR(p.aos, brute[i].aos, 2);
+        EXPECT_NEAR(p.los, brute[i].los, 2);
+        EXPECT_NEAR(p.max_elevation, brute[i].max_elevation, 0.05);
+        EXPECT_NEAR(p.max_time, brute[i].max_time, 5);  // the top is flat, the elevation is what matters
+        EXPECT_LT(p.aos, p.max_time);
+        EXPECT_LT(p.max_time, p.los);
+    }
+}
+
+TEST(PassPredictor, PassInProgressIsFirst) {
+    Sgp4 sat = iss();
+    sat_passes_t ahead = predict(sat, site_lat + 1, jd_start);  // a new key, so it is computed again
+    ASSERT_GT(ahead.count, 0);
+    // from the middle of the first pass: the same pass comes first
+    double mid = getJulianFromUnix(ahead.passes[0].max_time);
+    sat_passes_t now = predict(sat, site_lat, mid);
+    ASSERT_GT(now.count, 0);
+    EXPECT_LT(now.passes[0].aos, ahead.passes[0].max_time);
+    EXPECT_GT(now.passes[0].los, ahead.passes[0].max_time);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "pointing.hpp"
+
+// PointingStream against Sgp4::findsat() (double sgp4 and rv2azel at every output) on an iss pass right over the site,
+// the hardest case for the interpolation: the azimuth swings 180 degrees in seconds at the top
+
+static const double jd_over = 2460538.0;  // 2024-08-17 12:00 UTC, the site is the sub satellite point then
+
+// angle between two directions on the sky, degrees
+static double separation(double az1, double el1, double az2, double el2) {
+    const double d = pi / 180.0;
+    if (std::isnan(az2)) return fabs(el1 - el2);  // rv2azel() has no azimuth right at the zenith
+    double c = sin(el1 * d) * sin(el2 * d) + cos(el1 * d) * cos(el2 * d) * cos((az1 - az2) * d);
+    return acos(std::min(1.0, std::max(-1.0, c))) / d;
+}
+
+class PointingTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+        char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+        ASSERT_TRUE(sat.init("ISS", l1, l2));
+        sat.findsat(jd_over);
+        lat = sat.satLat;
+        lon = sat.satLon;
+        sat.site(lat, lon, 0);
+    }
+
+    Sgp4 sat;
+    double lat = 0;
+    double lon = 0;
+};
+
+TEST_F(PointingTest, MidIntervalErrorOverhead) {
+    // the samples are at start + k * step, the middle of the intervals is the farthest from them
+    PointingStream stream;
+    elsetrec satrec = sat.satrec;
+    double start = jd_over - 300 / 86400.0;
+    double worst = 0;
+    double worst_low = 0;  // under 80 degrees, where the azimuth alone means something
+    float az, el;
+    ASSERT_TRUE(stream.get(satrec, start, lat, lon, 0, az, el));
+    for (double t = POINTING_STEP_SEC / 2; t < 600; t += POINTING_STEP_SEC) {
+        double jd = start + t / 86400.0;
+        ASSERT_TRUE(stream.get(satrec, jd, lat, lon, 0, az, el));
+        sat.findsat(jd);
+        double err = separation(az, el, sat.satAz, sat.satEl);
+        worst = std::max(worst, err);
+        if (sat.satEl < 80) worst_low = std::max(worst_low, err);
+        EXPECT_NEAR(el, sat.satEl, 0.01) << "t=" << t;
+    }
+    RecordProperty("max_error_mdeg", (int)(worst * 1000));
+    RecordProperty("max_error_under_80_mdeg", (int)(worst_low * 1000));
+    EXPECT_LT(worst, 0.01);  // a rotator's resolution is ~0.1-1 degree
+    EXPECT_LT(worst_low, 0.005);
+}
+
+TEST_F(PointingTest, StreamAtTheRateSamplesEveryStep) {
+    PointingStream stream;
+    elsetrec satrec = sat.satrec;
+    double start = jd_over - 300 / 86400.0;
+    double worst = 0;
+    float az, el;
+    const int hz = POINTING_HZ_DEFAULT;
+    for (int i = 0; i < 600 * hz; i++) {
+        double jd = start + i / (86400.0 * hz);
+        ASSERT_TRUE(stream.get(satrec, jd, lat, lon, 0, az, el));
+        sat.findsat(jd);
+        worst = std::max(worst, separation(az, el, sat.satAz, sat.satEl));
+    }
+    RecordProperty("max_error_mdeg", (int)(worst * 1000));
+    EXPECT_LT(worst, 0.01);
+    // 4 to fill, then one per step
+    EXPECT_LE(stream.propagations(), 4 + 600 / POINTING_STEP_SEC);
+}
+
+TEST_F(PointingTest, SiteChangeDropsTheSamples) {
+    PointingStream stream;
+    elsetrec satrec = sat.satrec;
+    float az, el;
+    ASSERT_TRUE(stream.get(satrec, jd_over, lat, lon, 0, az, el));
+    uint32_t before = stream.propagations();
+    ASSERT_TRUE(stream.get(satrec, jd_over + 1 / 86400.0, lat + 1, lon, 0, az, el));
+    EXPECT_EQ(stream.propagations(), before + 4);
+    sat.site(lat + 1, lon, 0);
+    sat.findsat(jd_over + 1 / 86400.0);
+    EXPECT_LT(separation(az, el, sat.satAz, sat.satEl), 0.01);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "alloc_count.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+
+// the ppi2c protocol, with the portapack as the master on the simulated bus
+
+static void gps_cb(ppgpssmall_t& gps) {
+    gps.latitude = 47.5f;
+    gps.longitude = 19.05f;
+    gps.sats_in_use = 7;
+}
+
+TEST(PPHandler, InfoNameAndVersion) {
+    PPHandler::set_module_name("HOSTMODULE");
+    PPHandler::set_module_version(42);
+    pp_master_init();
+    device_info info = pp_query_as<device_info>((uint16_t)Command::COMMAND_INFO);
+    EXPECT_EQ(info.api_version, (uint32_t)PP_API_VERSION);
+    EXPECT_EQ(info.module_version, 42u);
+    EXPECT_STREQ(info.module_name, "HOSTMODULE");
+}
+
+TEST(PPHandler, FeatureMaskFromCallback) {
+    pp_master_init();
+    PPHandler::set_get_features_CB([](uint64_t& feat) { feat = (uint64_t)SupportedFeatures::FEAT_GPS | (uint64_t)SupportedFeatures::FEAT_SHELL; });
+    uint64_t mask = pp_query_as<uint64_t>((uint16_t)Command::COMMAND_GETFEATURE_MASK);
+    EXPECT_EQ(mask, (uint64_t)SupportedFeatures::FEAT_GPS | (uint64_t)SupportedFeatures::FEAT_SHELL);
+    PPHandler::set_get_features_CB(nullptr);
+}
+
+TEST(PPHandler, DataAllComposedFromSingleCallbacks) {
+    pp_master_init();
+    PPHandler::set_get_gps_data_CB(gps_cb);
+    feat_data_all_t all = pp_query_as<feat_data_all_t>((uint16_t)Command::COMMAND_GETFEAT_DATA_ALL);
+    PPHandler::set_get_gps_data_CB(nullptr);
+    EXPECT_EQ(all.version, PP_FEAT_DATA_ALL_VERSION);
+    EXPECT_EQ(all.present, FEAT_DATA_PRESENT_GPS);
+    EXPECT_FLOAT_EQ(all.gps.latitude, 47.5f);
+    EXPECT_EQ(all.gps.sats_in_use, 7);
+    EXPECT_FLOAT_EQ(all.orientation.angle, 400);  // no orientation
+}
+
+TEST(PPHandler, ShellFrameSizeIsClamped) {
+    pp_master_init();
+    uint8_t size = 200;
+    pp_send((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, &size, 1);
+    std::vector<uint8_t> reply = pp_query((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, 1);
+    ASSERT_EQ(reply.size(), 1u);
+    EXPECT_EQ(reply[0], PP_SHELL_FRAME_MAX);
+    size = 0;  // back to the default
+    pp_send((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, &size, 1);
+    reply = pp_query((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, 1);
+    EXPECT_EQ(reply[0], PP_SHELL_FRAME_DEFAULT);
+}
+
+TEST(PPHandler, UnknownCommandAnswersFF) {
+    pp_master_init();
+    std::vector<uint8_t> reply = pp_query(0x7FF0, 1);
+    ASSERT_EQ(reply.size(), 1u);
+    EXPECT_EQ(reply[0], 0xFF);
+}
+
+TEST(PPHandler, CommandMixDoesNotAllocateInIsr) {
+    pp_master_init();
+    PPHandler::set_get_gps_data_CB(gps_cb);
+    pp_replay_mix();  // the first round may set up the lazily created state
+    host_alloc_reset_stats();
+    size_t transactions = 0;
+    for (int i = 0; i < 50; i++) transactions += pp_replay_mix();
+    host_alloc_stats_t allocs = host_alloc_get_stats();
+    PPHandler::set_get_gps_data_CB(nullptr);
+    RecordProperty("transactions", (int)transactions);
+    EXPECT_EQ(allocs.isr_news, 0u);
+    EXPECT_EQ(allocs.isr_deletes, 0u);
+}
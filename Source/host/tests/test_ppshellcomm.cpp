@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "esp_timer.h"
+#include "host/i2c_bus.h"
+#include "host_stubs.h"
+#include "pp_handler.hpp"
+#include "pp_master.h"
+#include "ppshellcomm.h"
+
+// esp -> pp shell data through the tx ring, with the portapack polling it over the simulated bus like its shell bridge does
+
+static std::mutex rx_lock;
+static std::vector<uint8_t> rx;  // pp -> esp, what the shell rx task passed on
+
+static void shell_init() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        pp_master_init();
+        PPShellComm::init();
+        // the same wiring as in main.cpp
+        PPHandler::set_get_shell_data_size_CB([]() -> uint16_t { return PPShellComm::get_i2c_tx_queue_size(); });
+        PPHandler::set_send_shell_data_CB([](PPSpan& data, bool& hasmore) {
+            uint32_t size = PPShellComm::read_i2c_tx_queue_ISR(data.data() + data.size(), data.capacity() - data.size());
+            data.commit(size);
+            hasmore = PPShellComm::get_i2c_tx_queue_size() > 0;
+        });
+        PPHandler::set_got_shell_data_CB([](PPSpan& data) {
+            I2CQueueMessage_t msg;
+            auto ttt = pdFALSE;
+            for (size_t pos = 0; pos < data.size(); pos += msg.size) {
+                msg.size = data.size() - pos < sizeof(msg.data) ? data.size() - pos : sizeof(msg.data);
+                memcpy(msg.data, data.data() + pos, msg.size);
+                xQueueSendFromISR(PPShellComm::datain_queue, &msg, &ttt);
+            }
+        });
+        PPShellComm::set_data_rx_callback([](const uint8_t* data, size_t len) {
+            std::lock_guard<std::mutex> lock(rx_lock);
+            rx.insert(rx.end(), data, data + len);
+            return true;
+        });
+    });
+    PPShellComm::set_i2c_connected(true);
+}
+
+static void set_frame_size(uint8_t size) {
+    pp_send((uint16_t)Command::COMMAND_SHELL_FRAME_SIZE, &size, 1);
+}
+
+// polls like the pp: frames while hasmore is set, the size query when idle. returns what arrived
+static std::vector<uint8_t> pp_drain(size_t expected, uint8_t frame, int64_t timeout_us = 5000000) {
+    std::vector<uint8_t> got;
+    uint8_t buf[1 + PP_SHELL_FRAME_MAX];
+    int64_t start = esp_timer_get_time();
+    bool more = false;
+    while (got.size() < expected && esp_timer_get_time() - start < timeout_us) {
+        if (!more) {
+            shell_data_size_t size = pp_query_as<shell_data_size_t>((uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA_SIZE);
+            if (size.size == 0) {
+                vTaskDelay(1);
+                continue;
+            }
+        }
+        pp_send((uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA);
+        pp_receive(buf, 1 + frame);
+        uint8_t len = buf[0] & 0x7F;
+        more = buf[0] & 0x80;
+        got.insert(got.end(), buf + 1, buf + 1 + len);
+    }
+    return got;
+}
+
+static uint8_t* pattern(size_t len) {
+    uint8_t* data = (uint8_t*)malloc(len);
+    for (size_t i = 0; i < len; ++i) data[i] = (uint8_t)(i * 7 + i / 256);
+    return data;
+}
+
+TEST(PPShellComm, WriteIsAllOrNothing) {
+    shell_init();
+    std::vector<uint8_t> big(SHELL_TX_RING_SIZE + 1, 'x');
+    EXPECT_FALSE(PPShellComm::write(big.data(), big.size(), false, true));
+    EXPECT_EQ(PPShellComm::get_i2c_tx_queue_size(), 0);
+    EXPECT_TRUE(PPShellComm::write((const uint8_t*)"help\r\n", 6, false, true));
+    std::vector<uint8_t> got = pp_drain(6, PP_SHELL_FRAME_DEFAULT);
+    EXPECT_EQ(std::string(got.begin(), got.end()), "help\r\n");
+}
+
+TEST(PPShellComm, QueuedWriteBiggerThanTheRing) {
+    shell_init();
+    for (uint8_t frame : {(uint8_t)PP_SHELL_FRAME_DEFAULT, (uint8_t)PP_SHELL_FRAME_MAX}) {
+        set_frame_size(frame);
+        const size_t len = 4 * SHELL_TX_RING_SIZE;
+        uint8_t* data = pattern(len);
+        std::vector<uint8_t> want(data, data + len);
+        host_i2c_slave_reset_stats();
+        ASSERT_TRUE(PPShellComm::write_queued(data, len));  // the writer task frees it
+        std::vector<uint8_t> got = pp_drain(len, frame);
+        host_i2c_stats_t st = host_i2c_slave_get_stats();
+        ASSERT_EQ(got.size(), len);
+        EXPECT_TRUE(got == want);
+        // what the bus allows at 400 kHz, with the polling overhead
+        double kbps = len / st.bus_us * 1000.0;
+        RecordProperty(frame == PP_SHELL_FRAME_MAX ? "kbytes_per_s_127" : "kbytes_per_s_64", (int)kbps);
+        EXPECT_GT(kbps, frame == PP_SHELL_FRAME_MAX ? 25.0 : 15.0);
+    }
+    set_frame_size(0);
+}
+
+TEST(PPShellComm, QueuedWriteNeverBlocksTheCaller) {
+    shell_init();
+    host_ws_sent();
+    const size_t len = 2 * SHELL_TX_RING_SIZE;  // can't fit without the pp polling
+    int64_t start = esp_timer_get_time();
+    ASSERT_TRUE(PPShellComm::write_queued(pattern(len), len));
+    EXPECT_LT(esp_timer_get_time() - start, 50000);
+
+    // nobody polls: the writer task gives up after SHELL_WRITE_BLOCK_TIMEOUT_MS and tells the web
+    std::string sent;
+    for (int i = 0; i < SHELL_WRITE_BLOCK_TIMEOUT_MS / 100 + 20 && sent.empty(); ++i) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        sent = host_ws_sent();
+    }
+    EXPECT_EQ(sent, "#$##$$#SHELLBUSY\r\n");
+    pp_drain(SHELL_TX_RING_SIZE, PP_SHELL_FRAME_DEFAULT);  // what fitted, for the next test
+}
+
+TEST(PPShellComm, QueueFullIsBackpressure) {
+    shell_init();
+    PPShellComm::set_i2c_connected(false);
+    EXPECT_FALSE(PPShellComm::write_queued(nullptr, 1));  // not connected, nothing taken
+    PPShellComm::set_i2c_connected(true);
+}
+
+TEST(PPShellComm, LongPpWriteIsNotCut) {
+    shell_init();
+    {
+        std::lock_guard<std::mutex> lock(rx_lock);
+        rx.clear();
+    }
+    // more than a shell frame, as much as the i2c buffer takes after the command
+    const size_t len = PP_I2C_BUFFER_SIZE - 2;
+    uint8_t* data = pattern(len);
+    std::vector<uint8_t> want(data, data + len);
+    free(data);
+    ASSERT_TRUE(pp_send((uint16_t)Command::COMMAND_SHELL_PPTOMOD_DATA, want.data(), len));
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(rx_lock);
+            if (rx.size() >= len) break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    std::lock_guard<std::mutex> lock(rx_lock);
+    EXPECT_TRUE(rx == want);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include "satbatch.hpp"
+#include "tle_gen.h"
+
+// SatBatch against the per satellite Sgp4 class (sgp4() and rv2azel() for every satellite, like the single tracked one):
+// a random low orbit catalog from budapest, at a few times around the epochs
+
+static const double site_lat = 47.4979;
+static const double site_lon = 19.0402;
+static const double site_alt = 110;
+
+class SatBatchTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        std::istringstream catalog(tle_catalog(100, 5));
+        std::string name, l1, l2;
+        while (std::getline(catalog, name) && std::getline(catalog, l1) && std::getline(catalog, l2)) {
+            tle_db_record_t rec;
+            ASSERT_TRUE(TleDb::parse(name.c_str(), l1.c_str(), l2.c_str(), rec)) << name;
+            ASSERT_TRUE(batch.add(rec)) << name;
+            char line1[130], line2[130];
+            strlcpy(line1, l1.c_str(), sizeof(line1));
+            strlcpy(line2, l2.c_str(), sizeof(line2));
+            Sgp4& sat = sats[name];
+            ASSERT_TRUE(sat.init(name.c_str(), line1, line2));
+            sat.site(site_lat, site_lon, site_alt);
+        }
+        ASSERT_EQ(batch.size(), 100);
+    }
+
+    SatBatch batch;
+    std::map<std::string, Sgp4> sats;
+};
+
+TEST_F(SatBatchTest, MatchesPerSatelliteSgp4) {
+    // the float kernel is within 30 m of sgp4() (test_sgp4kernel.cpp), that is a few millidegrees at these ranges
+    double worst_el = 0;
+    double worst_az = 0;
+    for (double jd : {2460538.5, 2460539.0, 2460539.75, 2460541.0}) {
+        batch.propagate(jd, site_lat, site_lon, site_alt);
+        sat_batch_entry_t entries[100];
+        ASSERT_EQ(batch.get_sorted(entries, 100), 100);
+        for (const sat_batch_entry_t& entry : entries) {
+            Sgp4& sat = sats.at(entry.name);
+            sat.findsat(jd);
+            SCOPED_TRACE(entry.name);
+            EXPECT_NEAR(entry.elevation, sat.satEl, 0.01);
+            worst_el = std::max(worst_el, fabs(entry.elevation - sat.satEl));
+            if (sat.satEl < 85) {  // the azimuth is undefined at the zenith
+                double daz = fabs(entry.azimuth - sat.satAz);
+                daz = std::min(daz, 360 - daz);
+                EXPECT_LT(daz, 0.02);
+                worst_az = std::max(worst_az, daz);
+            }
+        }
+    }
+    RecordProperty("max_elevation_error_mdeg", (int)(worst_el * 1000));
+    RecordProperty("max_azimuth_error_mdeg", (int)(worst_az * 1000));
+}
+
+TEST_F(SatBatchTest, SortedAndRiseTimesHold) {
+    double jd = 2460539.0;
+    // one rise search per tick: after a tick for every satellite, all the ones under the horizon have one
+    for (int i = 0; i < 100; i++) batch.propagate(jd + i / 86400.0, site_lat, site_lon, site_alt);
+    jd += 99 / 86400.0;
+    sat_batch_entry_t entries[100];
+    ASSERT_EQ(batch.get_sorted(entries, 100), 100);
+    bool visible = true;
+    uint32_t last_aos = 0;
+    int rising = 0;
+    for (const sat_batch_entry_t& entry : entries) {
+        SCOPED_TRACE(entry.name);
+        if (entry.elevation <= 0) visible = false;
+        EXPECT_EQ(entry.elevation > 0, visible);  // the visible ones first
+        if (visible || entry.aos == 0) continue;
+        EXPECT_GE(entry.aos, last_aos);  // then by rise time
+        last_aos = entry.aos;
+        rising++;
+        // the rise is at the horizon, to the ~4 s bisection and the 1 s rounding
+        Sgp4& sat = sats.at(entry.name);
+        sat.findsat(getJulianFromUnix(entry.aos));
+        EXPECT_NEAR(sat.satEl, 0, 0.5);
+        sat.findsat(getJulianFromUnix(entry.aos - 10));
+        EXPECT_LT(sat.satEl, 0);
+    }
+    RecordProperty("rising", rising);
+    EXPECT_GT(rising, 50);
+}
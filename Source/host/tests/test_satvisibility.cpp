@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include "satvisibility.hpp"
+#include "sgp4/visible.h"
+
+// the sun and eclipse fields of sattrackdata_t for the iss from budapest: the sun's noon elevation at the solstices and
+// the equinox, the eclipse against a cylindrical earth shadow over a day, and the visibility states against their rules
+
+static const double site_lat = 47.4979;
+static const double site_lon = 19.0402;
+
+class SatVisibilityTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char l1[130] = "1 25544U 98067A   24230.50000000  .00016717  00000-0  30594-3 0  9992";
+        char l2[130] = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.50377579467892";
+        ASSERT_TRUE(sat.init("ISS", l1, l2));
+        sat.site(site_lat, site_lon, 110);
+    }
+
+    sattrackdata_t at(double jd) {
+        sattrackdata_t data = {};
+        sat.findsat(jd);
+        SatVisibility::fill(&sat, data);
+        return data;
+    }
+
+    Sgp4 sat;
+};
+
+TEST_F(SatVisibilityTest, SunAtNoon) {
+    // the highest sun of the day is 90 - latitude + declination, due south, at the local solar noon
+    typedef struct {
+        int year, month, day;
+        double declination;  // at the noon, degrees
+        double noon_utc;     // hours, 12 - longitude / 15 - equation of time
+    } day_t;
+    const day_t days[] = {
+        {2024, 6, 20, 23.44, 10.76},
+        {2024, 12, 21, -23.44, 10.70},
+        {2024, 3, 20, 0.13, 10.86},
+    };
+    for (const day_t& d : days) {
+        SCOPED_TRACE(d.month);
+        double jd0;
+        jday(d.year, d.month, d.day, 0, 0, 0, 0, false, jd0);
+        sattrackdata_t best = {};
+        double best_hour = 0;
+        for (int minute = 0; minute < 24 * 60; minute++) {
+            sattrackdata_t data = at(jd0 + minute / 1440.0);
+            if (data.sun_elevation > best.sun_elevation) {
+                best = data;
+                best_hour = minute / 60.0;
+            }
+        }
+        EXPECT_NEAR(best.sun_elevation, 90 - site_lat + d.declination, 0.1);
+        EXPECT_NEAR(best.sun_azimuth, 180, 0.5);
+        EXPECT_NEAR(best_hour, d.noon_utc, 0.05);  // 3 minutes
+    }
+}
+
+TEST_F(SatVisibilityTest, EclipseMatchesTheShadowCylinder) {
+    // sun and satellite both in the equatorial frame of date. behind the earth and within its radius from the sun line: shadow.
+    // the cylinder has no penumbra, and is a few seconds off the cone at the edges
+    double jd0 = 2460538.0;
+    int steps = 0, lit = 0, shadowed = 0, mismatch = 0, transitions = 0;
+    bool last_shadow = false;
+    for (int s = 0; s < 86400; s += 10) {
+        double jd = jd0 + s / 86400.0;
+        sattrackdata_t data = at(jd);
+        double r[3], v[3], rsun[3];
+        elsetrec rec = sat.satrec;
+        ASSERT_TRUE(sgp4(wgs84, rec, (jd - rec.jdsatepoch) * 1440.0, r, v));
+        sun(jd, rsun);
+        double sun_len = sqrt(rsun[0] * rsun[0] + rsun[1] * rsun[1] + rsun[2] * rsun[2]);
+        double along = (r[0] * rsun[0] + r[1] * rsun[1] + r[2] * rsun[2]) / sun_len;
+        double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+        bool shadow = along < 0 && sqrt(r2 - along * along) < 6378.137;
+        if (s && shadow != last_shadow) transitions++;
+        last_shadow = shadow;
+        steps++;
+        if (shadow) shadowed++;
+        if (data.sunlit == 1000) lit++;
+        if ((data.sunlit == 0 && !shadow) || (data.sunlit == 1000 && shadow)) mismatch++;
+        EXPECT_LE(data.sunlit, 1000);
+    }
+    RecordProperty("lit_percent", lit * 100 / steps);
+    RecordProperty("mismatch_steps", mismatch);
+    EXPECT_NEAR(transitions, 31, 1);  // in and out on each of the ~15.5 orbits of the day
+    EXPECT_LE(mismatch, transitions);  // at most one 10 s step at each edge
+    EXPECT_NEAR(lit, steps - shadowed, 2 * transitions);  // the penumbra (~10 s at each edge) is neither
+}
+
+TEST_F(SatVisibilityTest, StatesFollowTheirRules) {
+    double jd0 = 2460538.0;
+    int count[5] = {};
+    for (int s = 0; s < 86400; s += 10) {
+        sattrackdata_t data = at(jd0 + s / 86400.0);
+        ASSERT_FLOAT_EQ(data.sun_elevation, sat.sunEl);
+        ASSERT_GE(data.sun_azimuth, 0);
+        ASSERT_LT(data.sun_azimuth, 360);
+        ASSERT_EQ(data.sunlit, sat.satLit);
+        sat_visibility_t want;
+        if (sat.satEl < 0)
+            want = SAT_VIS_UNDER_HORIZON;
+        else if (sat.sunEl > -6)
+            want = SAT_VIS_DAYLIGHT;
+        else if (sat.satLit == 0)
+            want = SAT_VIS_ECLIPSED;
+        else
+            want = SAT_VIS_VISIBLE;
+        ASSERT_EQ(data.visibility, want) << "t=" << s;
+        count[data.visibility]++;
+    }
+    EXPECT_GT(count[SAT_VIS_UNDER_HORIZON], 0);
+    EXPECT_GT(count[SAT_VIS_DAYLIGHT] + count[SAT_VIS_ECLIPSED] + count[SAT_VIS_VISIBLE], 0);
+
+    sattrackdata_t none = at(jd0);
+    SatVisibility::fill(nullptr, none);
+    EXPECT_EQ(none.visibility, SAT_VIS_UNKNOWN);
+    EXPECT_EQ(none.sunlit, 0);
+}
+
+TEST_F(SatVisibilityTest, Timing) {
+    // the tracking job's per tick cost: findsat() with the sun and shadow, and the mapping
+    const int n = 20000;
+    volatile uint16_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sink = sink + at(2460538.0 + i / 86400.0).sunlit;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    RecordProperty("ns_per_tick", (int)ns);
+    EXPECT_LT(ns, 100000);  // far from the 1 s tick even on the esp
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "scheduler.hpp"
+
+// the deadline scheduler on a fake clock: the wait function just moves the clock, or stops early like an event would
+
+static uint32_t fake_now = 0;
+static std::vector<uint32_t> waits;       // every sleep the scheduler asked for
+static uint32_t event_after = UINT32_MAX;  // the next wait returns after this many ms, like a WakeMainLoop()
+static void (*on_event)() = nullptr;
+
+static uint32_t now_fn() {
+    return fake_now;
+}
+
+static void wait_fn(uint32_t ms) {
+    waits.push_back(ms);
+    if (event_after < ms) {
+        fake_now += event_after;
+        event_after = UINT32_MAX;
+        if (on_event) on_event();
+        return;
+    }
+    fake_now += ms;
+}
+
+static std::vector<std::pair<int, uint32_t>> runs;  // job, time
+static void job0(uint32_t now) {
+    runs.push_back({0, now});
+}
+static void job1(uint32_t now) {
+    runs.push_back({1, now});
+}
+
+class SchedulerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        fake_now = 1000;
+        waits.clear();
+        runs.clear();
+        event_after = UINT32_MAX;
+        on_event = nullptr;
+    }
+
+    void loop_till(Scheduler& s, uint32_t end) {
+        while (fake_now < end) s.run_due(s.wait_next());
+    }
+};
+
+TEST_F(SchedulerTest, RunsOnTheDeadlinesWithoutPolling) {
+    Scheduler s(now_fn, wait_fn);
+    ASSERT_TRUE(s.add_job(0, 100, job0));
+    ASSERT_TRUE(s.add_job(1, 250, job1));
+    loop_till(s, 1000 + 1000);
+    std::vector<std::pair<int, uint32_t>> want;
+    for (uint32_t t = 1000; t <= 2000; t += 50) {
+        if (t > 1000 && (t - 1000) % 100 == 0) want.push_back({0, t});
+        if (t > 1000 && (t - 1000) % 250 == 0) want.push_back({1, t});
+    }
+    EXPECT_EQ(runs, want);
+    // one sleep per distinct deadline, none of them 0 or a poll tick
+    EXPECT_EQ(waits.size(), 12u);  // 100, 200, 250, 300, 400, 500, 600, 700, 750, 800, 900, 1000
+    for (uint32_t w : waits) EXPECT_GE(w, 50u);
+}
+
+TEST_F(SchedulerTest, NothingDueSleepsTheMaximum) {
+    Scheduler s(now_fn, wait_fn);
+    ASSERT_TRUE(s.add_job(0, 0, job0));  // paused
+    s.run_due(s.wait_next());
+    ASSERT_EQ(waits.size(), 1u);
+    EXPECT_EQ(waits[0], Scheduler::MAX_SLEEP_MS);
+    EXPECT_TRUE(runs.empty());
+}
+
+static Scheduler* trig_sched = nullptr;
+static void trigger_job0() {
+    trig_sched->trigger(0);
+}
+
+TEST_F(SchedulerTest, TriggerWakesAndRestartsThePeriod) {
+    Scheduler s(now_fn, wait_fn);
+    trig_sched = &s;
+    ASSERT_TRUE(s.add_job(0, 100, job0));
+    event_after = 30;  // an irq at 1030 triggers the job
+    on_event = trigger_job0;
+    s.run_due(s.wait_next());
+    ASSERT_EQ(runs.size(), 1u);
+    EXPECT_EQ(runs[0].second, 1030u);
+    loop_till(s, 1130);
+    ASSERT_EQ(runs.size(), 2u);
+    EXPECT_EQ(runs[1].second, 1130u);  // 100 from the triggered run, not from the add
+}
+
+TEST_F(SchedulerTest, PausedJobRunsOnlyWhenTriggered) {
+    Scheduler s(now_fn, wait_fn);
+    ASSERT_TRUE(s.add_job(0, 0, job0));
+    ASSERT_TRUE(s.add_job(1, 500, job1));
+    s.trigger(0);
+    EXPECT_EQ(s.wait_next(), 1000u);  // no sleep with a pending trigger
+    EXPECT_TRUE(waits.empty());
+    s.run_due(1000);
+    loop_till(s, 2000);
+    int job0_runs = 0;
+    for (auto& r : runs) job0_runs += r.first == 0;
+    EXPECT_EQ(job0_runs, 1);
+    s.set_period(0, 200);  // resumed, rescheduled from its last run (1000), so it is overdue
+    s.run_due(s.wait_next());
+    EXPECT_EQ(runs.back(), std::make_pair(0, 2000u));
+    s.run_due(s.wait_next());
+    EXPECT_EQ(runs.back(), std::make_pair(0, 2200u));
+}
+
+TEST_F(SchedulerTest, SurvivesTheMillisWrap) {
+    fake_now = UINT32_MAX - 150;
+    Scheduler s(now_fn, wait_fn);
+    ASSERT_TRUE(s.add_job(0, 100, job0));
+    uint32_t start = fake_now;
+    for (int i = 0; i < 4; ++i) s.run_due(s.wait_next());
+    ASSERT_EQ(runs.size(), 4u);
+    for (int i = 0; i < 4; ++i) EXPECT_EQ(runs[i].second, start + 100u * (i + 1));
+}
+
+TEST_F(SchedulerTest, RejectsBadJobs) {
+    Scheduler s(now_fn, wait_fn);
+    EXPECT_FALSE(s.add_job(Scheduler::MAX_JOBS, 100, job0));
+    EXPECT_FALSE(s.add_job(0, 100, nullptr));
+    EXPECT_TRUE(s.add_job(0, 100, job0));
+    EXPECT_FALSE(s.add_job(0, 100, job1));  // taken
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "sensorsnapshot.hpp"
+
+// DoubleBuffer with a writer that laps the reader (the other core of the S3, or a reader isr that got delayed)
+
+// every word is the publish counter, a mixed copy shows up as different words.
+// the copy can be interrupted in the middle, to replay an exact interleaving on one thread
+struct frame_t {
+    uint32_t words[64];
+
+    frame_t() = default;
+    frame_t(const frame_t& o) { *this = o; }
+    frame_t& operator=(const frame_t& o) {
+        for (size_t i = 0; i < 64; ++i) {
+            words[i] = o.words[i];
+            if (mid_copy) mid_copy(i);
+        }
+        return *this;
+    }
+
+    static thread_local void (*mid_copy)(size_t copied);
+};
+thread_local void (*frame_t::mid_copy)(size_t) = nullptr;
+
+struct writer_stopped {};  // thrown in the middle of a publish, like the writer being preempted there
+
+static frame_t frame_of(uint32_t n) {
+    frame_t f;
+    for (uint32_t& w : f.words) w = n;
+    return f;
+}
+
+static bool is_torn(const frame_t& f) {
+    for (uint32_t w : f.words) {
+        if (w != f.words[0]) return true;
+    }
+    return false;
+}
+
+TEST(SensorSnapshot, ReaderSeesLastPublish) {
+    DoubleBuffer<SensorSnapshot> buf;
+    SensorSnapshot snap = {};
+    snap.light = 123;
+    buf.publish(snap);
+    SensorSnapshot out = {};
+    ASSERT_TRUE(buf.read(out));
+    EXPECT_EQ(out.light, 123);
+    EXPECT_EQ(buf.sequence(), 1u);
+}
+
+TEST(SensorSnapshot, LappedReaderRejectsTornCopy) {
+    // reader copies a quarter of publish 1, the writer publishes 2 and is 3/4 through 3 (same slot as 1) when the reader finishes
+    static DoubleBuffer<frame_t> buf;
+    buf.publish(frame_of(1));
+    frame_t::mid_copy = [](size_t copied) {
+        if (copied != 15) return;
+        frame_t::mid_copy = nullptr;  // only the reader's first try
+        buf.publish(frame_of(buf.sequence() + 1));
+        frame_t::mid_copy = [](size_t copied) {
+            if (copied == 47) throw writer_stopped();
+        };
+        try {
+            buf.publish(frame_of(buf.sequence() + 1));
+        } catch (const writer_stopped&) {
+        }
+        frame_t::mid_copy = nullptr;
+    };
+    frame_t out;
+    bool ok = buf.read(out);
+    if (ok) {
+        EXPECT_FALSE(is_torn(out)) << "read() accepted a mixed copy: " << out.words[0] << " / " << out.words[63];
+    }
+}
+
+TEST(SensorSnapshot, CrossThreadStress) {
+    static DoubleBuffer<frame_t> buf;
+    std::atomic<bool> stop{false};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> good{0};
+
+    std::thread writer([&] {
+        for (uint32_t n = 1; !stop.load(std::memory_order_relaxed); ++n) buf.publish(frame_of(n));
+    });
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            // a slow reader, so the writer laps it often when there is a core for each
+            frame_t::mid_copy = [](size_t copied) {
+                if (copied == 31) {
+                    for (int spin = 0; spin < 200; ++spin) asm volatile("");
+                }
+            };
+            frame_t f;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!buf.read(f)) continue;
+                good.fetch_add(1, std::memory_order_relaxed);
+                if (is_torn(f)) torn.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    stop = true;
+    writer.join();
+    for (std::thread& t : readers) t.join();
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_GT(good.load(), 0u);
+}
+
+TEST(SensorSnapshot, FailedReadServesTheLastGoodCopy) {
+    static DoubleBuffer<frame_t> buf;
+    buf.publish(frame_of(1));
+    frame_t last = frame_of(0);
+    frame_t out;
+    ASSERT_TRUE(buf.read(out, last));
+    EXPECT_EQ(last.words[0], 1u);
+
+    // the writer laps every try: two publishes in the middle of each copy
+    frame_t::mid_copy = [](size_t copied) {
+        if (copied != 31) return;
+        auto self = frame_t::mid_copy;
+        frame_t::mid_copy = nullptr;
+        buf.publish(frame_of(buf.sequence() + 1));
+        buf.publish(frame_of(buf.sequence() + 1));
+        frame_t::mid_copy = self;
+    };
+    bool ok = buf.read(out, last);
+    frame_t::mid_copy = nullptr;
+    EXPECT_FALSE(ok);
+    EXPECT_FALSE(is_torn(out));
+    EXPECT_EQ(out.words[0], 1u);  // the previous publish, not a mix of the new ones
+    EXPECT_EQ(last.words[0], 1u);
+}
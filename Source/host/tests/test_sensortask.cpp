@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "esp_timer.h"
+#include "host_stubs.h"
+#include "sensortask.hpp"
+
+// the sensor task over the stubbed i2c sensors (support/sensors_stub.cpp), with the gps fix from a double buffer like in main.cpp
+
+static DoubleBuffer<ppgpssmall_t> gps_buffer;
+
+class SensorTaskTest : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        temperature_sensor_handle_t temp = nullptr;
+        temperature_sensor_config_t config = TEMPERATURE_SENSOR_CONFIG_DEFAULT(10, 50);
+        temperature_sensor_install(&config, &temp);
+        SensorTask::init(temp, &gps_buffer, false);
+        // till the first reads replaced the defaults
+        SensorSnapshot snap = {};
+        for (int i = 0; i < 100 && !(SensorTask::read(snap) && snap.orientation.angle != 400 && snap.light != 0); i++) vTaskDelay(pdMS_TO_TICKS(5));
+    }
+
+    static void TearDownTestSuite() { default_periods(); }
+
+    // the task keeps running between the tests
+    static void default_periods() {
+        SensorTask::set_period(Sensor_ORIENTATION, 100);
+        SensorTask::set_period(Sensor_ENVIRONMENT, 2000);
+        SensorTask::set_period(Sensor_LIGHT, 1000);
+    }
+
+    // mean time between the reads of a sensor, in ms
+    static double mean_period_ms(const std::vector<int64_t>& reads) {
+        if (reads.size() < 2) return 0;
+        return (reads.back() - reads.front()) / 1000.0 / (reads.size() - 1);
+    }
+};
+
+TEST_F(SensorTaskTest, SamplesAtThePeriods) {
+    SensorTask::set_period(Sensor_ORIENTATION, 20);
+    SensorTask::set_period(Sensor_ENVIRONMENT, 100);
+    SensorTask::set_period(Sensor_LIGHT, 50);
+    vTaskDelay(pdMS_TO_TICKS(150));  // the new periods are in use
+    for (int s = 0; s < HOST_SENSOR_MAX; s++) host_sensor_reads((host_sensor_t)s);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    std::vector<int64_t> ori = host_sensor_reads(HOST_SENSOR_ORIENTATION);
+    std::vector<int64_t> env = host_sensor_reads(HOST_SENSOR_ENVIRONMENT);
+    std::vector<int64_t> light = host_sensor_reads(HOST_SENSOR_LIGHT);
+    RecordProperty("orientation_reads", (int)ori.size());
+    RecordProperty("environment_reads", (int)env.size());
+    RecordProperty("light_reads", (int)light.size());
+    EXPECT_NEAR(mean_period_ms(ori), 20, 4);
+    EXPECT_NEAR(mean_period_ms(env), 100, 10);
+    EXPECT_NEAR(mean_period_ms(light), 50, 7);
+    // never faster than asked
+    for (size_t i = 1; i < env.size(); i++) EXPECT_GE(env[i] - env[i - 1], 95000) << "read " << i;
+}
+
+TEST_F(SensorTaskTest, DisabledSensorIsNotRead) {
+    SensorTask::set_period(Sensor_LIGHT, 0);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    host_sensor_reads(HOST_SENSOR_LIGHT);
+    vTaskDelay(pdMS_TO_TICKS(300));
+    EXPECT_TRUE(host_sensor_reads(HOST_SENSOR_LIGHT).empty());
+    SensorTask::set_period(Sensor_LIGHT, 1000);
+}
+
+TEST_F(SensorTaskTest, SnapshotsAreConsistent) {
+    SensorTask::set_period(Sensor_ORIENTATION, 1);
+    SensorTask::set_period(Sensor_ENVIRONMENT, 1);
+    SensorTask::set_period(Sensor_LIGHT, 1);
+    int64_t end = esp_timer_get_time() + 500000;
+    uint32_t reads = 0;
+    uint32_t last_seq = 0;
+    uint32_t first_ori = 0;
+    uint32_t last_ori = 0;
+    SensorSnapshot snap;
+    while (esp_timer_get_time() < end) {
+        uint32_t seq = SensorTask::sequence();
+        if (!SensorTask::read(snap)) continue;  // torn, a retry is the caller's business
+        reads++;
+        // every field of a sensor comes from the same read
+        ASSERT_EQ(snap.orientation.angle, snap.orientation.tilt);
+        ASSERT_EQ(snap.environment.temperature, snap.environment.pressure);
+        ASSERT_EQ(snap.environment.temperature, snap.environment.humidity);
+        ASSERT_EQ(snap.present & (FEAT_DATA_PRESENT_ORIENTATION | FEAT_DATA_PRESENT_ENVIRONMENT | FEAT_DATA_PRESENT_LIGHT),
+                  FEAT_DATA_PRESENT_ORIENTATION | FEAT_DATA_PRESENT_ENVIRONMENT | FEAT_DATA_PRESENT_LIGHT);
+        // and the snapshots only go forward
+        ASSERT_GE(seq, last_seq);
+        ASSERT_GE((uint32_t)snap.orientation.angle, last_ori);
+        if (!first_ori) first_ori = (uint32_t)snap.orientation.angle;
+        last_seq = seq;
+        last_ori = (uint32_t)snap.orientation.angle;
+        std::this_thread::yield();
+    }
+    RecordProperty("snapshots_read", (int)reads);
+    EXPECT_GT(reads, 100u);
+    EXPECT_GT(last_ori - first_ori, 20u);  // the task kept publishing, at the tick rate
+    default_periods();
+}
+
+TEST_F(SensorTaskTest, GpsFixIsPublishedOnUpdate) {
+    ppgpssmall_t fix = {};
+    fix.latitude = 47.5f;
+    fix.longitude = 19.05f;
+    fix.sats_in_use = 9;
+    gps_buffer.publish(fix);
+    SensorTask::gps_updated();
+    SensorSnapshot snap = {};
+    for (int i = 0; i < 50 && snap.gps.sats_in_use != 9; i++) {
+        vTaskDelay(pdMS_TO_TICKS(2));
+        SensorTask::read(snap);
+    }
+    EXPECT_EQ(snap.gps.sats_in_use, 9);
+    EXPECT_FLOAT_EQ(snap.gps.latitude, 47.5f);
+    EXPECT_TRUE(snap.present & FEAT_DATA_PRESENT_GPS);
+}
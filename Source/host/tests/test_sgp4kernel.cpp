@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include "sgp4kernel.hpp"
+#include "tle_gen.h"
+
+// Sgp4Kernel against the reference sgp4(): the verification vectors, and random low orbits over +-3 days around the epoch
+
+static const char* VER_L1 = "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753";
+static const char* VER_L2 = "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667";
+
+static elsetrec load(const char* l1, const char* l2, gravconsttype whichconst) {
+    char line1[130], line2[130];
+    strlcpy(line1, l1, sizeof(line1));
+    strlcpy(line2, l2, sizeof(line2));
+    elsetrec satrec;
+    twoline2rv(line1, line2, 'i', whichconst, satrec);
+    return satrec;
+}
+
+static double dist(const double a[3], const double b[3]) {
+    return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+// the largest position (km) and velocity (km/s) difference from sgp4() over -3..3 days
+template <typename T>
+static void max_error(elsetrec satrec, double& rerr, double& verr) {
+    rerr = verr = 0;
+    elsetrec ref = satrec;
+    for (double t = -3 * 1440; t <= 3 * 1440; t += 37) {
+        double r[3], v[3], rr[3], rv[3];
+        ASSERT_TRUE(sgp4(wgs84, ref, t, rr, rv));
+        ASSERT_TRUE(Sgp4Kernel<T>::propagate(wgs84, satrec, t, r, v)) << "t=" << t;
+        rerr = std::max(rerr, dist(r, rr));
+        verr = std::max(verr, dist(v, rv));
+    }
+}
+
+TEST(Sgp4Kernel, VerificationVectors) {
+    // tcppver.out, wgs72. the float kernel adds its own error to the ~6 m drift of the library (test_sgp4.cpp)
+    const double want_r[2][3] = {{7022.46529266, -1400.08296755, 0.03995155}, {-7154.03120202, -3783.17682504, -3536.19412294}};
+    const double want_v[2][3] = {{1.893841015, 6.405893759, 4.534807250}, {4.741887409, -4.151817765, -2.093935425}};
+    const double tsince[2] = {0.0, 360.0};
+    for (int i = 0; i < 2; i++) {
+        elsetrec satrec = load(VER_L1, VER_L2, wgs72);
+        double r[3], v[3];
+        ASSERT_TRUE(Sgp4Kernel<double>::propagate(wgs72, satrec, tsince[i], r, v));
+        EXPECT_LT(dist(r, want_r[i]), 1e-2) << "double t=" << tsince[i];
+        EXPECT_LT(dist(v, want_v[i]), 1e-5) << "double t=" << tsince[i];
+        ASSERT_TRUE(Sgp4Kernel<float>::propagate(wgs72, satrec, tsince[i], r, v));
+        EXPECT_LT(dist(r, want_r[i]), 0.04) << "float t=" << tsince[i];
+        EXPECT_LT(dist(v, want_v[i]), 4e-5) << "float t=" << tsince[i];
+    }
+}
+
+TEST(Sgp4Kernel, ErrorBudgetOverACatalog) {
+    // the bounds of the sgp4kernel.hpp comment: float < 30 m and < 0.03 m/s, double < 1 mm
+    std::istringstream catalog(tle_catalog(40, 11));
+    std::string name, l1, l2;
+    double worst_r = 0, worst_v = 0;
+    while (std::getline(catalog, name) && std::getline(catalog, l1) && std::getline(catalog, l2)) {
+        elsetrec satrec = load(l1.c_str(), l2.c_str(), wgs84);
+        double rerr, verr;
+        max_error<double>(satrec, rerr, verr);
+        EXPECT_LT(rerr, 1e-6) << name;
+        EXPECT_LT(verr, 1e-9) << name;
+        max_error<float>(satrec, rerr, verr);
+        EXPECT_LT(rerr, 0.030) << name;
+        EXPECT_LT(verr, 3e-5) << name;
+        worst_r = std::max(worst_r, rerr);
+        worst_v = std::max(worst_v, verr);
+    }
+    RecordProperty("float_max_position_m", (int)(worst_r * 1000));
+    RecordProperty("float_max_velocity_mm_s", (int)(worst_v * 1e6));
+}
+
+TEST(Sgp4Kernel, DeepSpaceGoesToTheReference) {
+    tle_elements_t el = {"GEO", 41000, 24, 230.5, 0.0, 0.05, 80.0, 0.0003, 90.0, 10.0, 1.0027, 100};
+    std::istringstream tle(tle_make(el));
+    std::string name, l1, l2;
+    std::getline(tle, name);
+    std::getline(tle, l1);
+    std::getline(tle, l2);
+    elsetrec satrec = load(l1.c_str(), l2.c_str(), wgs84);
+    ASSERT_EQ(satrec.method, 'd');
+    elsetrec ref = satrec;
+    double r[3], v[3], rr[3], rv[3];
+    ASSERT_TRUE(Sgp4Kernel<float>::propagate(wgs84, satrec, 720, r, v));
+    ASSERT_TRUE(sgp4(wgs84, ref, 720, rr, rv));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(r[i], rr[i]);
+        EXPECT_EQ(v[i], rv[i]);
+    }
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "host/i2c_bus.h"
+
+// the shim itself, so a failing module test is not the shim's fault
+
+TEST(Shim, TicksFollowTheClock) {
+    TickType_t t0 = xTaskGetTickCount();
+    int64_t us0 = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(50));
+    EXPECT_GE(xTaskGetTickCount() - t0, pdMS_TO_TICKS(50));
+    EXPECT_GE(esp_timer_get_time() - us0, 50000);
+}
+
+TEST(Shim, QueueTimesOutAndDelivers) {
+    QueueHandle_t q = xQueueCreate(2, sizeof(int));
+    int v = 0;
+    EXPECT_EQ(xQueueReceive(q, &v, pdMS_TO_TICKS(20)), pdFALSE);
+    v = 1;
+    EXPECT_EQ(xQueueSend(q, &v, 0), pdTRUE);
+    v = 2;
+    EXPECT_EQ(xQueueSend(q, &v, 0), pdTRUE);
+    v = 3;
+    EXPECT_EQ(xQueueSend(q, &v, 0), pdFALSE);  // full
+    EXPECT_EQ(xQueueReceive(q, &v, 0), pdTRUE);
+    EXPECT_EQ(v, 1);
+    vQueueDelete(q);
+}
+
+static void give_task(void* arg) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+    vTaskDelete(NULL);
+}
+
+TEST(Shim, TaskGivesSemaphore) {
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    ASSERT_EQ(xTaskCreate(give_task, "give", 2048, sem, 5, NULL), pdPASS);
+    EXPECT_EQ(xSemaphoreTake(sem, pdMS_TO_TICKS(1000)), pdTRUE);
+    vSemaphoreDelete(sem);
+}
+
+TEST(Shim, Crc32IsZlibCompatible) {
+    const char* s = "123456789";
+    EXPECT_EQ(esp_rom_crc32_le(0, (const uint8_t*)s, 9), 0xCBF43926u);
+}
+
+TEST(Shim, I2cMasterNacksMissingDevice) {
+    i2c_config_t conf = {};
+    conf.mode = I2C_MODE_MASTER;
+    conf.master.clk_speed = 100000;
+    ASSERT_EQ(i2c_param_config(I2C_NUM_1, &conf), ESP_OK);
+    ASSERT_EQ(i2c_driver_install(I2C_NUM_1, I2C_MODE_MASTER, 0, 0, 0), ESP_OK);
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, 0x77 << 1, true);
+    i2c_master_stop(cmd);
+    EXPECT_EQ(i2c_master_cmd_begin(I2C_NUM_1, cmd, pdMS_TO_TICKS(10)), ESP_FAIL);
+    i2c_cmd_link_delete(cmd);
+    i2c_driver_delete(I2C_NUM_1);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "sdkconfig.h"
+#include "ssd1306.h"
+#include "ssd1306_model.h"
+
+// the display driver against a model of the controller: what the driver keeps as the framebuffer must be on the panel
+
+class Ssd1306Test : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        host_i2c_attach(I2C_NUM_0, I2C_SSD1306_DEV_ADDR, &panel);
+        ASSERT_EQ(ssd1306_init_desc(&bus, I2C_SSD1306_DEV_ADDR, I2C_NUM_0, (gpio_num_t)CONFIG_IC2SDAPIN, (gpio_num_t)CONFIG_IC2SCLPIN), ESP_OK);
+        ssd1306_config_t cfg = I2C_SSD1306_128x64_CONFIG_DEFAULT;
+        ASSERT_EQ(ssd1306_init(bus, &cfg, &dev), ESP_OK);
+    }
+
+    void TearDown() override {
+        host_i2c_attach(I2C_NUM_0, I2C_SSD1306_DEV_ADDR, nullptr);
+        free(dev);
+    }
+
+    void expect_panel_matches() {
+        for (int p = 0; p < dev->pages; p++)
+            for (int c = 0; c < dev->width; c++)
+                ASSERT_EQ(panel.gddram[p][c], dev->page[p].segment[c]) << "page " << p << " column " << c;
+    }
+
+    Ssd1306Model panel;
+    i2c_dev_t bus = {};
+    ssd1306_handle_t dev = nullptr;
+};
+
+TEST_F(Ssd1306Test, SetupTurnsThePanelOn) {
+    EXPECT_TRUE(panel.display_on);
+    EXPECT_EQ(panel.mux, 0x3F);
+    EXPECT_EQ(panel.contrast, 0xFF);
+    ssd1306_disable_display(dev);
+    EXPECT_FALSE(panel.display_on);
+    ssd1306_enable_display(dev);
+    EXPECT_TRUE(panel.display_on);
+}
+
+TEST_F(Ssd1306Test, DisplayPagesWritesTheFramebuffer) {
+    uint8_t buf[128 * 8];
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 7 + (i >> 7));
+    ssd1306_set_pages(dev, buf);
+    ASSERT_EQ(ssd1306_display_pages(dev), ESP_OK);
+    expect_panel_matches();
+    EXPECT_EQ(panel.data_bytes, sizeof(buf));
+}
+
+TEST_F(Ssd1306Test, TextLandsOnItsPage) {
+    char text[] = "HOST";
+    ASSERT_EQ(ssd1306_display_text(dev, 3, text, false), ESP_OK);
+    expect_panel_matches();
+    bool any = false;
+    for (int c = 0; c < 32; c++) any |= panel.gddram[3][c] != 0;
+    EXPECT_TRUE(any);
+    for (int c = 0; c < 128; c++) EXPECT_EQ(panel.gddram[2][c], 0);
+}
+
+TEST_F(Ssd1306Test, BusTimeOfAFullFrame) {
+    host_i2c_reset_stats(I2C_NUM_0);
+    ASSERT_EQ(ssd1306_display_pages(dev), ESP_OK);
+    host_i2c_stats_t st = host_i2c_get_stats(I2C_NUM_0);
+    EXPECT_EQ(st.transactions, 16u);  // addressing and data, for each page
+    EXPECT_EQ(st.bytes, 8u * (4 + 129));
+    EXPECT_NEAR(st.bus_us, 16 * 11 * 10.0 + 8 * (4 + 129) * 9 * 10.0, 1);  // 100 kHz
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "host/http_sim.h"
+#include "tle_gen.h"
+#include "tledownload.hpp"
+
+// the tle download against the simulated http server: conditional requests, a connection dropped mid body and its resume
+
+#define TEST_URL "http://tle.test/mini.tle"
+
+class TleDownloadTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() / ("esp32pp_tledl_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        tle_path = (dir / "mini.tle").string();
+        catalog = tle_catalog(100, 3);
+        host_http_set_server([this](const HostHttpRequest& req) { return serve(req); });
+    }
+
+    void TearDown() override {
+        host_http_set_server(nullptr);
+        std::filesystem::remove_all(dir);
+    }
+
+    // a static file server with an etag, that can drop the connection after cut_after body bytes
+    HostHttpResponse serve(const HostHttpRequest& req) {
+        requests.push_back(req);
+        HostHttpResponse res;
+        res.headers.push_back({"ETag", etag});
+        res.headers.push_back({"Last-Modified", "Sat, 17 Aug 2024 12:00:00 GMT"});
+        auto header = [&](const char* key) -> std::string {
+            auto it = req.headers.find(key);
+            return it == req.headers.end() ? "" : it->second;
+        };
+        if (header("If-None-Match") == etag) {
+            res.status = 304;
+            return res;
+        }
+        size_t from = 0;
+        if (!header("Range").empty() && header("If-Range") == etag) {
+            from = std::stoul(header("Range").substr(6));  // "bytes=N-"
+            res.status = 206;
+        }
+        res.body = catalog.substr(from);
+        res.cut_after = cut_after;
+        cut_after = SIZE_MAX;  // only the first try
+        body_bytes += std::min(res.body.size(), res.cut_after);
+        return res;
+    }
+
+    std::string read_file(const std::string& path) {
+        std::ifstream f(path, std::ios::binary);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    tle_download_meta_t read_meta() {
+        tle_download_meta_t meta{};
+        std::ifstream f(tle_path + ".meta", std::ios::binary);
+        f.read((char*)&meta, sizeof(meta));
+        return meta;
+    }
+
+    void age_meta(uint32_t seconds) {
+        tle_download_meta_t meta = read_meta();
+        meta.checked -= seconds;
+        std::ofstream(tle_path + ".meta", std::ios::binary).write((const char*)&meta, sizeof(meta));
+    }
+
+    std::filesystem::path dir;
+    std::string tle_path;
+    std::string catalog;
+    std::string etag = "\"v1\"";
+    size_t cut_after = SIZE_MAX;
+    size_t body_bytes = 0;
+    std::vector<HostHttpRequest> requests;
+};
+
+TEST_F(TleDownloadTest, UnchangedFileIsNotDownloadedAgain) {
+    ASSERT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_UPDATED);
+    EXPECT_EQ(read_file(tle_path), catalog);
+    EXPECT_EQ(requests[0].headers.count("If-None-Match"), 0u);
+
+    // checked recently: no request at all
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_NOT_MODIFIED);
+    EXPECT_EQ(requests.size(), 1u);
+
+    // later: a conditional request and a 304 without a body
+    age_meta(TLE_DOWNLOAD_MAX_AGE_SEC + 60);
+    size_t before = body_bytes;
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_NOT_MODIFIED);
+    ASSERT_EQ(requests.size(), 2u);
+    EXPECT_EQ(requests[1].headers["If-None-Match"], etag);
+    EXPECT_EQ(body_bytes, before);
+    EXPECT_EQ(read_file(tle_path), catalog);
+
+    // a new version on the server is downloaded
+    age_meta(TLE_DOWNLOAD_MAX_AGE_SEC + 60);
+    etag = "\"v2\"";
+    catalog = tle_catalog(80, 4);
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_UPDATED);
+    EXPECT_EQ(read_file(tle_path), catalog);
+}
+
+TEST_F(TleDownloadTest, TruncatedDownloadKeepsTheOldFileAndResumes) {
+    std::ofstream(tle_path) << tle_catalog(10, 9);
+    std::string old = read_file(tle_path);
+    const size_t cut = catalog.size() / 2 + 17;  // in the middle of a set
+    cut_after = cut;
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_FAILED);
+    EXPECT_EQ(read_file(tle_path), old);
+    tle_download_meta_t meta = read_meta();
+    ASSERT_GT(meta.resume_offset, 0u);
+    EXPECT_LE(meta.resume_offset, cut);
+    EXPECT_EQ(catalog[meta.resume_offset - 1], '\n');  // after the last whole set
+
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_UPDATED);
+    ASSERT_EQ(requests.size(), 2u);
+    EXPECT_EQ(requests[1].headers["Range"], "bytes=" + std::to_string(meta.resume_offset) + "-");
+    EXPECT_EQ(requests[1].headers["If-Range"], etag);
+    EXPECT_EQ(read_file(tle_path), catalog);
+    EXPECT_EQ(body_bytes, catalog.size() + cut - meta.resume_offset);  // only the unfinished set again
+    EXPECT_EQ(read_meta().resume_offset, 0u);
+}
+
+TEST_F(TleDownloadTest, ChangedFileIsNotResumed) {
+    cut_after = catalog.size() / 3;
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_FAILED);
+    EXPECT_FALSE(std::filesystem::exists(tle_path));
+
+    // If-Range doesn't match, the server sends the whole new file with a 200
+    etag = "\"v2\"";
+    catalog = tle_catalog(60, 5);
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_UPDATED);
+    EXPECT_EQ(read_file(tle_path), catalog);
+}
+
+TEST_F(TleDownloadTest, BadSetsAreDropped) {
+    std::string good = catalog;
+    size_t second = catalog.find("SAT 40001\n");
+    size_t l1 = catalog.find('\n', second) + 1;
+    catalog[l1 + 20] = catalog[l1 + 20] == '9' ? '8' : '9';  // checksum fails
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_UPDATED);
+    std::string got = read_file(tle_path);
+    EXPECT_EQ(got.find("SAT 40001\n"), std::string::npos);
+    size_t end = catalog.find("SAT 40002\n");
+    EXPECT_EQ(got, good.substr(0, second) + good.substr(end));
+}
+
+TEST_F(TleDownloadTest, NoServerFails) {
+    host_http_set_server(nullptr);
+    EXPECT_EQ(TleDownload::run(TEST_URL, tle_path.c_str()), TleDownload_FAILED);
+    EXPECT_FALSE(std::filesystem::exists(tle_path));
+}
@@ -25,6 +25,7 @@ void AppManager::startApp(AppList app) {
             break;
     }
     sendCurrentAppToWeb();
+    WakeMainLoop();  // so the app loop switches to the fast period now
 }
 
 void AppManager::loop(uint32_t currentMillis) {
@@ -34,7 +35,7 @@ void AppManager::loop(uint32_t currentMillis) {
 }
 
 // IRQ CALLBACK!!!!!
-bool AppManager::handlePPAppmgrCommands(std::vector<uint8_t>& data) {
+bool AppManager::handlePPAppmgrCommands(PPSpan& data) {
     // ESP_DRAM_LOGW("Appmgr", "appmgrcmd");
     if (data.size() < 2) return false;
     uint16_t appcmd = *(uint16_t*)data.data();
@@ -44,7 +45,7 @@ bool AppManager::handlePPAppmgrCommands(std::vector<uint8_t>& data) {
 }
 
 // IRQ CALLBACK!!!!!
-bool AppManager::handlePPReqAppmgrCommands(std::vector<uint8_t>& data) {
+bool AppManager::handlePPReqAppmgrCommands(PPSpan& data) {
     data.resize(2);
     *(uint16_t*)data.data() = currentAppId;
     // ESP_DRAM_LOGW("Appmgr", "get appmgrcmd: %u", currentAppId);
@@ -52,7 +53,7 @@ bool AppManager::handlePPReqAppmgrCommands(std::vector<uint8_t>& data) {
 }
 
 // IRQ CALLBACK!!!!!
-bool AppManager::handlePPData(uint16_t command, std::vector<uint8_t>& data) {
+bool AppManager::handlePPData(uint16_t command, PPSpan& data) {
     // todo check if the data is for me
     if (currentApp) {
         return currentApp->OnPPData(command, data);
@@ -61,7 +62,7 @@ bool AppManager::handlePPData(uint16_t command, std::vector<uint8_t>& data) {
 }
 
 // IRQ CALLBACK!!!!!
-bool AppManager::handlePPReqData(uint16_t command, std::vector<uint8_t>& data) {
+bool AppManager::handlePPReqData(uint16_t command, PPSpan& data) {
     // todo check if the data is for me
     if (currentApp) {
         return currentApp->OnPPReqData(command, data);
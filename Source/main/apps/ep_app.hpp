@@ -6,16 +6,18 @@
 #include "esp_log.h"
 #include "ppshellcomm.h"
 #include "display/displayskeleton.hpp"
+#include "ppi2c/pp_structures.hpp"
 
 bool ws_sendall(uint8_t* data, size_t len, bool asyncmsg);
 void SetDisplayDirtyMain();
+void WakeMainLoop();
 
 class EPApp {
    public:
     virtual ~EPApp() = default;
 
-    virtual bool OnPPData(uint16_t command, std::vector<uint8_t>& data) { return false; };     // IRQ CALLBACK!!!
-    virtual bool OnPPReqData(uint16_t command, std::vector<uint8_t>& data) { return false; };  // IRQ CALLBACK!!!
+    virtual bool OnPPData(uint16_t command, PPSpan& data) { return false; };     // IRQ CALLBACK!!!
+    virtual bool OnPPReqData(uint16_t command, PPSpan& data) { return false; };  // IRQ CALLBACK!!!
     virtual bool OnWebData(std::string& data) { return false; };
     virtual void OnDisplayRequest(DisplayGeneric* display) {};
     virtual void Loop(uint32_t currentMillis) {};
@@ -165,7 +165,7 @@ bool EPAppWifiSpam::OnWebData(std::string& data) {
     return false;
 }
 
-bool EPAppWifiSpam::OnPPData(uint16_t command, std::vector<uint8_t>& data) {
+bool EPAppWifiSpam::OnPPData(uint16_t command, PPSpan& data) {
     if (command == PPCMD_APPMGR_APPCMD) {
         if (data.size() >= 2) {
             uint16_t new_mode = *reinterpret_cast<uint16_t*>(data.data());
@@ -179,7 +179,7 @@ bool EPAppWifiSpam::OnPPData(uint16_t command, std::vector<uint8_t>& data) {
     return false;
 }
 
-bool EPAppWifiSpam::OnPPReqData(uint16_t command, std::vector<uint8_t>& data) {
+bool EPAppWifiSpam::OnPPReqData(uint16_t command, PPSpan& data) {
     if (command == PPCMD_APPMGR_APPCMD) {
         data.resize(2);
         *reinterpret_cast<uint16_t*>(data.data()) = current_mode;
@@ -10,8 +10,8 @@
 
 class EPAppWifiSpam : public EPApp {
    public:
-    bool OnPPData(uint16_t command, std::vector<uint8_t>& data) override;
-    bool OnPPReqData(uint16_t command, std::vector<uint8_t>& data) override;
+    bool OnPPData(uint16_t command, PPSpan& data) override;
+    bool OnPPReqData(uint16_t command, PPSpan& data) override;
 
     bool OnWebData(std::string& data) override;
 
@@ -1,5 +1,7 @@
 #include "configuration.h"
 #include "led.h"
+#include "tledownload.hpp"
+#include "gpsconfig.hpp"
 
 #if __cplusplus
 extern "C"
@@ -69,6 +71,8 @@ extern "C"
         uint8_t rgb_brightness = 50;
 
         gps_baud = 9600;
+        gps_hz = GPSCFG_HZ_DEFAULT;
+        strlcpy(tle_urls, TLE_URLS_DEFAULT, TLE_URLS_LEN);
         if (err != ESP_OK)
         {
             printf("Error (%s) opening NVS handle!\n", esp_err_to_name(err));
@@ -78,6 +82,10 @@ extern "C"
             nvs_get_u8(nvs_handle, "rgb_brightness", &rgb_brightness);
             LedFeedback::set_brightness(rgb_brightness);
             nvs_get_u32(nvs_handle, "gps_baud", &gps_baud);
+            nvs_get_u8(nvs_handle, "gps_hz", &gps_hz);
+            size_t len = TLE_URLS_LEN;
+            if (nvs_get_str(nvs_handle, "tle_urls", tle_urls, &len) != ESP_OK || tle_urls[0] == 0)
+                strlcpy(tle_urls, TLE_URLS_DEFAULT, TLE_URLS_LEN);
             nvs_close(nvs_handle);
             ESP_LOGI("CONFIG", "load_config_misc ok");
         }
@@ -92,6 +100,8 @@ extern "C"
         {
             nvs_set_u8(nvs_handle, "rgb_brightness", LedFeedback::get_brightness());
             nvs_set_u32(nvs_handle, "gps_baud", gps_baud);
+            nvs_set_u8(nvs_handle, "gps_hz", gps_hz);
+            nvs_set_str(nvs_handle, "tle_urls", tle_urls);
             nvs_commit(nvs_handle);
             nvs_close(nvs_handle);
             ESP_LOGI("CONFIG", "save_config_misc ok");
@@ -102,6 +112,38 @@ extern "C"
         }
     }
 
+    void load_config_gps()
+    {
+        nvs_handle_t nvs_handle;
+        gps_cfg_baud = 0;
+        gps_cfg_receiver = GpsReceiver_UNKNOWN;
+        esp_err_t err = nvs_open("gps", NVS_READONLY, &nvs_handle);
+        if (err == ESP_OK)
+        {
+            nvs_get_u32(nvs_handle, "baud", &gps_cfg_baud);
+            nvs_get_u8(nvs_handle, "receiver", &gps_cfg_receiver);
+            nvs_close(nvs_handle);
+        }
+    }
+
+    void save_config_gps()
+    {
+        ESP_LOGI("CONFIG", "save_config_gps");
+        nvs_handle_t nvs_handle;
+        esp_err_t err = nvs_open("gps", NVS_READWRITE, &nvs_handle);
+        if (err == ESP_OK)
+        {
+            nvs_set_u32(nvs_handle, "baud", gps_cfg_baud);
+            nvs_set_u8(nvs_handle, "receiver", gps_cfg_receiver);
+            nvs_commit(nvs_handle);
+            nvs_close(nvs_handle);
+        }
+        else
+        {
+            ESP_LOGI("CONFIG", "save_config_gps err: %d", err);
+        }
+    }
+
 #if __cplusplus
 }
 #endif
\ No newline at end of file
@@ -26,6 +26,12 @@ extern float declinationAngle;
 // misc
 extern uint8_t rgb_brightness;
 extern uint32_t gps_baud;
+extern uint8_t gps_hz;
+extern char tle_urls[];  // TLE_URLS_LEN
+
+// gps receiver, negotiated
+extern uint32_t gps_cfg_baud;
+extern uint8_t gps_cfg_receiver;
 
 #if __cplusplus
 extern "C"
@@ -37,6 +43,8 @@ extern "C"
     void reset_orientation_calibration();
     void load_config_misc(); // led brightness
     void save_config_misc();
+    void load_config_gps();  // negotiated receiver settings
+    void save_config_gps();
 
 #if __cplusplus
 }
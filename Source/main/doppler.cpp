@@ -0,0 +1,25 @@
+#include "doppler.hpp"
+#include <math.h>
+#include "sgp4/Sgp4.h"
+
+void Doppler::range_rate(double ro[3], double vo[3], double jd, double lat, double lon, double alt, double& range, double& rate) {
+    double recef[3];
+    double vrot[3];
+    double rs[3];
+    teme2ecef(ro, jd, recef);
+    teme2ecef(vo, jd, vrot);  // rotations only, so it works for the velocity too
+    // ecef velocity: minus earth rotation x position
+    double vecef[3] = {vrot[0] + EARTH_ROTATION_RADS * recef[1], vrot[1] - EARTH_ROTATION_RADS * recef[0], vrot[2]};
+    site(lat * pi / 180.0, lon * pi / 180.0, alt / 1000.0, rs);
+    double rho[3] = {recef[0] - rs[0], recef[1] - rs[1], recef[2] - rs[2]};
+    range = sqrt(rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2]);
+    rate = range > 0 ? (rho[0] * vecef[0] + rho[1] * vecef[1] + rho[2] * vecef[2]) / range : 0;
+}
+
+int32_t Doppler::downlink_shift(uint32_t freq_hz, double rate) {
+    return (int32_t)lround(-(double)freq_hz * rate / SPEED_OF_LIGHT_KMS);
+}
+
+int32_t Doppler::uplink_shift(uint32_t freq_hz, double rate) {
+    return (int32_t)lround((double)freq_hz / (1.0 - rate / SPEED_OF_LIGHT_KMS) - freq_hz);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef DOPPLER_HPP
+#define DOPPLER_HPP
+
+#include <stdint.h>
+
+#define SPEED_OF_LIGHT_KMS 299792.458
+#define EARTH_ROTATION_RADS 7.292115e-5
+
+/*
+    Range rate of a satellite seen from a site on the ground, and the doppler shift from it.
+    The teme velocity is rotated to ecef with the same transform as the position (teme2ecef()), minus the earth's rotation, so the site has no velocity.
+*/
+class Doppler {
+   public:
+    // ro, vo: teme km, km/s from sgp4(). lat, lon in degrees, alt in meters. range in km, rate in km/s, > 0 when the satellite moves away
+    static void range_rate(double ro[3], double vo[3], double jd, double lat, double lon, double alt, double& range, double& rate);
+    static int32_t downlink_shift(uint32_t freq_hz, double rate);  // receive on freq_hz + this
+    static int32_t uplink_shift(uint32_t freq_hz, double rate);    // transmit on freq_hz + this, so the satellite receives freq_hz
+};
+
+#endif  // DOPPLER_HPP
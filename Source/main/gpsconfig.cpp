@@ -0,0 +1,272 @@
+#include "gpsconfig.hpp"
+#include <stdio.h>
+#include <string.h>
+
+void GpsConfig::start(uint32_t now, uint32_t baud, uint32_t last_baud, GpsReceiver last_receiver, uint8_t hz) {
+    state = GpsCfgState_IDLE;
+    if (hz == 0) return;
+    hz_wanted = hz > GPSCFG_HZ_MAX ? GPSCFG_HZ_MAX : hz;
+    baud_cfg = baud;
+    baud_last = last_baud;
+    receiver_last = last_receiver < GpsReceiver_MAX ? last_receiver : GpsReceiver_UNKNOWN;
+    receiver = GpsReceiver_UNKNOWN;
+    detected = GpsReceiver_UNKNOWN;
+    hz_now = 1;
+    // the last negotiated first, it is still set if only the esp restarted
+    const uint32_t common[] = {last_baud, baud, 9600, 38400, 115200, 57600, 19200, 4800};
+    candidate_count = 0;
+    for (uint32_t b : common) {
+        bool dup = b == 0;
+        for (uint8_t i = 0; i < candidate_count && !dup; ++i) dup = candidates[i] == b;
+        if (!dup) candidates[candidate_count++] = b;
+    }
+    attempt = 0;
+    listen_next(now);
+}
+
+void GpsConfig::listen_next(uint32_t now) {
+    if (attempt >= candidate_count) {
+        baud_now = baud_cfg;
+        set_baud(baud_now);
+        goto_state(GpsCfgState_FAILED, now);
+        return;
+    }
+    baud_now = candidates[attempt++];
+    set_baud(baud_now);
+    goto_state(GpsCfgState_LISTEN, now);
+}
+
+void GpsConfig::goto_state(GpsCfgState s, uint32_t now) {
+    state = s;
+    state_time = now;
+    count_start = s == GpsCfgState_MEASURE ? updates.load() : valid.load();
+}
+
+void GpsConfig::start_rate(uint32_t now) {
+    uint8_t cap = max_hz(baud_now);
+    hz_trying = hz_wanted > cap ? cap : hz_wanted;
+    send_rate(hz_trying);
+    goto_state(GpsCfgState_SETTLE, now);
+}
+
+void GpsConfig::step(uint32_t now) {
+    uint32_t elapsed = now - state_time;
+    uint32_t got = valid.load() - count_start;
+    switch (state) {
+        case GpsCfgState_LISTEN:
+            if (got >= 2) {
+                attempt = 1;
+                send_probes();
+                goto_state(GpsCfgState_DETECT, now);
+            } else if (elapsed > GPSCFG_LISTEN_MS) {
+                listen_next(now);
+            }
+            break;
+        case GpsCfgState_DETECT:
+            if (detected.load() == GpsReceiver_UNKNOWN && elapsed <= GPSCFG_PROBE_MS) break;
+            if (detected.load() == GpsReceiver_UNKNOWN && attempt < GPSCFG_PROBES) {
+                attempt++;
+                send_probes();
+                goto_state(GpsCfgState_DETECT, now);
+                break;
+            }
+            receiver = (GpsReceiver)detected.load();
+            if (receiver == GpsReceiver_UNKNOWN && baud_now == baud_last) receiver = receiver_last;  // it may not answer at a high rate, but it was configured before
+            if (receiver == GpsReceiver_UNKNOWN) {
+                goto_state(GpsCfgState_DONE, now);  // plain nmea receiver, only the baud rate was found
+            } else if (max_hz(baud_now) < hz_wanted && baud_now != GPSCFG_BAUD) {
+                baud_old = baud_now;
+                send_baud(GPSCFG_BAUD);
+                goto_state(GpsCfgState_BAUD_SWITCH, now);
+            } else {
+                start_rate(now);
+            }
+            break;
+        case GpsCfgState_BAUD_SWITCH:
+            if (elapsed >= GPSCFG_BAUD_SWITCH_MS) {
+                baud_now = GPSCFG_BAUD;
+                set_baud(baud_now);
+                goto_state(GpsCfgState_BAUD_CHECK, now);
+            }
+            break;
+        case GpsCfgState_BAUD_CHECK:
+            if (got >= 2) {
+                start_rate(now);
+            } else if (elapsed > GPSCFG_LISTEN_MS) {
+                // didn't switch, stay on the old one with a lower rate
+                baud_now = baud_old;
+                set_baud(baud_now);
+                start_rate(now);
+            }
+            break;
+        case GpsCfgState_SETTLE:
+            if (elapsed >= GPSCFG_SETTLE_MS) goto_state(GpsCfgState_MEASURE, now);
+            break;
+        case GpsCfgState_MEASURE: {
+            if (elapsed < GPSCFG_MEASURE_MS) break;
+            uint32_t fixes = updates.load() - count_start;
+            if (fixes * 1000 * 4 >= (uint32_t)hz_trying * elapsed * 3) {
+                hz_now = hz_trying;
+                goto_state(GpsCfgState_DONE, now);
+            } else if (hz_trying > 1) {
+                hz_trying = hz_trying > 5 ? 5 : (hz_trying > 2 ? 2 : 1);
+                send_rate(hz_trying);
+                goto_state(GpsCfgState_SETTLE, now);
+            } else {
+                hz_now = 1;
+                goto_state(GpsCfgState_DONE, now);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GpsConfig::on_sentence(const char* line) {
+    valid++;
+    const char* s = strchr(line, '$');
+    if (!s) return;
+    GpsReceiver r = GpsReceiver_UNKNOWN;
+    if (strncmp(s, "$PUBX,", 6) == 0) {
+        r = GpsReceiver_UBLOX;
+    } else if (strncmp(s, "$PMTK", 5) == 0) {
+        r = GpsReceiver_MTK;
+    } else if (strncmp(s + 3, "TXT,", 4) == 0) {
+        // the boot banner, or the answer to PCAS06
+        if (strstr(s, "u-blox")) r = GpsReceiver_UBLOX;
+        else if (strstr(s, "SW=") || strstr(s, "CASIC") || strstr(s, "URANUS")) r = GpsReceiver_CASIC;
+        else if (strstr(s, "MTK") || strstr(s, "MediaTek")) r = GpsReceiver_MTK;
+    }
+    if (r != GpsReceiver_UNKNOWN) detected = r;
+}
+
+// bytes per second: ~150 for GGA + RMC per fix, ~1000 for GSA + GSV once a second with 4 systems. 80% of the line is used
+uint8_t GpsConfig::max_hz(uint32_t baud) {
+    int32_t hz = ((int32_t)(baud * 2 / 25) - 1000) / 150;
+    if (hz < 1) return 1;
+    return hz > GPSCFG_HZ_MAX ? GPSCFG_HZ_MAX : (uint8_t)hz;
+}
+
+void GpsConfig::send_probes() {
+    send_nmea("PUBX,00");   // u-blox: position, PUBX,00
+    send_nmea("PMTK605");   // mtk: firmware, PMTK705
+    send_nmea("PCAS06,0");  // casic: firmware, TXT with SW=
+}
+
+void GpsConfig::send_baud(uint32_t baud) {
+    char buff[48];
+    switch (receiver) {
+        case GpsReceiver_UBLOX: {
+            snprintf(buff, sizeof(buff), "PUBX,41,1,0007,0003,%lu,0", (unsigned long)baud);
+            send_nmea(buff);
+            // m9 / m10 don't know PUBX,41. CFG-VALSET, ram layer, CFG-UART1-BAUDRATE
+            uint8_t valset[12] = {0, 0x01, 0, 0, 0x01, 0x00, 0x52, 0x40};
+            memcpy(valset + 8, &baud, 4);
+            send_ubx(0x06, 0x8a, valset, sizeof(valset));
+            break;
+        }
+        case GpsReceiver_MTK:
+            snprintf(buff, sizeof(buff), "PMTK251,%lu", (unsigned long)baud);
+            send_nmea(buff);
+            break;
+        case GpsReceiver_CASIC: {
+            const uint32_t rates[] = {4800, 9600, 19200, 38400, 57600, 115200};
+            for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) {
+                if (rates[i] != baud) continue;
+                snprintf(buff, sizeof(buff), "PCAS01,%u", i);
+                send_nmea(buff);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// GGA and RMC with every fix, GSA and GSV about once a second, the rest off
+void GpsConfig::send_rate(uint8_t hz) {
+    char buff[64];
+    uint16_t ms = 1000 / hz;
+    switch (receiver) {
+        case GpsReceiver_UBLOX: {
+            const char* off[] = {"GLL", "VTG", "ZDA", "GST", "GRS", "GBS"};
+            for (const char* msg : off) {
+                snprintf(buff, sizeof(buff), "PUBX,40,%s,0,0,0,0,0,0", msg);
+                send_nmea(buff);
+            }
+            snprintf(buff, sizeof(buff), "PUBX,40,GSA,0,%u,0,%u,0,0", hz, hz);
+            send_nmea(buff);
+            snprintf(buff, sizeof(buff), "PUBX,40,GSV,0,%u,0,%u,0,0", hz, hz);
+            send_nmea(buff);
+            send_nmea("PUBX,40,GGA,0,1,0,1,0,0");
+            send_nmea("PUBX,40,RMC,0,1,0,1,0,0");
+            // CFG-RATE: meas ms, nav 1, time ref utc. and CFG-VALSET CFG-RATE-MEAS for m9 / m10
+            uint8_t rate[6] = {(uint8_t)(ms & 0xff), (uint8_t)(ms >> 8), 1, 0, 0, 0};
+            send_ubx(0x06, 0x08, rate, sizeof(rate));
+            uint8_t valset[10] = {0, 0x01, 0, 0, 0x01, 0x00, 0x21, 0x30, (uint8_t)(ms & 0xff), (uint8_t)(ms >> 8)};
+            send_ubx(0x06, 0x8a, valset, sizeof(valset));
+            break;
+        }
+        case GpsReceiver_MTK: {
+            uint8_t every = hz > 5 ? 5 : hz;  // 5 is the max divider
+            snprintf(buff, sizeof(buff), "PMTK314,0,1,0,1,%u,%u,0,0,0,0,0,0,0,0,0,0,0,0,0", every, every);
+            send_nmea(buff);
+            snprintf(buff, sizeof(buff), "PMTK220,%u", ms);
+            send_nmea(buff);
+            snprintf(buff, sizeof(buff), "PMTK300,%u,0,0,0,0", ms);  // the fix interval, older firmwares
+            send_nmea(buff);
+            break;
+        }
+        case GpsReceiver_CASIC:
+            snprintf(buff, sizeof(buff), "PCAS03,1,0,%u,%u,1,0,0,0,0,0,,,0,0", hz, hz);
+            send_nmea(buff);
+            snprintf(buff, sizeof(buff), "PCAS02,%u", ms);
+            send_nmea(buff);
+            break;
+        default:
+            break;
+    }
+}
+
+void GpsConfig::send_nmea(const char* body) {
+    char buff[96];
+    uint8_t crc = 0;
+    for (const char* c = body; *c; ++c) crc ^= (uint8_t)*c;
+    int len = snprintf(buff, sizeof(buff), "$%s*%02X\r\n", body, crc);
+    if (len > 0 && len < (int)sizeof(buff)) write((const uint8_t*)buff, len);
+}
+
+void GpsConfig::send_ubx(uint8_t cls, uint8_t id, const uint8_t* payload, uint16_t len) {
+    uint8_t buff[32];
+    if (len + 8 > (int)sizeof(buff)) return;
+    buff[0] = 0xb5;
+    buff[1] = 0x62;
+    buff[2] = cls;
+    buff[3] = id;
+    buff[4] = len & 0xff;
+    buff[5] = len >> 8;
+    memcpy(buff + 6, payload, len);
+    // 8 bit fletcher over class .. payload
+    uint8_t ck_a = 0, ck_b = 0;
+    for (uint16_t i = 2; i < len + 6; ++i) {
+        ck_a += buff[i];
+        ck_b += ck_a;
+    }
+    buff[len + 6] = ck_a;
+    buff[len + 7] = ck_b;
+    write(buff, len + 8);
+}
+
+const char* GpsConfig::receiver_name(GpsReceiver r) {
+    switch (r) {
+        case GpsReceiver_UBLOX:
+            return "u-blox";
+        case GpsReceiver_MTK:
+            return "MediaTek";
+        case GpsReceiver_CASIC:
+            return "CASIC";
+        default:
+            return "unknown";
+    }
+}
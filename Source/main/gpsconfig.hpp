@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef GPSCONFIG_HPP
+#define GPSCONFIG_HPP
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GPSCFG_STEP_MS 100  // step() period while it runs
+#define GPSCFG_BAUD 115200  // what the receiver is switched to
+#define GPSCFG_HZ_DEFAULT 5  // default update rate, 0 = don't touch the receiver
+#define GPSCFG_HZ_MAX 10
+#define GPSCFG_LISTEN_MS 3000  // time to get 2 valid sentences on a baud rate, the receiver may send only 1 fix a second
+#define GPSCFG_PROBE_MS 1000  // time for the answer to the detect queries
+#define GPSCFG_PROBES 3
+#define GPSCFG_SETTLE_MS 600  // after the rate commands, before the measurement
+#define GPSCFG_MEASURE_MS 3000  // update rate measurement
+#define GPSCFG_BAUD_SWITCH_MS 150  // the receiver applies the new baud rate after it acked the command
+
+typedef enum : uint8_t {
+    GpsReceiver_UNKNOWN = 0,  // not detected, or nmea only
+    GpsReceiver_UBLOX,        // PUBX, UBX
+    GpsReceiver_MTK,          // MediaTek PMTK (also the L80, PA6H, ...)
+    GpsReceiver_CASIC,        // AT6558 based, ATGM336H, PCAS
+    GpsReceiver_MAX
+} GpsReceiver;
+
+typedef enum : uint8_t {
+    GpsCfgState_IDLE,
+    GpsCfgState_LISTEN,       // looking for the receiver's baud rate
+    GpsCfgState_DETECT,       // queries sent, waiting for an answer
+    GpsCfgState_BAUD_SWITCH,  // baud command sent, waiting till the receiver switches
+    GpsCfgState_BAUD_CHECK,   // esp switched too, waiting for valid sentences
+    GpsCfgState_SETTLE,       // rate and sentence commands sent
+    GpsCfgState_MEASURE,      // counting the updates
+    GpsCfgState_DONE,
+    GpsCfgState_FAILED  // no valid data on any baud rate
+} GpsCfgState;
+
+typedef void (*gpscfg_write_fn)(const uint8_t* data, size_t len);  // send to the receiver, must not block for long
+typedef void (*gpscfg_baud_fn)(uint32_t baud);                     // change the esp uart's baud rate
+
+/*
+    Switches the gps receiver to GPSCFG_BAUD, a higher update rate, and only the sentences the parser uses (GGA, RMC every fix, GSA, GSV once a second).
+    Finds the receiver's baud rate first (last negotiated, configured, then the common ones), then detects the type by its answer to the PUBX / PMTK / PCAS queries, or its TXT banner.
+    Every step is checked by what the receiver sends after it (valid sentences on the new baud rate, the update rate), not by the acks, so it works the same for all types. A step that fails falls back: old baud rate, lower update rate.
+    The receiver's own flash is not written, after a power cycle it starts from its defaults and this runs again on the next boot.
+    step() runs on the main loop, on_update() / on_sentence() on the gps task. The uart and the clock are passed in, so it has no esp dependency.
+*/
+class GpsConfig {
+   public:
+    GpsConfig(gpscfg_write_fn write_fn, gpscfg_baud_fn baud_fn)
+        : write(write_fn), set_baud(baud_fn) {}
+
+    // baud: the configured (receiver's default), last_*: the last negotiated from nvs (0 if none), hz: wanted update rate
+    void start(uint32_t now, uint32_t baud, uint32_t last_baud, GpsReceiver last_receiver, uint8_t hz);
+    void step(uint32_t now);  // main loop, every GPSCFG_STEP_MS till finished()
+    bool finished() const { return state == GpsCfgState_DONE || state == GpsCfgState_FAILED || state == GpsCfgState_IDLE; }
+
+    // gps task
+    void on_update() {
+        updates++;
+        valid++;
+    }
+    void on_sentence(const char* line);  // statements the parser doesn't know (proprietary, TXT), crc is checked already
+
+    // results, valid when finished()
+    GpsCfgState get_state() const { return state; }
+    GpsReceiver get_receiver() const { return receiver; }
+    uint32_t get_baud() const { return baud_now; }
+    uint8_t get_hz() const { return hz_now; }
+    static const char* receiver_name(GpsReceiver r);
+
+   private:
+    void listen_next(uint32_t now);
+    void start_rate(uint32_t now);
+    void send_probes();
+    void send_baud(uint32_t baud);
+    void send_rate(uint8_t hz);
+    void send_nmea(const char* body);  // adds the $, the checksum and the crlf
+    void send_ubx(uint8_t cls, uint8_t id, const uint8_t* payload, uint16_t len);
+    void goto_state(GpsCfgState s, uint32_t now);
+    static uint8_t max_hz(uint32_t baud);
+
+    gpscfg_write_fn write;
+    gpscfg_baud_fn set_baud;
+    GpsCfgState state = GpsCfgState_IDLE;
+    uint32_t state_time = 0;
+    uint32_t count_start = 0;  // valid or updates at state_time
+    uint8_t attempt = 0;       // listen candidate or probe count
+    uint32_t candidates[8] = {};
+    uint8_t candidate_count = 0;
+    uint32_t baud_cfg = 0;   // configured, used if nothing is found
+    uint32_t baud_last = 0;  // last negotiated
+    uint32_t baud_now = 0;
+    uint32_t baud_old = 0;  // to go back if the receiver didn't switch
+    uint8_t hz_wanted = 0;
+    uint8_t hz_now = 1;
+    uint8_t hz_trying = 0;
+    GpsReceiver receiver = GpsReceiver_UNKNOWN;
+    GpsReceiver receiver_last = GpsReceiver_UNKNOWN;
+    std::atomic<uint32_t> valid{0};    // crc ok sentences
+    std::atomic<uint32_t> updates{0};  // GPS_UPDATE events
+    std::atomic<uint8_t> detected{GpsReceiver_UNKNOWN};
+};
+
+#endif  // GPSCONFIG_HPP
@@ -0,0 +1,159 @@
+#include "gpsfilter.hpp"
+#include <math.h>
+
+#define EARTH_RADIUS_M 6371000.0
+#define DEG2RAD (M_PI / 180.0)
+
+void GpsFilter::init(uint32_t now, double lat, double lon, float alt, float r, float r_up) {
+    st.lat0 = lat;
+    st.lon0 = lon;
+    st.pos[0] = 0;
+    st.pos[1] = 0;
+    st.pos[2] = alt;
+    for (uint8_t i = 0; i < 3; ++i) {
+        st.vel[i] = 0;
+        cov[i].p00 = i == 2 ? r_up : r;
+        cov[i].p01 = 0;
+        cov[i].p11 = 25.0f;  // 5 m/s
+    }
+    st.time = now;
+    st.valid = true;
+    outliers = 0;
+}
+
+void GpsFilter::time_update(uint8_t axis, float dt, float accel, float q) {
+    axis_cov_t& c = cov[axis];
+    float dt2 = dt * dt;
+    st.pos[axis] += st.vel[axis] * dt + accel * dt2 / 2;
+    st.vel[axis] += accel * dt;
+    // P = F P F' + Q, white acceleration
+    c.p00 += dt * (2 * c.p01 + dt * c.p11) + q * dt2 * dt2 / 4;
+    c.p01 += dt * c.p11 + q * dt2 * dt / 2;
+    c.p11 += q * dt2;
+}
+
+void GpsFilter::position_update(uint8_t axis, float z, float r) {
+    axis_cov_t& c = cov[axis];
+    float s = c.p00 + r;
+    float k0 = c.p00 / s;
+    float k1 = c.p01 / s;
+    float y = z - st.pos[axis];
+    st.pos[axis] += k0 * y;
+    st.vel[axis] += k1 * y;
+    c.p11 -= k1 * c.p01;
+    c.p00 *= 1 - k0;
+    c.p01 *= 1 - k0;
+}
+
+void GpsFilter::velocity_update(uint8_t axis, float z, float r) {
+    axis_cov_t& c = cov[axis];
+    float s = c.p11 + r;
+    float k0 = c.p01 / s;
+    float k1 = c.p11 / s;
+    float y = z - st.vel[axis];
+    st.pos[axis] += k0 * y;
+    st.vel[axis] += k1 * y;
+    c.p00 -= k0 * c.p01;
+    c.p01 *= 1 - k1;
+    c.p11 *= 1 - k1;
+}
+
+// moves the reference to the current position, the covariances don't change
+void GpsFilter::recenter() {
+    st.lat0 += st.pos[0] / EARTH_RADIUS_M / DEG2RAD;
+    st.lon0 += st.pos[1] / (EARTH_RADIUS_M * cos(st.lat0 * DEG2RAD)) / DEG2RAD;
+    if (st.lon0 > 180) st.lon0 -= 360;
+    if (st.lon0 < -180) st.lon0 += 360;
+    st.pos[0] = 0;
+    st.pos[1] = 0;
+}
+
+bool GpsFilter::update(uint32_t now, double lat, double lon, float alt, float hdop, float speed, float cog, float heading) {
+    if (hdop <= 0) hdop = 2;  // no GSA, no hdop in the GGA
+    float sigma = hdop * GPSFILTER_UERE_M;
+    float r = sigma * sigma;
+    float r_up = 2.25f * r;  // the vertical is ~1.5 times worse
+    if (!st.valid || now - st.time > GPSFILTER_RESET_MS) {
+        init(now, lat, lon, alt, r, r_up);
+        return true;
+    }
+    float dt = (now - st.time) / 1000.0f;
+    st.time = now;
+    speed /= 3.6f;  // m/s from here
+
+    // velocity: gps course when moving, compass direction when slow, zero when still
+    bool has_v = true;
+    float dir = 0;
+    float r_v = 0.09f;  // 0.3 m/s
+    if (speed >= GPSFILTER_MIN_COG_SPEED) {
+        dir = cog;
+    } else if (speed < GPSFILTER_STILL_SPEED) {
+        speed = 0;
+        r_v = 0.04f;
+    } else if (heading >= 0 && heading <= 360) {
+        dir = heading;
+        float sv = 0.3f + 0.3f * speed;
+        r_v = sv * sv;
+    } else {
+        has_v = false;
+    }
+    float a = dir * (float)DEG2RAD;
+    float vn = speed * cosf(a);
+    float ve = speed * sinf(a);
+
+    // the velocity is measured at the end of the step, so when moving, the change is the acceleration of the step: a turn at 1 Hz doesn't lag a whole step behind
+    float q = GPSFILTER_ACCEL * GPSFILTER_ACCEL;
+    float an = 0, ae = 0;
+    if (speed >= GPSFILTER_MIN_COG_SPEED && dt > 0) {
+        an = (vn - st.vel[0]) / dt;
+        ae = (ve - st.vel[1]) / dt;
+        q += 2 * r_v / (dt * dt);  // the noise of that acceleration
+    }
+    time_update(0, dt, an, q);
+    time_update(1, dt, ae, q);
+    time_update(2, dt, 0, GPSFILTER_ACCEL_UP * GPSFILTER_ACCEL_UP);
+
+    // the fix in the local frame
+    double dlon = lon - st.lon0;
+    if (dlon > 180) dlon -= 360;
+    if (dlon < -180) dlon += 360;
+    float n = (float)((lat - st.lat0) * DEG2RAD * EARTH_RADIUS_M);
+    float e = (float)(dlon * DEG2RAD * EARTH_RADIUS_M * cos(st.lat0 * DEG2RAD));
+
+    // gate on the horizontal innovation
+    float yn = n - st.pos[0];
+    float ye = e - st.pos[1];
+    float d2 = yn * yn / (cov[0].p00 + r) + ye * ye / (cov[1].p00 + r);
+    if (d2 > GPSFILTER_GATE * GPSFILTER_GATE) {
+        if (++outliers >= GPSFILTER_RESET_OUTLIERS) {
+            init(now, lat, lon, alt, r, r_up);
+            return true;
+        }
+        return false;  // the prediction stays
+    }
+    outliers = 0;
+    position_update(0, n, r);
+    position_update(1, e, r);
+    position_update(2, alt, r_up);
+    if (has_v) {
+        velocity_update(0, vn, r_v);
+        velocity_update(1, ve, r_v);
+    }
+    if (fabsf(st.pos[0]) > GPSFILTER_RECENTER_M || fabsf(st.pos[1]) > GPSFILTER_RECENTER_M) recenter();
+    return true;
+}
+
+bool GpsFilter::predict(const gps_filter_state_t& s, uint32_t now, double& lat, double& lon, float& alt) {
+    if (!s.valid) return false;
+    float dt = (int32_t)(now - s.time) / 1000.0f;
+    if (dt < 0) dt = 0;
+    if (dt > GPSFILTER_COAST_MS / 1000.0f) dt = GPSFILTER_COAST_MS / 1000.0f;
+    float n = s.pos[0] + s.vel[0] * dt;
+    float e = s.pos[1] + s.vel[1] * dt;
+    alt = s.pos[2] + s.vel[2] * dt;
+    lat = s.lat0 + n / EARTH_RADIUS_M / DEG2RAD;
+    lon = s.lon0 + e / (EARTH_RADIUS_M * cos(s.lat0 * DEG2RAD)) / DEG2RAD;
+    if (lon > 180) lon -= 360;
+    if (lon < -180) lon += 360;
+    return true;
+}
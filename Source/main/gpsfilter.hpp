@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef GPSFILTER_HPP
+#define GPSFILTER_HPP
+
+#include <stdint.h>
+
+#define GPSFILTER_UERE_M 4.0f             // position error (1 sigma) per hdop unit
+#define GPSFILTER_ACCEL 1.0f              // m/s^2 (1 sigma), how fast the horizontal motion can change
+#define GPSFILTER_ACCEL_UP 0.3f           // m/s^2, same for the vertical
+#define GPSFILTER_GATE 5.0f               // sigma, a fix farther from the prediction is an outlier
+#define GPSFILTER_RESET_OUTLIERS 3        // this many outliers in a row: it really jumped, restart from the fix
+#define GPSFILTER_RESET_MS 60000          // no fix for this long: restart from the next fix
+#define GPSFILTER_COAST_MS 10000          // dead reckoning with the last velocity after the last fix, then it holds
+#define GPSFILTER_MIN_COG_SPEED 1.5f      // m/s, below this the course over ground is noise, the compass is used
+#define GPSFILTER_STILL_SPEED 0.3f        // m/s, below this the velocity is measured as 0
+#define GPSFILTER_RECENTER_M 5000.0f      // the local frame follows the position, for the float precision
+
+// what the main loop needs to predict, published by the gps task
+typedef struct
+{
+    double lat0;     // reference of the local frame, degrees
+    double lon0;
+    float pos[3];    // north, east, up, m from the reference (up is the altitude)
+    float vel[3];    // m/s
+    uint32_t time;   // ms, when the state is valid
+    bool valid;
+} gps_filter_state_t;
+
+/*
+    Smooths the gps fixes, and predicts the position between them.
+    A 2 state (position, velocity) kalman filter for each axis of a local north / east / up frame around the last position, with constant velocity motion.
+    Measurements: the fix's position (error from the hdop), and the velocity from the speed and the course over ground. When the speed is too low for the course, the compass heading gives the direction, and standing still is measured as zero velocity, that is what removes most of the jitter of a parked receiver.
+    Fixes too far from the prediction are dropped, unless there are a few of them in a row.
+    Float math, ~100 ns per fix on a pc. update() on the gps task, predict() anywhere on a copy of the state.
+*/
+class GpsFilter {
+   public:
+    // now in ms. alt in m, speed in km/h (like gps_t), cog and heading in degrees, heading > 360 if there is no compass. false if the fix was dropped as an outlier
+    bool update(uint32_t now, double lat, double lon, float alt, float hdop, float speed, float cog, float heading);
+    void reset() { st.valid = false; }
+    const gps_filter_state_t& state() const { return st; }
+
+    // position at now from the state, dead reckoning for max GPSFILTER_COAST_MS after the last fix. false if there is no state
+    static bool predict(const gps_filter_state_t& s, uint32_t now, double& lat, double& lon, float& alt);
+
+   private:
+    typedef struct
+    {
+        float p00, p01, p11;  // covariance of position, velocity
+    } axis_cov_t;
+
+    void init(uint32_t now, double lat, double lon, float alt, float r, float r_up);
+    void time_update(uint8_t axis, float dt, float accel, float q);
+    void position_update(uint8_t axis, float z, float r);
+    void velocity_update(uint8_t axis, float z, float r);
+    void recenter();
+
+    gps_filter_state_t st = {};
+    axis_cov_t cov[3] = {};
+    uint8_t outliers = 0;
+};
+
+#endif  // GPSFILTER_HPP
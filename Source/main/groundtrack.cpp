@@ -0,0 +1,56 @@
+#include "groundtrack.hpp"
+#include <math.h>
+#include <string.h>
+#include "sgp4kernel.hpp"
+
+#define EARTH_RADIUS_KM 6378.137
+
+bool GroundTrack::update(elsetrec& satrec, double jd) {
+    if (satrec.no <= 0) return false;
+    bool same_sat = points > 0 && satrec.satnum == satnum && satrec.jdsatepoch == epoch;
+    if (same_sat && fabs(jd - middle) < period / 4) return false;
+    satnum = satrec.satnum;
+    epoch = satrec.jdsatepoch;
+    period = 2.0 * pi / satrec.no / 1440.0;  // no is rad / min
+    double step_sec = round(period * 86400.0 / GROUNDTRACK_POINTS_PER_ORBIT);
+    step = step_sec < GROUNDTRACK_MIN_STEP_SEC ? GROUNDTRACK_MIN_STEP_SEC : (step_sec > UINT16_MAX ? UINT16_MAX : (uint16_t)step_sec);
+    points = 2 * GROUNDTRACK_POINTS_PER_ORBIT + 1;
+    // whole seconds, so the web can compute the time of any point exactly
+    start = floor((jd - GROUNDTRACK_POINTS_PER_ORBIT * step / 86400.0) * 86400.0) / 86400.0;
+    middle = jd;
+    double r[3];
+    double v[3];
+    double recef[3];
+    double llh[3];
+    for (uint16_t i = 0; i < points; ++i) {
+        double t = start + i * step / 86400.0;
+        ground_track_point_t& p = track[i];
+        if (!Sgp4Fast::propagate(whichconst, satrec, (t - satrec.jdsatepoch) * 1440.0, r, v)) {
+            p.lat = GROUNDTRACK_NO_POINT;
+            p.lon = 0;
+            p.footprint = 0;
+            continue;
+        }
+        teme2ecef(r, t, recef);
+        ijk2ll(recef, llh);
+        p.lat = (int16_t)lround(llh[0] * 18000.0 / pi);
+        p.lon = (int16_t)lround(llh[1] * 18000.0 / pi);
+        double alt = llh[2] > 0 ? llh[2] : 0;
+        p.footprint = (uint16_t)(EARTH_RADIUS_KM * acos(EARTH_RADIUS_KM / (EARTH_RADIUS_KM + alt)));
+    }
+    return true;
+}
+
+size_t GroundTrack::encode(uint8_t* out, size_t max) const {
+    size_t len = encoded_size(points);
+    if (points == 0 || len > max) return 0;
+    ground_track_header_t header;
+    header.satnum = satnum;
+    header.start = getUnixFromJulian(start);
+    header.step = step;
+    header.count = points;
+    memcpy(out, GROUNDTRACK_PREFIX, GROUNDTRACK_PREFIX_LEN);
+    memcpy(out + GROUNDTRACK_PREFIX_LEN, &header, sizeof(header));
+    memcpy(out + GROUNDTRACK_PREFIX_LEN + sizeof(header), track, points * sizeof(ground_track_point_t));  // the esp is little endian too
+    return len;
+}
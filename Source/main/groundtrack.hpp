@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef GROUNDTRACK_HPP
+#define GROUNDTRACK_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sgp4/Sgp4.h"
+
+#define GROUNDTRACK_POINTS_PER_ORBIT 128  // the track is +-1 orbit, so 2 * this + 1 points
+#define GROUNDTRACK_MIN_STEP_SEC 10
+#define GROUNDTRACK_PREFIX "#$##$$#GOTTRACK"  // the binary websocket message starts with this, then the header and the points
+#define GROUNDTRACK_PREFIX_LEN 15
+#define GROUNDTRACK_NO_POINT INT16_MIN  // lat of a point that couldn't be propagated
+
+// websocket message after the prefix, little endian, no padding
+typedef struct
+{
+    uint32_t satnum;
+    uint32_t start;  // unix utc seconds of the first point
+    uint16_t step;   // seconds between the points
+    uint16_t count;
+} ground_track_header_t;
+
+typedef struct
+{
+    int16_t lat;         // 0.01 degrees, GROUNDTRACK_NO_POINT if there is no position
+    int16_t lon;         // 0.01 degrees, -180..180
+    uint16_t footprint;  // km, ground radius of the area where the satellite is above the horizon
+} ground_track_point_t;
+
+/*
+    Sub satellite points of the tracked satellite over +-1 orbit around now, for the web map.
+    Computed with sgp4 -> teme2ecef() -> ijk2ll() (geodetic), with the footprint from the altitude.
+    Recomputed only when the elements change or now drifts a quarter orbit from the middle of the window, so normally once every ~20 minutes for a leo.
+*/
+class GroundTrack {
+   public:
+    bool update(elsetrec& satrec, double jd);  // true if recomputed
+    void clear() { points = 0; }
+    uint16_t size() const { return points; }
+    size_t encode(uint8_t* out, size_t max) const;  // the websocket message, 0 if it doesn't fit or empty
+    static constexpr size_t encoded_size(uint16_t count) { return GROUNDTRACK_PREFIX_LEN + sizeof(ground_track_header_t) + count * sizeof(ground_track_point_t); }
+
+   private:
+    gravconsttype whichconst = wgs84;  // same as Sgp4
+    long int satnum = 0;
+    double epoch = 0;
+    double start = 0;   // jd of the first point
+    double middle = 0;  // jd of the window's middle
+    double period = 0;  // days
+    uint16_t step = 0;
+    uint16_t points = 0;
+    ground_track_point_t track[2 * GROUNDTRACK_POINTS_PER_ORBIT + 1];
+};
+
+#endif  // GROUNDTRACK_HPP
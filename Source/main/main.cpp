@@ -39,6 +39,7 @@
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 #endif
 #include <stdio.h>
+#include <sys/time.h>
 #include <string.h>
 #include <iostream>
 #include <fstream>
@@ -76,20 +77,30 @@ uint8_t gps_debug_limiter = 0;
 
 #include "ppi2c/pp_handler.hpp"
 #include "pp_commands.hpp"
+#include "sensortask.hpp"
+#include "passpredictor.hpp"
+#include "satbatch.hpp"
+#include "tledb.hpp"
+#include "tledownload.hpp"
+#include "doppler.hpp"
+#include "pointing.hpp"
+#include "satvisibility.hpp"
+#include "groundtrack.hpp"
+#include "gpsconfig.hpp"
+#include "gpsfilter.hpp"
+#include "nmealog.hpp"
+#include "scheduler.hpp"
 
 uint8_t time_method = 0;  // 0 = no valid, 1 = gps, 2 = ntp
 
 uint8_t airplane_mode = 1;      // 1 off, 2 on. 0 query
 uint8_t airplane_mode_new = 0;  // 0 no change, other: new value
 
-uint8_t shutdown_countdown = 0;  // when it is 1, init a shutdown. if >1 decrease it in every loop. if 0, ignore it. when the callback hits, set it to 10, so i2c reply can go through, and then shut down.
+uint8_t shutdown_countdown = 0;  // when it is 1, init a shutdown. if >1 decrease it in every SHUTDOWN_STEP_MS. if 0, ignore it. when the callback hits, set it to 10, so i2c reply can go through, and then shut down.
+#define SHUTDOWN_STEP_MS 15
 
 #include "sgp4/Sgp4.h"
-#include "../extapps/sattrack.h"
-#include "../extapps/wifisettings.h"
-#include "../extapps/tirapp.h"
-#include "../extapps/espmanager.h"
-#include "../extapps/espapps.h"
+#include "extapps_lz.h"  // generated at build time from ../extapps/*.h by tools/lzss_extapps.py
 
 #include "display/displaymanager.hpp"
 
@@ -102,24 +113,68 @@ PinConfig pinConfig(HW_VARIANT_SELECTED);
 
 DisplayManager displayManager;
 Sgp4 sat;
+SatBatch satBatch;  // all sats of the tle file, loaded only while the pp queries it
+TleDb tleDb;        // indexed tle store, built from TLE_TXT_PATH after every download
+#define TLE_TXT_PATH "/spiffs/mini.tle"
+#define TLE_DB_PATH "/spiffs/tle.db"
+#define NMEA_LOG_PATH0 "/spiffs/nmea0.log"  // raw gps recording, two files as a ring, see NmeaLog
+#define NMEA_LOG_PATH1 "/spiffs/nmea1.log"
 TIR tir;
 
+// main loop jobs, see Scheduler
 typedef enum TimerEntry {
-    TimerEntry_SENSORGET,
-    TimerEntry_REPORTPPGPS,
-    TimerEntry_REPORTPPORI,
-    TimerEntry_REPORTPPENVI,
-    TimerEntry_REPORTPPTIME,
     TimerEntry_REPORTWEB,
     TimerEntry_REPORTSTATES,
     TimerEntry_SATTRACK,
     TimerEntry_SATDOWN,
+    TimerEntry_I2CCONN,
+    TimerEntry_WIFI,
+    TimerEntry_DISPLAY,
+    TimerEntry_APPLOOP,
+    TimerEntry_SATBATCH,
+    TimerEntry_DOPPLER,
+    TimerEntry_POINTING,
+    TimerEntry_GPSCFG,
+    TimerEntry_NMEALOG,
     TimerEntry_MAX
 } TimerEntry;
 uint32_t time_millis = 0;  // current time in millis
-uint32_t last_millis[TimerEntry_MAX] = {0};
-// ______________________________________SEN    GPS  ORI    ENV   TIME        WEB   RGB   SAT    DOWN
-uint32_t timer_millis[TimerEntry_MAX] = {2000, 2000, 1000, 2000, 60000 * 10, 2000, 1000, 2000, 20000};
+// ______________________________________WEB   RGB   SAT    DOWN   I2C   WIFI  DISP  APP  BATCH DOPPLER POINTING                GPSCFG          NMEALOG
+uint32_t timer_millis[TimerEntry_MAX] = {2000, 1000, 2000, 20000, 1000, 1000, 1000, 500, 5000, 250, 1000 / POINTING_HZ_DEFAULT, GPSCFG_STEP_MS, NMEALOG_FLUSH_MS};
+#define SATBATCH_IDLE_MS 60000  // unload the sat batch, if the pp didn't query it for this long
+#define DOPPLER_IDLE_MS 5000    // stop the doppler job, if the pp didn't query it for this long
+#define POINTING_IDLE_MS 5000   // stop the pointing stream, if neither the pp nor the web asked for it for this long
+#define APPLOOP_RUNNING_MS 10  // app loop period while an esp app runs
+
+TaskHandle_t main_task = nullptr;
+uint32_t scheduler_now() {
+    return esp_timer_get_time() / 1000;
+}
+void scheduler_wait(uint32_t wait_ms) {
+    TickType_t ticks = (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;  // round up, so it never spins with 0 tick waits
+    ulTaskNotifyTake(pdTRUE, ticks);
+}
+Scheduler scheduler(scheduler_now, scheduler_wait);
+// the irq callbacks stamp their queries with scheduler_now(), not with time_millis (that is only refreshed when the loop wakes).
+// so a stamp can be a bit newer than the now of the running job, the difference is signed
+static inline int32_t millis_since(uint32_t now, uint32_t stamp) {
+    return (int32_t)(now - stamp);
+}
+NmeaLog nmeaLog(scheduler_now, NMEA_LOG_PATH0, NMEA_LOG_PATH1);
+char nmealog_wanted = 0;      // set by the web, see ws_request_nmealog
+bool nmealog_report = false;  // send the log state to the web, once more after it stopped
+
+// wakes the main loop, to handle the new event now, not at the next deadline. can be called from IRQ too
+void WakeMainLoop() {
+    if (!main_task) return;
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(main_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(main_task);
+    }
+}
 
 // default sensor values and declaration
 orientation_t orientation{400.0, 0.0};
@@ -129,11 +184,57 @@ uint16_t light = 0;
 ppgpssmall_t gpsdata{200, 200, 0, 0, 0, 0, {}, {}};
 ir_data_t last_rcvd_ir{UNK, 0, 0};
 
+temperature_sensor_handle_t temp_sensor = NULL;
+
+DoubleBuffer<ppgpssmall_t> gpsBuffer;  // written by the gps task, main loop copies it to gpsdata, SensorTask publishes it to the pp
+GpsFilter gpsFilter;                               // gps task only
+DoubleBuffer<gps_filter_state_t> gpsFilterBuffer;  // written by the gps task, the main loop predicts the site from it
+DoubleBuffer<gps_skyview_frame_t> skyviewBuffer;  // written by the gps task, the pp (irq) and the web report read it
+uint32_t skyview_web_seq = 0;                     // last sky view sent to the web
+uint32_t sensor_seq = 0;               // last SensorTask snapshot copied to the globals
+SensorSnapshot pp_last_snapshot = {};  // the pp irq's last consistent snapshot, served when a read was torn
+uint32_t sat_passes_seq = 0;           // last PassPredictor result sent to the web
+bool sat_passes_resend = false;        // web asked for the passes
+GroundTrack groundTrack;
+bool ground_track_resend = false;  // web asked for the ground track
+DoubleBuffer<sat_batch_list_t> satBatchList;  // published by the main loop, the pp (irq) reads it
+uint32_t sat_batch_last_query = 0;            // set by the pp irq
+bool sat_batch_wanted = false;                // pp queried it, but it is not running
+DoubleBuffer<sat_find_result_t> satFindResult;  // published by the main loop, the pp (irq) reads it
+char sat_find_prefix[SAT_FIND_PREFIX_LEN] = {0};  // set by the pp irq or the web
+bool sat_find_wanted = false;                   // pp or web asked, the main loop searches
+bool sat_find_to_web = false;  // the web asked, send the result there too
+DoubleBuffer<sat_doppler_t> satDoppler;  // published by the main loop, the pp (irq) reads it
+uint32_t doppler_downlink_hz = 0;        // set by the pp irq
+uint32_t doppler_uplink_hz = 0;
+uint32_t doppler_last_query = 0;
+bool doppler_wanted = false;  // pp queried it, but it is not running
+PointingStream pointing;
+DoubleBuffer<sat_pointing_t> satPointing;  // published by the main loop, the pp (irq) reads it
+uint8_t pointing_hz = POINTING_HZ_DEFAULT;  // set by the pp irq or the web
+uint32_t pointing_last_query = 0;           // pp
+uint32_t pointing_web_last_query = 0;       // web, it sends a keepalive while the stream is on
+bool pointing_wanted = false;               // asked, the main loop starts it or changes its rate
+uint32_t gps_seq = 0;          // last gps buffer copied to gpsdata
+uint32_t gps_fix_millis = 0;   // when it was copied, for the sub second part of the gps time
+
 bool gotAnyGps = false;
 
 bool downloadedTLE = false;
 uint16_t lastReportedMxS = 0;  // gps last reported gps time mix to see if it is changed. if not changes, it stuck (bad signal, no update), so won't update PP based on it
 uint32_t gps_baud = 9600;
+uint8_t gps_hz = GPSCFG_HZ_DEFAULT;  // wanted update rate, 0 = leave the receiver as it is
+uint32_t gps_cfg_baud = 0;          // last negotiated with the receiver, 0 = none
+uint8_t gps_cfg_receiver = GpsReceiver_UNKNOWN;
+nmea_parser_handle_t nmea_hdl = nullptr;
+void gps_config_write(const uint8_t* data, size_t len) {
+    nmea_parser_write(nmea_hdl, data, len);
+}
+void gps_config_baud(uint32_t baud) {
+    nmea_parser_set_baudrate(nmea_hdl, baud);
+}
+GpsConfig gpsConfig(gps_config_write, gps_config_baud);  // receiver setup, step() on the main loop, fed by the gps task
+char tle_urls[TLE_URLS_LEN] = TLE_URLS_DEFAULT;
 uint32_t i2c_pp_last_comm_time = 0;  // when is it connected last time (last query from pp).
 bool i2p_pp_conn_state = false;      // to save and check if i need to send a message to web
 
@@ -219,6 +320,12 @@ void update_features() {
     if (displayManager.getDisplayCount() > 0)
         chipFeatures.enableFeature(SupportedFeatures::FEAT_DISPLAY);
     chipFeatures.enableFeature(SupportedFeatures::FEAT_SHELL);
+    chipFeatures.enableFeature(SupportedFeatures::FEAT_SHELL_FRAME);
+    chipFeatures.enableFeature(SupportedFeatures::FEAT_DATA_ALL);
+    if (PPHandler::get_appCount() > 0) {
+        chipFeatures.enableFeature(SupportedFeatures::FEAT_APP_STREAM);
+        chipFeatures.enableFeature(SupportedFeatures::FEAT_APP_LZSS);
+    }
 }
 
 esp_err_t init_spiffs(void) {
@@ -270,55 +377,11 @@ esp_err_t init_spiffs(void) {
     return ret;
 }
 
-/**
- * @brief HTTP event handler to handle HTTP client events during the download.
- *
- * @param evt HTTP client event.
- * @return esp_err_t Returns ESP_OK to continue the operation, or an error code to abort.
- */
-esp_err_t http_event_handler_tledata(esp_http_client_event_t* evt) {
-    static FILE* file = NULL;
-
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (!file) {
-                // Open the file for writing when the first data chunk is received
-                file = fopen("/spiffs/mini.tle", "w");
-                if (file == NULL) {
-                    ESP_LOGE(TAG, "Failed to open file for writing");
-                    return ESP_FAIL;
-                }
-            }
-
-            // Write the data chunk to the file
-            if (fwrite(evt->data, 1, evt->data_len, file) != evt->data_len) {
-                ESP_LOGE(TAG, "File write failed!");
-                fclose(file);
-                file = NULL;
-                return ESP_FAIL;
-            }
-            break;
-
-        case HTTP_EVENT_ON_FINISH:
-            if (file) {
-                fclose(file);
-                file = NULL;
-                ESP_LOGI(TAG, "File download completed");
-            }
-            break;
-
-        case HTTP_EVENT_ERROR:
-            ESP_LOGE(TAG, "HTTP event error");
-            if (file) {
-                fclose(file);
-                file = NULL;
-            }
-            break;
-
-        default:
-            break;
-    }
-    return ESP_OK;
+// opens the tle db, builds it from the text file if it is missing, or updates it after a download
+bool open_tle_db(bool refresh) {
+    tleDb.close();
+    if (!refresh && tleDb.open(TLE_DB_PATH)) return true;
+    return TleDb::update(TLE_TXT_PATH, TLE_DB_PATH) && tleDb.open(TLE_DB_PATH);
 }
 
 esp_err_t load_satellite_tle(const std::string& sat_to_track) {
@@ -326,137 +389,109 @@ esp_err_t load_satellite_tle(const std::string& sat_to_track) {
         ESP_LOGE(TAG, "Satellite name is empty.");
         return ESP_FAIL;
     }
-    std::string l1, l2;
-    // Open the TLE file from SPIFFS
-    std::ifstream file("/spiffs/mini.tle");
-    if (!file.is_open()) {
-        ESP_LOGE(TAG, "Failed to open file: /spiffs/mini.tle");
+    if (!tleDb.is_open() && !open_tle_db(false)) {
+        ESP_LOGE(TAG, "No tle db");
         return ESP_FAIL;
     }
-
-    std::string line;
-    bool satellite_found = false;
-
-    // Read the file line by line
-    while (std::getline(file, line)) {
-        // Check if the current line starts with the satellite name
-        if (line.find(sat_to_track) == 0) {
-            ESP_LOGI(TAG, "Found satellite: %s", sat_to_track.c_str());
-
-            // Read the next two lines (the TLE data)
-            if (std::getline(file, l1) && std::getline(file, l2)) {
-                ESP_LOGI(TAG, "TLE Line 1: %s", l1.c_str());
-                ESP_LOGI(TAG, "TLE Line 2: %s", l2.c_str());
-                sat.init(sat_to_track.c_str(), (char*)l1.c_str(), (char*)l2.c_str());
-                double satjs = sat.satrec.jdsatepoch;
-                int y, m, d, h, mi;
-                double s;
-                invjday(satjs, 0, false, y, m, d, h, mi, s);
-                sattrackdata.sat_day = d;
-                sattrackdata.sat_month = m;
-                sattrackdata.sat_year = y;
-                sattrackdata.sat_hour = h;
-                satellite_found = true;
-            } else {
-                ESP_LOGE(TAG, "Failed to read TLE lines after satellite name.");
-                file.close();
-                return ESP_FAIL;
-            }
-            break;
-        }
-    }
-
-    // Close the file
-    file.close();
-
-    // Return status based on whether the satellite was found
-    if (satellite_found) {
-        return ESP_OK;
-    } else {
-        ESP_LOGE(TAG, "Satellite %s not found in TLE file.", sat_to_track.c_str());
+    tle_db_record_t rec;
+    if (!tleDb.find_name(sat_to_track.c_str(), rec)) {
+        ESP_LOGE(TAG, "Satellite %s not found in TLE db.", sat_to_track.c_str());
         return ESP_FAIL;
     }
+    ESP_LOGI(TAG, "Found satellite: %s", rec.name);
+    ESP_LOGI(TAG, "TLE Line 1: %s", rec.line1);
+    ESP_LOGI(TAG, "TLE Line 2: %s", rec.line2);
+    char line1[130];  // twoline2rv() edits the lines in place
+    char line2[130];
+    strlcpy(line1, rec.line1, sizeof(line1));
+    strlcpy(line2, rec.line2, sizeof(line2));
+    sat.init(rec.name, line1, line2);
+    double satjs = sat.satrec.jdsatepoch;
+    int y, m, d, h, mi;
+    double s;
+    invjday(satjs, 0, false, y, m, d, h, mi, s);
+    sattrackdata.sat_day = d;
+    sattrackdata.sat_month = m;
+    sattrackdata.sat_year = y;
+    sattrackdata.sat_hour = h;
+    return ESP_OK;
 }
 
 /**
- * @brief Downloads the file from the given URL and saves it to SPIFFS.
+ * @brief Downloads the tle file from the configured sources to SPIFFS, if there is a newer one, and updates the tle db.
  *
- * @return esp_err_t Returns ESP_OK if the download and save were successful, or an error code otherwise.
+ * @return esp_err_t Returns ESP_OK if the file is up to date, or an error code otherwise.
  */
 esp_err_t download_tle_file_to_spiffs(void) {
-    esp_err_t ret;
-
-    // Get the file information
-    struct stat file_stat;
-    if (stat("/spiffs/mini.tle", &file_stat) == 0) {
-        // Get the current time
-        time_t now;
-        time(&now);
-
-        // Check if the file modification time is within the last 2 hours
-        if (difftime(now, file_stat.st_mtime) <= 2 * 3600) {
-            ESP_LOGI(TAG, "File /spiffs/mini.tle is not older than 2 hours.");
-            downloadedTLE = true;
-            return ESP_OK;
-        } else {
-            ESP_LOGI(TAG, "File /spiffs/mini.tle is older than 2 hours.");
-        }
-    } else {
-        ESP_LOGE(TAG, "Failed to get file information for /spiffs/mini.tle");
-    }
-
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-    // Configure the HTTP client
-    esp_http_client_config_t config = {
-        .url = "http://creativo.hu/sattrack/mini.tle",
-        .event_handler = http_event_handler_tledata,
-    };
-#pragma GCC diagnostic pop
-
-    ESP_LOGI(TAG, "HTTP GET request started");
-    // Initialize the HTTP client
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-
-    // Perform the HTTP GET request to download the file
-    ret = esp_http_client_perform(client);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "HTTP GET request completed");
-        downloadedTLE = true;
+    TleDownloadResult res = TleDownload::run(tle_urls, TLE_TXT_PATH);
+    if (res == TleDownload_FAILED) return ESP_FAIL;  // retried at the next satdown, resumed where it stopped
+    downloadedTLE = true;
+    if (res == TleDownload_UPDATED) {
+        open_tle_db(true);
         sat_to_track_new = sat_to_track;
-    } else {
-        ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(ret));
+        if (satBatch.size() > 0) satBatch.load(tleDb);
     }
-
-    // Clean up
-    esp_http_client_cleanup(client);
-
-    return ret;
+    return ESP_OK;
 }
 
 static void gps_event_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
     gps_t* gps = NULL;
     char buff[400] = {0};
     switch (event_id) {
-        case GPS_UPDATE:
-            gotAnyGps = true;
+        case GPS_UPDATE: {
             gps = (gps_t*)event_data;
-            gpsdata.altitude = gps->altitude;
-            gpsdata.date.day = gps->date.day;
-            gpsdata.date.month = gps->date.month;
-            gpsdata.date.year = gps->date.year;
-            gpsdata.tim.hour = gps->tim.hour;
-            gpsdata.tim.minute = gps->tim.minute;
-            gpsdata.tim.second = gps->tim.second;
-            gpsdata.latitude = gps->latitude;
-            gpsdata.longitude = gps->longitude;
-            gpsdata.speed = gps->speed;
-            gpsdata.sats_in_use = gps->sats_in_use;
-            gpsdata.sats_in_view = gps->sats_in_view;
-
+            ppgpssmall_t fix = {};
+            fix.altitude = gps->altitude;
+            fix.date.day = gps->date.day;
+            fix.date.month = gps->date.month;
+            fix.date.year = gps->date.year;
+            fix.tim.hour = gps->tim.hour;
+            fix.tim.minute = gps->tim.minute;
+            fix.tim.second = gps->tim.second;
+            fix.latitude = gps->latitude;
+            fix.longitude = gps->longitude;
+            if (gps->fix != GPS_FIX_INVALID) {
+                // smoothed, the compass gives the direction when it is too slow for the course
+                SensorSnapshot snap;
+                float heading = SensorTask::read(snap) ? snap.orientation.angle : 400;
+                uint32_t now = scheduler_now();
+                gpsFilter.update(now, gps->latitude, gps->longitude, gps->altitude, gps->dop_h, gps->speed, gps->cog, heading);
+                gpsFilterBuffer.publish(gpsFilter.state());
+                double lat, lon;
+                GpsFilter::predict(gpsFilter.state(), now, lat, lon, fix.altitude);
+                fix.latitude = lat;
+                fix.longitude = lon;
+            }
+            fix.speed = gps->speed;
+            fix.sats_in_use = gps->sats_in_use;
+            fix.sats_in_view = gps->sats_in_view;
+            gpsBuffer.publish(fix);  // main loop picks it up, so gpsdata is never written from this task
+            gotAnyGps = true;
+            gpsConfig.on_update();
+            SensorTask::gps_updated();
+            WakeMainLoop();
+            break;
+        }
+        case GPS_SKYVIEW: {
+            const gps_skyview_t* sky = (const gps_skyview_t*)event_data;  // only count sats are valid
+            gps_skyview_frame_t frame = {};
+            for (uint8_t i = 0; i < sky->count && frame.count < PP_SKYVIEW_MAX; ++i) {
+                const gps_satellite_t& s = sky->sats[i];
+                gps_sky_sat_t& out = frame.sats[frame.count++];
+                out.num = s.num;
+                out.flags = (s.system & 0x07) | (s.in_use ? 0x80 : 0);
+                out.elevation = s.elevation;
+                out.azimuth = s.azimuth / 2;
+                out.snr = s.snr;
+                if (s.in_use) frame.in_use++;
+            }
+            frame.sequence = skyviewBuffer.sequence() + 1;
+            skyviewBuffer.publish(frame);
             break;
+        }
         case GPS_UNKNOWN:
             // ESP_LOGW(TAG, "Unknown statement:%s", (char*)event_data);
+            gpsConfig.on_sentence((const char*)event_data);  // receiver answers
             break;
         case GPS_DEBUG:
             // passing debug dat to web. needs rate limit, so wifi won't die.
@@ -480,6 +515,479 @@ void time_sync_notification_cb(struct timeval* tv) {
         time_method = 2;
 }
 
+void ws_request_sat_find(const char* prefix) {
+    strlcpy(sat_find_prefix, prefix, sizeof(sat_find_prefix));
+    sat_find_to_web = true;
+    sat_find_wanted = true;
+    WakeMainLoop();
+}
+
+// prefix search in the tle db index for the pp and the web, no record reads
+void find_satellites() {
+    sat_find_result_t res{};
+    strlcpy(res.prefix, sat_find_prefix, sizeof(res.prefix));
+    if (tleDb.is_open() || open_tle_db(false)) {
+        res.count = tleDb.find_prefix(res.prefix, res.names, PP_SAT_FIND_MAX);
+    }
+    res.done = 1;
+    satFindResult.publish(res);
+    if (!sat_find_to_web || PPShellComm::getInCommand()) return;
+    sat_find_to_web = false;
+    char buff[300];
+    size_t len = snprintf(buff, sizeof(buff), "#$##$$#GOTSATFIND{\"names\":[");
+    for (uint8_t i = 0; i < res.count && len < sizeof(buff); ++i) {
+        len += snprintf(buff + len, sizeof(buff) - len, "%s\"%s\"", i == 0 ? "" : ",", res.names[i]);
+    }
+    if (len < sizeof(buff)) len += snprintf(buff + len, sizeof(buff) - len, "]}\r\n");
+    if (len >= sizeof(buff)) return;
+    ws_sendall((uint8_t*)buff, len, true);
+}
+
+void ws_request_nmealog(char cmd) {
+    nmealog_wanted = cmd;
+    WakeMainLoop();
+}
+
+uint8_t nmealog_files(const char* out[2]) {
+    return nmeaLog.files(out);
+}
+
+// 'R' records, 'P' replays at the recorded pace, 'F' replays as fast as the parser takes it, 'S' stops both
+void handle_nmealog(char cmd) {
+    nmealog_report = true;
+    if (cmd == 'S') {
+        if (nmeaLog.recording()) nmeaLog.stop();
+        nmeaLog.replay_stop();  // the parser task ends it
+        return;
+    }
+    if (!nmea_hdl) return;
+    if (cmd == 'R') {
+        if (!nmeaLog.start()) {
+            ESP_LOGW(TAG, "NMEA log: can't start the recording");
+            return;
+        }
+    } else if (cmd == 'P' || cmd == 'F') {
+        if (!nmeaLog.replay_start(cmd == 'P')) {
+            ESP_LOGW(TAG, "NMEA log: nothing to replay");
+            return;
+        }
+        if (nmea_parser_set_source(nmea_hdl, NmeaLog::source, &nmeaLog) != ESP_OK) {
+            nmeaLog.replay_cancel();  // the last replay is still ending
+            return;
+        }
+    }
+    scheduler.set_period(TimerEntry_NMEALOG, timer_millis[TimerEntry_NMEALOG]);
+}
+
+// events from other tasks / irq. runs on every wake of the main loop
+void handle_events() {
+    // a torn copy (the writer published twice while copying) is dropped, and read again on the next wake
+    if (gotAnyGps && gpsBuffer.sequence() != gps_seq) {
+        uint32_t seq = gpsBuffer.sequence();
+        ppgpssmall_t fix;
+        if (gpsBuffer.read(fix)) {
+            gps_seq = seq;
+            gpsdata = fix;
+            gps_fix_millis = time_millis;
+        }
+    }
+    SensorSnapshot snap;
+    uint32_t seq = SensorTask::sequence();
+    if (seq != sensor_seq && SensorTask::read(snap)) {
+        // the display and the web report use the globals
+        sensor_seq = seq;
+        orientation = snap.orientation;
+        environment = snap.environment;
+        light = snap.light;
+        temperatureEsp = snap.temperatureEsp;
+    }
+    if (sat_to_track_new != "") {
+        sat_to_track = sat_to_track_new;
+        sat_data_loaded = (load_satellite_tle(sat_to_track) == ESP_OK);
+        sattrackdata.elevation = 0;
+        sattrackdata.azimuth = 0;
+        scheduler.trigger(TimerEntry_SATTRACK);  // force update
+        sat_to_track_new = "";
+    }
+
+    if (airplane_mode_new != 0) {
+        airplane_mode = airplane_mode_new;
+        airplane_mode_new = 0;
+        WifiM::set_airplane_mode(airplane_mode);
+    }
+
+    if (wifi_config_changed) {
+        wifi_config_changed = false;
+        ESP_LOGI(TAG, "Saving new wifi config, and applying");
+        WifiM::save_config_wifi();
+        WifiM::config_wifi_apsta();
+    }
+
+    if (sat_batch_wanted) {
+        sat_batch_wanted = false;
+        if (scheduler.get_period(TimerEntry_SATBATCH) == 0) {
+            if (satBatch.size() == 0) satBatch.load(tleDb);
+            scheduler.set_period(TimerEntry_SATBATCH, timer_millis[TimerEntry_SATBATCH]);
+            scheduler.trigger(TimerEntry_SATBATCH);
+        }
+    }
+
+    if (doppler_wanted) {
+        doppler_wanted = false;
+        if (scheduler.get_period(TimerEntry_DOPPLER) == 0) {
+            scheduler.set_period(TimerEntry_DOPPLER, timer_millis[TimerEntry_DOPPLER]);
+            scheduler.trigger(TimerEntry_DOPPLER);
+        }
+    }
+
+    if (pointing_wanted) {
+        pointing_wanted = false;
+        uint32_t period = 1000 / pointing_hz;
+        if (scheduler.get_period(TimerEntry_POINTING) != period) {
+            if (scheduler.get_period(TimerEntry_POINTING) == 0) pointing.reset();
+            scheduler.set_period(TimerEntry_POINTING, period);
+            scheduler.trigger(TimerEntry_POINTING);
+        }
+    }
+    if (sat_find_wanted) {
+        sat_find_wanted = false;
+        find_satellites();
+    }
+
+    if (nmealog_wanted) {
+        char cmd = nmealog_wanted;
+        nmealog_wanted = 0;
+        handle_nmealog(cmd);
+    }
+
+    uint32_t app_period = AppManager::getCurrentApp() ? APPLOOP_RUNNING_MS : timer_millis[TimerEntry_APPLOOP];
+    if (scheduler.get_period(TimerEntry_APPLOOP) != app_period) {
+        scheduler.set_period(TimerEntry_APPLOOP, app_period);
+        scheduler.trigger(TimerEntry_APPLOOP);
+    }
+
+    if (shutdown_countdown > 1) {
+        // let the i2c reply go through, then shut down
+        vTaskDelay(pdMS_TO_TICKS(SHUTDOWN_STEP_MS * (shutdown_countdown - 1)));
+        shutdown_countdown = 1;
+        shutdownme();
+    }
+}
+
+void ws_request_sat_passes() {
+    sat_passes_resend = true;
+    ground_track_resend = true;
+}
+
+// sends the ground track of the tracked sat to the web as a binary message. main loop only
+void ws_send_ground_track() {
+    if (PPShellComm::getInCommand()) return;  // retry on the next sattrack
+    static uint8_t buff[GroundTrack::encoded_size(2 * GROUNDTRACK_POINTS_PER_ORBIT + 1)];
+    size_t len = groundTrack.encode(buff, sizeof(buff));
+    ground_track_resend = false;
+    if (len == 0) return;
+    ws_sendall(buff, len, true);
+}
+
+// sends the predicted passes of the tracked sat to the web. main loop only
+void ws_send_sat_passes() {
+    if (PPShellComm::getInCommand()) return;  // retry on the next sattrack
+    static char buff[1100];
+    sat_passes_t passes;
+    uint32_t seq = PassPredictor::sequence();
+    if (!PassPredictor::read(passes)) return;  // torn, retry on the next sattrack
+    sat_passes_resend = false;
+    sat_passes_seq = seq;
+    size_t len = snprintf(buff, sizeof(buff), "#$##$$#GOTPASSES{\"computing\":%d,\"passes\":[", passes.computing);
+    for (uint8_t i = 0; i < passes.count && len < sizeof(buff); ++i) {
+        sat_pass_t& p = passes.passes[i];
+        len += snprintf(buff + len, sizeof(buff) - len, "%s{\"aos\":%" PRIu32 ",\"los\":%" PRIu32 ",\"tmax\":%" PRIu32 ",\"maxel\":%.01f,\"azaos\":%.01f,\"azmax\":%.01f,\"azlos\":%.01f}",
+                        i == 0 ? "" : ",", p.aos, p.los, p.max_time, p.max_elevation, p.aos_azimuth, p.max_azimuth, p.los_azimuth);
+    }
+    if (len < sizeof(buff)) len += snprintf(buff + len, sizeof(buff) - len, "]}\r\n");
+    if (len >= sizeof(buff)) return;
+    ws_sendall((uint8_t*)buff, len, true);
+}
+
+// REPORT ALL SENSOR DATA TO WEB
+void job_reportweb(uint32_t now) {
+    if (PPShellComm::getInCommand()) return;
+    char buff[420] = {0};
+    snprintf(buff, sizeof(buff),
+             "#$##$$#GOTSENS"
+             "{\"gps\":{\"y\":%d,\"m\":%d,\"d\":%d,\"h\":%d,\"mi\":%d,\"s\":%d,"
+             "\"siu\":%d,\"siv\":%d,\"lat\":%.06f,\"lon\":%.06f,\"alt\":%.02f,\"speed\":%f},"
+             "\"ori\":{\"head\":%.01f, \"tilt\":%.01f },"
+             "\"env\":{\"tempesp\":%.01f,\"temp\":%.01f,\"humi\":%.01f, \"press\":%.01f, \"light\":%d },"
+             "\"sat\":{\"az\":%.01f,\"el\":%.01f,\"vis\":%d,\"lit\":%d,\"sunaz\":%.01f,\"sunel\":%.01f}"
+             "}\r\n",
+             gpsdata.date.year + YEAR_BASE, gpsdata.date.month, gpsdata.date.day, gpsdata.tim.hour + TIME_ZONE, gpsdata.tim.minute, gpsdata.tim.second,
+             gpsdata.sats_in_use, gpsdata.sats_in_view, gpsdata.latitude, gpsdata.longitude, gpsdata.altitude, gpsdata.speed,
+             orientation.angle, orientation.tilt,
+             temperatureEsp, environment.temperature, environment.humidity, environment.pressure, light,
+             sattrackdata.azimuth, sattrackdata.elevation, sattrackdata.visibility, sattrackdata.sunlit, sattrackdata.sun_azimuth, sattrackdata.sun_elevation);
+    ws_sendall((uint8_t*)buff, strlen(buff), true);
+    gps_skyview_frame_t frame;
+    if (skyviewBuffer.sequence() != skyview_web_seq && skyviewBuffer.read(frame)) {  // a torn copy goes with the next report
+        // binary: prefix, then the frame with only the valid sats
+        static uint8_t sky[17 + sizeof(gps_skyview_frame_t)];
+        skyview_web_seq = frame.sequence;
+        size_t len = offsetof(gps_skyview_frame_t, sats) + frame.count * sizeof(gps_sky_sat_t);
+        memcpy(sky, "#$##$$#GOTSKYVIEW", 17);
+        memcpy(sky + 17, &frame, len);
+        ws_sendall(sky, 17 + len, true);
+    }
+    if (nmealog_report) {
+        nmealog_report = nmeaLog.recording() || nmeaLog.replaying();  // once more after it stopped
+        snprintf(buff, sizeof(buff), "#$##$$#GOTNMEALOG%d,%d,%" PRIu32 ",%" PRIu32 "\r\n", nmeaLog.recording(), nmeaLog.replaying(), nmeaLog.get_size(), nmeaLog.get_dropped());
+        ws_sendall((uint8_t*)buff, strlen(buff), true);
+    }
+}
+
+void job_reportstates(uint32_t now) {
+    LedFeedback::rgb_set_by_status(PPShellComm::getAnyConnected() | i2p_pp_conn_state, WifiM::getWifiStaStatus(), WifiM::getWifiApClientNum() > 0, gpsdata.latitude != 200 && gpsdata.longitude != 200 && gpsdata.sats_in_use > 2);
+    displayManager.setEspState(WifiM::getWifiStaStatus(), WifiM::getWifiApClientNum() > 0, gpsdata.latitude != 200 && gpsdata.longitude != 200 && gpsdata.sats_in_use > 2, PPShellComm::getAnyConnected() | i2p_pp_conn_state);
+}
+
+void job_sattrack(uint32_t now) {
+    // check for new gps data
+    // ESP_LOGI(TAG, "qgps: %f  %f", sattrackdata.lat, sattrackdata.lon);
+    if (sat_data_loaded) {
+        float alt = gpsdata.altitude;
+        gps_filter_state_t gfs;
+        double lat, lon;
+        if (gpsFilterBuffer.read(gfs) && GpsFilter::predict(gfs, now, lat, lon, alt)) {
+            sattrackdata.lat = lat;  // where it is now, not at the last fix
+            sattrackdata.lon = lon;
+        } else if (gpsdata.latitude != 200 || gpsdata.longitude != 200) {
+            sattrackdata.lat = gpsdata.latitude;
+            sattrackdata.lon = gpsdata.longitude;
+        }
+        // if only old, or etc use that nvm
+        if (sattrackdata.lat != 0 || sattrackdata.lon != 0) {
+            struct tm timeinfo;
+            sat.site(sattrackdata.lat, sattrackdata.lon, alt);
+            double jd = 0;
+            if (gpsdata.date.year < 44 && gpsdata.date.year >= 23)  // has valid gps time
+            {
+                time_method = 1;
+                jday(gpsdata.date.year + YEAR_BASE, gpsdata.date.month, gpsdata.date.day, gpsdata.tim.hour, gpsdata.tim.minute, gpsdata.tim.second, 0, false, jd);
+            } else {
+                time_t now;
+                time(&now);
+                localtime_r(&now, &timeinfo);
+                int year = timeinfo.tm_year + 1900;  // Az év 1900-tól számítva
+                int month = timeinfo.tm_mon + 1;     // A hónap 0-11, ezért +1
+                int day = timeinfo.tm_mday;
+
+                int hour = timeinfo.tm_hour;
+                int minute = timeinfo.tm_min;
+                int second = timeinfo.tm_sec;
+                jday(year, month, day, hour, minute, second, 0, false, jd);
+            }
+            sat.findsat(jd);
+            if (time_method == 0) {
+                sattrackdata.azimuth = 0;
+                sattrackdata.elevation = 0;
+                SatVisibility::fill(nullptr, sattrackdata);
+            } else {
+                sattrackdata.azimuth = sat.satAz;
+                sattrackdata.elevation = sat.satEl;
+                SatVisibility::fill(&sat, sattrackdata);
+                PassPredictor::update(sat, sattrackdata.lat, sattrackdata.lon, gpsdata.altitude, jd);  // only with valid time
+                if (groundTrack.update(sat.satrec, jd) || ground_track_resend) ws_send_ground_track();
+            }
+            if (time_method == 1) {
+                sattrackdata.day = gpsdata.date.day;
+                sattrackdata.month = gpsdata.date.month;
+                sattrackdata.year = gpsdata.date.year;
+                sattrackdata.hour = gpsdata.tim.hour;
+                sattrackdata.minute = gpsdata.tim.minute;
+                sattrackdata.second = gpsdata.tim.second;
+            } else {
+                sattrackdata.day = timeinfo.tm_mday;
+                sattrackdata.month = timeinfo.tm_mon + 1;
+                sattrackdata.year = timeinfo.tm_year + 1900;
+                sattrackdata.hour = timeinfo.tm_hour;
+                sattrackdata.minute = timeinfo.tm_min;
+                sattrackdata.second = timeinfo.tm_sec;
+            }
+            sattrackdata.time_method = time_method;
+        }
+        displayManager.setSatTrackDataSource(&sattrackdata, &sat_to_track);  // to update screen is that screen is selected
+    } else {
+        sattrackdata.sat_day = 0;
+        sattrackdata.sat_month = 0;
+        sattrackdata.sat_year = 0;
+        sattrackdata.sat_hour = 0;
+        sattrackdata.azimuth = 0;
+        sattrackdata.elevation = 0;
+        SatVisibility::fill(nullptr, sattrackdata);
+        PassPredictor::clear();
+        groundTrack.clear();
+    }
+    if (PassPredictor::sequence() != sat_passes_seq || sat_passes_resend) ws_send_sat_passes();
+}
+
+// current julian date from the gps, or from the ntp synced clock, with the sub second part. false if there is no valid time
+bool get_current_jd(double& jd) {
+    if (gpsdata.date.year < 44 && gpsdata.date.year >= 23) {  // has valid gps time
+        jday(gpsdata.date.year + YEAR_BASE, gpsdata.date.month, gpsdata.date.day, gpsdata.tim.hour, gpsdata.tim.minute, gpsdata.tim.second, 0, false, jd);
+        uint32_t since_fix = time_millis - gps_fix_millis;  // the fix arrives a bit after its second, good enough for the doppler
+        if (since_fix < 2000) jd += since_fix / 86400000.0;
+        return true;
+    }
+    if (time_method == 0) return false;
+    struct tm timeinfo;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    localtime_r(&tv.tv_sec, &timeinfo);
+    jday(timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec + tv.tv_usec / 1000000.0, 0, false, jd);
+    return true;
+}
+
+// range rate and doppler shift of the tracked satellite, for the pp to retune during a pass
+void job_doppler(uint32_t now) {
+    if (millis_since(now, doppler_last_query) > DOPPLER_IDLE_MS) {
+        scheduler.set_period(TimerEntry_DOPPLER, 0);  // pause till the next query
+        return;
+    }
+    sat_doppler_t res{};
+    res.downlink_hz = doppler_downlink_hz;
+    res.uplink_hz = doppler_uplink_hz;
+    double jd;
+    double r[3];
+    double v[3];
+    if (sat_data_loaded && (sattrackdata.lat != 0 || sattrackdata.lon != 0) && get_current_jd(jd) &&
+        sgp4(wgs84, sat.satrec, (jd - sat.satrec.jdsatepoch) * 1440.0, r, v)) {  // the tracked satellite stays on the reference sgp4(), Sgp4Fast is for the batch
+        double range, rate;
+        Doppler::range_rate(r, v, jd, sattrackdata.lat, sattrackdata.lon, gpsdata.altitude, range, rate);
+        res.valid = 1;
+        res.range = range;
+        res.range_rate = rate;
+        res.downlink_shift = Doppler::downlink_shift(res.downlink_hz, rate);
+        res.uplink_shift = Doppler::uplink_shift(res.uplink_hz, rate);
+        res.timestamp = getUnixFromJulian(jd);
+    }
+    res.sequence = satDoppler.sequence() + 1;
+    satDoppler.publish(res);
+}
+
+// interpolated az / el of the tracked satellite at pointing_hz, for a rotator
+void job_pointing(uint32_t now) {
+    bool to_pp = millis_since(now, pointing_last_query) <= POINTING_IDLE_MS;
+    bool to_web = millis_since(now, pointing_web_last_query) <= POINTING_IDLE_MS;
+    if (!to_pp && !to_web) {
+        scheduler.set_period(TimerEntry_POINTING, 0);  // pause till the next request
+        return;
+    }
+    sat_pointing_t res{};
+    res.rate_hz = pointing_hz;
+    double jd;
+    if (sat_data_loaded && (sattrackdata.lat != 0 || sattrackdata.lon != 0) && get_current_jd(jd) &&
+        pointing.get(sat.satrec, jd, sattrackdata.lat, sattrackdata.lon, gpsdata.altitude, res.azimuth, res.elevation)) {
+        double unix_time = (jd - 2440587.5) * 86400.0;
+        res.valid = 1;
+        res.timestamp = (uint32_t)unix_time;
+        res.millis = (uint16_t)((unix_time - res.timestamp) * 1000.0);
+    }
+    res.sequence = satPointing.sequence() + 1;
+    satPointing.publish(res);
+    if (to_web && res.valid && !PPShellComm::getInCommand()) {
+        char buff[100];
+        size_t len = snprintf(buff, sizeof(buff), "#$##$$#GOTPOINT{\"az\":%.02f,\"el\":%.02f,\"t\":%" PRIu32 "%03u}\r\n", res.azimuth, res.elevation, res.timestamp, (unsigned)res.millis);
+        ws_sendall((uint8_t*)buff, len, true);
+    }
+}
+
+// the pp or the web asked for the pointing stream. hz is clamped to POINTING_HZ_MIN..MAX
+void request_pointing(uint8_t hz, bool from_web) {
+    pointing_hz = hz < POINTING_HZ_MIN ? POINTING_HZ_MIN : (hz > POINTING_HZ_MAX ? POINTING_HZ_MAX : hz);
+    if (from_web)
+        pointing_web_last_query = scheduler_now();
+    else
+        pointing_last_query = scheduler_now();
+    pointing_wanted = true;
+    WakeMainLoop();
+}
+
+void ws_request_pointing(uint8_t hz) {
+    if (hz == 0) {
+        pointing_web_last_query = scheduler_now() - POINTING_IDLE_MS - 1;  // stop, the job pauses itself if the pp doesn't need it
+        return;
+    }
+    request_pointing(hz, true);
+}
+
+// nmea recorder: ring -> spiffs. pauses itself when neither recording nor replaying
+void job_nmealog(uint32_t now) {
+    if (nmeaLog.recording() && !nmeaLog.flush()) ESP_LOGW(TAG, "NMEA log: write failed, the recording stopped");
+    if (!nmeaLog.recording() && !nmeaLog.replaying()) scheduler.set_period(TimerEntry_NMEALOG, 0);
+}
+
+// receiver baud / rate setup after boot, pauses itself when finished
+void job_gpsconfig(uint32_t now) {
+    gpsConfig.step(now);
+    if (!gpsConfig.finished()) return;
+    scheduler.set_period(TimerEntry_GPSCFG, 0);
+    if (gpsConfig.get_state() != GpsCfgState_DONE) {
+        ESP_LOGW(TAG, "GPS config: no valid data on any baud rate");
+        return;
+    }
+    ESP_LOGI(TAG, "GPS config: %s receiver, %" PRIu32 " baud, %u Hz", GpsConfig::receiver_name(gpsConfig.get_receiver()), gpsConfig.get_baud(), gpsConfig.get_hz());
+    if (gpsConfig.get_baud() != gps_cfg_baud || gpsConfig.get_receiver() != gps_cfg_receiver) {
+        gps_cfg_baud = gpsConfig.get_baud();
+        gps_cfg_receiver = gpsConfig.get_receiver();
+        save_config_gps();
+    }
+}
+
+// all satellites of the tle file, visible / next rising list for the pp
+void job_satbatch(uint32_t now) {
+    if (millis_since(now, sat_batch_last_query) > SATBATCH_IDLE_MS) {
+        scheduler.set_period(TimerEntry_SATBATCH, 0);  // pause till the next query
+        satBatch.clear();
+        satBatchList.publish(sat_batch_list_t{});
+        return;
+    }
+    double jd;
+    if (!get_current_jd(jd) || (sattrackdata.lat == 0 && sattrackdata.lon == 0)) return;
+    satBatch.propagate(jd, sattrackdata.lat, sattrackdata.lon, gpsdata.altitude);
+    sat_batch_list_t list = {};
+    list.total = satBatch.size() > 255 ? 255 : satBatch.size();
+    list.count = satBatch.get_sorted(list.sats, PP_SAT_BATCH_MAX);
+    satBatchList.publish(list);
+}
+
+void job_satdown(uint32_t now) {
+    if (!downloadedTLE && time_method && WifiM::getWifiStaStatus())  // not yet downloaded, and has valid time, and has wifi
+        download_tle_file_to_spiffs();
+}
+
+// check if i2c connected or dc
+void job_i2cconn(uint32_t now) {
+    if (i2c_pp_last_comm_time != 0 && millis_since(now, i2c_pp_last_comm_time) > 21000)  // pp query time 5 sec, so 20 is a good timeout
+    {
+        i2c_pp_last_comm_time = 0;  // reset time
+        PPShellComm::set_i2c_connected(false);
+        ws_notify_dc_i2c();  // send to webpage it is dc
+        i2p_pp_conn_state = false;
+    } else if (i2c_pp_last_comm_time != 0)  // no dc, but communication in last 20 sec
+    {
+        if (!i2p_pp_conn_state)  // if it was disconnecdet before, and now it is connected, notify
+        {
+            PPShellComm::set_i2c_connected(true);
+            ws_notify_cc_i2c();
+            i2p_pp_conn_state = true;
+        }
+    }
+}
+
+// esp apps need a fast loop only while running
+void job_apploop(uint32_t now) {
+    AppManager::loop(now);
+}
+
 #if __cplusplus
 extern "C" {
 #endif
@@ -497,6 +1005,7 @@ void app_main(void) {
     pinConfig.loadFromNvs();
 
     load_config_misc();
+    load_config_gps();
 
     init_spiffs();
     sat.site(0, 0, 34);
@@ -521,15 +1030,16 @@ void app_main(void) {
     nmea_parser_config_t nmeaconfig = NMEA_PARSER_CONFIG_DEFAULT();
     nmeaconfig.uart.baud_rate = gps_baud;
     nmeaconfig.uart.rx_pin = pinConfig.GpsRxPin();
+    nmeaconfig.uart.tx_pin = pinConfig.GpsTxPin();
     if (nmeaconfig.uart.rx_pin == 256) {
         ESP_LOGW(TAG, "GPS Rx pin not set. GPS disabled.");
     } else {
-        nmea_parser_handle_t nmea_hdl = nmea_parser_init(&nmeaconfig);
+        nmea_hdl = nmea_parser_init(&nmeaconfig);
         nmea_parser_add_handler(nmea_hdl, gps_event_handler, NULL);
+        nmea_parser_set_tap(nmea_hdl, NmeaLog::tap, &nmeaLog);
     }
     esp_task_wdt_deinit();
 
-    temperature_sensor_handle_t temp_sensor = NULL;
     temperature_sensor_config_t temp_sensor_config = {
         .range_min = -10,
         .range_max = 80,
@@ -572,32 +1082,111 @@ void app_main(void) {
 
     PPHandler::set_module_name("ESP32PP");
     PPHandler::set_module_version(1);
-    PPHandler::add_app((uint8_t*)sattrack, sizeof(sattrack));  // no neet to pinfor gps, since it can handle manual input
-    PPHandler::add_app((uint8_t*)wifisettings, sizeof(wifisettings));
-    PPHandler::add_app((uint8_t*)espapps, sizeof(espapps));
-    if (pinConfig.hasIRrx() || pinConfig.hasIRrx()) PPHandler::add_app((uint8_t*)tirapp, sizeof(tirapp));  // only add this app, if the user has ir tx or rx
-    PPHandler::add_app((uint8_t*)espmanager, sizeof(espmanager));
+    PPHandler::add_app_compressed(sattrack_lz, sizeof(sattrack_lz), sattrack_raw_size);  // no neet to pinfor gps, since it can handle manual input
+    PPHandler::add_app_compressed(wifisettings_lz, sizeof(wifisettings_lz), wifisettings_raw_size);
+    PPHandler::add_app_compressed(espapps_lz, sizeof(espapps_lz), espapps_raw_size);
+    if (pinConfig.hasIRrx() || pinConfig.hasIRrx()) PPHandler::add_app_compressed(tirapp_lz, sizeof(tirapp_lz), tirapp_raw_size);  // only add this app, if the user has ir tx or rx
+    PPHandler::add_app_compressed(espmanager_lz, sizeof(espmanager_lz), espmanager_raw_size);
     PPHandler::set_get_features_CB([](uint64_t& feat) {
-                                        i2c_pp_last_comm_time = time_millis;
+                                        i2c_pp_last_comm_time = scheduler_now();
                                     update_features();
                                     feat = chipFeatures.getFeatures(); });
 
-    PPHandler::set_get_gps_data_CB([](ppgpssmall_t& gpsdata_) { gpsdata_ = gpsdata; i2c_pp_last_comm_time = time_millis; });
+    // these are irq callbacks, so they only read the published snapshot, never the live globals
+    PPHandler::set_get_gps_data_CB([](ppgpssmall_t& gpsdata_) {
+                                        SensorSnapshot snap;
+                                        SensorTask::read(snap, pp_last_snapshot);
+                                        gpsdata_ = snap.gps; i2c_pp_last_comm_time = scheduler_now(); });
 
     PPHandler::set_get_orientation_data_CB([](orientation_t& ori) {
-                                                ori.angle = orientation.angle;
-                                                ori.tilt = orientation.tilt; i2c_pp_last_comm_time = time_millis; });
-    PPHandler::set_get_environment_data_CB([](environment_t& env) { 
-                                                i2c_pp_last_comm_time = time_millis;
-                                                env.temperature = environment.temperature;
-                                                env.humidity = environment.humidity;
-                                                env.pressure = environment.pressure; });
-    PPHandler::set_get_light_data_CB([](uint16_t& light) { light = light; });
+                                                SensorSnapshot snap;
+                                                SensorTask::read(snap, pp_last_snapshot);
+                                                ori = snap.orientation; i2c_pp_last_comm_time = scheduler_now(); });
+    PPHandler::set_get_environment_data_CB([](environment_t& env) {
+                                                SensorSnapshot snap;
+                                                SensorTask::read(snap, pp_last_snapshot);
+                                                i2c_pp_last_comm_time = scheduler_now();
+                                                env = snap.environment; });
+    PPHandler::set_get_light_data_CB([](uint16_t& light_) {
+                                                SensorSnapshot snap;
+                                                SensorTask::read(snap, pp_last_snapshot);
+                                                light_ = snap.light; });
+    PPHandler::set_get_all_data_CB([](feat_data_all_t& all) {
+                                                SensorSnapshot snap;
+                                                SensorTask::read(snap, pp_last_snapshot);
+                                                i2c_pp_last_comm_time = scheduler_now();
+                                                all.present = snap.present;
+                                                all.light = snap.light;
+                                                all.gps = snap.gps;
+                                                all.orientation = snap.orientation;
+                                                all.environment = snap.environment; });
 
     PPHandler::add_custom_command(PPCMD_SATTRACK_DATA, nullptr, [](pp_command_data_t data) {
                                         data.data->resize(sizeof(sattrackdata_t));
                                         *(sattrackdata_t *)(*data.data).data() = sattrackdata; });
 
+    PPHandler::add_custom_command(PPCMD_SATTRACK_PASSES, nullptr, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(sat_passes_t));
+                                        static sat_passes_t last = {};
+                                        PassPredictor::read(last);
+                                        *(sat_passes_t *)(*data.data).data() = last; });
+
+    PPHandler::add_custom_command(PPCMD_SATTRACK_BATCH, nullptr, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(sat_batch_list_t));
+                                        static sat_batch_list_t last = {};  // the last consistent copy, served again when a read was torn
+                                        satBatchList.read(*(sat_batch_list_t *)(*data.data).data(), last);
+                                        sat_batch_last_query = scheduler_now();
+                                        sat_batch_wanted = true;
+                                        WakeMainLoop(); });
+
+    PPHandler::add_custom_command(PPCMD_SATTRACK_DOPPLER, [](pp_command_data_t data) {
+                                        if (data.data->size() != sizeof(sat_doppler_set_t)) {
+                                            return;
+                                        }
+                                        sat_doppler_set_t tmp;
+                                        memcpy(&tmp, data.data->data(), sizeof(sat_doppler_set_t));
+                                        doppler_downlink_hz = tmp.downlink_hz;
+                                        doppler_uplink_hz = tmp.uplink_hz;
+                                        doppler_last_query = scheduler_now();
+                                        doppler_wanted = true;
+                                        WakeMainLoop(); }, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(sat_doppler_t));
+                                        static sat_doppler_t last = {};
+                                        satDoppler.read(*(sat_doppler_t *)(*data.data).data(), last);
+                                        doppler_last_query = scheduler_now();
+                                        doppler_wanted = true;
+                                        WakeMainLoop(); });
+
+    PPHandler::add_custom_command(PPCMD_GPS_SKYVIEW, nullptr, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(gps_skyview_frame_t));
+                                        static gps_skyview_frame_t last = {};
+                                        skyviewBuffer.read(*(gps_skyview_frame_t *)(*data.data).data(), last); });
+
+    PPHandler::add_custom_command(PPCMD_SATTRACK_POINTING, [](pp_command_data_t data) {
+                                        if (data.data->size() != sizeof(sat_pointing_set_t)) {
+                                            return;
+                                        }
+                                        sat_pointing_set_t tmp;
+                                        memcpy(&tmp, data.data->data(), sizeof(sat_pointing_set_t));
+                                        request_pointing(tmp.rate_hz, false); }, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(sat_pointing_t));
+                                        static sat_pointing_t last = {};
+                                        satPointing.read(*(sat_pointing_t *)(*data.data).data(), last);
+                                        pointing_last_query = scheduler_now();
+                                        pointing_wanted = true;
+                                        WakeMainLoop(); });
+
+    PPHandler::add_custom_command(PPCMD_SATTRACK_FIND, [](pp_command_data_t data) {
+                                        size_t len = data.data->size() < sizeof(sat_find_prefix) ? data.data->size() : sizeof(sat_find_prefix) - 1;
+                                        memcpy(sat_find_prefix, data.data->data(), len);
+                                        sat_find_prefix[len] = 0;
+                                        satFindResult.publish(sat_find_result_t{});  // done = 0 till the main loop searches
+                                        sat_find_wanted = true;
+                                        WakeMainLoop(); }, [](pp_command_data_t data) {
+                                        data.data->resize(sizeof(sat_find_result_t));
+                                        static sat_find_result_t last = {};
+                                        satFindResult.read(*(sat_find_result_t *)(*data.data).data(), last); });
+
     PPHandler::add_custom_command(PPCMD_SATTRACK_SETMGPS, [](pp_command_data_t data) {
                                         if (data.data->size() != sizeof(sat_mgps_t)) {
                                             return;
@@ -616,7 +1205,8 @@ void app_main(void) {
                                             if (data.data->at(i) == 0) break;
                                             str += (char)data.data->at(i);
                                         }
-                                        sat_to_track_new =str; }, nullptr);
+                                        sat_to_track_new =str;
+                                        WakeMainLoop(); }, nullptr);
     PPHandler::add_custom_command(PPCMD_IRTX_SENDIR, [](pp_command_data_t data) {
                                         if (data.data->size() != sizeof(ir_data_t)) {
                                             return;
@@ -644,7 +1234,8 @@ void app_main(void) {
                                         memcpy(WifiM::wifiStaPASS, tmp.password, 30);
                                         WifiM::wifiStaSSID[30] = 0;
                                         WifiM::wifiStaPASS[30] = 0;
-                                        wifi_config_changed= true; }, nullptr);
+                                        wifi_config_changed= true;
+                                        WakeMainLoop(); }, nullptr);
 
     PPHandler::add_custom_command(PPCMD_WIFI_SET_AP, [](pp_command_data_t data) {
                                         if (data.data->size() != sizeof(wifi_config_comp_t)) {
@@ -658,7 +1249,8 @@ void app_main(void) {
                                         memcpy(WifiM::wifiAPPASS, tmp.password, 30);
                                         WifiM::wifiAPSSID[30] = 0;
                                         WifiM::wifiAPPASS[30] = 0;
-                                        wifi_config_changed= true; }, nullptr);
+                                        wifi_config_changed= true;
+                                        WakeMainLoop(); }, nullptr);
 
     PPHandler::add_custom_command(PPCMD_WIFI_GET_CONFIG, nullptr, [](pp_command_data_t data) {
         data.data->resize(sizeof(wifi_current_data_t));
@@ -675,40 +1267,35 @@ void app_main(void) {
                     return;
                 }
                 memcpy(&airplane_mode_new, data.data->data(), sizeof(uint8_t));
-                ESP_DRAM_LOGW(TAG, "apmode: %d", airplane_mode_new); }, [](pp_command_data_t data) {
+                ESP_DRAM_LOGW(TAG, "apmode: %d", airplane_mode_new);
+                WakeMainLoop(); }, [](pp_command_data_t data) {
         data.data->resize(sizeof(uint8_t));
         memcpy((*data.data).data(), &airplane_mode, sizeof(uint8_t)); });
 
-    PPHandler::set_get_shell_data_size_CB([]() -> uint16_t {i2c_pp_last_comm_time = time_millis; return PPShellComm::get_i2c_tx_queue_size(); });
+    PPHandler::set_get_shell_data_size_CB([]() -> uint16_t {i2c_pp_last_comm_time = scheduler_now(); return PPShellComm::get_i2c_tx_queue_size(); });
 
-    PPHandler::set_got_shell_data_CB([](std::vector<uint8_t>& data) { I2CQueueMessage_t msg;
-                                           i2c_pp_last_comm_time = time_millis;
-                                           msg.size = data.size();
-                                           size_t size = data.size();
-                                           if (size > 64)
-                                           {
-                                               size = 64;
-                                           }
-                                           memcpy(msg.data, data.data(), size);
+    PPHandler::set_got_shell_data_CB([](PPSpan& data) { I2CQueueMessage_t msg;
+                                           i2c_pp_last_comm_time = scheduler_now();
                                            auto ttt = pdFALSE;
-                                           xQueueSendFromISR(PPShellComm::datain_queue, &msg, &ttt); });
-
-    PPHandler::set_send_shell_data_CB([](std::vector<uint8_t>& data, bool& hasmore) {
-                                            hasmore = false;
-                                            data.resize(64); 
-                                            size_t size = PPShellComm::get_i2c_tx_queue_size();
-                                            if (size>64)
-                                            {
-                                                hasmore = true;
-                                                size = 64;
-                                            }
-                                            memcpy(data.data(), PPShellComm::get_i2c_tx_queue_data(), size);
-                                            PPShellComm::clear_tx_queue(); });
-
-    PPHandler::set_shutdown_command_CB([](std::vector<uint8_t>& data) {
+                                           for (size_t pos = 0; pos < data.size(); pos += msg.size)
+                                           {
+                                               // the i2c buffer can hold more than a shell frame, that goes in more messages, nothing is cut
+                                               msg.size = data.size() - pos < sizeof(msg.data) ? data.size() - pos : sizeof(msg.data);
+                                               memcpy(msg.data, data.data() + pos, msg.size);
+                                               xQueueSendFromISR(PPShellComm::datain_queue, &msg, &ttt);
+                                           } });
+
+    PPHandler::set_send_shell_data_CB([](PPSpan& data, bool& hasmore) {
+                                            // straight from the ring to the response, the frame is zero padded by PPHandler
+                                            uint32_t size = PPShellComm::read_i2c_tx_queue_ISR(data.data() + data.size(), data.capacity() - data.size());
+                                            data.commit(size);
+                                            hasmore = PPShellComm::get_i2c_tx_queue_size() > 0; });
+
+    PPHandler::set_shutdown_command_CB([](PPSpan& data) {
         data.resize(1);
         data[0] = 1;
         shutdown_countdown = 10;  // set to 1, so in the main loop it will trigger the shutdown, and set to 10, so i2c reply can go through
+        WakeMainLoop();
     });
 
     // shell helper
@@ -717,169 +1304,33 @@ void app_main(void) {
                                                     vTaskDelay(1 / portTICK_PERIOD_MS);
                                                     return true; });
 
+    SensorTask::init(temp_sensor, &gpsBuffer, pinConfig.hasGPS());
+    PassPredictor::init();  // publishes the defaults, so the pp has data till the first sensor read
     PPHandler::init((gpio_num_t)pinConfig.I2cSclSlavePin(), (gpio_num_t)pinConfig.I2cSdaSlavePin(), 0x51);
 
-    while (true) {
-        time_millis = esp_timer_get_time() / 1000;
-        if (sat_to_track_new != "") {
-            sat_to_track = sat_to_track_new;
-            sat_data_loaded = (load_satellite_tle(sat_to_track) == ESP_OK);
-            sattrackdata.elevation = 0;
-            sattrackdata.azimuth = 0;
-            last_millis[TimerEntry_SATTRACK] = 10;  // force update
-            sat_to_track_new = "";
-        }
-
-        if (airplane_mode_new != 0) {
-            airplane_mode = airplane_mode_new;
-            airplane_mode_new = 0;
-            WifiM::set_airplane_mode(airplane_mode);
-        }
-
-        // GET ALL SENSOR DATA
-        if (time_millis - last_millis[TimerEntry_SENSORGET] > timer_millis[TimerEntry_SENSORGET]) {
-            // GPS IS AUTO
-            ESP_ERROR_CHECK(temperature_sensor_get_celsius(temp_sensor, &temperatureEsp));                 // TEMPINT
-            orientation.angle = get_heading_degrees();                                                     // ORIENTATION
-            orientation.tilt = get_tilt();                                                                 // TILT
-            get_environment_meas(&environment.temperature, &environment.pressure, &environment.humidity);  // env data
-            get_environment_light(&light);                                                                 // light (lux) data
-            last_millis[TimerEntry_SENSORGET] = time_millis;
-        }
-
-        // REPORT ALL SENSOR DATA TO WEB
-        if (!PPShellComm::getInCommand() && (time_millis - last_millis[TimerEntry_REPORTWEB] > timer_millis[TimerEntry_REPORTWEB])) {
-            char buff[300] = {0};
-            snprintf(buff, 300,
-                     "#$##$$#GOTSENS"
-                     "{\"gps\":{\"y\":%d,\"m\":%d,\"d\":%d,\"h\":%d,\"mi\":%d,\"s\":%d,"
-                     "\"siu\":%d,\"siv\":%d,\"lat\":%.06f,\"lon\":%.06f,\"alt\":%.02f,\"speed\":%f},"
-                     "\"ori\":{\"head\":%.01f, \"tilt\":%.01f },"
-                     "\"env\":{\"tempesp\":%.01f,\"temp\":%.01f,\"humi\":%.01f, \"press\":%.01f, \"light\":%d }"
-                     "}\r\n",
-                     gpsdata.date.year + YEAR_BASE, gpsdata.date.month, gpsdata.date.day, gpsdata.tim.hour + TIME_ZONE, gpsdata.tim.minute, gpsdata.tim.second,
-                     gpsdata.sats_in_use, gpsdata.sats_in_view, gpsdata.latitude, gpsdata.longitude, gpsdata.altitude, gpsdata.speed,
-                     orientation.angle, orientation.tilt,
-                     temperatureEsp, environment.temperature, environment.humidity, environment.pressure, light);
-            ws_sendall((uint8_t*)buff, strlen(buff), true);
-            last_millis[TimerEntry_REPORTWEB] = time_millis;
-        }
-
-        if (time_millis - last_millis[TimerEntry_REPORTSTATES] > timer_millis[TimerEntry_REPORTSTATES]) {
-            LedFeedback::rgb_set_by_status(PPShellComm::getAnyConnected() | i2p_pp_conn_state, WifiM::getWifiStaStatus(), WifiM::getWifiApClientNum() > 0, gpsdata.latitude != 200 && gpsdata.longitude != 200 && gpsdata.sats_in_use > 2);
-            displayManager.setEspState(WifiM::getWifiStaStatus(), WifiM::getWifiApClientNum() > 0, gpsdata.latitude != 200 && gpsdata.longitude != 200 && gpsdata.sats_in_use > 2, PPShellComm::getAnyConnected() | i2p_pp_conn_state);
-            last_millis[TimerEntry_REPORTSTATES] = time_millis;
-        }
-
-        if (time_millis - last_millis[TimerEntry_SATTRACK] > timer_millis[TimerEntry_SATTRACK]) {
-            // check for new gps data
-            // ESP_LOGI(TAG, "qgps: %f  %f", sattrackdata.lat, sattrackdata.lon);
-            if (sat_data_loaded) {
-                if (gpsdata.latitude != 200 || gpsdata.longitude != 200) {
-                    sattrackdata.lat = gpsdata.latitude;
-                    sattrackdata.lon = gpsdata.longitude;
-                }
-                // if only old, or etc use that nvm
-                if (sattrackdata.lat != 0 || sattrackdata.lon != 0) {
-                    struct tm timeinfo;
-                    sat.site(sattrackdata.lat, sattrackdata.lon, gpsdata.altitude);
-                    double jd = 0;
-                    if (gpsdata.date.year < 44 && gpsdata.date.year >= 23)  // has valid gps time
-                    {
-                        time_method = 1;
-                        jday(gpsdata.date.year + YEAR_BASE, gpsdata.date.month, gpsdata.date.day, gpsdata.tim.hour, gpsdata.tim.minute, gpsdata.tim.second, 0, false, jd);
-                    } else {
-                        time_t now;
-                        time(&now);
-                        localtime_r(&now, &timeinfo);
-                        int year = timeinfo.tm_year + 1900;  // Az év 1900-tól számítva
-                        int month = timeinfo.tm_mon + 1;     // A hónap 0-11, ezért +1
-                        int day = timeinfo.tm_mday;
-
-                        int hour = timeinfo.tm_hour;
-                        int minute = timeinfo.tm_min;
-                        int second = timeinfo.tm_sec;
-                        jday(year, month, day, hour, minute, second, 0, false, jd);
-                    }
-                    sat.findsat(jd);
-                    if (time_method == 0) {
-                        sattrackdata.azimuth = 0;
-                        sattrackdata.elevation = 0;
-                    } else {
-                        sattrackdata.azimuth = sat.satAz;
-                        sattrackdata.elevation = sat.satEl;
-                    }
-                    if (time_method == 1) {
-                        sattrackdata.day = gpsdata.date.day;
-                        sattrackdata.month = gpsdata.date.month;
-                        sattrackdata.year = gpsdata.date.year;
-                        sattrackdata.hour = gpsdata.tim.hour;
-                        sattrackdata.minute = gpsdata.tim.minute;
-                        sattrackdata.second = gpsdata.tim.second;
-                    } else {
-                        sattrackdata.day = timeinfo.tm_mday;
-                        sattrackdata.month = timeinfo.tm_mon + 1;
-                        sattrackdata.year = timeinfo.tm_year + 1900;
-                        sattrackdata.hour = timeinfo.tm_hour;
-                        sattrackdata.minute = timeinfo.tm_min;
-                        sattrackdata.second = timeinfo.tm_sec;
-                    }
-                    sattrackdata.time_method = time_method;
-                }
-                last_millis[TimerEntry_SATTRACK] = time_millis;
-                displayManager.setSatTrackDataSource(&sattrackdata, &sat_to_track);  // to update screen is that screen is selected
-            } else {
-                sattrackdata.sat_day = 0;
-                sattrackdata.sat_month = 0;
-                sattrackdata.sat_year = 0;
-                sattrackdata.sat_hour = 0;
-                sattrackdata.azimuth = 0;
-                sattrackdata.elevation = 0;
-                last_millis[TimerEntry_SATTRACK] = time_millis;
-            }
-        }
-
-        if (time_millis - last_millis[TimerEntry_SATDOWN] > timer_millis[TimerEntry_SATDOWN]) {
-            if (!downloadedTLE && time_method && WifiM::getWifiStaStatus())  // not yet downloaded, and has valid time, and has wifi
-                download_tle_file_to_spiffs();
-            last_millis[TimerEntry_SATDOWN] = time_millis;
-        }
-
-        // check if i2c connected or dc
-        if (i2c_pp_last_comm_time != 0 && (time_millis - i2c_pp_last_comm_time > 21000))  // pp query time 5 sec, so 20 is a good timeout
-        {
-            i2c_pp_last_comm_time = 0;  // reset time
-            PPShellComm::set_i2c_connected(false);
-            ws_notify_dc_i2c();  // send to webpage it is dc
-            i2p_pp_conn_state = false;
-        } else if (i2c_pp_last_comm_time != 0)  // no dc, but communication in last 20 sec
-        {
-            if (!i2p_pp_conn_state)  // if it was disconnecdet before, and now it is connected, notify
-            {
-                PPShellComm::set_i2c_connected(true);
-                ws_notify_cc_i2c();
-                i2p_pp_conn_state = true;
-            }
-        }
+    main_task = xTaskGetCurrentTaskHandle();
+    scheduler.add_job(TimerEntry_REPORTWEB, timer_millis[TimerEntry_REPORTWEB], job_reportweb);
+    scheduler.add_job(TimerEntry_REPORTSTATES, timer_millis[TimerEntry_REPORTSTATES], job_reportstates);
+    scheduler.add_job(TimerEntry_SATTRACK, timer_millis[TimerEntry_SATTRACK], job_sattrack);
+    scheduler.add_job(TimerEntry_SATDOWN, timer_millis[TimerEntry_SATDOWN], job_satdown);
+    scheduler.add_job(TimerEntry_I2CCONN, timer_millis[TimerEntry_I2CCONN], job_i2cconn);
+    scheduler.add_job(TimerEntry_WIFI, timer_millis[TimerEntry_WIFI], [](uint32_t now) { WifiM::wifi_loop(now); });  // try wifi client connect
+    scheduler.add_job(TimerEntry_DISPLAY, timer_millis[TimerEntry_DISPLAY], [](uint32_t now) { displayManager.loop(now); });
+    scheduler.add_job(TimerEntry_APPLOOP, timer_millis[TimerEntry_APPLOOP], job_apploop);
+    scheduler.add_job(TimerEntry_SATBATCH, 0, job_satbatch);  // paused till the pp queries it
+    scheduler.add_job(TimerEntry_DOPPLER, 0, job_doppler);    // paused till the pp queries it
+    scheduler.add_job(TimerEntry_POINTING, 0, job_pointing);  // paused till the pp or the web asks for it
+    scheduler.add_job(TimerEntry_GPSCFG, 0, job_gpsconfig);    // runs once after boot, if the gps tx pin is set
+    scheduler.add_job(TimerEntry_NMEALOG, 0, job_nmealog);      // paused till the web starts a recording or a replay
+    if (nmea_hdl && pinConfig.hasGPSTx() && gps_hz > 0) {
+        gpsConfig.start(scheduler_now(), gps_baud, gps_cfg_baud, (GpsReceiver)gps_cfg_receiver, gps_hz);
+        scheduler.set_period(TimerEntry_GPSCFG, timer_millis[TimerEntry_GPSCFG]);
+    }
 
-        if (wifi_config_changed) {
-            wifi_config_changed = false;
-            ESP_LOGI(TAG, "Saving new wifi config, and applying");
-            WifiM::save_config_wifi();
-            WifiM::config_wifi_apsta();
-        }
-        // try wifi client connect
-        WifiM::wifi_loop(time_millis);
-        AppManager::loop(time_millis);
-        displayManager.loop(time_millis);
-        vTaskDelay(15 / portTICK_PERIOD_MS);
-
-        if (shutdown_countdown > 1) {
-            shutdown_countdown--;
-            if (shutdown_countdown == 1) {
-                shutdownme();
-            }
-        }
+    while (true) {
+        time_millis = scheduler.wait_next();  // sleeps till the next job is due, or an event wakes it up
+        handle_events();
+        scheduler.run_due(time_millis);
     }
 }
 
@@ -14,8 +14,12 @@
 #define CONFIG_NMEA_PARSER_RING_BUFFER_SIZE 2048
 #define NMEA_PARSER_RUNTIME_BUFFER_SIZE \
     (CONFIG_NMEA_PARSER_RING_BUFFER_SIZE / 2)
-#define NMEA_MAX_STATEMENT_ITEM_LENGTH (16)
+#define NMEA_MAX_FIELDS (24) /* GSV has 20 with 4 satellites, the rest is ignored */
 #define NMEA_EVENT_LOOP_QUEUE_SIZE (24)
+#define NMEA_PARSER_TX_BUFFER_SIZE (256) /* receiver configuration commands */
+#define NMEA_SENTENCE_HASH_SIZE (16)
+#define NMEA_SOURCE_POLL_MS (10)    /* while a line source replaces the uart */
+#define NMEA_SOURCE_BURST (8)       /* lines from the source per loop, so the event queue keeps up */
 
 /**
  * @brief Define of NMEA Parser Event base
@@ -25,42 +29,96 @@ ESP_EVENT_DEFINE_BASE(ESP_NMEA_EVENT);
 
 static const char* GPS_TAG = "nmea_parser";
 
+/**
+ * @brief One field of a statement, points into the line buffer (not terminated)
+ *
+ */
+typedef struct {
+    const char* str; /*!< First character */
+    uint8_t len;     /*!< Length */
+} nmea_field_t;
+
 /**
  * @brief GPS parser library runtime structure
  *
  */
 typedef struct {
-    uint8_t item_pos;                              /*!< Current position in item */
-    uint8_t item_num;                              /*!< Current item number */
-    uint8_t asterisk;                              /*!< Asterisk detected flag */
-    uint8_t crc;                                   /*!< Calculated CRC value */
-    uint8_t parsed_statement;                      /*!< OR'd of statements that have been parsed */
-    uint8_t sat_num;                               /*!< Satellite number */
-    uint8_t sat_count;                             /*!< Satellite count */
-    uint8_t cur_statement;                         /*!< Current statement ID */
-    uint32_t all_statements;                       /*!< All statements mask */
-    char item_str[NMEA_MAX_STATEMENT_ITEM_LENGTH]; /*!< Current item */
-    gps_t parent;                                  /*!< Parent class */
-    uart_port_t uart_port;                         /*!< Uart port number */
-    uint8_t* buffer;                               /*!< Runtime buffer */
-    esp_event_loop_handle_t event_loop_hdl;        /*!< Event loop handle */
-    TaskHandle_t tsk_hdl;                          /*!< NMEA Parser task handle */
-    QueueHandle_t event_queue;                     /*!< UART event queue handle */
+    uint8_t parsed_statement;              /*!< OR'd of statements that have been parsed */
+    uint8_t sat_num;                       /*!< Index in skyview of the satellite being parsed, 0xff if none */
+    uint8_t sat_count;                     /*!< Number of parts of the current GSV */
+    uint8_t sat_part;                      /*!< Part number of the current GSV */
+    uint8_t cur_system;                    /*!< gps_system_t of the current GSV / GSA, from the talker */
+    uint8_t cur_statement;                 /*!< Current statement ID */
+    uint32_t all_statements;               /*!< All statements mask */
+    nmea_field_t fields[NMEA_MAX_FIELDS];  /*!< Fields of the current statement */
+    uint8_t field_count;                   /*!< Valid elements in fields */
+    char talker[2];                        /*!< Talker ID of the current statement (GP, GN, GL, ...) */
+    gps_skyview_t skyview;                 /*!< Satellites in view, updated part by part */
+    uint8_t sat_seen[GPS_MAX_SATELLITES_IN_VIEW];                 /*!< In the current GSV cycle of its system */
+    uint8_t gsv_signal[GPS_SYSTEM_MAX];                           /*!< Signal ID of the last GSV group, per system */
+    uint8_t sats_used[GPS_SYSTEM_MAX][GPS_MAX_SATELLITES_IN_USE]; /*!< Satellites of the last GSA, per system, 0 is empty */
+    bool skyview_changed;                  /*!< A GSV cycle finished since the last GPS_SKYVIEW */
+    gps_t parent;                          /*!< Parent class */
+    uart_port_t uart_port;                 /*!< Uart port number */
+    uint8_t* buffer;                       /*!< Runtime buffer */
+    esp_event_loop_handle_t event_loop_hdl; /*!< Event loop handle */
+    TaskHandle_t tsk_hdl;                  /*!< NMEA Parser task handle */
+    QueueHandle_t event_queue;             /*!< UART event queue handle */
+    nmea_parser_tap_t tap;                 /*!< Gets every raw line from the uart, NULL if none */
+    void* tap_arg;                         /*!< Argument of tap */
+    volatile nmea_parser_source_t source;  /*!< Gives the lines instead of the uart, NULL if none */
+    void* source_arg;                      /*!< Argument of source */
 } esp_gps_t;
 
+/**
+ * @brief Parse a decimal number to fixed point, no float math
+ *
+ * @param f field
+ * @param decimals digits after the point to keep, the rest is truncated
+ * @return int32_t value * 10^decimals, 0 for an empty field
+ */
+static int32_t parse_fixed(const nmea_field_t* f, uint8_t decimals) {
+    const char* s = f->str;
+    const char* end = f->str + f->len;
+    bool neg = false;
+    if (s < end && (*s == '-' || *s == '+')) neg = (*s++ == '-');
+    int32_t v = 0;
+    while (s < end && *s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+    if (s < end && *s == '.') s++;
+    for (uint8_t i = 0; i < decimals; ++i) {
+        v *= 10;
+        if (s < end && *s >= '0' && *s <= '9') v += *s++ - '0';
+    }
+    return neg ? -v : v;
+}
+
+/**
+ * @brief Parse a decimal number to float, through the fixed point parser
+ *
+ * @param f field
+ * @return float value, with 3 decimals
+ */
+static inline float parse_float(const nmea_field_t* f) {
+    return parse_fixed(f, 3) / 1000.0f;
+}
+
 /**
  * @brief parse latitude or longitude
  *              format of latitude in NMEA is ddmm.sss and longitude is
- * dddmm.sss
- * @param esp_gps esp_gps_t type object
+ * dddmm.sss. the minutes are kept in fixed point (1e-7 minute), so only the
+ * final division is float
+ * @param f field
  * @return float Latitude or Longitude value (unit: degree)
  */
-static float parse_lat_long(esp_gps_t* esp_gps) {
-    float ll = strtof(esp_gps->item_str, NULL);
-    int deg = ((int)ll) / 100;
-    float min = ll - (deg * 100);
-    ll = deg + min / 60.0f;
-    return ll;
+static float parse_lat_long(const nmea_field_t* f) {
+    const char* dot = memchr(f->str, '.', f->len);
+    const char* end = f->str + f->len;
+    nmea_field_t whole = {f->str, (uint8_t)((dot ? dot : end) - f->str)};
+    nmea_field_t frac = {dot ? dot : end, (uint8_t)(dot ? end - dot : 0)};
+    int32_t dm = parse_fixed(&whole, 0);
+    int32_t deg = dm / 100;
+    int32_t min = (dm - deg * 100) * 10000000 + parse_fixed(&frac, 7);  // 1e-7 minute
+    return deg + min / 6.0e8f;
 }
 
 /**
@@ -77,19 +135,16 @@ static inline uint8_t convert_two_digit2number(const char* digit_char) {
  * @brief Parse UTC time in GPS statements
  *
  * @param esp_gps esp_gps_t type object
+ * @param f field, hhmmss.sss
  */
-static void parse_utc_time(esp_gps_t* esp_gps) {
-    esp_gps->parent.tim.hour = convert_two_digit2number(esp_gps->item_str + 0);
-    esp_gps->parent.tim.minute = convert_two_digit2number(esp_gps->item_str + 2);
-    esp_gps->parent.tim.second = convert_two_digit2number(esp_gps->item_str + 4);
-    if (esp_gps->item_str[6] == '.') {
-        uint16_t tmp = 0;
-        uint8_t i = 7;
-        while (esp_gps->item_str[i]) {
-            tmp = 10 * tmp + esp_gps->item_str[i] - '0';
-            i++;
-        }
-        esp_gps->parent.tim.thousand = tmp;
+static void parse_utc_time(esp_gps_t* esp_gps, const nmea_field_t* f) {
+    if (f->len < 6) return;
+    esp_gps->parent.tim.hour = convert_two_digit2number(f->str + 0);
+    esp_gps->parent.tim.minute = convert_two_digit2number(f->str + 2);
+    esp_gps->parent.tim.second = convert_two_digit2number(f->str + 4);
+    if (f->len > 6 && f->str[6] == '.') {
+        nmea_field_t frac = {f->str + 6, (uint8_t)(f->len - 6)};
+        esp_gps->parent.tim.thousand = (uint16_t)parse_fixed(&frac, 3);
     }
 }
 
@@ -97,44 +152,45 @@ static void parse_utc_time(esp_gps_t* esp_gps) {
  * @brief Parse GGA statements
  *
  * @param esp_gps esp_gps_t type object
+ * @param item_num field number
+ * @param f field
  */
-static void parse_gga(esp_gps_t* esp_gps) {
+static void parse_gga(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
     /* Process GGA statement */
-    switch (esp_gps->item_num) {
+    switch (item_num) {
         case 1: /* Process UTC time */
-            parse_utc_time(esp_gps);
+            parse_utc_time(esp_gps, f);
             break;
         case 2: /* Latitude */
-            esp_gps->parent.latitude = parse_lat_long(esp_gps);
+            esp_gps->parent.latitude = parse_lat_long(f);
             break;
         case 3: /* Latitude north(1)/south(-1) information */
-            if (esp_gps->item_str[0] == 'S' || esp_gps->item_str[0] == 's') {
+            if (f->len && (f->str[0] == 'S' || f->str[0] == 's')) {
                 esp_gps->parent.latitude *= -1;
             }
             break;
         case 4: /* Longitude */
-            esp_gps->parent.longitude = parse_lat_long(esp_gps);
+            esp_gps->parent.longitude = parse_lat_long(f);
             break;
         case 5: /* Longitude east(1)/west(-1) information */
-            if (esp_gps->item_str[0] == 'W' || esp_gps->item_str[0] == 'w') {
+            if (f->len && (f->str[0] == 'W' || f->str[0] == 'w')) {
                 esp_gps->parent.longitude *= -1;
             }
             break;
         case 6: /* Fix status */
-            esp_gps->parent.fix = (gps_fix_t)strtol(esp_gps->item_str, NULL, 10);
+            esp_gps->parent.fix = (gps_fix_t)parse_fixed(f, 0);
             break;
         case 7: /* Satellites in use */
-            esp_gps->parent.sats_in_use =
-                (uint8_t)strtol(esp_gps->item_str, NULL, 10);
+            esp_gps->parent.sats_in_use = (uint8_t)parse_fixed(f, 0);
             break;
         case 8: /* HDOP */
-            esp_gps->parent.dop_h = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.dop_h = parse_float(f);
             break;
         case 9: /* Altitude */
-            esp_gps->parent.altitude = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.altitude = parse_float(f);
             break;
         case 11: /* Altitude above ellipsoid */
-            esp_gps->parent.altitude += strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.altitude += parse_float(f);
             break;
         default:
             break;
@@ -145,48 +201,48 @@ static void parse_gga(esp_gps_t* esp_gps) {
  * @brief Parse RMC statements
  *
  * @param esp_gps esp_gps_t type object
+ * @param item_num field number
+ * @param f field
  */
-static void parse_rmc(esp_gps_t* esp_gps) {
+static void parse_rmc(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
     /* Process GPRMC statement */
-    switch (esp_gps->item_num) {
+    switch (item_num) {
         case 1: /* Process UTC time */
-            parse_utc_time(esp_gps);
+            parse_utc_time(esp_gps, f);
             break;
         case 2: /* Process valid status */
-            esp_gps->parent.valid = (esp_gps->item_str[0] == 'A');
+            esp_gps->parent.valid = (f->len && f->str[0] == 'A');
             break;
         case 3: /* Latitude */
-            esp_gps->parent.latitude = parse_lat_long(esp_gps);
+            esp_gps->parent.latitude = parse_lat_long(f);
             break;
         case 4: /* Latitude north(1)/south(-1) information */
-            if (esp_gps->item_str[0] == 'S' || esp_gps->item_str[0] == 's') {
+            if (f->len && (f->str[0] == 'S' || f->str[0] == 's')) {
                 esp_gps->parent.latitude *= -1;
             }
             break;
         case 5: /* Longitude */
-            esp_gps->parent.longitude = parse_lat_long(esp_gps);
+            esp_gps->parent.longitude = parse_lat_long(f);
             break;
         case 6: /* Longitude east(1)/west(-1) information */
-            if (esp_gps->item_str[0] == 'W' || esp_gps->item_str[0] == 'w') {
+            if (f->len && (f->str[0] == 'W' || f->str[0] == 'w')) {
                 esp_gps->parent.longitude *= -1;
             }
             break;
-        case 7: /* Process ground speed in unit m/s */
-            esp_gps->parent.speed = strtof(esp_gps->item_str, NULL) * 1.852;
+        case 7: /* Process ground speed in unit km/h */
+            esp_gps->parent.speed = parse_float(f) * 1.852f;  // knots to km/h
             break;
         case 8: /* Process true course over ground */
-            esp_gps->parent.cog = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.cog = parse_float(f);
             break;
         case 9: /* Process date */
-            esp_gps->parent.date.day =
-                convert_two_digit2number(esp_gps->item_str + 0);
-            esp_gps->parent.date.month =
-                convert_two_digit2number(esp_gps->item_str + 2);
-            esp_gps->parent.date.year =
-                convert_two_digit2number(esp_gps->item_str + 4);
+            if (f->len < 6) break;
+            esp_gps->parent.date.day = convert_two_digit2number(f->str + 0);
+            esp_gps->parent.date.month = convert_two_digit2number(f->str + 2);
+            esp_gps->parent.date.year = convert_two_digit2number(f->str + 4);
             break;
         case 10: /* Process magnetic variation */
-            esp_gps->parent.variation = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.variation = parse_float(f);
             break;
         default:
             break;
@@ -197,31 +253,33 @@ static void parse_rmc(esp_gps_t* esp_gps) {
  * @brief Parse GLL statements
  *
  * @param esp_gps esp_gps_t type object
+ * @param item_num field number
+ * @param f field
  */
-static void parse_gll(esp_gps_t* esp_gps) {
+static void parse_gll(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
     /* Process GPGLL statement */
-    switch (esp_gps->item_num) {
+    switch (item_num) {
         case 1: /* Latitude */
-            esp_gps->parent.latitude = parse_lat_long(esp_gps);
+            esp_gps->parent.latitude = parse_lat_long(f);
             break;
         case 2: /* Latitude north(1)/south(-1) information */
-            if (esp_gps->item_str[0] == 'S' || esp_gps->item_str[0] == 's') {
+            if (f->len && (f->str[0] == 'S' || f->str[0] == 's')) {
                 esp_gps->parent.latitude *= -1;
             }
             break;
         case 3: /* Longitude */
-            esp_gps->parent.longitude = parse_lat_long(esp_gps);
+            esp_gps->parent.longitude = parse_lat_long(f);
             break;
         case 4: /* Longitude east(1)/west(-1) information */
-            if (esp_gps->item_str[0] == 'W' || esp_gps->item_str[0] == 'w') {
+            if (f->len && (f->str[0] == 'W' || f->str[0] == 'w')) {
                 esp_gps->parent.longitude *= -1;
             }
             break;
         case 5: /* Process UTC time */
-            parse_utc_time(esp_gps);
+            parse_utc_time(esp_gps, f);
             break;
         case 6: /* Process valid status */
-            esp_gps->parent.valid = (esp_gps->item_str[0] == 'A');
+            esp_gps->parent.valid = (f->len && f->str[0] == 'A');
             break;
         default:
             break;
@@ -232,23 +290,23 @@ static void parse_gll(esp_gps_t* esp_gps) {
  * @brief Parse VTG statements
  *
  * @param esp_gps esp_gps_t type object
+ * @param item_num field number
+ * @param f field
  */
-static void parse_vtg(esp_gps_t* esp_gps) {
+static void parse_vtg(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
     /* Process GPVGT statement */
-    switch (esp_gps->item_num) {
+    switch (item_num) {
         case 1: /* Process true course over ground */
-            esp_gps->parent.cog = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.cog = parse_float(f);
             break;
         case 3: /* Process magnetic variation */
-            esp_gps->parent.variation = strtof(esp_gps->item_str, NULL);
+            esp_gps->parent.variation = parse_float(f);
             break;
-        case 5: /* Process ground speed in unit m/s */
-            esp_gps->parent.speed =
-                strtof(esp_gps->item_str, NULL) * 1.852;  // knots to m/s
+        case 5: /* Process ground speed in unit km/h */
+            esp_gps->parent.speed = parse_float(f) * 1.852f;  // knots to km/h
             break;
-        case 7: /* Process ground speed in unit m/s */
-            esp_gps->parent.speed =
-                strtof(esp_gps->item_str, NULL) / 3.6;  // km/h to m/s
+        case 7: /* Process ground speed in unit km/h */
+            esp_gps->parent.speed = parse_float(f);
             break;
         default:
             break;
@@ -256,47 +314,302 @@ static void parse_vtg(esp_gps_t* esp_gps) {
 }
 
 /**
- * @brief Parse received item
+ * @brief GNSS system from the talker ID
+ *
+ * @param talker 2 characters
+ * @return gps_system_t GPS_SYSTEM_UNKNOWN for GN (combined), the satellite number tells it then
+ */
+static gps_system_t talker_system(const char* talker) {
+    if (talker[0] == 'B' && talker[1] == 'D') return GPS_SYSTEM_BEIDOU;
+    if (talker[0] != 'G') return GPS_SYSTEM_UNKNOWN;
+    switch (talker[1]) {
+        case 'P':
+            return GPS_SYSTEM_GPS;
+        case 'L':
+            return GPS_SYSTEM_GLONASS;
+        case 'A':
+            return GPS_SYSTEM_GALILEO;
+        case 'B':
+            return GPS_SYSTEM_BEIDOU;
+        case 'Q':
+            return GPS_SYSTEM_QZSS;
+        case 'I':
+            return GPS_SYSTEM_NAVIC;
+        default:
+            return GPS_SYSTEM_UNKNOWN;
+    }
+}
+
+/**
+ * @brief GNSS system from the NMEA satellite number, for the GN talker without a system ID
+ *
+ */
+static gps_system_t number_system(int32_t num) {
+    if (num >= 1 && num <= 64) return GPS_SYSTEM_GPS;  // 33..64 is SBAS
+    if (num >= 65 && num <= 96) return GPS_SYSTEM_GLONASS;
+    return GPS_SYSTEM_UNKNOWN;
+}
+
+/**
+ * @brief Find or add a satellite in the sky view
+ *
+ * @return uint8_t index, 0xff if the table is full
+ */
+static uint8_t skyview_slot(esp_gps_t* esp_gps, uint8_t system, uint8_t num) {
+    gps_skyview_t* sky = &esp_gps->skyview;
+    for (uint8_t i = 0; i < sky->count; ++i) {
+        if (sky->sats[i].num == num && sky->sats[i].system == system) return i;
+    }
+    uint8_t i = sky->count;
+    if (i >= GPS_MAX_SATELLITES_IN_VIEW) {
+        /* full, reuse one from the previous cycle of this system that is not in view any more */
+        for (i = 0; i < sky->count; ++i) {
+            if (sky->sats[i].system == system && !esp_gps->sat_seen[i]) break;
+        }
+        if (i == sky->count) return 0xff;
+    } else {
+        sky->count++;
+    }
+    memset(&sky->sats[i], 0, sizeof(gps_satellite_t));
+    sky->sats[i].num = num;
+    sky->sats[i].system = system;
+    esp_gps->sat_seen[i] = 0;
+    return i;
+}
+
+/**
+ * @brief End of a GSV cycle, drop the satellites of the system that were not in it
+ *
+ */
+static void skyview_finish(esp_gps_t* esp_gps, uint8_t system) {
+    gps_skyview_t* sky = &esp_gps->skyview;
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < sky->count; ++i) {
+        if (sky->sats[i].system == system && !esp_gps->sat_seen[i]) continue;
+        sky->sats[n] = sky->sats[i];
+        esp_gps->sat_seen[n++] = esp_gps->sat_seen[i];
+    }
+    sky->count = n;
+    esp_gps->skyview_changed = true;
+}
+
+/**
+ * @brief Parse GSV statements, one part of the satellites in view of one system
  *
  * @param esp_gps esp_gps_t type object
- * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ * @param item_num field number
+ * @param f field
  */
-static esp_err_t parse_item(esp_gps_t* esp_gps) {
-    esp_err_t err = ESP_OK;
-    /* start of a statement */
-    if (esp_gps->item_num == 0 && esp_gps->item_str[0] == '$') {
-        if (0) {
-        } else if (strstr(esp_gps->item_str, "GGA")) {
-            esp_gps->cur_statement = STATEMENT_GGA;
-        } else if (strstr(esp_gps->item_str, "RMC")) {
-            esp_gps->cur_statement = STATEMENT_RMC;
-        } else if (strstr(esp_gps->item_str, "GLL")) {
-            esp_gps->cur_statement = STATEMENT_GLL;
-        } else if (strstr(esp_gps->item_str, "VTG")) {
-            esp_gps->cur_statement = STATEMENT_VTG;
-        } else {
-            esp_gps->cur_statement = STATEMENT_UNKNOWN;
+static void parse_gsv(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
+    switch (item_num) {
+        case 1: /* Number of parts */
+            esp_gps->sat_count = (uint8_t)parse_fixed(f, 0);
+            esp_gps->cur_system = talker_system(esp_gps->talker);
+            esp_gps->sat_num = 0xff;
+            break;
+        case 2: { /* Part number */
+            esp_gps->sat_part = (uint8_t)parse_fixed(f, 0);
+            /* NMEA 4.10 appends a signal ID, a receiver may send one group per signal (L1, L5). those are merged */
+            uint8_t signal = 0;
+            const nmea_field_t* last = &esp_gps->fields[esp_gps->field_count - 1];
+            if ((esp_gps->field_count - 4) % 4 == 1 && last->len == 1) {
+                signal = last->str[0] <= '9' ? last->str[0] - '0' : last->str[0] - 'A' + 10;
+            }
+            uint8_t sys = esp_gps->cur_system;
+            if (esp_gps->sat_part == 1 && (signal == 0 || signal <= esp_gps->gsv_signal[sys])) {
+                /* new cycle of this system */
+                for (uint8_t i = 0; i < esp_gps->skyview.count; ++i) {
+                    if (esp_gps->skyview.sats[i].system == sys) esp_gps->sat_seen[i] = 0;
+                }
+            }
+            esp_gps->gsv_signal[sys] = signal;
+            break;
+        }
+        case 3: /* Satellites in view of this system */
+            break;
+        default: {
+            if ((esp_gps->field_count - 4) % 4 == 1 && item_num == esp_gps->field_count - 1) {
+                break; /* signal ID */
+            }
+            gps_satellite_t* sat = esp_gps->sat_num != 0xff ? &esp_gps->skyview.sats[esp_gps->sat_num] : NULL;
+            switch ((item_num - 4) % 4) {
+                case 0: { /* Satellite number */
+                    int32_t num = parse_fixed(f, 0);
+                    uint8_t sys = esp_gps->cur_system != GPS_SYSTEM_UNKNOWN ? esp_gps->cur_system : number_system(num);
+                    esp_gps->sat_num = (f->len && num > 0 && num < 256) ? skyview_slot(esp_gps, sys, (uint8_t)num) : 0xff;
+                    break;
+                }
+                case 1: /* Elevation */
+                    if (sat) sat->elevation = (uint8_t)parse_fixed(f, 0);
+                    break;
+                case 2: /* Azimuth */
+                    if (sat) sat->azimuth = (uint16_t)parse_fixed(f, 0);
+                    break;
+                case 3: { /* SNR, the best of the signals */
+                    if (!sat) break;
+                    uint8_t snr = (uint8_t)parse_fixed(f, 0);
+                    if (!esp_gps->sat_seen[esp_gps->sat_num] || snr > sat->snr) sat->snr = snr;
+                    esp_gps->sat_seen[esp_gps->sat_num] = 1;
+                    esp_gps->sat_num = 0xff;
+                    break;
+                }
+            }
+            break;
         }
-        goto out;
     }
-    /* Parse each item, depend on the type of the statement */
-    if (esp_gps->cur_statement == STATEMENT_UNKNOWN) {
-        goto out;
+    /* the last field of the last part closes the cycle */
+    if (item_num == esp_gps->field_count - 1 && esp_gps->sat_part == esp_gps->sat_count) {
+        skyview_finish(esp_gps, esp_gps->cur_system);
     }
+}
 
-    else if (esp_gps->cur_statement == STATEMENT_GGA) {
-        parse_gga(esp_gps);
-    } else if (esp_gps->cur_statement == STATEMENT_RMC) {
-        parse_rmc(esp_gps);
-    } else if (esp_gps->cur_statement == STATEMENT_GLL) {
-        parse_gll(esp_gps);
-    } else if (esp_gps->cur_statement == STATEMENT_VTG) {
-        parse_vtg(esp_gps);
-    } else {
-        err = ESP_FAIL;
+/**
+ * @brief Parse GSA statements, the satellites used in the fix of one system
+ *
+ * @param esp_gps esp_gps_t type object
+ * @param item_num field number
+ * @param f field
+ */
+static void parse_gsa(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f) {
+    switch (item_num) {
+        case 1: { /* Mode, A/M. find the system here, NMEA 4.10 has a system ID at the end */
+            esp_gps->cur_system = talker_system(esp_gps->talker);
+            if (esp_gps->cur_system == GPS_SYSTEM_UNKNOWN && esp_gps->field_count > 18) {
+                int32_t id = parse_fixed(&esp_gps->fields[18], 0);
+                if (id > 0 && id < GPS_SYSTEM_MAX) esp_gps->cur_system = (uint8_t)id;  // same order as gps_system_t
+            }
+            if (esp_gps->cur_system == GPS_SYSTEM_UNKNOWN && esp_gps->field_count > 3) {
+                esp_gps->cur_system = number_system(parse_fixed(&esp_gps->fields[3], 0));
+            }
+            memset(esp_gps->sats_used[esp_gps->cur_system], 0, GPS_MAX_SATELLITES_IN_USE);
+            break;
+        }
+        case 2: /* Fix mode */
+            if (f->len) esp_gps->parent.fix_mode = (gps_fix_mode_t)parse_fixed(f, 0);
+            break;
+        case 15: /* PDOP */
+            esp_gps->parent.dop_p = parse_float(f);
+            break;
+        case 16: /* HDOP */
+            esp_gps->parent.dop_h = parse_float(f);
+            break;
+        case 17: /* VDOP */
+            esp_gps->parent.dop_v = parse_float(f);
+            break;
+        default:
+            if (item_num >= 3 && item_num < 3 + GPS_MAX_SATELLITES_IN_USE) {
+                int32_t num = parse_fixed(f, 0);
+                esp_gps->sats_used[esp_gps->cur_system][item_num - 3] = (num > 0 && num < 256) ? (uint8_t)num : 0;
+            }
+            break;
     }
-out:
-    return err;
+}
+
+/**
+ * @brief Post the sky view with the in use flags from the GSAs
+ *
+ * @param esp_gps esp_gps_t type object
+ */
+static void post_skyview(esp_gps_t* esp_gps) {
+    gps_skyview_t* sky = &esp_gps->skyview;
+    for (uint8_t i = 0; i < sky->count; ++i) {
+        gps_satellite_t* sat = &sky->sats[i];
+        sat->in_use = 0;
+        for (uint8_t k = 0; k < GPS_MAX_SATELLITES_IN_USE && sat->system < GPS_SYSTEM_MAX; ++k) {
+            if (esp_gps->sats_used[sat->system][k] == sat->num) {
+                sat->in_use = 1;
+                break;
+            }
+        }
+    }
+    esp_gps->skyview_changed = false;
+    esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_SKYVIEW,
+                      sky, sizeof(uint8_t) + sky->count * sizeof(gps_satellite_t),
+                      100 / portTICK_PERIOD_MS);
+}
+
+/**
+ * @brief Statement parser, called for each field after the first
+ *
+ */
+typedef void (*nmea_statement_parser_t)(esp_gps_t* esp_gps, uint8_t item_num, const nmea_field_t* f);
+
+/**
+ * @brief Entry of the statement table
+ *
+ */
+typedef struct {
+    char id[3];                    /*!< Sentence ID, without the talker */
+    nmea_statement_t statement;    /*!< Statement */
+    nmea_statement_parser_t parse; /*!< Parser */
+} nmea_statement_entry_t;
+
+/**
+ * @brief Perfect hash of the 3 character sentence ID
+ *        collision free for GGA RMC GLL VTG GSA GSV ZDA GNS TXT, so any of
+ *        them can get a slot later
+ *
+ */
+static inline uint8_t statement_hash(const char* id) {
+    return (uint8_t)(id[0] * 2 + id[1] * 11 + id[2]) & (NMEA_SENTENCE_HASH_SIZE - 1);
+}
+
+/**
+ * @brief Statement table, indexed by statement_hash()
+ *
+ */
+static const nmea_statement_entry_t statement_table[NMEA_SENTENCE_HASH_SIZE] = {
+    [12] = {{'G', 'G', 'A'}, STATEMENT_GGA, parse_gga},
+    [6] = {{'R', 'M', 'C'}, STATEMENT_RMC, parse_rmc},
+    [14] = {{'G', 'L', 'L'}, STATEMENT_GLL, parse_gll},
+    [15] = {{'V', 'T', 'G'}, STATEMENT_VTG, parse_vtg},
+    [0] = {{'G', 'S', 'A'}, STATEMENT_GSA, parse_gsa},
+    [5] = {{'G', 'S', 'V'}, STATEMENT_GSV, parse_gsv},
+};
+
+/**
+ * @brief Split the statement to fields without copying, and check its CRC
+ *
+ * @param esp_gps esp_gps_t type object
+ * @param d first character after the '$'
+ * @param end end of the buffer
+ * @return const char* the end of the statement, NULL if it is not complete or the CRC is wrong
+ */
+static const char* tokenize(esp_gps_t* esp_gps, const char* d, const char* end) {
+    uint8_t crc = 0;
+    uint8_t n = 0;
+    const char* start = d;
+    for (; d < end && *d != '*' && *d != '\r' && *d != '\n' && *d != '$' && *d; ++d) {
+        crc ^= (uint8_t)*d;
+        if (*d == ',') {
+            if (n < NMEA_MAX_FIELDS) {
+                esp_gps->fields[n].str = start;
+                esp_gps->fields[n++].len = d - start > 255 ? 255 : (uint8_t)(d - start);
+            }
+            start = d + 1;
+        }
+    }
+    if (n < NMEA_MAX_FIELDS) {
+        esp_gps->fields[n].str = start;
+        esp_gps->fields[n++].len = d - start > 255 ? 255 : (uint8_t)(d - start);
+    }
+    esp_gps->field_count = n;
+    if (end - d < 3 || *d != '*') return NULL;
+    /* Convert received CRC from hex */
+    uint8_t got = 0;
+    for (uint8_t i = 1; i <= 2; ++i) {
+        char c = d[i];
+        got <<= 4;
+        if (c >= '0' && c <= '9') got |= c - '0';
+        else if (c >= 'A' && c <= 'F') got |= c - 'A' + 10;
+        else if (c >= 'a' && c <= 'f') got |= c - 'a' + 10;
+        else return NULL;
+    }
+    if (got != crc) {
+        ESP_LOGD(GPS_TAG, "CRC Error for statement:%s", esp_gps->buffer);
+        return NULL;
+    }
+    return d + 3;
 }
 
 /**
@@ -307,99 +620,56 @@ out:
  * @return esp_err_t ESP_OK on success, ESP_FAIL on error
  */
 static esp_err_t gps_decode(esp_gps_t* esp_gps, size_t len) {
-    const uint8_t* d = esp_gps->buffer;
-    if (1) esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_DEBUG, esp_gps->buffer, len, 100 / portTICK_PERIOD_MS);
-    while (*d) {
+    const char* d = (const char*)esp_gps->buffer;
+    const char* end = d + len;
+    esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_DEBUG, esp_gps->buffer, len, 100 / portTICK_PERIOD_MS);
+    while (d < end && *d) {
         /* Start of a statement */
-        if (*d == '$') {
-            /* Reset runtime information */
-            esp_gps->asterisk = 0;
-            esp_gps->item_num = 0;
-            esp_gps->item_pos = 0;
-            esp_gps->cur_statement = 0;
-            esp_gps->crc = 0;
-            esp_gps->sat_count = 0;
-            esp_gps->sat_num = 0;
-            /* Add character to item */
-            esp_gps->item_str[esp_gps->item_pos++] = *d;
-            esp_gps->item_str[esp_gps->item_pos] = '\0';
+        if (*d != '$') {
+            d++;
+            continue;
         }
-        /* Detect item separator character */
-        else if (*d == ',') {
-            /* Parse current item */
-            parse_item(esp_gps);
-            /* Add character to CRC computation */
-            esp_gps->crc ^= (uint8_t)(*d);
-            /* Start with next item */
-            esp_gps->item_pos = 0;
-            esp_gps->item_str[0] = '\0';
-            esp_gps->item_num++;
+        esp_gps->cur_statement = STATEMENT_UNKNOWN;
+        esp_gps->sat_count = 0;
+        esp_gps->sat_part = 0;
+        esp_gps->sat_num = 0xff;
+        const char* next = tokenize(esp_gps, d + 1, end);
+        if (!next) {
+            d++;
+            continue;
         }
-        /* End of CRC computation */
-        else if (*d == '*') {
-            /* Parse current item */
-            parse_item(esp_gps);
-            /* Asterisk detected */
-            esp_gps->asterisk = 1;
-            /* Start with next item */
-            esp_gps->item_pos = 0;
-            esp_gps->item_str[0] = '\0';
-            esp_gps->item_num++;
+        d = next;
+        const nmea_field_t* id = &esp_gps->fields[0];
+        const nmea_statement_entry_t* entry = NULL;
+        if (id->len == 5) {
+            esp_gps->talker[0] = id->str[0];
+            esp_gps->talker[1] = id->str[1];
+            entry = &statement_table[statement_hash(id->str + 2)];
+            if (!entry->parse || memcmp(entry->id, id->str + 2, 3) != 0) entry = NULL;
         }
-        /* End of statement */
-        else if (*d == '\r') {
-            /* Convert received CRC from string (hex) to number */
-            uint8_t crc = (uint8_t)strtol(esp_gps->item_str, NULL, 16);
-            /* CRC passed */
-            if (esp_gps->crc == crc) {
-                switch (esp_gps->cur_statement) {
-                    case STATEMENT_GGA:
-                        esp_gps->parsed_statement |= 1 << STATEMENT_GGA;
-                        break;
-
-                    case STATEMENT_RMC:
-                        esp_gps->parsed_statement |= 1 << STATEMENT_RMC;
-                        break;
-                    case STATEMENT_GLL:
-                        esp_gps->parsed_statement |= 1 << STATEMENT_GLL;
-                        break;
-
-                    case STATEMENT_VTG:
-                        esp_gps->parsed_statement |= 1 << STATEMENT_VTG;
-                        break;
-                    default:
-                        break;
-                }
-                /* Check if all statements have been parsed */
-                if (((esp_gps->parsed_statement) & esp_gps->all_statements) ==
-                    esp_gps->all_statements) {
-                    esp_gps->parsed_statement = 0;
-                    /* Send signal to notify that GPS information has been updated */
-                    esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_UPDATE,
-                                      &(esp_gps->parent), sizeof(gps_t),
-                                      100 / portTICK_PERIOD_MS);
-                }
-            } else {
-                ESP_LOGD(GPS_TAG, "CRC Error for statement:%s", esp_gps->buffer);
-            }
-            if (esp_gps->cur_statement == STATEMENT_UNKNOWN) {
-                /* Send signal to notify that one unknown statement has been met */
-                esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_UNKNOWN,
-                                  esp_gps->buffer, len, 100 / portTICK_PERIOD_MS);
-            }
+        if (!entry) {
+            /* Send signal to notify that one unknown statement has been met */
+            esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_UNKNOWN,
+                              esp_gps->buffer, len, 100 / portTICK_PERIOD_MS);
+            continue;
         }
-        /* Other non-space character */
-        else {
-            if (!(esp_gps->asterisk)) {
-                /* Add to CRC */
-                esp_gps->crc ^= (uint8_t)(*d);
-            }
-            /* Add character to item */
-            esp_gps->item_str[esp_gps->item_pos++] = *d;
-            esp_gps->item_str[esp_gps->item_pos] = '\0';
+        esp_gps->cur_statement = entry->statement;
+        /* Parse each item, depend on the type of the statement */
+        for (uint8_t i = 1; i < esp_gps->field_count; ++i) {
+            entry->parse(esp_gps, i, &esp_gps->fields[i]);
+        }
+        esp_gps->parsed_statement |= 1 << entry->statement;
+        /* Check if all statements have been parsed */
+        if (((esp_gps->parsed_statement) & esp_gps->all_statements) ==
+            esp_gps->all_statements) {
+            esp_gps->parsed_statement = 0;
+            esp_gps->parent.sats_in_view = esp_gps->skyview.count;
+            if (esp_gps->skyview_changed) post_skyview(esp_gps);
+            /* Send signal to notify that GPS information has been updated */
+            esp_event_post_to(esp_gps->event_loop_hdl, ESP_NMEA_EVENT, GPS_UPDATE,
+                              &(esp_gps->parent), sizeof(gps_t),
+                              100 / portTICK_PERIOD_MS);
         }
-        /* Process next character */
-        d++;
     }
     return ESP_OK;
 }
@@ -417,6 +687,9 @@ static void esp_handle_uart_pattern(esp_gps_t* esp_gps) {
                                        100 / portTICK_PERIOD_MS);
         /* make sure the line is a standard string */
         esp_gps->buffer[read_len] = '\0';
+        /* the uart is ignored while a source replaces it */
+        if (esp_gps->source) return;
+        if (esp_gps->tap && read_len > 0) esp_gps->tap(esp_gps->tap_arg, (const char*)esp_gps->buffer, read_len);
         /* Send new line to handle */
         if (gps_decode(esp_gps, read_len + 1) != ESP_OK) {
             ESP_LOGW(GPS_TAG, "GPS decode line failed");
@@ -427,6 +700,27 @@ static void esp_handle_uart_pattern(esp_gps_t* esp_gps) {
     }
 }
 
+/**
+ * @brief Decode the lines that are due from the source, it is cleared when it ends
+ *
+ * @param esp_gps esp_gps_t type object
+ */
+static void esp_handle_source(esp_gps_t* esp_gps) {
+    nmea_parser_source_t source = esp_gps->source;
+    for (uint8_t i = 0; source && i < NMEA_SOURCE_BURST; ++i) {
+        int len = source(esp_gps->source_arg, (char*)esp_gps->buffer, NMEA_PARSER_RUNTIME_BUFFER_SIZE - 1);
+        if (len < 0) {
+            ESP_LOGI(GPS_TAG, "Line source ended, back to the uart");
+            esp_gps->source = NULL;
+            uart_flush_input(esp_gps->uart_port);
+            break;
+        }
+        if (len == 0) break;
+        esp_gps->buffer[len] = '\0';
+        gps_decode(esp_gps, len + 1);
+    }
+}
+
 /**
  * @brief NMEA Parser Task Entry
  *
@@ -436,7 +730,7 @@ static void nmea_parser_task_entry(void* arg) {
     esp_gps_t* esp_gps = (esp_gps_t*)arg;
     uart_event_t event;
     while (1) {
-        if (xQueueReceive(esp_gps->event_queue, &event, pdMS_TO_TICKS(200))) {
+        if (xQueueReceive(esp_gps->event_queue, &event, pdMS_TO_TICKS(esp_gps->source ? NMEA_SOURCE_POLL_MS : 200))) {
             switch (event.type) {
                 case UART_DATA:
                     break;
@@ -467,8 +761,12 @@ static void nmea_parser_task_entry(void* arg) {
                     break;
             }
         }
-        /* Drive the event loop */
-        esp_event_loop_run(esp_gps->event_loop_hdl, pdMS_TO_TICKS(50));
+        esp_handle_source(esp_gps);
+        /* Drive the event loop. a run with 0 ticks dispatches one event and doesn't wait, a line posts at most 3.
+           waiting here held up the next uart line: 20 lines/s max, less than a 10 Hz receiver sends */
+        for (uint8_t i = 0; i < 3 * NMEA_SOURCE_BURST; ++i) {
+            esp_event_loop_run(esp_gps->event_loop_hdl, 0);
+        }
     }
     vTaskDelete(NULL);
 }
@@ -509,7 +807,7 @@ nmea_parser_handle_t nmea_parser_init(const nmea_parser_config_t* config) {
         .source_clk = UART_SCLK_DEFAULT,
     };
     if (uart_driver_install(
-            esp_gps->uart_port, CONFIG_NMEA_PARSER_RING_BUFFER_SIZE, 0,
+            esp_gps->uart_port, CONFIG_NMEA_PARSER_RING_BUFFER_SIZE, NMEA_PARSER_TX_BUFFER_SIZE,
             config->uart.event_queue_size, &esp_gps->event_queue, 0) != ESP_OK) {
         ESP_LOGE(GPS_TAG, "install uart driver failed");
         goto err_uart_install;
@@ -518,7 +816,7 @@ nmea_parser_handle_t nmea_parser_init(const nmea_parser_config_t* config) {
         ESP_LOGE(GPS_TAG, "config uart parameter failed");
         goto err_uart_config;
     }
-    if (uart_set_pin(esp_gps->uart_port, UART_PIN_NO_CHANGE, config->uart.rx_pin,
+    if (uart_set_pin(esp_gps->uart_port, config->uart.tx_pin < 0 ? UART_PIN_NO_CHANGE : config->uart.tx_pin, config->uart.rx_pin,
                      UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
         ESP_LOGE(GPS_TAG, "config uart gpio failed");
         goto err_uart_config;
@@ -536,7 +834,7 @@ nmea_parser_handle_t nmea_parser_init(const nmea_parser_config_t* config) {
         goto err_eloop;
     }
     /* Create NMEA Parser task */
-    BaseType_t err = xTaskCreate(nmea_parser_task_entry, "nmea_parser", 3072,
+    BaseType_t err = xTaskCreate(nmea_parser_task_entry, "nmea_parser", 4096,  /* the line source may read files */
                                  esp_gps, 2, &esp_gps->tsk_hdl);
     if (err != pdTRUE) {
         ESP_LOGE(GPS_TAG, "create NMEA Parser task failed");
@@ -610,4 +908,68 @@ esp_err_t nmea_parser_remove_handler(nmea_parser_handle_t nmea_hdl,
     esp_gps_t* esp_gps = (esp_gps_t*)nmea_hdl;
     return esp_event_handler_unregister_with(
         esp_gps->event_loop_hdl, ESP_NMEA_EVENT, ESP_EVENT_ANY_ID, event_handler);
+}
+
+/**
+ * @brief Send a command to the receiver
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param data bytes to send
+ * @param len number of bytes
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_write(nmea_parser_handle_t nmea_hdl, const uint8_t* data, size_t len) {
+    esp_gps_t* esp_gps = (esp_gps_t*)nmea_hdl;
+    if (!esp_gps) return ESP_FAIL;
+    return uart_write_bytes(esp_gps->uart_port, data, len) == (int)len ? ESP_OK : ESP_FAIL;
+}
+
+/**
+ * @brief Change the UART baud rate
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param baud_rate new baud rate
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_set_baudrate(nmea_parser_handle_t nmea_hdl, uint32_t baud_rate) {
+    esp_gps_t* esp_gps = (esp_gps_t*)nmea_hdl;
+    if (!esp_gps) return ESP_FAIL;
+    /* the last command must go out with the old rate */
+    uart_wait_tx_done(esp_gps->uart_port, 200 / portTICK_PERIOD_MS);
+    esp_err_t err = uart_set_baudrate(esp_gps->uart_port, baud_rate);
+    /* what was received with the old rate is garbage now */
+    uart_flush_input(esp_gps->uart_port);
+    return err;
+}
+
+/**
+ * @brief Set the raw line tap, call it before any line arrives
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param tap called on the parser task with every line from the uart, must not block. NULL removes it
+ * @param arg argument of tap
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_set_tap(nmea_parser_handle_t nmea_hdl, nmea_parser_tap_t tap, void* arg) {
+    esp_gps_t* esp_gps = (esp_gps_t*)nmea_hdl;
+    if (!esp_gps) return ESP_FAIL;
+    esp_gps->tap_arg = arg;
+    esp_gps->tap = tap;
+    return ESP_OK;
+}
+
+/**
+ * @brief Replace the uart with a line source (a replayed log), till it returns < 0
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param source called on the parser task for the next line
+ * @param arg argument of source
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error (a source is already running)
+ */
+esp_err_t nmea_parser_set_source(nmea_parser_handle_t nmea_hdl, nmea_parser_source_t source, void* arg) {
+    esp_gps_t* esp_gps = (esp_gps_t*)nmea_hdl;
+    if (!esp_gps || esp_gps->source) return ESP_FAIL;
+    esp_gps->source_arg = arg;
+    esp_gps->source = source;
+    return ESP_OK;
 }
\ No newline at end of file
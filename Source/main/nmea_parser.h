@@ -12,6 +12,8 @@ extern "C" {
 #define CONFIG_NMEA_PARSER_UART_RXD 18
 #define TIME_ZONE (0)
 #define YEAR_BASE (2000)  // date in GPS starts from 2000
+#define GPS_MAX_SATELLITES_IN_VIEW (40)
+#define GPS_MAX_SATELLITES_IN_USE (12)  // per system, in one GSA
 
 /**
  * @brief Declare of NMEA Parser Event base
@@ -39,6 +41,21 @@ typedef enum {
     GPS_MODE_3D           /*!< 3D GPS */
 } gps_fix_mode_t;
 
+/**
+ * @brief GNSS system of a satellite, from the talker ID or the GSA system ID
+ *
+ */
+typedef enum {
+    GPS_SYSTEM_UNKNOWN = 0,
+    GPS_SYSTEM_GPS,     /*!< GP, also SBAS */
+    GPS_SYSTEM_GLONASS, /*!< GL */
+    GPS_SYSTEM_GALILEO, /*!< GA */
+    GPS_SYSTEM_BEIDOU,  /*!< GB, BD */
+    GPS_SYSTEM_QZSS,    /*!< GQ */
+    GPS_SYSTEM_NAVIC,   /*!< GI */
+    GPS_SYSTEM_MAX
+} gps_system_t;
+
 /**
  * @brief GPS satellite information
  *
@@ -48,9 +65,21 @@ typedef struct
     uint8_t num;       /*!< Satellite number */
     uint8_t elevation; /*!< Satellite elevation */
     uint16_t azimuth;  /*!< Satellite azimuth */
-    uint8_t snr;       /*!< Satellite signal noise ratio */
+    uint8_t snr;       /*!< Satellite signal noise ratio, 0 if not tracked */
+    uint8_t system;    /*!< gps_system_t */
+    uint8_t in_use;    /*!< Used in the fix (GSA) */
 } gps_satellite_t;
 
+/**
+ * @brief Satellites in view of all systems, from the last complete GSV cycles
+ *
+ */
+typedef struct
+{
+    uint8_t count;                                       /*!< Valid elements in sats */
+    gps_satellite_t sats[GPS_MAX_SATELLITES_IN_VIEW];  /*!< Satellites */
+} gps_skyview_t;
+
 /**
  * @brief GPS time
  *
@@ -107,7 +136,7 @@ typedef struct
     uint8_t sats_in_view;    /*!< Number of satellites in view */
     gps_date_t date;         /*!< Fix date */
     bool valid;              /*!< GPS validity */
-    float speed;             /*!< Ground speed, unit: m/s */
+    float speed;             /*!< Ground speed, unit: km/h */
     float cog;               /*!< Course over ground */
     float variation;         /*!< Magnetic variation */
 } gps_t;
@@ -122,6 +151,7 @@ typedef struct
     {
         uart_port_t uart_port;        /*!< UART port number */
         uint32_t rx_pin;              /*!< UART Rx Pin number */
+        int32_t tx_pin;               /*!< UART Tx Pin number, -1 if not wired (the receiver can't be configured) */
         uint32_t baud_rate;           /*!< UART baud rate */
         uart_word_length_t data_bits; /*!< UART data bits length */
         uart_parity_t parity;         /*!< UART parity */
@@ -136,6 +166,19 @@ typedef struct
  */
 typedef void* nmea_parser_handle_t;
 
+/**
+ * @brief Raw line tap, gets every line from the uart on the parser task (for a recorder)
+ *
+ */
+typedef void (*nmea_parser_tap_t)(void* arg, const char* line, size_t len);
+
+/**
+ * @brief Line source that replaces the uart (a replayed log)
+ *
+ * @return int length of the line copied to buff (max size), 0 if none is due yet, < 0 at the end
+ */
+typedef int (*nmea_parser_source_t)(void* arg, char* buff, size_t size);
+
 /**
  * @brief Default configuration for NMEA Parser
  *
@@ -145,6 +188,7 @@ typedef void* nmea_parser_handle_t;
         .uart = {                          \
             .uart_port = UART_NUM_1,       \
             .rx_pin = 256,                 \
+            .tx_pin = -1,                  \
             .baud_rate = 9600,             \
             .data_bits = UART_DATA_8_BITS, \
             .parity = UART_PARITY_DISABLE, \
@@ -159,6 +203,7 @@ typedef enum {
     GPS_UPDATE,  /*!< GPS information has been updated */
     GPS_UNKNOWN, /*!< Unknown statements detected */
     GPS_DEBUG,   /*!< Debug information */
+    GPS_SKYVIEW, /*!< Satellites in view have been updated, data is gps_skyview_t */
 } nmea_event_id_t;
 
 /**
@@ -206,6 +251,45 @@ esp_err_t nmea_parser_add_handler(nmea_parser_handle_t nmea_hdl,
 esp_err_t nmea_parser_remove_handler(nmea_parser_handle_t nmea_hdl,
                                      esp_event_handler_t event_handler);
 
+/**
+ * @brief Send a command to the receiver, needs the Tx pin
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param data bytes to send, queued, doesn't wait for the transmission
+ * @param len number of bytes
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_write(nmea_parser_handle_t nmea_hdl, const uint8_t* data, size_t len);
+
+/**
+ * @brief Change the UART baud rate, after the queued bytes are sent
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param baud_rate new baud rate
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_set_baudrate(nmea_parser_handle_t nmea_hdl, uint32_t baud_rate);
+
+/**
+ * @brief Set the raw line tap, call it before any line arrives
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param tap called on the parser task with every line from the uart, must not block. NULL removes it
+ * @param arg argument of tap
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t nmea_parser_set_tap(nmea_parser_handle_t nmea_hdl, nmea_parser_tap_t tap, void* arg);
+
+/**
+ * @brief Replace the uart with a line source (a replayed log), till it returns < 0
+ *
+ * @param nmea_hdl handle of NMEA parser
+ * @param source called on the parser task for the next line
+ * @param arg argument of source
+ * @return esp_err_t ESP_OK on success, ESP_FAIL on error (a source is already running)
+ */
+esp_err_t nmea_parser_set_source(nmea_parser_handle_t nmea_hdl, nmea_parser_source_t source, void* arg);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
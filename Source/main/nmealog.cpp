@@ -0,0 +1,408 @@
+#include "nmealog.hpp"
+#include <string.h>
+
+static size_t put_varint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+    out[n++] = v;
+    return n;
+}
+
+static size_t get_varint(const uint8_t* in, size_t avail, uint32_t& v) {
+    v = 0;
+    for (size_t i = 0; i < avail && i < 5; ++i) {
+        v |= (uint32_t)(in[i] & 0x7f) << (7 * i);
+        if (!(in[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+// uppercase only, so the stripped checksum is put back the same
+static uint8_t hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 0xff;
+}
+
+void NmeaLogCodec::reset() {
+    memset(slot_len, 0, sizeof(slot_len));
+    memset(slot_used, 0, sizeof(slot_used));
+    counter = 0;
+}
+
+// 0 if there are too many fields
+uint8_t NmeaLogCodec::split(const char* s, uint8_t len, const char** fields, uint8_t* lens) {
+    uint8_t n = 0;
+    uint8_t start = 0;
+    for (uint8_t i = 0; i <= len; ++i) {
+        if (i < len && s[i] != ',') continue;
+        if (n >= NMEALOG_FIELDS_MAX) return 0;
+        fields[n] = s + start;
+        lens[n++] = i - start;
+        start = i + 1;
+    }
+    return n;
+}
+
+void NmeaLogCodec::store(uint8_t slot, const char* s, uint8_t len) {
+    memcpy(slots[slot], s, len);
+    slot_len[slot] = len;
+    slot_used[slot] = ++counter;
+}
+
+size_t NmeaLogCodec::encode(uint32_t dt, const char* line, size_t len, uint8_t* out) {
+    uint8_t flags = 0;
+    if (len >= 2 && line[len - 2] == '\r' && line[len - 1] == '\n') {
+        len -= 2;
+        flags |= NMEALOG_CRLF;
+    }
+    if (len >= 4 && line[0] == '$' && line[len - 3] == '*') {
+        uint8_t hi = hex_value(line[len - 2]);
+        uint8_t lo = hex_value(line[len - 1]);
+        uint8_t crc = 0;
+        for (size_t i = 1; i < len - 3; ++i) crc ^= (uint8_t)line[i];
+        if (hi != 0xff && lo != 0xff && ((hi << 4) | lo) == crc) {
+            len -= 3;
+            flags |= NMEALOG_CRC;
+        }
+    }
+    if (len > NMEALOG_LINE_MAX) {
+        len = NMEALOG_LINE_MAX;
+        flags &= ~NMEALOG_CRC;
+    }
+
+    // the most similar earlier line with the same tag (GSV parts and GSA systems have their own slots)
+    const char* fields[NMEALOG_FIELDS_MAX];
+    uint8_t lens[NMEALOG_FIELDS_MAX];
+    const char* ref[NMEALOG_FIELDS_MAX];
+    uint8_t ref_lens[NMEALOG_FIELDS_MAX];
+    uint8_t nf = split(line, len, fields, lens);
+    int best = -1;
+    uint8_t best_eq = 0;
+    for (uint8_t s = 0; s < NMEALOG_SLOTS && nf > 1; ++s) {
+        if (!slot_used[s]) continue;
+        uint8_t rnf = split(slots[s], slot_len[s], ref, ref_lens);
+        if (rnf == 0 || ref_lens[0] != lens[0] || memcmp(ref[0], fields[0], lens[0]) != 0) continue;
+        uint8_t eq = 0;
+        for (uint8_t i = 1; i < nf && i < rnf; ++i) {
+            if (ref_lens[i] == lens[i] && memcmp(ref[i], fields[i], lens[i]) == 0) eq++;
+        }
+        if (best < 0 || eq > best_eq) {
+            best = s;
+            best_eq = eq;
+        }
+    }
+
+    uint8_t payload[NMEALOG_RECORD_MAX];
+    size_t p = 0;
+    uint8_t slot;
+    if (best >= 0) {
+        // mask of the equal fields, then the rest
+        uint8_t rnf = split(slots[best], slot_len[best], ref, ref_lens);
+        uint8_t mask_len = (nf + 7) / 8;
+        payload[p++] = best;
+        payload[p++] = nf;
+        memset(payload + p, 0, mask_len);
+        uint8_t* mask = payload + p;
+        p += mask_len;
+        bool first = true;
+        for (uint8_t i = 0; i < nf; ++i) {
+            if (i < rnf && ref_lens[i] == lens[i] && memcmp(ref[i], fields[i], lens[i]) == 0) {
+                mask[i / 8] |= 1 << (i % 8);
+                continue;
+            }
+            if (!first) payload[p++] = ',';
+            first = false;
+            memcpy(payload + p, fields[i], lens[i]);
+            p += lens[i];
+        }
+    }
+    if (best >= 0 && p < len + 1) {
+        flags |= NMEALOG_DELTA;
+        slot = best;
+    } else {
+        // raw, to an empty or the least recently used slot
+        slot = 0;
+        for (uint8_t s = 1; s < NMEALOG_SLOTS; ++s) {
+            if (slot_used[s] < slot_used[slot]) slot = s;
+        }
+        p = 0;
+        payload[p++] = slot;
+        memcpy(payload + p, line, len);
+        p += len;
+    }
+    store(slot, line, len);
+    size_t n = put_varint(out, dt);
+    n += put_varint(out + n, (p << 3) | flags);
+    memcpy(out + n, payload, p);
+    return n + p;
+}
+
+size_t NmeaLogCodec::decode(const uint8_t* in, size_t avail, uint32_t& dt, char* line, size_t& len) {
+    uint32_t h;
+    size_t n = get_varint(in, avail, dt);
+    if (n == 0) return 0;
+    size_t m = get_varint(in + n, avail - n, h);
+    if (m == 0) return 0;
+    n += m;
+    uint32_t plen = h >> 3;
+    uint8_t flags = h & 7;
+    if (plen < 1 || plen > NMEALOG_RECORD_MAX || avail - n < plen) return 0;
+    const uint8_t* p = in + n;
+    n += plen;
+    uint8_t slot = p[0];
+    if (slot >= NMEALOG_SLOTS) return 0;
+    len = 0;
+    if (flags & NMEALOG_DELTA) {
+        if (!slot_used[slot] || plen < 2) return 0;
+        uint8_t nf = p[1];
+        uint8_t mask_len = (nf + 7) / 8;
+        if (nf == 0 || nf > NMEALOG_FIELDS_MAX || plen < 2u + mask_len) return 0;
+        const uint8_t* mask = p + 2;
+        const char* ch = (const char*)p + 2 + mask_len;
+        const char* ch_end = (const char*)p + plen;
+        const char* ref[NMEALOG_FIELDS_MAX];
+        uint8_t ref_lens[NMEALOG_FIELDS_MAX];
+        uint8_t rnf = split(slots[slot], slot_len[slot], ref, ref_lens);
+        for (uint8_t i = 0; i < nf; ++i) {
+            const char* s;
+            size_t l;
+            if (mask[i / 8] & (1 << (i % 8))) {
+                if (i >= rnf) return 0;
+                s = ref[i];
+                l = ref_lens[i];
+            } else {
+                if (ch > ch_end) return 0;
+                s = ch;
+                while (ch < ch_end && *ch != ',') ch++;
+                l = ch - s;
+                ch++;  // the ','
+            }
+            if (len + l + (i > 0) > NMEALOG_LINE_MAX) return 0;
+            if (i > 0) line[len++] = ',';
+            memcpy(line + len, s, l);
+            len += l;
+        }
+    } else {
+        if (plen - 1 > NMEALOG_LINE_MAX) return 0;
+        memcpy(line, p + 1, plen - 1);
+        len = plen - 1;
+    }
+    store(slot, line, len);
+    if ((flags & NMEALOG_CRC) && len > 0) {
+        static const char hex[] = "0123456789ABCDEF";
+        uint8_t crc = 0;
+        for (size_t i = 1; i < len; ++i) crc ^= (uint8_t)line[i];
+        line[len++] = '*';
+        line[len++] = hex[crc >> 4];
+        line[len++] = hex[crc & 0x0f];
+    }
+    if (flags & NMEALOG_CRLF) {
+        line[len++] = '\r';
+        line[len++] = '\n';
+    }
+    line[len] = 0;
+    return n;
+}
+
+void NmeaLog::ring_read(uint32_t pos, void* out, uint32_t len) {
+    uint32_t at = pos & (NMEALOG_RAM_SIZE - 1);
+    uint32_t first = NMEALOG_RAM_SIZE - at < len ? NMEALOG_RAM_SIZE - at : len;
+    memcpy(out, ring + at, first);
+    memcpy((uint8_t*)out + first, ring, len - first);
+}
+
+void NmeaLog::ring_write(uint32_t pos, const void* in, uint32_t len) {
+    uint32_t at = pos & (NMEALOG_RAM_SIZE - 1);
+    uint32_t first = NMEALOG_RAM_SIZE - at < len ? NMEALOG_RAM_SIZE - at : len;
+    memcpy(ring + at, in, first);
+    memcpy(ring, (const uint8_t*)in + first, len - first);
+}
+
+// gps task. never waits, the line is dropped if the ring is full
+void NmeaLog::tap(void* arg, const char* line, size_t len) {
+    NmeaLog* self = (NmeaLog*)arg;
+    if (!self->rec.load(std::memory_order_relaxed)) return;
+    if (len > NMEALOG_LINE_MAX + 8) len = NMEALOG_LINE_MAX + 8;
+    uint32_t need = 6 + len;
+    uint32_t h = self->head.load(std::memory_order_relaxed);
+    if (NMEALOG_RAM_SIZE - (h - self->tail.load(std::memory_order_acquire)) < need) {
+        self->dropped++;
+        return;
+    }
+    uint32_t ms = self->now();
+    uint16_t l = len;
+    self->ring_write(h, &ms, 4);
+    self->ring_write(h + 4, &l, 2);
+    self->ring_write(h + 6, line, len);
+    self->head.store(h + need, std::memory_order_release);
+}
+
+bool NmeaLog::open_file(uint8_t idx, uint32_t seq, uint32_t start_ms) {
+    if (f) fclose(f);
+    f = fopen(paths[idx], "wb");
+    if (!f) return false;
+    uint8_t hdr[NMEALOG_HEADER_SIZE];
+    memcpy(hdr, NMEALOG_MAGIC, 8);
+    memcpy(hdr + 8, &seq, 4);  // little endian, on the esp and on a pc
+    memcpy(hdr + 12, &start_ms, 4);
+    file_idx = idx;
+    file_seq = seq;
+    enc.reset();
+    if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) {
+        fclose(f);
+        f = nullptr;
+        return false;
+    }
+    file_size = sizeof(hdr);
+    size_total += sizeof(hdr);
+    return true;
+}
+
+bool NmeaLog::start() {
+    if (rec.load() || replay_on.load()) return false;
+    remove(paths[0]);
+    remove(paths[1]);
+    size_total = 0;
+    dropped = 0;
+    last_ms = now();
+    if (!open_file(0, 1, last_ms)) return false;
+    tail.store(head.load());  // what the tap left there from the last recording
+    rec = true;
+    return true;
+}
+
+void NmeaLog::stop() {
+    rec = false;
+    flush();
+    if (f) fclose(f);
+    f = nullptr;
+}
+
+bool NmeaLog::flush() {
+    if (!f) return true;
+    uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    bool ok = true;
+    while (t != h && ok) {
+        uint32_t ms;
+        uint16_t len;
+        char line[NMEALOG_LINE_MAX + 8];
+        uint8_t out[NMEALOG_RECORD_MAX];
+        ring_read(t, &ms, 4);
+        ring_read(t + 4, &len, 2);
+        ring_read(t + 6, line, len);
+        t += 6 + len;
+        uint32_t dt = (int32_t)(ms - last_ms) > 0 ? ms - last_ms : 0;
+        last_ms += dt;
+        size_t n = enc.encode(dt, line, len, out);
+        ok = fwrite(out, 1, n, f) == n;
+        file_size += n;
+        size_total += n;
+        if (ok && file_size >= NMEALOG_FILE_MAX) ok = open_file(file_idx ^ 1, file_seq + 1, last_ms);  // the other one is the older
+    }
+    tail.store(t, std::memory_order_release);
+    if (ok) ok = fflush(f) == 0;
+    if (!ok) {
+        rec = false;
+        if (f) fclose(f);
+        f = nullptr;
+    }
+    return ok;
+}
+
+bool NmeaLog::read_header(const char* path, uint32_t& seq) {
+    FILE* hf = fopen(path, "rb");
+    if (!hf) return false;
+    uint8_t hdr[NMEALOG_HEADER_SIZE];
+    bool ok = fread(hdr, 1, sizeof(hdr), hf) == sizeof(hdr) && memcmp(hdr, NMEALOG_MAGIC, 8) == 0;
+    fclose(hf);
+    if (ok) memcpy(&seq, hdr + 8, 4);
+    return ok;
+}
+
+uint8_t NmeaLog::files(const char* out[2]) {
+    uint32_t seq[2];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < 2; ++i) {
+        if (read_header(paths[i], seq[n])) out[n++] = paths[i];
+    }
+    if (n == 2 && seq[1] < seq[0]) {
+        const char* tmp = out[0];
+        out[0] = out[1];
+        out[1] = tmp;
+    }
+    return n;
+}
+
+bool NmeaLog::replay_start(bool realtime) {
+    if (rec.load() || replay_on.load()) return false;
+    replay_count = files(replay_paths);
+    if (replay_count == 0) return false;
+    replay_idx = 0;
+    rf = nullptr;
+    rbuf_len = 0;
+    rbuf_pos = 0;
+    pending = false;
+    replay_time = 0;
+    replay_realtime = realtime;
+    replay_abort = false;
+    replay_base = now();
+    replay_on = true;
+    return true;
+}
+
+bool NmeaLog::replay_next() {
+    while (true) {
+        if (!rf) {
+            if (replay_idx >= replay_count) return false;
+            rf = fopen(replay_paths[replay_idx++], "rb");
+            rbuf_len = 0;
+            rbuf_pos = 0;
+            continue;
+        }
+        if (rbuf_len - rbuf_pos < NMEALOG_RECORD_MAX) {
+            memmove(rbuf, rbuf + rbuf_pos, rbuf_len - rbuf_pos);
+            rbuf_len -= rbuf_pos;
+            rbuf_pos = 0;
+            rbuf_len += fread(rbuf + rbuf_len, 1, sizeof(rbuf) - rbuf_len, rf);
+        }
+        size_t avail = rbuf_len - rbuf_pos;
+        if (avail >= NMEALOG_HEADER_SIZE && memcmp(rbuf + rbuf_pos, NMEALOG_MAGIC, 8) == 0) {
+            rbuf_pos += NMEALOG_HEADER_SIZE;
+            dec.reset();
+            continue;
+        }
+        uint32_t dt;
+        size_t n = avail ? dec.decode(rbuf + rbuf_pos, avail, dt, pending_line, pending_len) : 0;
+        if (n == 0) {
+            // end of the file, or a record cut by a power off
+            fclose(rf);
+            rf = nullptr;
+            continue;
+        }
+        rbuf_pos += n;
+        replay_time += dt;
+        pending = true;
+        return true;
+    }
+}
+
+// parser task
+int NmeaLog::source(void* arg, char* buff, size_t size) {
+    NmeaLog* self = (NmeaLog*)arg;
+    if (!self->replay_abort.load() && (self->pending || self->replay_next())) {
+        if (self->replay_realtime && (int32_t)(self->now() - self->replay_base - self->replay_time) < 0) return 0;
+        size_t len = self->pending_len < size - 1 ? self->pending_len : size - 1;
+        memcpy(buff, self->pending_line, len);
+        self->pending = false;
+        return (int)len;
+    }
+    if (self->rf) fclose(self->rf);
+    self->rf = nullptr;
+    self->replay_on = false;
+    return -1;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef NMEALOG_HPP
+#define NMEALOG_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+#define NMEALOG_MAGIC "NMEALOG1"          // file header: magic, u32 sequence, u32 start ms (little endian)
+#define NMEALOG_HEADER_SIZE 16
+#define NMEALOG_LINE_MAX 128              // without the checksum and the line end, longer lines are cut. nmea is max 82 with them, u-blox PUBX,00 ~110
+#define NMEALOG_SLOTS 32                  // previous lines kept for the delta encoding, a 1 Hz multi gnss epoch has ~25 different ones
+#define NMEALOG_FIELDS_MAX 40
+#define NMEALOG_RECORD_MAX (NMEALOG_LINE_MAX + 16)
+#define NMEALOG_RAM_SIZE 8192             // gps task -> main loop ring, power of 2. ~3 sec of a 10 Hz receiver
+#define NMEALOG_FILE_MAX (48 * 1024)      // two files, when one is full the older one is overwritten
+#define NMEALOG_FLUSH_MS 1000
+
+typedef uint32_t (*nmealog_now_fn)();  // current time in ms
+
+/*
+    Record format, after the header:
+        varint dt: ms since the previous record (the first one: since the start in the header)
+        varint (payload length << 3 | flags): NMEALOG_DELTA, NMEALOG_CRLF, NMEALOG_CRC
+        payload: slot, then
+            raw: the line
+            delta: field count, bit mask of the fields equal to the line in the slot, then the other fields joined with ','
+        then the line is stored to the slot.
+    The "\r\n" end and a valid uppercase "*XX" checksum are stripped and put back by the decoder, so the replay is byte exact.
+    The magic can't be a valid record (slot 'E' > NMEALOG_SLOTS), so the files can be concatenated.
+*/
+#define NMEALOG_DELTA 1
+#define NMEALOG_CRLF 2
+#define NMEALOG_CRC 4
+
+class NmeaLogCodec {
+   public:
+    void reset();
+    // line as received, returns the record size written to out (NMEALOG_RECORD_MAX)
+    size_t encode(uint32_t dt, const char* line, size_t len, uint8_t* out);
+    // returns the bytes used from in, 0 if it is incomplete or invalid. line needs NMEALOG_LINE_MAX + 8, it is 0 terminated
+    size_t decode(const uint8_t* in, size_t avail, uint32_t& dt, char* line, size_t& len);
+
+   private:
+    uint8_t split(const char* s, uint8_t len, const char** fields, uint8_t* lens);
+    void store(uint8_t slot, const char* s, uint8_t len);
+
+    char slots[NMEALOG_SLOTS][NMEALOG_LINE_MAX];
+    uint8_t slot_len[NMEALOG_SLOTS] = {};
+    uint32_t slot_used[NMEALOG_SLOTS] = {};  // 0: empty, or the counter of the last use
+    uint32_t counter = 0;
+};
+
+/*
+    NMEA recorder and replay.
+    The recording is a tap on the raw lines of the uart (gps task), into a lock free ring, that the owner task (main loop) encodes and appends to the log file with flush(). Two files are used as a ring, so the last ~100 KB is kept.
+    The replay is a line source for the nmea parser: it reads the log (oldest file first), and gives the lines at their recorded times (or as fast as the parser takes them), instead of the uart.
+    Files through stdio, so it runs on the spiffs and on a pc.
+*/
+class NmeaLog {
+   public:
+    NmeaLog(nmealog_now_fn now_fn, const char* path0, const char* path1)
+        : now(now_fn), paths{path0, path1} {}
+
+    // recording. owner task
+    bool start();  // new recording, the old one is deleted. false if it can't write, or replaying
+    void stop();
+    bool flush();  // ring -> file, call it every NMEALOG_FLUSH_MS. false on a write error (the recording stops)
+    bool recording() const { return rec.load(); }
+    uint32_t get_size() const { return size_total; }   // bytes written since the start
+    uint32_t get_dropped() const { return dropped.load(); }  // lines lost, the ring was full
+    static void tap(void* arg, const char* line, size_t len);  // the gps task calls it for every raw line
+
+    // replay. owner starts it, then the parser task pulls the lines with source(), till it returns < 0
+    bool replay_start(bool realtime);  // false if there is no log, or recording
+    void replay_stop() { replay_abort = true; }
+    void replay_cancel() { replay_on = false; }  // replay_start() without the source running
+    bool replaying() const { return replay_on.load(); }
+    static int source(void* arg, char* buff, size_t size);  // line length, 0 if none is due yet, -1 at the end
+
+    uint8_t files(const char* out[2]);  // the recording's files, oldest first. any task, while recording the last record may be cut
+
+   private:
+    bool open_file(uint8_t idx, uint32_t seq, uint32_t start_ms);
+    bool read_header(const char* path, uint32_t& seq);
+    void ring_read(uint32_t pos, void* out, uint32_t len);
+    void ring_write(uint32_t pos, const void* in, uint32_t len);
+    bool replay_next();  // reads the next record into pending
+
+    nmealog_now_fn now;
+    const char* paths[2];
+
+    // recording
+    NmeaLogCodec enc;
+    uint8_t ring[NMEALOG_RAM_SIZE];
+    std::atomic<uint32_t> head{0};  // written by the tap
+    std::atomic<uint32_t> tail{0};  // written by flush
+    std::atomic<bool> rec{false};
+    std::atomic<uint32_t> dropped{0};
+    FILE* f = nullptr;
+    uint8_t file_idx = 0;
+    uint32_t file_seq = 0;
+    uint32_t file_size = 0;
+    uint32_t size_total = 0;
+    uint32_t last_ms = 0;
+
+    // replay, the parser task owns these while replay_on
+    NmeaLogCodec dec;
+    std::atomic<bool> replay_on{false};
+    std::atomic<bool> replay_abort{false};
+    bool replay_realtime = true;
+    FILE* rf = nullptr;
+    const char* replay_paths[2] = {};
+    uint8_t replay_count = 0;
+    uint8_t replay_idx = 0;
+    uint8_t rbuf[NMEALOG_RECORD_MAX * 2];
+    size_t rbuf_len = 0;
+    size_t rbuf_pos = 0;
+    bool pending = false;
+    char pending_line[NMEALOG_LINE_MAX + 8];
+    size_t pending_len = 0;
+    uint32_t replay_time = 0;  // log time of the pending line
+    uint32_t replay_base = 0;  // now() at the start of the replay
+};
+
+#endif  // NMEALOG_HPP
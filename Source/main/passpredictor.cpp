@@ -0,0 +1,105 @@
+#include "passpredictor.hpp"
+#include <math.h>
+#include "esp_log.h"
+
+static const char* TAG = "PassPredictor";
+
+long PassPredictor::key_satnum = 0;
+double PassPredictor::key_epoch = 0;
+double PassPredictor::key_lat = 0;
+double PassPredictor::key_lon = 0;
+double PassPredictor::key_valid_till = 0;
+bool PassPredictor::key_set = false;
+uint32_t PassPredictor::last_request_id = 0;
+
+TaskHandle_t PassPredictor::task_handle = nullptr;
+QueueHandle_t PassPredictor::request_queue = nullptr;
+PassPredictor::request_t PassPredictor::pending;
+PassPredictor::request_t PassPredictor::work;
+PassPredictor::result_t PassPredictor::result{};
+DoubleBuffer<PassPredictor::result_t> PassPredictor::results;
+
+void PassPredictor::init() {
+    request_queue = xQueueCreate(1, sizeof(request_t));
+    xTaskCreate(predictor_task, "passpredict", 4096, NULL, 1, &task_handle);  // lowest prio, it is a long cpu job
+}
+
+bool PassPredictor::read(sat_passes_t& out) {
+    result_t res;
+    if (!results.read(res)) return false;
+    out = res.list;
+    return true;
+}
+
+void PassPredictor::update(const Sgp4& sat, double lat, double lon, double alt, double jd_now) {
+    if (!task_handle) return;
+    result_t res;
+    if (results.read(res) && key_set && res.request_id == last_request_id) key_valid_till = res.valid_till;  // the task answered our last request
+    if (key_set && sat.satrec.satnum == key_satnum && sat.satrec.jdsatepoch == key_epoch &&
+        fabs(lat - key_lat) <= PASS_SITE_TOLERANCE_DEG && fabs(lon - key_lon) <= PASS_SITE_TOLERANCE_DEG &&
+        jd_now < key_valid_till) {
+        return;  // cache is still good
+    }
+    key_set = true;
+    key_satnum = sat.satrec.satnum;
+    key_epoch = sat.satrec.jdsatepoch;
+    key_lat = lat;
+    key_lon = lon;
+    key_valid_till = jd_now + PASS_RETRY_NO_PASS_DAYS;  // till the task answers
+    pending.sat = sat;
+    pending.sat.site(lat, lon, alt);
+    request(&pending.sat, jd_now);
+}
+
+void PassPredictor::clear() {
+    if (!task_handle || !key_set) return;
+    key_set = false;
+    request(nullptr, 0);
+}
+
+void PassPredictor::request(const Sgp4* sat, double jd_now) {
+    pending.jd = jd_now;
+    pending.id = ++last_request_id;
+    pending.clear = (sat == nullptr);
+    xQueueOverwrite(request_queue, &pending);  // drop the not yet started one, it is outdated anyway
+}
+
+void PassPredictor::compute(request_t& req, result_t& res) {
+    res.list = {};
+    res.request_id = req.id;
+    res.valid_till = req.jd + PASS_RETRY_NO_PASS_DAYS;
+    if (req.clear) return;
+    Sgp4& sat = req.sat;
+    if (sat.revpday <= 0) return;
+    // start one orbit back, so a pass in progress is found too
+    if (!sat.initpredpoint(req.jd - 1.0 / sat.revpday, 0.0)) return;
+    passinfo pass;
+    for (uint8_t i = 0; i < PP_SAT_PASS_MAX + 2 && res.list.count < PP_SAT_PASS_MAX; ++i) {
+        if (!sat.nextpass(&pass, PASS_SEARCH_ORBITS)) break;
+        if (pass.jdstop < req.jd) continue;  // already over
+        if (res.list.count == 0) res.valid_till = pass.jdstop;
+        sat_pass_t& p = res.list.passes[res.list.count++];
+        p.aos = getUnixFromJulian(pass.jdstart);
+        p.los = getUnixFromJulian(pass.jdstop);
+        p.max_time = getUnixFromJulian(pass.jdmax);
+        p.max_elevation = pass.maxelevation;
+        p.aos_azimuth = pass.azstart;
+        p.max_azimuth = pass.azmax;
+        p.los_azimuth = pass.azstop;
+    }
+}
+
+void PassPredictor::predictor_task(void* pvParameters) {
+    (void)pvParameters;
+    while (true) {
+        if (xQueueReceive(request_queue, &work, portMAX_DELAY) != pdTRUE) continue;
+        if (!work.clear) {
+            result.list.computing = 1;  // old list till the new is ready
+            results.publish(result);
+        }
+        uint32_t start = xTaskGetTickCount();
+        compute(work, result);
+        results.publish(result);
+        if (!work.clear) ESP_LOGI(TAG, "%s: %d passes in %lu ms", work.sat.satName, result.list.count, (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS));
+    }
+}
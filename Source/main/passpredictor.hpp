@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef PASSPREDICTOR_HPP
+#define PASSPREDICTOR_HPP
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <numbers>  // before Sgp4.h: its pi macro breaks <numbers>, that the c++20 std headers pull in later
+#include "sgp4/Sgp4.h"
+#include "sensorsnapshot.hpp"
+#include "ppi2c/pp_structures.hpp"
+
+#define PASS_SITE_TOLERANCE_DEG 0.1   // ~11 km, site moves less than this won't trigger a recompute
+#define PASS_RETRY_NO_PASS_DAYS 0.25  // if no pass found, try again after this
+#define PASS_SEARCH_ORBITS 48         // orbits to search for the next pass (nextpass itterations)
+
+/*
+    Computes the next PP_SAT_PASS_MAX passes of the tracked satellite on a low priority task, with the library's Brent based nextpass() search.
+    The result is cached, keyed by the tle (sat number + epoch) and the site. It is recomputed only when those change (site with PASS_SITE_TOLERANCE_DEG), or when the first cached pass is over.
+*/
+class PassPredictor {
+   public:
+    static void init();
+    static void update(const Sgp4& sat, double lat, double lon, double alt, double jd_now);  // main loop. cheap, hands the work to the task only when the cache is not valid
+    static void clear();                                                                    // main loop. no satellite loaded
+
+    // any task or irq
+    static bool read(sat_passes_t& out);  // out is left as is when the copy was torn
+    static uint32_t sequence() { return results.sequence(); }
+
+   private:
+    typedef struct
+    {
+        Sgp4 sat;
+        double jd;
+        uint32_t id;
+        bool clear;
+    } request_t;
+
+    typedef struct
+    {
+        sat_passes_t list;
+        double valid_till;  // jd, when the first pass is over (or when to retry if there was none)
+        uint32_t request_id;
+    } result_t;
+
+    static void request(const Sgp4* sat, double jd_now);
+    static void predictor_task(void* pvParameters);
+    static void compute(request_t& req, result_t& res);
+
+    // cache key, main loop only
+    static long key_satnum;
+    static double key_epoch;
+    static double key_lat;
+    static double key_lon;
+    static double key_valid_till;
+    static bool key_set;
+    static uint32_t last_request_id;
+
+    static TaskHandle_t task_handle;
+    static QueueHandle_t request_queue;
+    static request_t pending;  // main loop only, too big for the main task's stack
+    static request_t work;     // predictor task only
+    static result_t result;    // predictor task only
+    static DoubleBuffer<result_t> results;
+};
+
+#endif  // PASSPREDICTOR_HPP
@@ -9,6 +9,7 @@ void PinConfig::saveToNvs() {
     if (err == ESP_OK) {
         nvs_set_i32(nvsHandle, "led_rgb_pin", ledRgbPin);
         nvs_set_i32(nvsHandle, "gps_rx_pin", gpsRxPin);
+        nvs_set_i32(nvsHandle, "gps_tx_pin", gpsTxPin);
         nvs_set_i32(nvsHandle, "i2c_sda_pin", i2cSdaPin);
         nvs_set_i32(nvsHandle, "i2c_scl_pin", i2cSclPin);
         nvs_set_i32(nvsHandle, "ir_rx_pin", irRxPin);
@@ -28,6 +29,7 @@ void PinConfig::loadFromNvs() {
     if (err == ESP_OK) {
         nvs_get_i32(nvsHandle, "led_rgb_pin", &ledRgbPin);
         nvs_get_i32(nvsHandle, "gps_rx_pin", &gpsRxPin);
+        nvs_get_i32(nvsHandle, "gps_tx_pin", &gpsTxPin);
         nvs_get_i32(nvsHandle, "i2c_sda_pin", &i2cSdaPin);
         nvs_get_i32(nvsHandle, "i2c_scl_pin", &i2cSclPin);
         nvs_get_i32(nvsHandle, "ir_rx_pin", &irRxPin);
@@ -47,6 +49,7 @@ void PinConfig::debugPrint() {
     ESP_LOGI("PinConfig", "Current Pin Configuration:");
     ESP_LOGI("PinConfig", "LED RGB Pin: %ld", ledRgbPin);
     ESP_LOGI("PinConfig", "GPS RX Pin: %ld", gpsRxPin);
+    ESP_LOGI("PinConfig", "GPS TX Pin: %ld", gpsTxPin);
     ESP_LOGI("PinConfig", "I2C SDA Pin: %ld", i2cSdaPin);
     ESP_LOGI("PinConfig", "I2C SCL Pin: %ld", i2cSclPin);
     ESP_LOGI("PinConfig", "IR RX Pin: %ld", irRxPin);
@@ -21,8 +21,9 @@ class PinConfig {
      * @param irTx Pin for the IR Transmitter.
      * @param i2cSdaSlave Pin for the I2C SDA (Slave).
      * @param i2cSclSlave Pin for the I2C SCL (Slave).
+     * @param gpsTx Pin for the GPS's rx, only needed to configure the receiver.
      */
-    PinConfig(int32_t ledRgb, int32_t gpsRx, int32_t i2cSda, int32_t i2cScl, int32_t irRx, int32_t irTx, int32_t i2cSdaSlave, int32_t i2cSclSlave) {
+    PinConfig(int32_t ledRgb, int32_t gpsRx, int32_t i2cSda, int32_t i2cScl, int32_t irRx, int32_t irTx, int32_t i2cSdaSlave, int32_t i2cSclSlave, int32_t gpsTx = -1) {
         ledRgbPin = ledRgb;
         gpsRxPin = gpsRx;
         i2cSdaPin = i2cSda;
@@ -31,9 +32,10 @@ class PinConfig {
         irTxPin = irTx;
         i2cSdaSlavePin = i2cSdaSlave;
         i2cSclSlavePin = i2cSclSlave;
+        gpsTxPin = gpsTx;
     };
 
-    void setPins(int32_t ledRgb, int32_t gpsRx, int32_t i2cSda, int32_t i2cScl, int32_t irRx, int32_t irTx, int32_t i2cSdaSlave, int32_t i2cSclSlave) {
+    void setPins(int32_t ledRgb, int32_t gpsRx, int32_t i2cSda, int32_t i2cScl, int32_t irRx, int32_t irTx, int32_t i2cSdaSlave, int32_t i2cSclSlave, int32_t gpsTx) {
         ledRgbPin = ledRgb;
         gpsRxPin = gpsRx;
         i2cSdaPin = i2cSda;
@@ -42,11 +44,13 @@ class PinConfig {
         irTxPin = irTx;
         i2cSdaSlavePin = i2cSdaSlave;
         i2cSclSlavePin = i2cSclSlave;
+        gpsTxPin = gpsTx;
     };
     bool isPinsOk() { return (i2cSdaSlavePin != -1 && i2cSclSlavePin != -1); }  // the bare minimum
 
     int32_t LedRgbPin() { return ledRgbPin; }
     int32_t GpsRxPin() { return gpsRxPin; }
+    int32_t GpsTxPin() { return gpsTxPin; }
     int32_t I2cSdaPin() { return i2cSdaPin; }
     int32_t I2cSclPin() { return i2cSclPin; }
     int32_t IrRxPin() { return irRxPin; }
@@ -60,12 +64,14 @@ class PinConfig {
     void debugPrint();  // print current config to log
 
     bool hasGPS() { return (gpsRxPin < 200); }
+    bool hasGPSTx() { return (gpsTxPin != -1); }
     bool hasIRrx() { return (irRxPin != -1); }
     bool hasIRtx() { return (irTxPin != -1); }
 
    protected:
     int32_t ledRgbPin = -1;  // -1 = not used. this is the rgb led pin. single pin, that uses ledstrip_controller
     int32_t gpsRxPin = 256;  // 256 = not used this it the uart rx port of the esp, where the gps's tx pin is wired.
+    int32_t gpsTxPin = -1;   // -1 = not used this is the uart tx port of the esp, where the gps's rx pin is wired. only needed to set the receiver's rate.
 
     int32_t i2cSdaPin = -1;  // -1 = not used this is the i2c sda pin (master). you'll wire the sda of the sensors here.
     int32_t i2cSclPin = -1;  // -1 = not used this is the i2c scl pin (master). you'll wire the scl of the sensors here.
@@ -38,7 +38,12 @@ static const char PINCONFIG_HTML_PART2[] = R"EOF(" />
             <label for="gpsRxPin">GPS RX Pin:</label>
             <input type="number" min="-1" name="gpsRxPin" id="gpsRxPin" value=")EOF";
 
-// Part 3: Between gpsRxPin and i2cSdaPin
+// Part 2b: Between gpsRxPin and gpsTxPin
+static const char PINCONFIG_HTML_PART2B[] = R"EOF(" />
+            <label for="gpsTxPin">GPS TX Pin:</label>
+            <input type="number" min="-1" name="gpsTxPin" id="gpsTxPin" value=")EOF";
+
+// Part 3: Between gpsTxPin and i2cSdaPin
 static const char PINCONFIG_HTML_PART3[] = R"EOF(" />
         </div>
         <div class="form-section">
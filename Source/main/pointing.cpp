@@ -0,0 +1,72 @@
+#include "pointing.hpp"
+#include <math.h>
+#include "sgp4kernel.hpp"
+
+// the first part of rv2azel(), without the angles
+bool PointingStream::sample(elsetrec& satrec, double jd, double out[3]) {
+    double r[3];
+    double v[3];
+    prop_count++;
+    if (!Sgp4Fast::propagate(whichconst, satrec, (jd - satrec.jdsatepoch) * 1440.0, r, v)) return false;
+    double latr = site_lat * pi / 180.0;
+    double lonr = site_lon * pi / 180.0;
+    double rs[3];
+    double recef[3];
+    double rho[3];
+    double tmp[3];
+    site(latr, lonr, site_alt / 1000.0, rs);
+    teme2ecef(r, jd, recef);
+    for (uint8_t i = 0; i < 3; ++i) rho[i] = recef[i] - rs[i];
+    rot3(rho, lonr, tmp);
+    rot2(tmp, pi * 0.5 - latr, out);
+    return true;
+}
+
+bool PointingStream::fill(elsetrec& satrec, double start) {
+    t0 = start;
+    for (uint8_t k = 0; k < 4; ++k) {
+        if (!sample(satrec, t0 + (k - 1.0) * POINTING_STEP_SEC / 86400.0, s[k])) return false;
+    }
+    return true;
+}
+
+bool PointingStream::get(elsetrec& satrec, double jd, double lat, double lon, double alt, float& az, float& el) {
+    const double step = POINTING_STEP_SEC / 86400.0;
+    if (satrec.satnum != satnum || satrec.jdsatepoch != epoch || fabs(lat - site_lat) > 0.0001 || fabs(lon - site_lon) > 0.0001 || fabs(alt - site_alt) > 10) {
+        valid = false;
+        satnum = satrec.satnum;
+        epoch = satrec.jdsatepoch;
+        site_lat = lat;
+        site_lon = lon;
+        site_alt = alt;
+    }
+    double u = valid ? (jd - t0) / step : -1;
+    if (u >= 1 && u < 2) {
+        // moved to the next interval, only one new sample is needed
+        for (uint8_t k = 0; k < 3; ++k) {
+            s[k][0] = s[k + 1][0];
+            s[k][1] = s[k + 1][1];
+            s[k][2] = s[k + 1][2];
+        }
+        t0 += step;
+        valid = sample(satrec, t0 + 2 * step, s[3]);
+        u -= 1;
+    } else if (u < 0 || u >= 2) {
+        valid = fill(satrec, jd);  // first call, time jump or change
+        u = 0;
+    }
+    if (!valid) return false;
+
+    // lagrange basis for the samples at u = -1, 0, 1, 2
+    double l0 = -u * (u - 1) * (u - 2) / 6.0;
+    double l1 = (u + 1) * (u - 1) * (u - 2) / 2.0;
+    double l2 = -(u + 1) * u * (u - 2) / 2.0;
+    double l3 = (u + 1) * u * (u - 1) / 6.0;
+    double p[3];
+    for (uint8_t i = 0; i < 3; ++i) p[i] = l0 * s[0][i] + l1 * s[1][i] + l2 * s[2][i] + l3 * s[3][i];
+    double rho = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    if (rho <= 0) return false;
+    el = asin(p[2] / rho) * 180.0 / pi;
+    az = floatmod(atan2(p[1], -p[0]) * 180.0 / pi + 360.0, 360.0);
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef POINTING_HPP
+#define POINTING_HPP
+
+#include <stdint.h>
+#include "sgp4/Sgp4.h"
+
+#define POINTING_STEP_SEC 4.0  // spacing of the propagated samples
+#define POINTING_HZ_MIN 5
+#define POINTING_HZ_MAX 20
+#define POINTING_HZ_DEFAULT 10
+
+/*
+    Az / el of one satellite at a high rate, for a rotator.
+    Keeps 4 propagated samples, POINTING_STEP_SEC apart, of the topocentric (sez) vector, and interpolates it with a cubic (lagrange) between the middle two.
+    The vector is interpolated, not the angles, so the azimuth wrap and the pass over the zenith are not a problem.
+    One sgp4 call per POINTING_STEP_SEC in the steady state, the rest is a few multiplications and an atan2 / asin per output.
+*/
+class PointingStream {
+   public:
+    void reset() { valid = false; }  // the samples are dropped anyway on satellite or site change
+
+    // lat, lon in degrees, alt in meters. az, el in degrees. false if the satellite can't be propagated
+    bool get(elsetrec& satrec, double jd, double lat, double lon, double alt, float& az, float& el);
+    uint32_t propagations() const { return prop_count; }  // sgp4 calls so far
+
+   private:
+    bool sample(elsetrec& satrec, double jd, double out[3]);
+    bool fill(elsetrec& satrec, double start);
+
+    gravconsttype whichconst = wgs84;  // same as Sgp4
+    bool valid = false;
+    double t0 = 0;        // jd of s[1], the window is t0 .. t0 + step
+    double s[4][3] = {};  // sez km at t0 - step, t0, t0 + step, t0 + 2 * step
+    long int satnum = 0;  // the samples belong to this satellite and elements
+    double epoch = 0;
+    double site_lat = 0, site_lon = 0, site_alt = 0;
+    uint32_t prop_count = 0;
+};
+
+#endif  // POINTING_HPP
@@ -4,6 +4,13 @@
 #define PPCMD_SATTRACK_DATA 0xa000
 #define PPCMD_SATTRACK_SETSAT 0xa001
 #define PPCMD_SATTRACK_SETMGPS 0xa002
+#define PPCMD_SATTRACK_PASSES 0xa00e
+#define PPCMD_SATTRACK_BATCH 0xa00f
+#define PPCMD_SATTRACK_FIND 0xa010
+#define PPCMD_SATTRACK_DOPPLER 0xa011
+#define PPCMD_SATTRACK_POINTING 0xa012
+// gps
+#define PPCMD_GPS_SKYVIEW 0xa013
 // ir
 #define PPCMD_IRTX_SENDIR 0xa003
 #define PPCMD_IRTX_GETLASTRCVIR 0xa004
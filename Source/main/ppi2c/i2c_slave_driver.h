@@ -50,8 +50,9 @@ typedef enum I2CState {
 //
 // When receiving, data is added to bufend which is incremented, and the user
 // can use the bufstart to remember how much has been processed.
+// buffer size must stay below 256, since bufstart / bufend are uint8_t.
 typedef struct i2c_slave_device_t {
-    uint8_t buffer[128];
+    uint8_t buffer[240];
     uint8_t bufend;
     uint8_t bufstart;
     I2CState state;
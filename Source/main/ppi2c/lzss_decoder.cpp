@@ -0,0 +1,110 @@
+#include "lzss_decoder.hpp"
+#include "esp_attr.h"
+
+uint32_t LzssDecoder::index_blocks(const uint8_t* src_, uint32_t src_size_, uint32_t raw_size_, uint32_t* blocks_, uint32_t max_blocks) {
+    uint32_t sp = 0;
+    uint32_t op = 0;
+    uint32_t count = 0;
+    uint8_t fl = 0;
+    uint8_t fb = 0;
+    while (op < raw_size_) {
+        if ((op & (BLOCK_SIZE - 1)) == 0) {
+            if (count >= max_blocks) return 0;
+            blocks_[count++] = sp;
+            fb = 0;  // every block starts with a new flag byte
+        }
+        if (fb == 0) {
+            if (sp >= src_size_) return 0;
+            fl = src_[sp++];
+            fb = 8;
+        }
+        bool literal = fl & 1;
+        fl >>= 1;
+        fb--;
+        uint32_t len = 1;
+        if (literal) {
+            sp++;
+        } else {
+            if (sp + 2 > src_size_) return 0;
+            uint16_t v = src_[sp] | (src_[sp + 1] << 8);
+            sp += 2;
+            len = (v >> 11) + MIN_MATCH;
+            if ((v & (WINDOW_SIZE - 1)) + 1u > (op & (BLOCK_SIZE - 1))) return 0;  // reaches back into the previous block
+        }
+        if (sp > src_size_ || op / BLOCK_SIZE != (op + len - 1) / BLOCK_SIZE) return 0;  // runs into the next block
+        op += len;
+    }
+    return op == raw_size_ ? count : 0;
+}
+
+void LzssDecoder::reset(const uint8_t* src_, uint32_t src_size_, uint32_t raw_size_, const uint32_t* blocks_) {
+    src = src_;
+    src_size = src_size_;
+    raw_size = raw_size_;
+    blocks = blocks_;
+    restart(0);
+}
+
+void LzssDecoder::restart(uint32_t pos) {
+    uint32_t block = pos / BLOCK_SIZE;
+    src_pos = blocks[block];
+    out_pos = block * BLOCK_SIZE;
+    valid_from = out_pos;
+    flags = 0;
+    flag_bits = 0;
+    match_off = 0;
+    match_len = 0;
+}
+
+IRAM_ATTR bool LzssDecoder::decode_byte(uint8_t& b) {
+    if (match_len == 0) {
+        if ((out_pos & (BLOCK_SIZE - 1)) == 0) flag_bits = 0;  // block start, the rest of the flag byte is unused
+        if (flag_bits == 0) {
+            if (src_pos >= src_size) return false;
+            flags = src[src_pos++];
+            flag_bits = 8;
+        }
+        bool literal = flags & 1;
+        flags >>= 1;
+        flag_bits--;
+        if (literal) {
+            if (src_pos >= src_size) return false;
+            b = src[src_pos++];
+            window[out_pos & (WINDOW_SIZE - 1)] = b;
+            out_pos++;
+            return true;
+        }
+        if (src_pos + 2 > src_size) return false;
+        uint16_t v = src[src_pos] | (src[src_pos + 1] << 8);
+        src_pos += 2;
+        match_off = (v & (WINDOW_SIZE - 1)) + 1;
+        match_len = (v >> 11) + MIN_MATCH;
+    }
+    b = window[(out_pos - match_off) & (WINDOW_SIZE - 1)];
+    match_len--;
+    window[out_pos & (WINDOW_SIZE - 1)] = b;
+    out_pos++;
+    return true;
+}
+
+IRAM_ATTR uint32_t LzssDecoder::read_at(uint32_t pos, uint8_t* out, uint32_t len) {
+    if (!src || pos >= raw_size) return 0;
+    if (len > raw_size - pos) len = raw_size - pos;
+    if (len > WINDOW_SIZE) len = WINDOW_SIZE;  // so the start is still in the window when the end is decoded
+    if (pos < valid_from || pos + WINDOW_SIZE < out_pos || pos / BLOCK_SIZE > out_pos / BLOCK_SIZE) restart(pos);  // not in the window, or a later block: jump there
+    uint8_t b;
+    uint32_t i = 0;
+    for (; i < len; ++i) {
+        uint32_t p = pos + i;
+        if (p < out_pos) {
+            out[i] = window[p & (WINDOW_SIZE - 1)];
+            continue;
+        }
+        while (out_pos < p) {
+            if (!decode_byte(b)) return i;
+        }
+        if (!decode_byte(b)) return i;
+        out[i] = b;
+    }
+    return i;
+}
@@ -0,0 +1,44 @@
+#ifndef LZSS_DECODER_HPP
+#define LZSS_DECODER_HPP
+
+#include <stdint.h>
+
+/*
+    Streaming LZSS decoder for the compressed ext apps (see tools/lzss_extapps.py for the format).
+    Only a window sized ring buffer is kept in RAM, the image is never inflated as a whole.
+    The image is made of BLOCK_SIZE raw byte blocks that don't reference each other, index_blocks() finds where each starts in the compressed data.
+    read_at() is cheap when reading forward, or re-reading anything inside the window (retry of the last block). Any other seek restarts at the start of the block, so one call decodes at most BLOCK_SIZE + len bytes.
+    IRQ safe (no allocation), but not reentrant.
+*/
+class LzssDecoder {
+   public:
+    static constexpr uint16_t WINDOW_SIZE = 2048;  // must be power of 2
+    static constexpr uint16_t BLOCK_SIZE = 4096;   // must be power of 2, and match tools/lzss_extapps.py
+    static constexpr uint8_t MIN_MATCH = 3;
+
+    static uint32_t block_count(uint32_t raw_size_) { return (raw_size_ + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+    static uint32_t index_blocks(const uint8_t* src_, uint32_t src_size_, uint32_t raw_size_, uint32_t* blocks_, uint32_t max_blocks);  // not for the IRQ, walks the whole image. fills the compressed offset of each block, returns the block count, 0 on bad data
+
+    void reset(const uint8_t* src_, uint32_t src_size_, uint32_t raw_size_, const uint32_t* blocks_);  // blocks_ from index_blocks(), must outlive the decoder's use
+    uint32_t read_at(uint32_t pos, uint8_t* out, uint32_t len);                                      // copies the decompressed [pos, pos+len) to out. returns the bytes copied
+    const uint8_t* source() const { return src; }
+
+   private:
+    void restart(uint32_t pos);  // continues decoding from the start of the block of pos
+    bool decode_byte(uint8_t& b);
+
+    const uint8_t* src = nullptr;
+    const uint32_t* blocks = nullptr;
+    uint32_t src_size = 0;
+    uint32_t raw_size = 0;
+    uint32_t src_pos = 0;
+    uint32_t out_pos = 0;     // decompressed bytes so far
+    uint32_t valid_from = 0;  // window holds [max(valid_from, out_pos - WINDOW_SIZE), out_pos)
+    uint8_t flags = 0;
+    uint8_t flag_bits = 0;
+    uint16_t match_off = 0;
+    uint8_t match_len = 0;
+    uint8_t window[WINDOW_SIZE] = {0};
+};
+
+#endif  // LZSS_DECODER_HPP
@@ -1,6 +1,7 @@
 
 #include "pp_handler.hpp"
 #include <cstring>
+#include "esp_rom_crc.h"
 #include "apps/appmanager.hpp"
 #include "pp_commands.hpp"  //for some subcommands
 
@@ -10,11 +11,19 @@ QueueHandle_t PPHandler::slave_queue;
 volatile uint16_t PPHandler::command_state = (uint16_t)Command::COMMAND_NONE;
 volatile uint16_t PPHandler::app_counter = 0;
 volatile uint16_t PPHandler::app_transfer_block = 0;
+volatile uint16_t PPHandler::app_stream_chunk = 0;
+volatile uint16_t PPHandler::app_stream_end = 0;
+volatile bool PPHandler::app_stream_lz = false;
+volatile uint8_t PPHandler::shell_frame_size = PP_SHELL_FRAME_DEFAULT;
+LzssDecoder PPHandler::app_decoder;
+int16_t PPHandler::app_decoder_app = -1;
+uint8_t PPHandler::tx_buffer[PP_I2C_BUFFER_SIZE] = {0};
 get_features_CB PPHandler::features_cb = nullptr;
 get_gps_data_CB PPHandler::gps_data_cb = nullptr;
 get_orientation_data_CB PPHandler::orientation_data_cb = nullptr;
 get_environment_data_CB PPHandler::environment_data_cb = nullptr;
 get_light_data_CB PPHandler::light_data_cb = nullptr;
+get_all_data_CB PPHandler::all_data_cb = nullptr;
 
 get_shell_data_size_CB PPHandler::shell_data_size_cb = nullptr;
 got_shell_data_CB PPHandler::got_shell_data_cb = nullptr;
@@ -23,6 +32,9 @@ get_shutdown_command_CB PPHandler::shutdown_command_cb = nullptr;
 
 std::vector<app_list_element_t> PPHandler::app_list;
 std::vector<pp_custom_command_list_element_t> PPHandler::custom_command_list;
+uint8_t PPHandler::custom_command_dense[PP_CUSTOM_COMMAND_DENSE_SIZE] = {0};
+uint16_t PPHandler::custom_command_sparse_key[PP_CUSTOM_COMMAND_SPARSE_SIZE] = {0};
+uint8_t PPHandler::custom_command_sparse_idx[PP_CUSTOM_COMMAND_SPARSE_SIZE] = {0};
 uint32_t PPHandler::module_version = 1;
 char PPHandler::module_name[20] = "ESP32MODULE";
 
@@ -70,6 +82,10 @@ void PPHandler::set_get_light_data_CB(get_light_data_CB cb) {
     light_data_cb = cb;
 }
 
+void PPHandler::set_get_all_data_CB(get_all_data_CB cb) {
+    all_data_cb = cb;
+}
+
 void PPHandler::set_get_shell_data_size_CB(get_shell_data_size_CB cb) {
     shell_data_size_cb = cb;
 }
@@ -97,28 +113,116 @@ void PPHandler::set_module_version(uint32_t version) {
     module_version = version;
 }
 
-bool PPHandler::add_app(uint8_t* binary, uint32_t size) {
+bool PPHandler::add_app(const uint8_t* binary, uint32_t size) {
     if (size % 32 != 0 || size < sizeof(standalone_app_info)) {
         esp_rom_printf("FAILED ADDING APP, BAD SIZE\n");
         return false;
     }
 
-    app_list.push_back({binary, size});
+    app_list_element_t app = {binary, size, 0, nullptr, {}};
+    std::memcpy(&app.info, binary, sizeof(app.info) - 4);
+    app.info.binary_size = size;
+    app_list.push_back(app);
+    return true;
+}
+
+bool PPHandler::add_app_compressed(const uint8_t* data, uint32_t compressed_size, uint32_t raw_size) {
+    if (raw_size % 32 != 0 || raw_size < sizeof(standalone_app_info) || compressed_size == 0) {
+        esp_rom_printf("FAILED ADDING APP, BAD SIZE\n");
+        return false;
+    }
+
+    // the block index bounds the decoding a seek costs in the isr. apps are never removed, so it is never freed
+    uint32_t block_count = LzssDecoder::block_count(raw_size);
+    uint32_t* blocks = new uint32_t[block_count];
+    app_list_element_t app = {data, raw_size, compressed_size, blocks, {}};
+    app_decoder_app = -1;  // not bound to any app after this
+    if (LzssDecoder::index_blocks(data, compressed_size, raw_size, blocks, block_count) != block_count) {
+        esp_rom_printf("FAILED ADDING APP, BAD COMPRESSED DATA\n");
+        delete[] blocks;
+        return false;
+    }
+    app_decoder.reset(data, compressed_size, raw_size, blocks);
+    if (app_decoder.read_at(0, (uint8_t*)&app.info, sizeof(app.info) - 4) != sizeof(app.info) - 4) {
+        esp_rom_printf("FAILED ADDING APP, BAD COMPRESSED DATA\n");
+        delete[] blocks;
+        return false;
+    }
+    app.info.binary_size = raw_size;
+    app_list.push_back(app);
     return true;
 }
 
-void PPHandler::add_custom_command(uint16_t command, pp_i2c_command got_command, pp_i2c_command send_command) {
-    pp_custom_command_list_element_t element;
-    element.command = command;
-    element.got_command = got_command;
-    element.send_command = send_command;
-    custom_command_list.push_back(element);
+uint32_t PPHandler::read_app(uint16_t index, uint32_t offset, uint8_t* out, uint32_t len) {
+    if (index >= app_list.size()) return 0;
+    const app_list_element_t& app = app_list[index];
+    if (offset >= app.size) return 0;
+    if (app.compressed_size == 0) {
+        len = std::min(len, app.size - offset);
+        memcpy(out, app.binary + offset, len);
+        return len;
+    }
+    if (app_decoder_app != (int16_t)index) {
+        app_decoder.reset(app.binary, app.compressed_size, app.size, app.lz_blocks);
+        app_decoder_app = index;
+    }
+    return app_decoder.read_at(offset, out, len);
+}
+
+static inline uint8_t custom_command_hash(uint16_t command) {
+    return (uint8_t)((command * 40503u) >> 8) & (PP_CUSTOM_COMMAND_SPARSE_SIZE - 1);
+}
+
+bool PPHandler::add_custom_command(uint16_t command, pp_i2c_command got_command, pp_i2c_command send_command) {
+    if (find_custom_command(command)) {
+        esp_rom_printf("FAILED ADDING CUSTOM COMMAND 0x%04x, ALREADY REGISTERED\n", command);
+        return false;
+    }
+    if (custom_command_list.size() >= PP_CUSTOM_COMMAND_MAX) {
+        esp_rom_printf("FAILED ADDING CUSTOM COMMAND 0x%04x, TOO MANY COMMANDS\n", command);
+        return false;
+    }
+    uint8_t idx = custom_command_list.size() + 1;
+    uint16_t dense = command - PP_CUSTOM_COMMAND_BASE;
+    if (dense < PP_CUSTOM_COMMAND_DENSE_SIZE) {
+        custom_command_dense[dense] = idx;
+    } else {
+        uint8_t slot = custom_command_hash(command);
+        uint8_t tries = 0;
+        while (custom_command_sparse_idx[slot] != 0 && tries < PP_CUSTOM_COMMAND_SPARSE_SIZE) {
+            slot = (slot + 1) & (PP_CUSTOM_COMMAND_SPARSE_SIZE - 1);
+            tries++;
+        }
+        if (tries == PP_CUSTOM_COMMAND_SPARSE_SIZE) {
+            esp_rom_printf("FAILED ADDING CUSTOM COMMAND 0x%04x, SPARSE TABLE FULL\n", command);
+            return false;
+        }
+        custom_command_sparse_key[slot] = command;
+        custom_command_sparse_idx[slot] = idx;
+    }
+    custom_command_list.push_back({command, got_command, send_command});
+    return true;
+}
+
+const pp_custom_command_list_element_t* PPHandler::find_custom_command(uint16_t command) {
+    uint16_t dense = command - PP_CUSTOM_COMMAND_BASE;
+    if (dense < PP_CUSTOM_COMMAND_DENSE_SIZE) {
+        uint8_t idx = custom_command_dense[dense];
+        return idx ? &custom_command_list[idx - 1] : nullptr;
+    }
+    uint8_t slot = custom_command_hash(command);
+    for (uint8_t i = 0; i < PP_CUSTOM_COMMAND_SPARSE_SIZE; ++i) {
+        uint8_t idx = custom_command_sparse_idx[slot];
+        if (idx == 0) return nullptr;  // empty slot ends the probe, there is no delete
+        if (custom_command_sparse_key[slot] == command) return &custom_command_list[idx - 1];
+        slot = (slot + 1) & (PP_CUSTOM_COMMAND_SPARSE_SIZE - 1);
+    }
+    return nullptr;
 }
 
 // when pp tx-es to us
-void PPHandler::on_command_ISR(uint16_t command, std::vector<uint8_t> additional_data) {
+void PPHandler::on_command_ISR(uint16_t command, PPSpan& additional_data) {
     command_state = command;
-    bool found = false;
     switch (command) {
         case (uint16_t)Command::COMMAND_APP_INFO:
             if (additional_data.size() == 2)
@@ -132,6 +236,34 @@ void PPHandler::on_command_ISR(uint16_t command, std::vector<uint8_t> additional
             }
             break;
 
+        case (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM:
+        case (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM_LZ:
+            if (additional_data.size() == sizeof(app_stream_request_t)) {
+                app_stream_request_t req;
+                memcpy(&req, additional_data.data(), sizeof(req));
+                app_counter = req.app_index;
+                app_stream_chunk = req.first_chunk;
+                app_stream_end = 0;
+                app_stream_lz = false;
+                if (app_counter < app_list.size()) {
+                    const app_list_element_t& app = app_list[app_counter];
+                    app_stream_lz = command == (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM_LZ && app.compressed_size > 0;
+                    uint32_t size = app_stream_lz ? app.compressed_size : app.size;
+                    uint16_t chunks = (size + PP_APP_STREAM_CHUNK_SIZE - 1) / PP_APP_STREAM_CHUNK_SIZE;
+                    app_stream_end = (req.chunk_count == 0 || req.first_chunk + req.chunk_count > chunks) ? chunks : req.first_chunk + req.chunk_count;
+                }
+            }
+            break;
+
+        case (uint16_t)Command::COMMAND_SHELL_FRAME_SIZE:
+            if (additional_data.size() == 1) {
+                uint8_t size = additional_data[0];
+                if (size == 0) size = PP_SHELL_FRAME_DEFAULT;
+                if (size > PP_SHELL_FRAME_MAX) size = PP_SHELL_FRAME_MAX;
+                shell_frame_size = size;
+            }
+            break;
+
         case (uint16_t)Command::COMMAND_GETFEATURE_MASK:
             break;
 
@@ -147,22 +279,19 @@ void PPHandler::on_command_ISR(uint16_t command, std::vector<uint8_t> additional
             AppManager::handlePPAppmgrCommands(additional_data);
             break;
 
-        default:
-            for (auto element : custom_command_list) {
-                if (element.command == (uint16_t)command) {
-                    if (element.got_command) {
-                        pp_command_data_t data;
-                        data.data = &additional_data;
-                        element.got_command(data);
-                    }
-                    found = true;
-                    break;
+        default: {
+            const pp_custom_command_list_element_t* element = find_custom_command(command);
+            if (element) {
+                if (element->got_command) {
+                    pp_command_data_t data;
+                    data.data = &additional_data;
+                    element->got_command(data);
                 }
-            }
-            if (!found) {
+            } else {
                 AppManager::handlePPData(command, additional_data);
             }
             break;
+        }
     }
 
     BaseType_t high_task_wakeup = pdFALSE;
@@ -176,16 +305,12 @@ bool PPHandler::i2c_slave_callback_ISR(struct i2c_slave_device_t* dev, I2CSlaveC
 
         case I2C_CALLBACK_SEND_DATA:
             if (dev->state == I2C_STATE_SEND) {
-                auto data = on_send_ISR();
+                PPSpan data(tx_buffer, 0, sizeof(tx_buffer));
+                on_send_ISR(data);
 
                 if (data.size() == 0)
                     return false;
 
-                if (data.size() > 128) {
-                    esp_rom_printf("FAILED SENDING DATA. Byte count of %d is exceeding cache size of 128.\n", data.size());
-                    return false;
-                }
-
                 uint8_t len = data.size();
                 i2c_slave_send_data(dev, data.data(), &len);
 
@@ -197,9 +322,15 @@ bool PPHandler::i2c_slave_callback_ISR(struct i2c_slave_device_t* dev, I2CSlaveC
             break;
 
         case I2C_CALLBACK_DONE:
+            if (dev->state == I2C_STATE_SEND) {
+                on_send_done_ISR(dev->bufstart == dev->bufend);
+            }
             if (dev->state == I2C_STATE_RECV) {
+                if (dev->bufend - dev->bufstart < 2)
+                    break;
                 uint16_t command = *(uint16_t*)&dev->buffer[dev->bufstart];
-                std::vector<uint8_t> additional_data(dev->buffer + dev->bufstart + 2, dev->buffer + dev->bufend);
+                uint16_t size = dev->bufend - dev->bufstart - 2;
+                PPSpan additional_data(dev->buffer + dev->bufstart + 2, size, size);
                 on_command_ISR(command, additional_data);
             }
             break;
@@ -210,9 +341,44 @@ bool PPHandler::i2c_slave_callback_ISR(struct i2c_slave_device_t* dev, I2CSlaveC
     return true;
 }
 
-// this handle, when the PP needs data
-std::vector<uint8_t> PPHandler::on_send_ISR() {
-    bool found = false;
+void PPHandler::on_send_done_ISR(bool all_sent) {
+    bool streaming = command_state == (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM || command_state == (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM_LZ;
+    if (streaming && all_sent && app_stream_chunk < app_stream_end) {
+        app_stream_chunk = app_stream_chunk + 1;
+    }
+}
+
+// more data than a frame: poll asap, some data: poll soon, nothing: relax
+uint16_t PPHandler::get_shell_poll_hint(uint16_t size) {
+    if (size > shell_frame_size) return PP_SHELL_POLL_BURST_MS;
+    if (size > 0) return PP_SHELL_POLL_ACTIVE_MS;
+    return PP_SHELL_POLL_IDLE_MS;
+}
+
+void PPHandler::fill_app_stream_chunk(PPSpan& response) {
+    response.resize(sizeof(app_stream_chunk_t));  // zeroes it too
+    app_stream_chunk_t* chunk = (app_stream_chunk_t*)response.data();
+    chunk->chunk = app_stream_chunk;
+    if (app_counter >= app_list.size() || app_stream_chunk >= app_stream_end) {
+        chunk->flags = APP_STREAM_ERROR | APP_STREAM_LAST;
+    } else {
+        const app_list_element_t& app = app_list[app_counter];
+        uint32_t offset = (uint32_t)app_stream_chunk * PP_APP_STREAM_CHUNK_SIZE;
+        if (app_stream_lz) {
+            chunk->len = std::min<uint32_t>(app.compressed_size - offset, PP_APP_STREAM_CHUNK_SIZE);
+            memcpy(chunk->data, app.binary + offset, chunk->len);
+            chunk->flags = APP_STREAM_COMPRESSED;
+        } else {
+            chunk->len = read_app(app_counter, offset, chunk->data, PP_APP_STREAM_CHUNK_SIZE);
+        }
+        if (app_stream_chunk + 1 == app_stream_end)
+            chunk->flags |= APP_STREAM_LAST;
+    }
+    chunk->crc32 = esp_rom_crc32_le(0, response.data(), offsetof(app_stream_chunk_t, crc32));
+}
+
+// this handle, when the PP needs data. everything is written to the preallocated response span, no heap usage here.
+void PPHandler::on_send_ISR(PPSpan& response) {
     switch (command_state) {
         case (uint16_t)Command::COMMAND_INFO: {
             device_info info = {
@@ -221,17 +387,15 @@ std::vector<uint8_t> PPHandler::on_send_ISR() {
                 /* module_name = */ "",
                 /* application_count = */ app_list.size()};
             strncpy(info.module_name, module_name, 20);
-            return std::vector<uint8_t>((uint8_t*)&info, (uint8_t*)&info + sizeof(info));
+            response.assign(info);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_APP_INFO: {
             if (app_counter <= app_list.size() - 1) {
-                standalone_app_info app_info;
-                std::memset(&app_info, 0, sizeof(app_info));
-                std::memcpy(&app_info, app_list[app_counter].binary, sizeof(app_info) - 4);
-                app_info.binary_size = app_list[app_counter].size;
+                response.assign(app_list[app_counter].info);
                 app_counter = app_counter + 1;
-                return std::vector<uint8_t>((uint8_t*)&app_info, (uint8_t*)&app_info + sizeof(app_info));
+                return;
             }
 
             break;
@@ -239,106 +403,151 @@ std::vector<uint8_t> PPHandler::on_send_ISR() {
 
         case (uint16_t)Command::COMMAND_APP_TRANSFER: {
             if (app_counter <= app_list.size() - 1 && app_transfer_block < app_list[app_counter].size / 128) {
-                return std::vector<uint8_t>(app_list[app_counter].binary + app_transfer_block * 128, app_list[app_counter].binary + app_transfer_block * 128 + 128);
+                response.resize(128);
+                read_app(app_counter, app_transfer_block * 128, response.data(), 128);
+                return;
             }
             break;
         }
 
+        case (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM:
+        case (uint16_t)Command::COMMAND_APP_TRANSFER_STREAM_LZ: {
+            fill_app_stream_chunk(response);
+            return;
+        }
+
         case (uint16_t)Command::COMMAND_GETFEATURE_MASK: {
             uint64_t features = 0;
             if (features_cb)
                 features_cb(features);
             else
                 features = app_list.size() > 0 ? (uint64_t)SupportedFeatures::FEAT_EXT_APP : (uint64_t)SupportedFeatures::FEAT_NONE;  // default, only check if ext app added or not
-            return std::vector<uint8_t>((uint8_t*)&features, (uint8_t*)&features + sizeof(features));
+            response.assign(features);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_GETFEAT_DATA_GPS: {
             ppgpssmall_t gpsdata = {};
             if (gps_data_cb)
                 gps_data_cb(gpsdata);
-            return std::vector<uint8_t>((uint8_t*)&gpsdata, (uint8_t*)&gpsdata + sizeof(gpsdata));
+            response.assign(gpsdata);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_GETFEAT_DATA_ORIENTATION: {
             orientation_t ori = {400, 400};  // false data
             if (orientation_data_cb)
                 orientation_data_cb(ori);
-            return std::vector<uint8_t>((uint8_t*)&ori, (uint8_t*)&ori + sizeof(ori));
+            response.assign(ori);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_GETFEAT_DATA_ENVIRONMENT: {
             environment_t env = {};
             if (environment_data_cb)
                 environment_data_cb(env);
-            return std::vector<uint8_t>((uint8_t*)&env, (uint8_t*)&env + sizeof(env));
+            response.assign(env);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_GETFEAT_DATA_LIGHT: {
             uint16_t light = 0;
             if (light_data_cb)
                 light_data_cb(light);
-            return std::vector<uint8_t>((uint8_t*)&light, (uint8_t*)&light + sizeof(light));
+            response.assign(light);
+            return;
+        }
+
+        case (uint16_t)Command::COMMAND_GETFEAT_DATA_ALL: {
+            feat_data_all_t all = {};
+            all.orientation = {400, 400};  // false data
+            if (all_data_cb) {
+                all_data_cb(all);
+            } else {
+                // compose it from the single callbacks
+                if (gps_data_cb) {
+                    gps_data_cb(all.gps);
+                    all.present |= FEAT_DATA_PRESENT_GPS;
+                }
+                if (orientation_data_cb) {
+                    orientation_data_cb(all.orientation);
+                    all.present |= FEAT_DATA_PRESENT_ORIENTATION;
+                }
+                if (environment_data_cb) {
+                    environment_data_cb(all.environment);
+                    all.present |= FEAT_DATA_PRESENT_ENVIRONMENT;
+                }
+                if (light_data_cb) {
+                    light_data_cb(all.light);
+                    all.present |= FEAT_DATA_PRESENT_LIGHT;
+                }
+            }
+            all.version = PP_FEAT_DATA_ALL_VERSION;
+            response.assign(all);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA_SIZE: {
-            uint16_t size = 0;
+            shell_data_size_t size = {0, 0};
             if (shell_data_size_cb)
-                size = shell_data_size_cb();
-            return std::vector<uint8_t>((uint8_t*)&size, (uint8_t*)&size + sizeof(size));
+                size.size = shell_data_size_cb();
+            size.poll_ms = get_shell_poll_hint(size.size);
+            response.assign(size);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_SHELL_MODTOPP_DATA: {
-            std::vector<uint8_t> data;
             if (send_shell_data_cb) {
+                // 0th byte is the header, the callback writes right after it. fixed 1 + frame size byte frame, zero padded
+                uint8_t frame = shell_frame_size;
+                response.resize(1 + frame);
+                PPSpan data(response.data() + 1, 0, frame);
                 bool hasmore = false;
                 send_shell_data_cb(data, hasmore);
                 uint8_t pre = hasmore ? 0x80 : 0x00;
                 pre |= data.size();
-                data.insert(data.begin(), pre);
-                data.resize(65);
-            }
-            if (data.size() == 0) {
-                return {0xFF};
+                response[0] = pre;
+                return;
             }
-            return data;
+            break;
+        }
+
+        case (uint16_t)Command::COMMAND_SHELL_FRAME_SIZE: {
+            uint8_t frame = shell_frame_size;
+            response.assign(frame);
+            return;
         }
 
         case (uint16_t)Command::COMMAND_POWER_OFF: {
-            std::vector<uint8_t> data;
             if (shutdown_command_cb)
-                shutdown_command_cb(data);
-            return data.size() > 0 ? data : std::vector<uint8_t>{0x00};  // if the shutdown command callback return some data, send it. otherwise just send 0xFF as a signal of shutdown command received
-            break;
+                shutdown_command_cb(response);
+            if (response.empty())
+                response.push_back(0x00);  // if the shutdown command callback return some data, send it. otherwise just send 0x00 as a signal of shutdown command received
+            return;
         }
 
         case (uint16_t)PPCMD_APPMGR_APPMGR: {
-            std::vector<uint8_t> data;
-            AppManager::handlePPReqAppmgrCommands(data);
-            return data;
+            AppManager::handlePPReqAppmgrCommands(response);
+            return;
         }
 
-        default:
-            for (auto element : custom_command_list) {
-                if (element.command == (uint16_t)command_state) {
-                    if (element.send_command) {
-                        std::vector<uint8_t> tmp;
-                        pp_command_data_t data = {&tmp};
-                        element.send_command(data);
-                        return tmp;
-                    }
-                    found = true;
-                    break;
+        default: {
+            const pp_custom_command_list_element_t* element = find_custom_command(command_state);
+            if (element) {
+                if (element->send_command) {
+                    pp_command_data_t data = {&response};
+                    element->send_command(data);
+                    return;
                 }
-            }
-            if (!found) {
-                std::vector<uint8_t> tmp;
-                if (AppManager::handlePPReqData(command_state, tmp)) {
-                    return tmp;
+            } else {
+                if (AppManager::handlePPReqData(command_state, response)) {
+                    return;
                 }
+                response.clear();
             }
             break;
+        }
     }
 
-    return {0xFF};
-}
\ No newline at end of file
+    response.push_back(0xFF);
+}
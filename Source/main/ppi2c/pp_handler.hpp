@@ -3,6 +3,7 @@ extern "C" {
 }
 
 #include "pp_structures.hpp"
+#include "lzss_decoder.hpp"
 #include <iostream>
 #include <memory>
 #include <cstring>
@@ -25,20 +26,27 @@ class PPHandler {
     static void set_get_orientation_data_CB(get_orientation_data_CB cb);  // IRQ CALLBACK!  this will be called when the module asked for orientation data
     static void set_get_environment_data_CB(get_environment_data_CB cb);  // IRQ CALLBACK!  this will be called when the module asked for environment data
     static void set_get_light_data_CB(get_light_data_CB cb);              // IRQ CALLBACK!  this will be called when the module asked for light data
+    static void set_get_all_data_CB(get_all_data_CB cb);                  // IRQ CALLBACK!  this will be called when the module asked for all sensor data at once. if not set, the single data callbacks are used
     static void set_get_shell_data_size_CB(get_shell_data_size_CB cb);    // IRQ CALLBACK!  this will be called when the module asked for shell tx data size
     static void set_got_shell_data_CB(got_shell_data_CB cb);              // IRQ CALLBACK!  this will be called when the PP sent data to the shell
     static void set_send_shell_data_CB(send_shell_data_CB cb);            // IRQ CALLBACK!  this will be called when the module needs to send data to the shell (when prev get_shell_data_size_CB give >0 value)
     static void set_shutdown_command_CB(get_shutdown_command_CB cb);      // IRQ CALLBACK!  this will be called when the module needs to handle shutdown command
     static uint32_t get_appCount();                                       // this will return the app count
-    static bool add_app(uint8_t* binary, uint32_t size);                  // this will add an app to the module.app size must be %32 == 0
+    static bool add_app(const uint8_t* binary, uint32_t size);            // this will add an app to the module.app size must be %32 == 0
+    static bool add_app_compressed(const uint8_t* data, uint32_t compressed_size, uint32_t raw_size);  // same as add_app, but with an LZSS compressed image (tools/lzss_extapps.py). raw size must be %32 == 0
 
-    static void add_custom_command(uint16_t command, pp_i2c_command got_command, pp_i2c_command send_command);  // Callbacks are from IRQ! This will add a custom command to the module, see pp_custom_command_list_element_t!
+    static bool add_custom_command(uint16_t command, pp_i2c_command got_command, pp_i2c_command send_command);  // Callbacks are from IRQ! This will add a custom command to the module, see pp_custom_command_list_element_t! Returns false on duplicate or if full. Call before init!
 
    private:
     // base working code
     static bool i2c_slave_callback_ISR(struct i2c_slave_device_t* dev, I2CSlaveCallbackReason reason);
-    static std::vector<uint8_t> on_send_ISR();
-    static void on_command_ISR(uint16_t command, std::vector<uint8_t> additional_data);
+    static void on_send_ISR(PPSpan& response);                             // fills the response. empty response means nothing to send
+    static void on_command_ISR(uint16_t command, PPSpan& additional_data);  // additional_data points into the driver's buffer, valid only during the call
+    static void on_send_done_ISR(bool all_sent);                           // called when a read transaction from the master finished
+    static void fill_app_stream_chunk(PPSpan& response);
+    static uint16_t get_shell_poll_hint(uint16_t size);
+    static const pp_custom_command_list_element_t* find_custom_command(uint16_t command);  // O(1), nullptr if not registered
+    static uint32_t read_app(uint16_t index, uint32_t offset, uint8_t* out, uint32_t len);  // reads the uncompressed app, decompressing if needed
     static uint8_t addr;  // my i2c address
     static i2c_slave_device_t* slave_device;
     static QueueHandle_t slave_queue;
@@ -48,9 +56,21 @@ class PPHandler {
     static volatile uint16_t command_state;  // current command
     static volatile uint16_t app_counter;    // for transfer
     static volatile uint16_t app_transfer_block;
+    static volatile uint16_t app_stream_chunk;  // next chunk to send in COMMAND_APP_TRANSFER_STREAM
+    static volatile uint16_t app_stream_end;    // first chunk not to send
+    static volatile bool app_stream_lz;         // stream the compressed image as is
+    static volatile uint8_t shell_frame_size;   // negotiated COMMAND_SHELL_MODTOPP_DATA payload size
+
+    static LzssDecoder app_decoder;  // only one app is decompressed at a time
+    static int16_t app_decoder_app;  // app index the decoder is set up for. -1 none
+
+    static uint8_t tx_buffer[PP_I2C_BUFFER_SIZE];  // preallocated response storage, so the IRQ path doesn't touch the heap
 
     static std::vector<app_list_element_t> app_list;
     static std::vector<pp_custom_command_list_element_t> custom_command_list;
+    static uint8_t custom_command_dense[PP_CUSTOM_COMMAND_DENSE_SIZE];         // index + 1 in custom_command_list, 0 = none
+    static uint16_t custom_command_sparse_key[PP_CUSTOM_COMMAND_SPARSE_SIZE];  // command, for the ones outside the dense range
+    static uint8_t custom_command_sparse_idx[PP_CUSTOM_COMMAND_SPARSE_SIZE];   // index + 1 in custom_command_list, 0 = empty slot
 
     // callback pointers
     static get_features_CB features_cb;
@@ -58,6 +78,7 @@ class PPHandler {
     static get_orientation_data_CB orientation_data_cb;
     static get_environment_data_CB environment_data_cb;
     static get_light_data_CB light_data_cb;
+    static get_all_data_CB all_data_cb;
     static get_shell_data_size_CB shell_data_size_cb;
     static got_shell_data_CB got_shell_data_cb;
     static send_shell_data_CB send_shell_data_cb;
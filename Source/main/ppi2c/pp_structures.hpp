@@ -2,21 +2,26 @@
 #define PP_STRUCTURES_HPP
 
 #include <cstdint>
-#include <vector>
+#include <cstring>
 
 #define PP_API_VERSION 1
 #define ESP_SLAVE_ADDR 0x51
+#define PP_I2C_BUFFER_SIZE 240  // must match i2c_slave_device_t::buffer
 
 enum class SupportedFeatures : uint64_t {
     FEAT_NONE = 0,
-    FEAT_EXT_APP = 1 << 0,      // provides ext app
-    FEAT_UART = 1 << 1,         // can handle uart commands
-    FEAT_GPS = 1 << 2,          // provides gps info
-    FEAT_ORIENTATION = 1 << 3,  // provides orientation info
-    FEAT_ENVIRONMENT = 1 << 4,  // provides environment info (temp || hum || pressure)
-    FEAT_LIGHT = 1 << 5,        // provides light info (lux)
-    FEAT_DISPLAY = 1 << 6,      // has display to be used by pp
-    FEAT_SHELL = 1 << 7,        // can handle shell commands (polling)
+    FEAT_EXT_APP = 1 << 0,       // provides ext app
+    FEAT_UART = 1 << 1,          // can handle uart commands
+    FEAT_GPS = 1 << 2,           // provides gps info
+    FEAT_ORIENTATION = 1 << 3,   // provides orientation info
+    FEAT_ENVIRONMENT = 1 << 4,   // provides environment info (temp || hum || pressure)
+    FEAT_LIGHT = 1 << 5,         // provides light info (lux)
+    FEAT_DISPLAY = 1 << 6,       // has display to be used by pp
+    FEAT_SHELL = 1 << 7,         // can handle shell commands (polling)
+    FEAT_DATA_ALL = 1 << 8,      // can send all sensor data in one transaction (COMMAND_GETFEAT_DATA_ALL)
+    FEAT_APP_STREAM = 1 << 9,    // can stream ext apps with COMMAND_APP_TRANSFER_STREAM
+    FEAT_APP_LZSS = 1 << 10,     // can stream ext apps LZSS compressed with COMMAND_APP_TRANSFER_STREAM_LZ
+    FEAT_SHELL_FRAME = 1 << 11,  // shell frame size can be set with COMMAND_SHELL_FRAME_SIZE, and DATA_SIZE sends poll hint too
 };
 
 enum class Command : uint16_t {
@@ -38,9 +43,13 @@ enum class Command : uint16_t {
     COMMAND_GETFEAT_DATA_LIGHT,
     // Shell specific communication
     COMMAND_SHELL_PPTOMOD_DATA,       // pp shell to esp. size not defined
-    COMMAND_SHELL_MODTOPP_DATA_SIZE,  // how many bytes the esp has to send to pp's shell
-    COMMAND_SHELL_MODTOPP_DATA,       // the actual bytes sent by esp. 1st byte's 1st bit is the "hasmore" flag, the remaining 7 bits are the size of the data. exactly 64 byte follows.
+    COMMAND_SHELL_MODTOPP_DATA_SIZE,  // how many bytes the esp has to send to pp's shell. see shell_data_size_t, old masters just read the first uint16_t
+    COMMAND_SHELL_MODTOPP_DATA,       // the actual bytes sent by esp. 1st byte's 1st bit is the "hasmore" flag, the remaining 7 bits are the size of the data. exactly frame size (default 64) byte follows.
     COMMAND_POWER_OFF,                // requests power off from the esp, and after it needs a full power cycle to get it back again
+    COMMAND_GETFEAT_DATA_ALL,         // all sensor data in one frame, see feat_data_all_t. Replaces the 4 separate GETFEAT_DATA_* transactions
+    COMMAND_APP_TRANSFER_STREAM,      // v2 app transfer. write app_stream_request_t once, then every read returns the next app_stream_chunk_t
+    COMMAND_APP_TRANSFER_STREAM_LZ,   // same as COMMAND_APP_TRANSFER_STREAM, but the chunks are from the LZSS compressed image (if the app is stored compressed, see APP_STREAM_COMPRESSED)
+    COMMAND_SHELL_FRAME_SIZE,         // write: uint8_t requested shell payload size (1..PP_SHELL_FRAME_MAX). read: uint8_t the size in use
 };
 
 // data structures
@@ -67,7 +76,7 @@ typedef struct
     float altitude;       /*!< Altitude (meters) */
     uint8_t sats_in_use;  /*!< Number of satellites in use */
     uint8_t sats_in_view; /*!< Number of satellites in view */
-    float speed;          /*!< Ground speed, unit: m/s */
+    float speed;          /*!< Ground speed, unit: km/h */
     ppgps_date_t date;    /*!< Fix date */
     ppgps_time_t tim;     /*!< time in UTC */
 } ppgpssmall_t;
@@ -85,6 +94,41 @@ typedef struct
     float pressure;
 } environment_t;
 
+#define PP_FEAT_DATA_ALL_VERSION 1
+
+// bits of feat_data_all_t::present
+enum FeatDataPresence : uint8_t {
+    FEAT_DATA_PRESENT_GPS = 1 << 0,
+    FEAT_DATA_PRESENT_ORIENTATION = 1 << 1,
+    FEAT_DATA_PRESENT_ENVIRONMENT = 1 << 2,
+    FEAT_DATA_PRESENT_LIGHT = 1 << 3,
+};
+
+// COMMAND_GETFEAT_DATA_ALL reply. Fields not flagged in present are zeroed (orientation is 400 like the single command). New fields may only be appended, with a version bump.
+typedef struct
+{
+    uint8_t version;  // PP_FEAT_DATA_ALL_VERSION
+    uint8_t present;  // FeatDataPresence bits
+    uint16_t light;
+    ppgpssmall_t gps;
+    orientation_t orientation;
+    environment_t environment;
+} feat_data_all_t;
+
+// shell
+#define PP_SHELL_FRAME_DEFAULT 64  // what old masters expect
+#define PP_SHELL_FRAME_MAX 127     // the size must fit in the 7 bits of the header byte
+#define PP_SHELL_POLL_BURST_MS 5   // poll hints, see shell_data_size_t
+#define PP_SHELL_POLL_ACTIVE_MS 20
+#define PP_SHELL_POLL_IDLE_MS 250
+
+// COMMAND_SHELL_MODTOPP_DATA_SIZE reply
+typedef struct
+{
+    uint16_t size;     // bytes waiting to be sent to the pp
+    uint16_t poll_ms;  // suggested time till the next poll. short while a burst drains, long when idle
+} shell_data_size_t;
+
 typedef struct
 {
     float azimuth;
@@ -102,8 +146,141 @@ typedef struct
     float lat;
     float lon;
     uint8_t time_method;
+    uint8_t visibility;  // sat_visibility_t
+    uint16_t sunlit;     // sunlit part of the satellite 0..1000, also when not visible
+    float sun_azimuth;   // at the site, degrees
+    float sun_elevation;
 } sattrackdata_t;
 
+// sattrackdata_t visibility of the tracked satellite
+enum sat_visibility_t : uint8_t {
+    SAT_VIS_UNKNOWN = 0,  // no satellite, location or time
+    SAT_VIS_UNDER_HORIZON = 1,
+    SAT_VIS_DAYLIGHT = 2,  // above the horizon, but the sky is too bright (sun above -6 degrees)
+    SAT_VIS_ECLIPSED = 3,  // above the horizon, dark sky, in the earth's shadow
+    SAT_VIS_VISIBLE = 4,   // above the horizon, dark sky, sunlit
+};
+
+#define PP_SAT_PASS_MAX 8  // sat_passes_t must fit in PP_I2C_BUFFER_SIZE
+
+// one predicted pass of the tracked satellite. times are unix utc seconds, angles in degrees
+typedef struct
+{
+    uint32_t aos;
+    uint32_t los;
+    uint32_t max_time;
+    float max_elevation;
+    float aos_azimuth;
+    float max_azimuth;
+    float los_azimuth;
+} sat_pass_t;
+
+// PPCMD_SATTRACK_PASSES reply
+typedef struct
+{
+    uint8_t count;      // valid elements in passes, the first is the next (or the current) pass
+    uint8_t computing;  // 1 while the list is being recomputed (tle or location changed)
+    uint16_t reserved;
+    sat_pass_t passes[PP_SAT_PASS_MAX];
+} sat_passes_t;
+
+#define PP_SAT_BATCH_MAX 8  // sat_batch_list_t must fit in PP_I2C_BUFFER_SIZE
+#define SAT_BATCH_NAME_LEN 16
+
+typedef struct
+{
+    char name[SAT_BATCH_NAME_LEN];  // zero terminated, cut if longer
+    float azimuth;
+    float elevation;  // > 0 if visible now
+    uint32_t aos;     // unix utc seconds of the next rise if not visible, 0 if not known (yet)
+} sat_batch_entry_t;
+
+// PPCMD_SATTRACK_BATCH reply
+typedef struct
+{
+    uint8_t count;  // valid elements in sats. visible ones first by elevation, then the next rising ones
+    uint8_t total;  // satellites tracked
+    uint16_t reserved;
+    sat_batch_entry_t sats[PP_SAT_BATCH_MAX];
+} sat_batch_list_t;
+
+// PPCMD_SATTRACK_DOPPLER request, the frequencies the shifts are computed for. 0 if not used
+typedef struct
+{
+    uint32_t downlink_hz;
+    uint32_t uplink_hz;
+} sat_doppler_set_t;
+
+// PPCMD_SATTRACK_DOPPLER reply. updated every 250 ms while the pp queries it
+typedef struct
+{
+    uint32_t sequence;       // changes on every update
+    uint32_t timestamp;      // unix utc seconds of the computation
+    uint32_t downlink_hz;
+    uint32_t uplink_hz;
+    int32_t downlink_shift;  // receive on downlink_hz + downlink_shift
+    int32_t uplink_shift;    // transmit on uplink_hz + uplink_shift, so the satellite receives uplink_hz
+    float range;             // km
+    float range_rate;        // km/s, > 0 when moving away
+    uint8_t valid;           // 0 if no satellite, location or time
+    uint8_t reserved[3];
+} sat_doppler_t;
+
+// PPCMD_SATTRACK_POINTING request
+typedef struct
+{
+    uint8_t rate_hz;  // 5..20, clamped
+    uint8_t reserved[3];
+} sat_pointing_set_t;
+
+// PPCMD_SATTRACK_POINTING reply. interpolated az / el of the tracked satellite, updated at rate_hz while the pp queries it
+typedef struct
+{
+    uint32_t sequence;   // changes on every update
+    uint32_t timestamp;  // unix utc seconds of the position
+    uint16_t millis;     // sub second part of the timestamp
+    uint8_t valid;       // 0 if no satellite, location or time
+    uint8_t rate_hz;
+    float azimuth;
+    float elevation;
+} sat_pointing_t;
+
+#define PP_SAT_FIND_MAX 7  // sat_find_result_t must fit in PP_I2C_BUFFER_SIZE
+#define SAT_FIND_PREFIX_LEN 16
+#define SAT_FIND_NAME_LEN 28
+
+// PPCMD_SATTRACK_FIND reply. the request is the zero terminated prefix
+typedef struct
+{
+    uint8_t count;   // valid elements in names, sorted by name
+    uint8_t done;    // 0 while the search for prefix is pending
+    uint16_t reserved;
+    char prefix[SAT_FIND_PREFIX_LEN];  // the result belongs to this prefix
+    char names[PP_SAT_FIND_MAX][SAT_FIND_NAME_LEN];
+} sat_find_result_t;
+
+#define PP_SKYVIEW_MAX 40  // gps_skyview_frame_t must fit in PP_I2C_BUFFER_SIZE
+
+// one satellite of the gps sky view
+typedef struct
+{
+    uint8_t num;        // satellite number, as in the nmea
+    uint8_t flags;      // bits 0-2: gps_system_t, bit 7: used in the fix
+    uint8_t elevation;  // degrees
+    uint8_t azimuth;    // degrees / 2
+    uint8_t snr;        // dB-Hz, 0 if not tracked
+} gps_sky_sat_t;
+
+// PPCMD_GPS_SKYVIEW reply, also the GOTSKYVIEW websocket message after its prefix (only count sats)
+typedef struct
+{
+    uint32_t sequence;  // changes on every update
+    uint8_t count;      // valid elements in sats
+    uint8_t in_use;     // of them used in the fix
+    uint16_t reserved;
+    gps_sky_sat_t sats[PP_SKYVIEW_MAX];
+} gps_skyview_frame_t;
+
 typedef struct
 {
     uint32_t api_version;
@@ -132,13 +309,100 @@ typedef struct
 
 typedef struct
 {
-    uint8_t* binary;
-    uint32_t size;
+    const uint8_t* binary;      // raw, or LZSS compressed image
+    uint32_t size;              // uncompressed size
+    uint32_t compressed_size;   // 0 if binary is not compressed
+    const uint32_t* lz_blocks;  // offset of each LzssDecoder::BLOCK_SIZE block in the compressed image, nullptr if not compressed
+    standalone_app_info info;   // header copy, so app info doesn't need decompression
 } app_list_element_t;
 
+// v2 app transfer. The cursor advances when the master clocked out the whole chunk, the slave can't tell if the bytes arrived intact.
+// A read stopped early gives the same chunk again. After a bad crc the master must write app_stream_request_t again with first_chunk set to the failed chunk, reading again would return the next one.
+#define PP_APP_STREAM_CHUNK_SIZE 224  // 7 * 32, app binaries are always %32
+
+typedef struct
+{
+    uint16_t app_index;
+    uint16_t first_chunk;
+    uint16_t chunk_count;  // 0 = till the end of the app
+} app_stream_request_t;
+
+enum AppStreamFlags : uint8_t {
+    APP_STREAM_LAST = 1 << 0,        // this is the last chunk of the requested range
+    APP_STREAM_ERROR = 1 << 1,       // bad request, or read after the last chunk. no data
+    APP_STREAM_COMPRESSED = 1 << 2,  // data is from the LZSS compressed image (tools/lzss_extapps.py has the format)
+};
+
+typedef struct
+{
+    uint16_t chunk;  // chunk index, chunk * PP_APP_STREAM_CHUNK_SIZE is the offset in the binary (or in the compressed image)
+    uint16_t len;    // valid bytes in data
+    uint8_t flags;   // AppStreamFlags
+    uint8_t reserved[3];
+    uint8_t data[PP_APP_STREAM_CHUNK_SIZE];  // zero padded after len
+    uint32_t crc32;                          // esp_rom_crc32_le(0, ...) of all the bytes before this field
+} app_stream_chunk_t;
+
+// Non owning, fixed capacity byte span. Used on the IRQ path instead of std::vector, so no heap allocation happens there.
+// The storage is preallocated by the owner (PPHandler uses a static buffer of PP_I2C_BUFFER_SIZE bytes, or the received bytes in the i2c driver's buffer).
+// resize() never grows beyond capacity, it returns false instead.
+class PPSpan {
+   public:
+    PPSpan()
+        : buf(nullptr), len(0), cap(0) {}
+    PPSpan(uint8_t* data, uint16_t size, uint16_t capacity)
+        : buf(data), len(size), cap(capacity) {}
+
+    uint8_t* data() { return buf; }
+    const uint8_t* data() const { return buf; }
+    uint16_t size() const { return len; }
+    uint16_t capacity() const { return cap; }
+    bool empty() const { return len == 0; }
+
+    bool resize(uint16_t size) {
+        if (size > cap) return false;
+        if (size > len) memset(buf + len, 0, size - len);
+        len = size;
+        return true;
+    }
+    void clear() { len = 0; }
+    bool push_back(uint8_t b) {
+        if (len >= cap) return false;
+        buf[len++] = b;
+        return true;
+    }
+    // appends raw bytes. returns false (and appends nothing) if it would overflow
+    bool append(const void* src, uint16_t size) {
+        if (size > cap - len) return false;
+        memcpy(buf + len, src, size);
+        len += size;
+        return true;
+    }
+    // takes size bytes, that the caller wrote in place after the end, like append() without the copy. returns false (and takes nothing) if it would overflow
+    bool commit(uint16_t size) {
+        if (size > cap - len) return false;
+        len += size;
+        return true;
+    }
+    // replaces the content with the given object's bytes
+    template <typename T>
+    bool assign(const T& obj) {
+        len = 0;
+        return append(&obj, sizeof(T));
+    }
+    uint8_t& operator[](uint16_t i) { return buf[i]; }
+    uint8_t operator[](uint16_t i) const { return buf[i]; }
+    uint8_t at(uint16_t i) const { return i < len ? buf[i] : 0; }
+
+   private:
+    uint8_t* buf;
+    uint16_t len;
+    uint16_t cap;
+};
+
 typedef struct
 {
-    std::vector<uint8_t>* data;
+    PPSpan* data;
 } pp_command_data_t;
 
 typedef void (*pp_i2c_command)(pp_command_data_t data);
@@ -150,6 +414,12 @@ typedef struct
     pp_i2c_command send_command;
 } pp_custom_command_list_element_t;
 
+// custom command lookup. commands in the 0xa0xx range (see pp_commands.hpp) are in a direct table, others in a small open addressing hash
+#define PP_CUSTOM_COMMAND_BASE 0xa000
+#define PP_CUSTOM_COMMAND_DENSE_SIZE 256
+#define PP_CUSTOM_COMMAND_SPARSE_SIZE 32  // power of 2
+#define PP_CUSTOM_COMMAND_MAX 255         // list index must fit in uint8_t
+
 // callback typedefs
 
 typedef void (*get_features_CB)(uint64_t& feat);
@@ -157,8 +427,9 @@ typedef void (*get_gps_data_CB)(ppgpssmall_t& gpsdata);
 typedef void (*get_orientation_data_CB)(orientation_t& gpsdata);
 typedef void (*get_environment_data_CB)(environment_t& envdata);
 typedef void (*get_light_data_CB)(uint16_t& light);
+typedef void (*get_all_data_CB)(feat_data_all_t& data);  // fill the data fields and the present bits. version is set by the handler
 typedef uint16_t (*get_shell_data_size_CB)();                                   // this wil be called when PP request MOD to send how many bytes it has in the outgoing (to shell) tx buffer. IRQ
-typedef void (*got_shell_data_CB)(std::vector<uint8_t>& data);                  // this wil be called when got shell data from pp. IRQ
-typedef void (*send_shell_data_CB)(std::vector<uint8_t>& data, bool& hasmore);  // this will be called when the module needs to send serial data to pp. Just pass the data, and set the hasmore. NO 0th byte set needed. IRQ
-typedef void (*get_shutdown_command_CB)(std::vector<uint8_t>& data);            // this will be called when got shutdown command from pp. IRQ
+typedef void (*got_shell_data_CB)(PPSpan& data);                  // this wil be called when got shell data from pp. IRQ
+typedef void (*send_shell_data_CB)(PPSpan& data, bool& hasmore);  // this will be called when the module needs to send serial data to pp. Just pass the data, and set the hasmore. NO 0th byte set needed. IRQ
+typedef void (*get_shutdown_command_CB)(PPSpan& data);            // this will be called when got shutdown command from pp. IRQ
 #endif
\ No newline at end of file
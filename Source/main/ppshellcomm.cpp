@@ -4,7 +4,7 @@
 #define USB_DEVICE_PID (0x6018)
 #define TAG "PPShellComm"
 
-bool ws_sendall(uint8_t* data, size_t len);
+bool ws_sendall(uint8_t* data, size_t len, bool asyncmsg);
 
 bool (*PPShellComm::data_rx_callback)(const uint8_t* data, size_t data_len) = nullptr;
 
@@ -17,44 +17,99 @@ bool PPShellComm::isMuted = false;
 
 SendBuffer PPShellComm::send_buffer;
 QueueHandle_t PPShellComm::datain_queue;
-I2CQueueMessage_t PPShellComm::tx;
+SpscRing<SHELL_TX_RING_SIZE> PPShellComm::tx_ring;
+SemaphoreHandle_t PPShellComm::tx_write_mutex;
+SemaphoreHandle_t PPShellComm::tx_space_sem;
+QueueHandle_t PPShellComm::tx_job_queue;
 
 void PPShellComm::init() {
     datain_queue = xQueueCreate(QUEUE_SIZE, sizeof(I2CQueueMessage_t));
+    tx_write_mutex = xSemaphoreCreateMutex();
+    tx_space_sem = xSemaphoreCreateBinary();
+    tx_job_queue = xQueueCreate(SHELL_TX_JOB_QUEUE_SIZE, sizeof(ShellTxJob_t));
     // i2c rx handler init
     xTaskCreate(processi2c_queuein_task, "i2crxinth", 4096, xTaskGetCurrentTaskHandle(), 20, NULL);
+    xTaskCreate(shell_tx_task, "shelltx", 3072, NULL, 5, NULL);
 }
 
 bool PPShellComm::write(const uint8_t* data, size_t len, bool mute, bool buffer) {
-    if (i2c_connected) {
-        tx.size = len;
-        ESP_LOGE(TAG, "i2c write");
-        if (len > 64) {
-            ESP_LOGE(TAG, "Data too big for I2C");
-            return false;
-        }
-        memcpy(tx.data, data, len);  // todo fix for real, buffered write
-        inCommand = true;
-        return true;
+    if (!i2c_connected) return false;
+    if (len > tx_ring.capacity()) {
+        ESP_LOGE(TAG, "Data too big for I2C buffer");
+        return false;
     }
-    return false;
+    xSemaphoreTake(tx_write_mutex, portMAX_DELAY);
+    bool ok = tx_ring.push(data, len);
+    xSemaphoreGive(tx_write_mutex);
+    if (ok) inCommand = true;
+    return ok;
 }
+
 bool PPShellComm::write_blocking(const uint8_t* data, size_t len, bool mute, bool buffer) {
-    if (i2c_connected) {
-        tx.size = len;
-        if (len > 64) {
-            ESP_LOGE(TAG, "Data too big for I2C");
-            return false;
+    if (!i2c_connected) return false;
+    TickType_t start = xTaskGetTickCount();
+    xSemaphoreTake(tx_write_mutex, portMAX_DELAY);  // so the parts of a big write stay together
+    while (len > 0) {
+        uint32_t part = tx_ring.space();
+        if (part > len) part = len;
+        if (part > 0 && tx_ring.push(data, part)) {
+            data += part;
+            len -= part;
+            inCommand = true;
+            continue;
+        }
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (!i2c_connected || waited >= pdMS_TO_TICKS(SHELL_WRITE_BLOCK_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "I2C shell write timeout");
+            break;
+        }
+        xSemaphoreTake(tx_space_sem, pdMS_TO_TICKS(SHELL_WRITE_BLOCK_TIMEOUT_MS) - waited);
+    }
+    xSemaphoreGive(tx_write_mutex);
+    return len == 0;
+}
+
+bool PPShellComm::write_queued(uint8_t* data, size_t len) {
+    if (!i2c_connected) return false;
+    ShellTxJob_t job = {data, len};
+    return xQueueSend(tx_job_queue, &job, 0) == pdTRUE;
+}
+
+// does the blocking writes for write_queued, in order. a write the pp didn't take in time is reported to the web
+void PPShellComm::shell_tx_task(void* pvParameters) {
+    (void)pvParameters;
+    ShellTxJob_t job;
+    while (1) {
+        if (xQueueReceive(tx_job_queue, &job, portMAX_DELAY)) {
+            bool ok = write_blocking(job.data, job.len, false, true);
+            free(job.data);
+            if (!ok) {
+                char* data = (char*)"#$##$$#SHELLBUSY\r\n";
+                ws_sendall((uint8_t*)data, 18, false);
+            }
         }
-        memcpy(tx.data, data, len);  // todo fix for real buffered blocking write
-        return true;
     }
-    return false;
 }
 
 bool PPShellComm::wait_till_sending(uint32_t timeoutMs) {
-    // todo i2c send wait, but hey, we should not send to i2c!!! check this
-    return false;
+    if (!i2c_connected) return false;
+    TickType_t start = xTaskGetTickCount();
+    while (tx_ring.size() > 0) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (waited >= pdMS_TO_TICKS(timeoutMs)) return false;
+        xSemaphoreTake(tx_space_sem, pdMS_TO_TICKS(timeoutMs) - waited);
+    }
+    return true;
+}
+
+uint32_t PPShellComm::read_i2c_tx_queue_ISR(uint8_t* out, uint32_t max) {
+    uint32_t len = tx_ring.pop(out, max);
+    if (len > 0 && tx_space_sem) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(tx_space_sem, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    return len;
 }
 
 void PPShellComm::processi2c_queuein_task(void* pvParameters) {
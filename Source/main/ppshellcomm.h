@@ -11,6 +11,9 @@
 #define PPSHELLCOMM_H
 
 #define QUEUE_SIZE 50
+#define SHELL_TX_RING_SIZE 4096          // esp -> pp shell buffer, power of 2
+#define SHELL_WRITE_BLOCK_TIMEOUT_MS 3000  // write_blocking gives up after this, if the pp doesn't poll
+#define SHELL_TX_JOB_QUEUE_SIZE 8          // write_queued jobs waiting for the writer task
 
 #include <inttypes.h>
 #include <stdio.h>
@@ -24,6 +27,8 @@
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "spscring.hpp"
+#include "ppi2c/pp_structures.hpp"
 
 typedef struct
 {
@@ -34,16 +39,23 @@ typedef struct
 
 typedef struct
 {
-    uint8_t size;      // Actual data size (1-64 bytes)
-    uint8_t data[64];  // Fixed 64-byte buffer
+    uint8_t* data;  // malloc-ed, the writer task frees it
+    size_t len;
+} ShellTxJob_t;
+
+typedef struct
+{
+    uint8_t size;                      // Actual data size (1-PP_SHELL_FRAME_MAX bytes)
+    uint8_t data[PP_SHELL_FRAME_MAX];  // Fixed buffer, max shell frame size. a bigger write from the pp is queued in more messages
 } I2CQueueMessage_t;
 
 class PPShellComm {
    public:
     static void init();
-    static bool write(const uint8_t* data, size_t len, bool mute, bool buffer);
-    static bool write_blocking(const uint8_t* data, size_t len, bool mute, bool buffer);
-    static bool wait_till_sending(uint32_t timeoutMs);
+    static bool write(const uint8_t* data, size_t len, bool mute, bool buffer);           // non blocking. all or nothing, false if there is no room (backpressure)
+    static bool write_blocking(const uint8_t* data, size_t len, bool mute, bool buffer);  // waits for room (max SHELL_WRITE_BLOCK_TIMEOUT_MS), can be bigger than the buffer
+    static bool write_queued(uint8_t* data, size_t len);                                  // non blocking, for the httpd task. takes the malloc-ed data on success, a task does the write_blocking. false if too many writes are waiting
+    static bool wait_till_sending(uint32_t timeoutMs);                                    // waits till the pp fetched everything. true if the tx buffer is empty
     static bool getInCommand() { return inCommand; }
     static uint8_t getAnyConnected() {
         uint8_t ret = 0;
@@ -60,15 +72,11 @@ class PPShellComm {
         inCommand = false;
     }
 
-    static uint16_t get_i2c_tx_queue_size() {
-        return tx.size;
-    }
-    static uint8_t* get_i2c_tx_queue_data() {
-        return tx.data;
-    }
-    static void clear_tx_queue() {
-        tx.size = 0;
+    static uint16_t get_i2c_tx_queue_size() {  // IRQ safe
+        uint32_t size = tx_ring.size();
+        return size > 0xFFFF ? 0xFFFF : size;
     }
+    static uint32_t read_i2c_tx_queue_ISR(uint8_t* out, uint32_t max);  // IRQ! the only consumer of the tx buffer
 
     static QueueHandle_t datain_queue;
     static QueueHandle_t dataout_queue;
@@ -76,6 +84,7 @@ class PPShellComm {
    private:
     static void searchPromptAdd(uint8_t ch);
     static void processi2c_queuein_task(void* pvParameters);
+    static void shell_tx_task(void* pvParameters);
 
     static bool i2c_connected;
     static bool (*data_rx_callback)(const uint8_t* data, size_t data_len);
@@ -87,7 +96,10 @@ class PPShellComm {
 
     static SendBuffer send_buffer;
 
-    static I2CQueueMessage_t tx;
+    static SpscRing<SHELL_TX_RING_SIZE> tx_ring;  // producer: writers (serialized by tx_write_mutex), consumer: the i2c irq
+    static SemaphoreHandle_t tx_write_mutex;
+    static SemaphoreHandle_t tx_space_sem;  // given by the irq when it consumed data, so blocked writers can retry
+    static QueueHandle_t tx_job_queue;      // ShellTxJob_t for shell_tx_task
 };
 
 #endif  // PPSHELLCOMM_H
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "satbatch.hpp"
+#include "sgp4kernel.hpp"
+#include <algorithm>
+#include <string.h>
+#include "esp_log.h"
+
+static const char* TAG = "SatBatch";
+
+// aos values: > 0 jd of the next rise, 0 not searched yet, < 0 no rise till -aos (jd)
+
+bool SatBatch::load(TleDb& db, uint16_t max) {
+    clear();
+    tle_db_record_t rec;
+    for (uint32_t i = 0; i < db.size() && size() < max; ++i) {
+        if (db.read_record(i, rec)) add(rec);
+    }
+    ESP_LOGI(TAG, "Loaded %d satellites", size());
+    return size() > 0;
+}
+
+bool SatBatch::add(const tle_db_record_t& rec) {
+    elsetrec satrec;
+    TleDb::to_elsetrec(rec, satrec);  // pre parsed, no text parsing here
+    if (satrec.error != 0) return false;
+    recs.push_back(satrec);
+    size_t pos = names.size();
+    names.resize(pos + SAT_BATCH_NAME_LEN, 0);
+    strlcpy(&names[pos], rec.name, SAT_BATCH_NAME_LEN);
+    x.push_back(0);
+    y.push_back(0);
+    z.push_back(0);
+    az.push_back(0);
+    el.push_back(-90);
+    aos.push_back(0);
+    ok.push_back(0);
+    order.push_back(order.size());
+    return true;
+}
+
+void SatBatch::clear() {
+    // swap, so the memory is released too
+    std::vector<elsetrec>().swap(recs);
+    std::vector<char>().swap(names);
+    std::vector<double>().swap(x);
+    std::vector<double>().swap(y);
+    std::vector<double>().swap(z);
+    std::vector<float>().swap(az);
+    std::vector<float>().swap(el);
+    std::vector<double>().swap(aos);
+    std::vector<uint8_t>().swap(ok);
+    std::vector<uint16_t>().swap(order);
+    aos_cursor = 0;
+}
+
+// builds the teme -> sez matrix and the site vector for this tick with the library's own transforms, so the result is the same as rv2azel()
+void SatBatch::update_transform(double jd, double lat, double lon, double alt) {
+    double latr = lat * pi / 180.0;
+    double lonr = lon * pi / 180.0;
+    double altkm = alt / 1000.0;
+    double tmp[3];
+    double sez[3];
+    for (uint8_t c = 0; c < 3; ++c) {
+        double unit[3] = {0, 0, 0};
+        double ecef[3];
+        unit[c] = 1.0;
+        teme2ecef(unit, jd, ecef);  // linear, so the unit vectors give the columns
+        rot3(ecef, lonr, tmp);
+        rot2(tmp, pi * 0.5 - latr, sez);
+        m[0][c] = sez[0];
+        m[1][c] = sez[1];
+        m[2][c] = sez[2];
+    }
+    double rs[3];
+    site(latr, lonr, altkm, rs);
+    rot3(rs, lonr, tmp);
+    rot2(tmp, pi * 0.5 - latr, site_sez);
+}
+
+// the hot loop, over the arrays
+void SatBatch::transform(uint16_t from, uint16_t to) {
+    for (uint16_t i = from; i < to; ++i) {
+        double s = m[0][0] * x[i] + m[0][1] * y[i] + m[0][2] * z[i] - site_sez[0];
+        double e = m[1][0] * x[i] + m[1][1] * y[i] + m[1][2] * z[i] - site_sez[1];
+        double zz = m[2][0] * x[i] + m[2][1] * y[i] + m[2][2] * z[i] - site_sez[2];
+        double rho = sqrt(s * s + e * e + zz * zz);
+        el[i] = rho > 0 ? asin(zz / rho) * 180.0 / pi : -90;
+        az[i] = floatmod(atan2(e, -s) * 180.0 / pi + 360.0, 360.0);
+    }
+}
+
+bool SatBatch::elevation_at(uint16_t i, double jd, double& elevation) {
+    double r[3];
+    double v[3];
+    double razel[3];
+    if (!Sgp4Fast::propagate(whichconst, recs[i], (jd - recs[i].jdsatepoch) * 1440.0, r, v)) return false;
+    rv2azel(r, site_lat * pi / 180.0, site_lon * pi / 180.0, site_alt / 1000.0, jd, razel);
+    elevation = razel[2] * 180.0 / pi;
+    return true;
+}
+
+void SatBatch::find_aos(uint16_t i, double jd) {
+    double e;
+    aos[i] = -(jd + SATBATCH_AOS_SEARCH_DAYS);
+    for (double t = jd + SATBATCH_AOS_STEP_DAYS; t < jd + SATBATCH_AOS_SEARCH_DAYS; t += SATBATCH_AOS_STEP_DAYS) {
+        if (!elevation_at(i, t, e)) return;
+        if (e <= 0) continue;
+        // risen in the last step, bisection to ~4 sec
+        double lo = t - SATBATCH_AOS_STEP_DAYS;
+        double hi = t;
+        for (uint8_t b = 0; b < 5; ++b) {
+            double mid = (lo + hi) * 0.5;
+            if (!elevation_at(i, mid, e)) break;
+            if (e > 0)
+                hi = mid;
+            else
+                lo = mid;
+        }
+        aos[i] = hi;
+        return;
+    }
+}
+
+void SatBatch::propagate(double jd, double lat, double lon, double alt) {
+    uint16_t n = size();
+    if (n == 0) return;
+    if (fabs(lat - site_lat) > 0.1 || fabs(lon - site_lon) > 0.1) {
+        std::fill(aos.begin(), aos.end(), 0);  // rise times depend on the site
+    }
+    site_lat = lat;
+    site_lon = lon;
+    site_alt = alt;
+    update_transform(jd, lat, lon, alt);
+    double r[3];
+    double v[3];
+    for (uint16_t i = 0; i < n; ++i) {
+        ok[i] = Sgp4Fast::propagate(whichconst, recs[i], (jd - recs[i].jdsatepoch) * 1440.0, r, v);
+        x[i] = r[0];
+        y[i] = r[1];
+        z[i] = r[2];
+    }
+    transform(0, n);
+
+    // lazy rise search, round robin
+    uint8_t searched = 0;
+    for (uint16_t k = 0; k < n; ++k) {
+        uint16_t i = aos_cursor;
+        aos_cursor = (aos_cursor + 1) % n;
+        if (!ok[i]) continue;
+        if (el[i] > 0) {
+            aos[i] = 0;  // visible, search again after it sets
+            continue;
+        }
+        bool need = aos[i] == 0 || (aos[i] > 0 && aos[i] < jd - SATBATCH_AOS_STEP_DAYS) || (aos[i] < 0 && jd > -aos[i]);
+        if (!need || searched >= SATBATCH_AOS_PER_TICK) continue;
+        find_aos(i, jd);
+        searched++;
+    }
+
+    std::sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b) {
+        bool va = ok[a] && el[a] > 0;
+        bool vb = ok[b] && el[b] > 0;
+        if (va != vb) return va;
+        if (va) return el[a] > el[b];
+        bool ra = ok[a] && aos[a] > 0;
+        bool rb = ok[b] && aos[b] > 0;
+        if (ra != rb) return ra;
+        if (ra) return aos[a] < aos[b];
+        return el[a] > el[b];
+    });
+}
+
+uint16_t SatBatch::get_sorted(sat_batch_entry_t* out, uint16_t max) const {
+    uint16_t count = 0;
+    for (uint16_t k = 0; k < order.size() && count < max; ++k) {
+        uint16_t i = order[k];
+        if (!ok[i]) continue;
+        sat_batch_entry_t& entry = out[count++];
+        memcpy(entry.name, &names[i * SAT_BATCH_NAME_LEN], SAT_BATCH_NAME_LEN);
+        entry.azimuth = az[i];
+        entry.elevation = el[i];
+        entry.aos = aos[i] > 0 ? getUnixFromJulian(aos[i]) : 0;
+    }
+    return count;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SATBATCH_HPP
+#define SATBATCH_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <numbers>  // before Sgp4.h: its pi macro breaks <numbers>, that the c++20 std headers pull in later
+#include "sgp4/Sgp4.h"
+#include "ppi2c/pp_structures.hpp"
+#include "tledb.hpp"
+
+#define SATBATCH_MAX 32                // default max satellites loaded, one elsetrec is ~800 bytes
+#define SATBATCH_AOS_PER_TICK 1        // max next rise searches per propagate() (a few hundred sgp4 calls each), the rest waits for the next ticks
+#define SATBATCH_AOS_STEP_DAYS 0.0014  // ~2 min coarse step for the rise search, then bisection
+#define SATBATCH_AOS_SEARCH_DAYS 0.5   // search the next rise this far
+
+/*
+    Keeps the initialized sgp4 state of many satellites, and propagates all of them in one pass.
+    The per tick data is stored as structure of arrays: the sgp4 kernel (sgp4kernel.hpp, float by default) writes the teme positions to x/y/z, then one tight loop turns all of them to az/el with a rotation matrix computed once per tick (instead of the gmst, polar motion and site math per satellite in rv2azel()).
+    The next rise time is searched lazily, at most SATBATCH_AOS_PER_TICK satellites per tick.
+*/
+class SatBatch {
+   public:
+    bool load(TleDb& db, uint16_t max = SATBATCH_MAX);  // loads the satellites from the tle db, in the file's order
+    bool add(const tle_db_record_t& rec);
+    void clear();
+    uint16_t size() const { return recs.size(); }
+
+    void propagate(double jd, double lat, double lon, double alt);  // lat, lon in degrees, alt in meters
+    uint16_t get_sorted(sat_batch_entry_t* out, uint16_t max) const;  // visible ones by elevation, then the rising ones by aos. returns the count
+
+   private:
+    void update_transform(double jd, double lat, double lon, double alt);
+    void transform(uint16_t from, uint16_t to);
+    bool elevation_at(uint16_t i, double jd, double& elevation);  // full rv2azel at any time, for the rise search
+    void find_aos(uint16_t i, double jd);
+
+    gravconsttype whichconst = wgs84;  // same as Sgp4
+    std::vector<elsetrec> recs;
+
+    // structure of arrays, one element per satellite
+    std::vector<char> names;  // SAT_BATCH_NAME_LEN per satellite
+    std::vector<double> x, y, z;
+    std::vector<float> az, el;
+    std::vector<double> aos;   // jd of the next rise, 0 if not known yet
+    std::vector<uint8_t> ok;   // sgp4 succeeded at the last tick
+    std::vector<uint16_t> order;
+
+    // teme -> topocentric sez transform of the current tick
+    double m[3][3] = {};
+    double site_sez[3] = {};
+    double site_lat = 0, site_lon = 0, site_alt = 0;  // the rise times are dropped on site change
+    uint16_t aos_cursor = 0;
+};
+
+#endif  // SATBATCH_HPP
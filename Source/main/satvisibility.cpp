@@ -0,0 +1,22 @@
+#include "satvisibility.hpp"
+
+void SatVisibility::fill(const Sgp4* sat, sattrackdata_t& data) {
+    if (!sat) {
+        data.visibility = SAT_VIS_UNKNOWN;
+        data.sunlit = 0;
+        data.sun_azimuth = 0;
+        data.sun_elevation = 0;
+        return;
+    }
+    data.sunlit = sat->satLit;
+    data.sun_azimuth = floatmod(sat->sunAz + 360.0, 360.0);
+    data.sun_elevation = sat->sunEl;
+    if (sat->satVis == -2)
+        data.visibility = SAT_VIS_UNDER_HORIZON;
+    else if (sat->satVis == -1)
+        data.visibility = SAT_VIS_DAYLIGHT;
+    else if (sat->satVis == 0)
+        data.visibility = SAT_VIS_ECLIPSED;
+    else
+        data.visibility = SAT_VIS_VISIBLE;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SATVISIBILITY_HPP
+#define SATVISIBILITY_HPP
+
+#include <numbers>  // before Sgp4.h: its pi macro breaks <numbers>, that the c++20 std headers pull in later
+#include "sgp4/Sgp4.h"
+#include "ppi2c/pp_structures.hpp"
+
+/*
+    The sun and eclipse state of the tracked satellite in sattrackdata_t, from the last Sgp4::findsat(). findsat() computes them anyway, this only maps them.
+*/
+class SatVisibility {
+   public:
+    static void fill(const Sgp4* sat, sattrackdata_t& data);  // nullptr: no satellite, location or time
+};
+
+#endif  // SATVISIBILITY_HPP
@@ -0,0 +1,47 @@
+#include "scheduler.hpp"
+
+bool Scheduler::add_job(uint8_t id, uint32_t period_ms, scheduler_job_cb cb) {
+    if (id >= MAX_JOBS || !cb || jobs[id].cb) return false;
+    jobs[id].cb = cb;
+    jobs[id].period = period_ms;
+    jobs[id].last = now();
+    return true;
+}
+
+void Scheduler::set_period(uint8_t id, uint32_t period_ms) {
+    if (id >= MAX_JOBS) return;
+    jobs[id].period = period_ms;
+}
+
+void Scheduler::trigger(uint8_t id) {
+    if (id >= MAX_JOBS) return;
+    triggered.fetch_or(1u << id);
+}
+
+uint32_t Scheduler::wait_next() {
+    uint32_t current = now();
+    uint32_t sleep = MAX_SLEEP_MS;
+    if (triggered.load() != 0) sleep = 0;
+    for (uint8_t i = 0; i < MAX_JOBS && sleep > 0; ++i) {
+        if (!jobs[i].cb || jobs[i].period == 0) continue;
+        uint32_t elapsed = current - jobs[i].last;
+        uint32_t left = elapsed >= jobs[i].period ? 0 : jobs[i].period - elapsed;
+        if (left < sleep) sleep = left;
+    }
+    if (sleep > 0) {
+        wait(sleep);
+        current = now();
+    }
+    return current;
+}
+
+void Scheduler::run_due(uint32_t now_ms) {
+    uint32_t trig = triggered.exchange(0);
+    for (uint8_t i = 0; i < MAX_JOBS; ++i) {
+        if (!jobs[i].cb) continue;
+        if ((trig & (1u << i)) || (jobs[i].period != 0 && now_ms - jobs[i].last >= jobs[i].period)) {
+            jobs[i].last = now_ms;
+            jobs[i].cb(now_ms);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <atomic>
+#include <stdint.h>
+
+typedef void (*scheduler_job_cb)(uint32_t now);
+typedef uint32_t (*scheduler_now_fn)();              // current time in ms
+typedef void (*scheduler_wait_fn)(uint32_t wait_ms);  // sleep till the timeout, or till someone wakes the loop up
+
+/*
+    Deadline scheduler for a task loop (main loop, sensor task). Every periodic task is a job with its own period.
+    wait_next() sleeps till the nearest deadline (no polling), the wait function must return early when an event arrives (new gps data, i2c command, ...), so the loop can react to it.
+    The clock and the wait are passed in, so it has no FreeRTOS dependency.
+*/
+class Scheduler {
+   public:
+    static constexpr uint8_t MAX_JOBS = 16;  // max 32, see triggered
+    static constexpr uint32_t MAX_SLEEP_MS = 60000;
+
+    Scheduler(scheduler_now_fn now_fn, scheduler_wait_fn wait_fn)
+        : now(now_fn), wait(wait_fn) {}
+
+    bool add_job(uint8_t id, uint32_t period_ms, scheduler_job_cb cb);  // first run is one period from now. period 0 means paused (runs only when triggered). owner task only
+    void set_period(uint8_t id, uint32_t period_ms);                    // owner task only. the next run is rescheduled from the last run
+    uint32_t get_period(uint8_t id) const { return id < MAX_JOBS ? jobs[id].period : 0; }
+    void trigger(uint8_t id);                                           // run it at the next wake, then continue with its period. IRQ safe, but wake the loop after it
+    uint32_t wait_next();                                               // sleeps till the next deadline or an event, returns the current time
+    void run_due(uint32_t now_ms);                                      // runs all jobs due (or triggered). owner task only
+
+   private:
+    typedef struct
+    {
+        scheduler_job_cb cb;
+        uint32_t period;
+        uint32_t last;
+    } job_t;
+
+    scheduler_now_fn now;
+    scheduler_wait_fn wait;
+    job_t jobs[MAX_JOBS] = {};
+    std::atomic<uint32_t> triggered{0};  // bit per job
+};
+
+#endif  // SCHEDULER_HPP
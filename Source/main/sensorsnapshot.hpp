@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SENSORSNAPSHOT_HPP
+#define SENSORSNAPSHOT_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include "ppi2c/pp_structures.hpp"
+
+/*
+    Single writer, multi reader double buffer with a sequence counter.
+    The writer always fills the buffer that is NOT published, then bumps the sequence, so readers (even an IRQ preempting the writer) always get a consistent copy without locks.
+    The next publish after that rewrites the buffer a reader on the other core may still be copying, and bumps the sequence only when done, so a copy is only accepted when no publish happened at all while it was made (seqlock style).
+    A reader only has to retry when the writer published while it was copying (possible only from the other core), so the retry count is bounded.
+*/
+template <typename T>
+class DoubleBuffer {
+   public:
+    DoubleBuffer()
+        : seq(0), buf{} {}
+
+    // only one task may call this
+    void publish(const T& data) {
+        uint32_t next = seq.load(std::memory_order_relaxed) + 1;
+        // the previous sequence store must be visible before any byte of this buffer changes, a reader that copied some of them then sees the sequence moved
+        std::atomic_thread_fence(std::memory_order_release);
+        buf[next & 1] = data;
+        seq.store(next, std::memory_order_release);
+    }
+
+    // IRQ safe. returns false if could not get a consistent copy (writer too fast), but out still has the latest try, it must not be used then
+    bool read(T& out) const {
+        for (uint8_t i = 0; i < 4; ++i) {
+            uint32_t s = seq.load(std::memory_order_acquire);
+            out = buf[s & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s) return true;  // no publish finished, so none started on this buffer either
+        }
+        return false;
+    }
+
+    // IRQ safe. last is the caller's previous consistent copy: it is updated on success, and out gets it back on failure, so out is never torn
+    bool read(T& out, T& last) const {
+        if (read(out)) {
+            last = out;
+            return true;
+        }
+        out = last;
+        return false;
+    }
+
+    uint32_t sequence() const { return seq.load(std::memory_order_acquire); }
+
+   private:
+    std::atomic<uint32_t> seq;
+    T buf[2];
+};
+
+// all sensor data, that is served to the pp / web from one consistent source
+typedef struct
+{
+    ppgpssmall_t gps;
+    orientation_t orientation;
+    environment_t environment;
+    uint16_t light;
+    float temperatureEsp;
+    uint8_t present;  // FeatDataPresence bits, which sensors are available
+} SensorSnapshot;
+
+#endif  // SENSORSNAPSHOT_HPP
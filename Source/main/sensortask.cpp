@@ -0,0 +1,119 @@
+#include "sensortask.hpp"
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "orientation.h"
+#include "environment.h"
+
+static const char* TAG = "SensorTask";
+
+TaskHandle_t SensorTask::task_handle = nullptr;
+temperature_sensor_handle_t SensorTask::temp_sensor = nullptr;
+const DoubleBuffer<ppgpssmall_t>* SensorTask::gps = nullptr;
+bool SensorTask::gps_pin_set = false;
+uint32_t SensorTask::gps_seq = 0;
+SensorSnapshot SensorTask::current{};
+bool SensorTask::dirty = false;
+Scheduler SensorTask::scheduler(SensorTask::now_ms, SensorTask::wait_ms);
+// _____________________________________________________TEMPESP  ORI  ENV   LIGHT
+std::atomic<uint32_t> SensorTask::periods[Sensor_MAX] = {2000, 100, 2000, 1000};
+DoubleBuffer<SensorSnapshot> SensorTask::snapshot;
+
+void SensorTask::init(temperature_sensor_handle_t temp_sensor_, const DoubleBuffer<ppgpssmall_t>* gps_, bool gps_pin_set_) {
+    temp_sensor = temp_sensor_;
+    gps = gps_;
+    gps_pin_set = gps_pin_set_;
+    // same defaults as the main loop's values
+    current.gps = {200, 200, 0, 0, 0, 0, {}, {}};
+    current.orientation = {400.0, 0.0};
+    current.environment = {0.0, 0.0, 0.0};
+    current.light = 0;
+    current.temperatureEsp = 0.0;
+    if (!is_orientation_sensor_present()) periods[Sensor_ORIENTATION] = 0;
+    if (!is_environment_sensor_present()) periods[Sensor_ENVIRONMENT] = 0;
+    if (!is_environment_light_sensor_present()) periods[Sensor_LIGHT] = 0;
+    if (!temp_sensor) periods[Sensor_TEMPESP] = 0;
+    scheduler.add_job(Sensor_TEMPESP, periods[Sensor_TEMPESP], read_tempesp);
+    scheduler.add_job(Sensor_ORIENTATION, periods[Sensor_ORIENTATION], read_orientation);
+    scheduler.add_job(Sensor_ENVIRONMENT, periods[Sensor_ENVIRONMENT], read_environment);
+    scheduler.add_job(Sensor_LIGHT, periods[Sensor_LIGHT], read_light);
+    for (uint8_t i = 0; i < Sensor_MAX; ++i) {
+        if (periods[i] != 0) scheduler.trigger(i);  // first read asap
+    }
+    publish();  // so the pp gets the defaults till the first sensor read
+    ESP_LOGI(TAG, "periods: tempesp %" PRIu32 ", ori %" PRIu32 ", env %" PRIu32 ", light %" PRIu32, periods[Sensor_TEMPESP].load(), periods[Sensor_ORIENTATION].load(), periods[Sensor_ENVIRONMENT].load(), periods[Sensor_LIGHT].load());
+    xTaskCreate(sensor_task, "sensors", 4096, NULL, 5, &task_handle);
+}
+
+void SensorTask::set_period(SensorId id, uint32_t period_ms) {
+    if (id >= Sensor_MAX) return;
+    periods[id] = period_ms;
+    wake();
+}
+
+void SensorTask::gps_updated() {
+    wake();
+}
+
+void SensorTask::wake() {
+    if (task_handle) xTaskNotifyGive(task_handle);
+}
+
+uint32_t SensorTask::now_ms() {
+    return esp_timer_get_time() / 1000;
+}
+
+void SensorTask::wait_ms(uint32_t ms) {
+    TickType_t ticks = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;  // round up, so it never spins with 0 tick waits
+    ulTaskNotifyTake(pdTRUE, ticks);
+}
+
+void SensorTask::read_tempesp(uint32_t now) {
+    if (temperature_sensor_get_celsius(temp_sensor, &current.temperatureEsp) == ESP_OK) dirty = true;
+}
+
+void SensorTask::read_orientation(uint32_t now) {
+    current.orientation.angle = get_heading_degrees();
+    current.orientation.tilt = get_tilt();
+    dirty = true;
+}
+
+void SensorTask::read_environment(uint32_t now) {
+    get_environment_meas(&current.environment.temperature, &current.environment.pressure, &current.environment.humidity);
+    dirty = true;
+}
+
+void SensorTask::read_light(uint32_t now) {
+    get_environment_light(&current.light);
+    dirty = true;
+}
+
+void SensorTask::publish() {
+    if (gps) {
+        uint32_t seq = gps->sequence();
+        ppgpssmall_t fix;
+        if (seq != 0 && gps->read(fix)) {  // a torn copy is retried on the next wake
+            current.gps = fix;
+            gps_seq = seq;
+        }
+    }
+    current.present = 0;
+    if (gps_seq != 0 || gps_pin_set) current.present |= FEAT_DATA_PRESENT_GPS;
+    if (is_orientation_sensor_present()) current.present |= FEAT_DATA_PRESENT_ORIENTATION;
+    if (is_environment_sensor_present()) current.present |= FEAT_DATA_PRESENT_ENVIRONMENT;
+    if (is_environment_light_sensor_present()) current.present |= FEAT_DATA_PRESENT_LIGHT;
+    snapshot.publish(current);
+    dirty = false;
+}
+
+void SensorTask::sensor_task(void* pvParameters) {
+    while (true) {
+        uint32_t now = scheduler.wait_next();
+        for (uint8_t i = 0; i < Sensor_MAX; ++i) {
+            uint32_t period = periods[i].load();
+            if (scheduler.get_period(i) != period) scheduler.set_period(i, period);
+        }
+        scheduler.run_due(now);
+        if (dirty || (gps && gps->sequence() != gps_seq)) publish();
+    }
+}
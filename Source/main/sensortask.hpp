@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SENSORTASK_HPP
+#define SENSORTASK_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <driver/temperature_sensor.h>
+#include "sensorsnapshot.hpp"
+#include "scheduler.hpp"
+
+typedef enum SensorId {
+    Sensor_TEMPESP,
+    Sensor_ORIENTATION,
+    Sensor_ENVIRONMENT,
+    Sensor_LIGHT,
+    Sensor_MAX
+} SensorId;
+
+/*
+    Reads all the i2c sensors on its own task, so a slow device can't stall the main loop.
+    Every sensor has its own sample period, and the results are published to a lock free snapshot (with the latest gps fix), that the main loop and the pp irq reads.
+*/
+class SensorTask {
+   public:
+    static void init(temperature_sensor_handle_t temp_sensor_, const DoubleBuffer<ppgpssmall_t>* gps_, bool gps_pin_set_);  // call after the sensors are inited
+    static void set_period(SensorId id, uint32_t period_ms);                                                                // 0 disables the sensor. any task
+    static uint32_t get_period(SensorId id) { return id < Sensor_MAX ? periods[id].load() : 0; }
+    static void gps_updated();  // call when a new gps fix is in the gps buffer, to republish the snapshot now. any task
+
+    // any task or irq
+    static bool read(SensorSnapshot& out) { return snapshot.read(out); }
+    static bool read(SensorSnapshot& out, SensorSnapshot& last) { return snapshot.read(out, last); }
+    static uint32_t sequence() { return snapshot.sequence(); }
+
+   private:
+    static void sensor_task(void* pvParameters);
+    static void publish();
+    static uint32_t now_ms();
+    static void wait_ms(uint32_t ms);
+    static void wake();
+
+    static void read_tempesp(uint32_t now);
+    static void read_orientation(uint32_t now);
+    static void read_environment(uint32_t now);
+    static void read_light(uint32_t now);
+
+    static TaskHandle_t task_handle;
+    static temperature_sensor_handle_t temp_sensor;
+    static const DoubleBuffer<ppgpssmall_t>* gps;
+    static bool gps_pin_set;
+    static uint32_t gps_seq;        // last gps buffer sequence published
+    static SensorSnapshot current;  // sensor task only
+    static bool dirty;              // current has new data, not published yet
+    static Scheduler scheduler;
+    static std::atomic<uint32_t> periods[Sensor_MAX];  // requested periods, the task applies them to the scheduler
+    static DoubleBuffer<SensorSnapshot> snapshot;
+};
+
+#endif  // SENSORTASK_HPP
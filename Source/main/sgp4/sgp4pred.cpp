@@ -24,6 +24,9 @@ Sgp4::Sgp4() {
     whichconst = wgs84;             // newest constants
     sunoffset = -0.10471975511966;  // sun aboven -6°  => not dark enough
     offset = 0.0;
+    satName[0] = 0;
+    line1[0] = 0;  // init() compares against it to skip a reload of the same tle
+    line2[0] = 0;
 }
 
 /// Init functions/////
@@ -85,8 +88,8 @@ void Sgp4::findsat(double jdI) {
     }
 }
 
-void Sgp4::findsat(unsigned long unix) {
-    findsat(getJulianFromUnix(unix));
+void Sgp4::findsat(unsigned long unixtime) {
+    findsat(getJulianFromUnix(unixtime));
 }
 
 //////Predict functions/////////
@@ -148,7 +151,7 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
     vis = visible(isdaylight, phi);
 
     if (isdaylight) {
-        (*passdata).vismax = daylight;
+        (*passdata).vismax = daytime;
     } else if (vis < 1000) {
         (*passdata).vismax = eclipsed;
     } else {
@@ -165,7 +168,7 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
     vis = visible(isdaylight, startphi);
 
     if (isdaylight) {
-        (*passdata).visstart = daylight;
+        (*passdata).visstart = daytime;
     } else if (vis < 1000) {
         (*passdata).visstart = eclipsed;
     } else {
@@ -182,7 +185,7 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
     vis = visible(isdaylight, stopphi);
 
     if (isdaylight) {
-        (*passdata).visstop = daylight;
+        (*passdata).visstop = daytime;
     } else if (vis < 1000) {
         (*passdata).visstop = eclipsed;
     } else {
@@ -192,8 +195,8 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
 
     // global visibility
 
-    if ((*passdata).visstop == daylight && (*passdata).visstart == daylight) {
-        (*passdata).sight = daylight;
+    if ((*passdata).visstop == daytime && (*passdata).visstart == daytime) {
+        (*passdata).sight = daytime;
     } else if (vissum < 1000) {
         (*passdata).sight = eclipsed;
     } else {
@@ -207,7 +210,7 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
         (*passdata).jdtransit = NAN;
         (*passdata).aztransit = NAN;
         (*passdata).transitelevation = NAN;
-        (*passdata).vistransit = daylight;
+        (*passdata).vistransit = daytime;
     } else {
         if (sgn(startphi) > sgn(stopphi)) {
             (*passdata).transit = enter;
@@ -223,7 +226,7 @@ bool Sgp4::nextpass(passinfo* passdata, int itterations, bool direc, double mini
         vis = visible(isdaylight, phi);
 
         if (isdaylight) {
-            (*passdata).vistransit = daylight;
+            (*passdata).vistransit = daytime;
         } else {
             (*passdata).vistransit = eclipsed;
         }
@@ -268,8 +271,8 @@ bool Sgp4::initpredpoint(double startpoint, double startelevation) {
     return 1;
 }
 
-bool Sgp4::initpredpoint(unsigned long unix, double startelevation) {
-    return initpredpoint(getJulianFromUnix(unix), startelevation);
+bool Sgp4::initpredpoint(unsigned long unixtime, double startelevation) {
+    return initpredpoint(getJulianFromUnix(unixtime), startelevation);
 }
 
 double Sgp4::getpredpoint() {
@@ -16,7 +16,7 @@ Written by Hopperpop
 
 enum visibletype
 {
-  daylight,
+  daytime,
   eclipsed,
   lighted
 };
@@ -79,6 +79,7 @@ public:
   double satLat, satLon, satAlt, satAz, satEl, satDist, satJd;
   double sunAz, sunEl;
   int16_t satVis;
+  int16_t satLit;   // sunlit part of the satellite 0..1000 at the last findsat, also when under the horizon or in daylight
 
   Sgp4();
   bool init(const char naam[], char longstr1[130], char longstr2[130]); // initialize parameters from 2 line elements
@@ -92,7 +93,7 @@ public:
   bool nextpass(passinfo *passdata, int itterations, bool direc);                          // direc = false for forward search, true for backwards search
   bool nextpass(passinfo *passdata, int itterations, bool direc, double minimumElevation); // minimumElevation = minimum elevation above the horizon (in degrees)
   bool initpredpoint(double juliandate, double startelevation);                            // initialize prediction algorithm, starting from a juliandate and predict passes aboven startelevation
-  bool initpredpoint(unsigned long unix, double startelevation);                           // from unix time
+  bool initpredpoint(unsigned long unixtime, double startelevation);                           // from unix time
 
   int16_t visible(); // check if satellite is visible
   int16_t visible(bool &notdark, double &deltaphi);
@@ -194,6 +194,7 @@ int16_t Sgp4::visible() {
 	bool notdark;
 	double deltaphi;
 	int16_t viss = visible(notdark,deltaphi);
+	satLit = viss;
 	if (notdark) {
 		return -1;
 	}
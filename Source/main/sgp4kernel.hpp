@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SGP4KERNEL_HPP
+#define SGP4KERNEL_HPP
+
+#include <math.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#include "sgp4/Sgp4.h"
+
+// precision of the near earth sgp4 kernel. the s3 fpu does float only, double is software emulated (CONFIG_SGP4_KERNEL_DOUBLE for the reference results)
+#ifndef SGP4_KERNEL_REAL
+#ifdef CONFIG_SGP4_KERNEL_DOUBLE
+#define SGP4_KERNEL_REAL double
+#else
+#define SGP4_KERNEL_REAL float
+#endif
+#endif
+
+/*
+    The near earth part of sgp4() (sgp4unit.cpp) with a selectable precision for the periodic part.
+    The secular update (polynomials of the time since epoch, the angles can grow to thousands of rad) stays in double, and the angles are reduced to 0..2pi before they are converted to T.
+    From there (periodics, kepler's equation, orientation vectors) everything is T, with float math functions when T is float.
+    Deep space satellites (period > 225 min) go to the reference sgp4(), so the result is the same as the reference for them.
+    Measured against sgp4() on the host, over +-3 days around the epoch, T = float: < 30 m position, < 0.03 m/s velocity, T = double: < 1 mm.
+    The satrec must be initialized by sgp4init() (or twoline2rv()), it is only read, except t and error, like sgp4() does.
+*/
+template <typename T>
+class Sgp4Kernel {
+   public:
+    static bool propagate(gravconsttype whichconst, elsetrec& satrec, double tsince, double r[3], double v[3]) {
+        if (satrec.method == 'd') return sgp4(whichconst, satrec, tsince, r, v);
+        double tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2;
+        getgravconst(whichconst, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2);
+        const double twopi = 2.0 * pi;
+        satrec.t = tsince;
+        satrec.error = 0;
+
+        // ---- secular gravity and atmospheric drag, double ----
+        double t = tsince;
+        double t2 = t * t;
+        double xmdf = satrec.mo + satrec.mdot * t;
+        double argpdf = satrec.argpo + satrec.argpdot * t;
+        double nodedf = satrec.nodeo + satrec.nodedot * t;
+        double argpm = argpdf;
+        double mm = xmdf;
+        double nodem = nodedf + satrec.nodecf * t2;
+        double tempa = 1.0 - satrec.cc1 * t;
+        double tempe = satrec.bstar * satrec.cc4 * t;
+        double templ = satrec.t2cof * t2;
+        if (satrec.isimp != 1) {
+            double delomg = satrec.omgcof * t;
+            double delmtemp = 1.0 + satrec.eta * fn_cos((T)floatmod(xmdf, twopi));
+            double delm = satrec.xmcof * (delmtemp * delmtemp * delmtemp - satrec.delmo);
+            double temp = delomg + delm;
+            mm = xmdf + temp;
+            argpm = argpdf - temp;
+            double t3 = t2 * t;
+            double t4 = t3 * t;
+            tempa = tempa - satrec.d2 * t2 - satrec.d3 * t3 - satrec.d4 * t4;
+            tempe = tempe + satrec.bstar * satrec.cc5 * (fn_sin((T)floatmod(mm, twopi)) - satrec.sinmao);
+            templ = templ + satrec.t3cof * t3 + t4 * (satrec.t4cof + t * satrec.t5cof);
+        }
+        if (satrec.no <= 0.0) {
+            satrec.error = 2;
+            return false;
+        }
+        T am = fn_pow((T)(xke / satrec.no), (T)(2.0 / 3.0)) * (T)(tempa * tempa);
+        T nm = (T)xke / fn_pow(am, (T)1.5);
+        T em = (T)(satrec.ecco - tempe);
+        if ((em >= 1) || (em < (T)-0.001)) {
+            satrec.error = 1;
+            return false;
+        }
+        if (em < (T)1.0e-6) em = (T)1.0e-6;
+        mm = mm + satrec.no * templ;
+        double xlm = floatmod(mm + argpm + nodem, twopi);
+        nodem = floatmod(nodem, twopi);
+        argpm = floatmod(argpm, twopi);
+        mm = floatmod(xlm - argpm - nodem, twopi);
+
+        // ---- from here everything is T ----
+        const T ep = em;
+        const T xincp = (T)satrec.inclo;
+        const T argpp = (T)argpm;
+        const T nodep = (T)nodem;
+        const T mp = (T)mm;
+        const T sinip = fn_sin(xincp);
+        const T cosip = fn_cos(xincp);
+
+        // long period periodics
+        T axnl = ep * fn_cos(argpp);
+        T temp = (T)1 / (am * ((T)1 - ep * ep));
+        T aynl = ep * fn_sin(argpp) + temp * (T)satrec.aycof;
+        T xl = mp + argpp + nodep + temp * (T)satrec.xlcof * axnl;
+
+        // kepler's equation
+        T u = floatmod(xl - nodep, (T)twopi);
+        T eo1 = u;
+        T tem5 = 9999;
+        T sineo1 = 0;
+        T coseo1 = 0;
+        for (uint8_t ktr = 1; fn_abs(tem5) >= kepler_tolerance() && ktr <= 10; ++ktr) {
+            sineo1 = fn_sin(eo1);
+            coseo1 = fn_cos(eo1);
+            tem5 = (T)1 - coseo1 * axnl - sineo1 * aynl;
+            tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+            if (fn_abs(tem5) >= (T)0.95) tem5 = tem5 > 0 ? (T)0.95 : (T)-0.95;
+            eo1 = eo1 + tem5;
+        }
+
+        // short period preliminary quantities
+        T ecose = axnl * coseo1 + aynl * sineo1;
+        T esine = axnl * sineo1 - aynl * coseo1;
+        T el2 = axnl * axnl + aynl * aynl;
+        T pl = am * ((T)1 - el2);
+        if (pl < 0) {
+            satrec.error = 4;
+            return false;
+        }
+        T rl = am * ((T)1 - ecose);
+        T rdotl = fn_sqrt(am) * esine / rl;
+        T rvdotl = fn_sqrt(pl) / rl;
+        T betal = fn_sqrt((T)1 - el2);
+        temp = esine / ((T)1 + betal);
+        T sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        T cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        T su = fn_atan2(sinu, cosu);
+        T sin2u = (cosu + cosu) * sinu;
+        T cos2u = (T)1 - (T)2 * sinu * sinu;
+        temp = (T)1 / pl;
+        T temp1 = (T)(0.5 * j2) * temp;
+        T temp2 = temp1 * temp;
+
+        // short period periodics
+        const T con41 = (T)satrec.con41;
+        const T x1mth2 = (T)satrec.x1mth2;
+        T mrt = rl * ((T)1 - (T)1.5 * temp2 * betal * con41) + (T)0.5 * temp1 * x1mth2 * cos2u;
+        su = su - (T)0.25 * temp2 * (T)satrec.x7thm1 * sin2u;
+        T xnode = nodep + (T)1.5 * temp2 * cosip * sin2u;
+        T xinc = xincp + (T)1.5 * temp2 * cosip * sinip * cos2u;
+        T mvt = rdotl - nm * temp1 * x1mth2 * sin2u / (T)xke;
+        T rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + (T)1.5 * con41) / (T)xke;
+
+        // orientation vectors
+        T sinsu = fn_sin(su);
+        T cossu = fn_cos(su);
+        T snod = fn_sin(xnode);
+        T cnod = fn_cos(xnode);
+        T sini = fn_sin(xinc);
+        T cosi = fn_cos(xinc);
+        T xmx = -snod * cosi;
+        T xmy = cnod * cosi;
+        T ux = xmx * sinsu + cnod * cossu;
+        T uy = xmy * sinsu + snod * cossu;
+        T uz = sini * sinsu;
+        T vx = xmx * cossu - cnod * sinsu;
+        T vy = xmy * cossu - snod * sinsu;
+        T vz = sini * cossu;
+
+        // km and km/s, the output is double like sgp4()
+        const T rkm = (T)radiusearthkm;
+        const T vkmpersec = (T)(radiusearthkm * xke / 60.0);
+        r[0] = (mrt * ux) * rkm;
+        r[1] = (mrt * uy) * rkm;
+        r[2] = (mrt * uz) * rkm;
+        v[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+        v[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+        v[2] = (mvt * uz + rvdot * vz) * vkmpersec;
+        if (mrt < 1) {
+            satrec.error = 6;
+            return false;
+        }
+        return true;
+    }
+
+   private:
+    static T kepler_tolerance();
+    static T fn_sin(T x);
+    static T fn_cos(T x);
+    static T fn_sqrt(T x);
+    static T fn_abs(T x);
+    static T fn_atan2(T y, T x);
+    static T fn_pow(T x, T y);
+};
+
+// the float versions, so no hidden promotion to double
+template <>
+inline float Sgp4Kernel<float>::kepler_tolerance() { return 1.0e-6f; }  // the reference 1e-12 is below the float resolution
+template <>
+inline float Sgp4Kernel<float>::fn_sin(float x) { return sinf(x); }
+template <>
+inline float Sgp4Kernel<float>::fn_cos(float x) { return cosf(x); }
+template <>
+inline float Sgp4Kernel<float>::fn_sqrt(float x) { return sqrtf(x); }
+template <>
+inline float Sgp4Kernel<float>::fn_abs(float x) { return fabsf(x); }
+template <>
+inline float Sgp4Kernel<float>::fn_atan2(float y, float x) { return atan2f(y, x); }
+template <>
+inline float Sgp4Kernel<float>::fn_pow(float x, float y) { return powf(x, y); }
+
+template <>
+inline double Sgp4Kernel<double>::kepler_tolerance() { return 1.0e-12; }
+template <>
+inline double Sgp4Kernel<double>::fn_sin(double x) { return sin(x); }
+template <>
+inline double Sgp4Kernel<double>::fn_cos(double x) { return cos(x); }
+template <>
+inline double Sgp4Kernel<double>::fn_sqrt(double x) { return sqrt(x); }
+template <>
+inline double Sgp4Kernel<double>::fn_abs(double x) { return fabs(x); }
+template <>
+inline double Sgp4Kernel<double>::fn_atan2(double y, double x) { return atan2(y, x); }
+template <>
+inline double Sgp4Kernel<double>::fn_pow(double x, double y) { return pow(x, y); }
+
+typedef Sgp4Kernel<SGP4_KERNEL_REAL> Sgp4Fast;
+
+#endif  // SGP4KERNEL_HPP
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef SPSCRING_HPP
+#define SPSCRING_HPP
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+/*
+    Lock free single producer, single consumer byte ring buffer.
+    One side may be an IRQ. If there are more producers (or consumers), they must serialize among themselves.
+    N must be a power of 2. head / tail are free running counters, so the full capacity is usable.
+*/
+template <uint32_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "SpscRing size must be power of 2");
+
+   public:
+    uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    uint32_t space() const { return N - size(); }
+    static constexpr uint32_t capacity() { return N; }
+
+    // producer. all or nothing, returns false if there is not enough space
+    bool push(const uint8_t* data, uint32_t len) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (N - (h - tail.load(std::memory_order_acquire)) < len) return false;
+        uint32_t pos = h & (N - 1);
+        uint32_t first = len < N - pos ? len : N - pos;
+        memcpy(buf + pos, data, first);
+        memcpy(buf, data + first, len - first);
+        head.store(h + len, std::memory_order_release);
+        return true;
+    }
+
+    // consumer. returns the bytes copied to out
+    uint32_t pop(uint8_t* out, uint32_t max) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t avail = head.load(std::memory_order_acquire) - t;
+        uint32_t len = avail < max ? avail : max;
+        uint32_t pos = t & (N - 1);
+        uint32_t first = len < N - pos ? len : N - pos;
+        memcpy(out, buf + pos, first);
+        memcpy(out + first, buf, len - first);
+        tail.store(t + len, std::memory_order_release);
+        return len;
+    }
+
+   private:
+    std::atomic<uint32_t> head{0};  // written only by the producer
+    std::atomic<uint32_t> tail{0};  // written only by the consumer
+    uint8_t buf[N];
+};
+
+#endif  // SPSCRING_HPP
@@ -0,0 +1,244 @@
+#include "tledb.hpp"
+#include <algorithm>
+#include <ctype.h>
+#include <fstream>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "esp_log.h"
+
+static const char* TAG = "TleDb";
+
+// upper case, without the trailing spaces (celestrak pads the names to 24)
+static void normalize_name(const char* in, char* out, size_t len) {
+    size_t n = 0;
+    while (in[n] && n < len - 1) {
+        out[n] = toupper((unsigned char)in[n]);
+        ++n;
+    }
+    while (n > 0 && (out[n - 1] == ' ' || out[n - 1] == '\r' || out[n - 1] == '\n')) --n;
+    out[n] = 0;
+}
+
+bool TleDb::parse(const char* name, const char* line1, const char* line2, tle_db_record_t& rec) {
+    if (line1[0] != '1' || line2[0] != '2') return false;
+    if (!twolineChecksum(line1) || !twolineChecksum(line2)) return false;
+    char l1[130];
+    char l2[130];
+    strlcpy(l1, line1, sizeof(l1));
+    strlcpy(l2, line2, sizeof(l2));
+    elsetrec satrec{};
+    twoline2rv(l1, l2, 'i', wgs84, satrec);  // same as Sgp4
+    if (satrec.error != 0) return false;
+    rec = {};
+    rec.jdsatepoch = satrec.jdsatepoch;
+    rec.epochdays = satrec.epochdays;
+    rec.bstar = satrec.bstar;
+    rec.ecco = satrec.ecco;
+    rec.argpo = satrec.argpo;
+    rec.inclo = satrec.inclo;
+    rec.mo = satrec.mo;
+    // sgp4init() already replaced no with the un-kozai'd one, take it from the line again, like twoline2rv()
+    char tmp[11];
+    memcpy(tmp, &l2[51], 10);
+    tmp[10] = 0;
+    rec.no = atof(tmp) / (1440.0 / (2.0 * pi));
+    rec.nodeo = satrec.nodeo;
+    rec.ndot = satrec.ndot;
+    rec.nddot = satrec.nddot;
+    rec.norad = satrec.satnum;
+    rec.epochyr = satrec.epochyr;
+    strlcpy(rec.name, name, sizeof(rec.name));
+    size_t n = strlen(rec.name);
+    while (n > 0 && (rec.name[n - 1] == ' ' || rec.name[n - 1] == '\r')) rec.name[--n] = 0;
+    strlcpy(rec.line1, line1, 70);  // without the line ending
+    strlcpy(rec.line2, line2, 70);
+    return true;
+}
+
+// the second half of twoline2rv(), the parsing is already done
+void TleDb::to_elsetrec(const tle_db_record_t& rec, elsetrec& satrec) {
+    double tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2;
+    getgravconst(wgs84, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2);
+    satrec = {};
+    satrec.satnum = rec.norad;
+    satrec.epochyr = rec.epochyr;
+    satrec.epochdays = rec.epochdays;
+    satrec.jdsatepoch = rec.jdsatepoch;
+    satrec.bstar = rec.bstar;
+    satrec.ecco = rec.ecco;
+    satrec.argpo = rec.argpo;
+    satrec.inclo = rec.inclo;
+    satrec.mo = rec.mo;
+    satrec.no = rec.no;
+    satrec.nodeo = rec.nodeo;
+    satrec.ndot = rec.ndot;
+    satrec.nddot = rec.nddot;
+    satrec.a = pow(satrec.no * tumin, (-2.0 / 3.0));
+    satrec.alta = satrec.a * (1.0 + satrec.ecco) - 1.0;
+    satrec.altp = satrec.a * (1.0 - satrec.ecco) - 1.0;
+    sgp4init(wgs84, 'i', satrec.satnum, satrec.jdsatepoch - 2433281.5, satrec.bstar,
+             satrec.ecco, satrec.argpo, satrec.inclo, satrec.mo, satrec.no,
+             satrec.nodeo, satrec);
+}
+
+bool TleDb::build(const char* tle_path, const char* db_path) {
+    std::ifstream in(tle_path);
+    if (!in.is_open()) {
+        ESP_LOGE(TAG, "Failed to open file: %s", tle_path);
+        return false;
+    }
+    std::vector<tle_db_record_t> records;
+    std::string name, l1, l2;
+    tle_db_record_t rec;
+    while (std::getline(in, name)) {
+        if (!std::getline(in, l1) || !std::getline(in, l2)) break;
+        if (parse(name.c_str(), l1.c_str(), l2.c_str(), rec)) {
+            records.push_back(rec);
+        } else {
+            ESP_LOGW(TAG, "Skipping bad tle: %s", name.c_str());
+        }
+    }
+    in.close();
+    if (records.empty()) return false;
+
+    std::vector<tle_db_name_index_t> name_index(records.size());
+    std::vector<tle_db_norad_index_t> norad_index(records.size());
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        normalize_name(records[i].name, name_index[i].name, TLE_DB_NAME_LEN);
+        name_index[i].record = i;
+        norad_index[i].norad = records[i].norad;
+        norad_index[i].record = i;
+    }
+    std::sort(name_index.begin(), name_index.end(), [](const tle_db_name_index_t& a, const tle_db_name_index_t& b) { return strcmp(a.name, b.name) < 0; });
+    std::sort(norad_index.begin(), norad_index.end(), [](const tle_db_norad_index_t& a, const tle_db_norad_index_t& b) { return a.norad < b.norad; });
+
+    tle_db_header_t hdr = {};
+    hdr.magic = TLE_DB_MAGIC;
+    hdr.version = TLE_DB_VERSION;
+    hdr.record_size = sizeof(tle_db_record_t);
+    hdr.count = records.size();
+    hdr.records_offset = sizeof(tle_db_header_t);
+    hdr.name_index_offset = hdr.records_offset + hdr.count * sizeof(tle_db_record_t);
+    hdr.norad_index_offset = hdr.name_index_offset + hdr.count * sizeof(tle_db_name_index_t);
+
+    std::string tmp_path = std::string(db_path) + ".tmp";
+    FILE* out = fopen(tmp_path.c_str(), "wb");
+    if (!out) {
+        ESP_LOGE(TAG, "Failed to create: %s", tmp_path.c_str());
+        return false;
+    }
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1 &&
+              fwrite(records.data(), sizeof(tle_db_record_t), records.size(), out) == records.size() &&
+              fwrite(name_index.data(), sizeof(tle_db_name_index_t), name_index.size(), out) == name_index.size() &&
+              fwrite(norad_index.data(), sizeof(tle_db_norad_index_t), norad_index.size(), out) == norad_index.size();
+    ok = (fclose(out) == 0) && ok;
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write: %s", tmp_path.c_str());
+        remove(tmp_path.c_str());
+        return false;
+    }
+    remove(db_path);  // spiffs can't rename over an existing file
+    if (rename(tmp_path.c_str(), db_path) != 0) {
+        ESP_LOGE(TAG, "Failed to rename to: %s", db_path);
+        return false;
+    }
+    ESP_LOGI(TAG, "Built %s with %u satellites", db_path, (unsigned)hdr.count);
+    return true;
+}
+
+// a new download usually has the same satellites in the same order with new elements only. then the indexes stay the same, and only the changed records are written
+bool TleDb::update(const char* tle_path, const char* db_path) {
+    FILE* db = fopen(db_path, "r+b");
+    if (!db) return build(tle_path, db_path);
+    tle_db_header_t hdr;
+    bool same = fread(&hdr, sizeof(hdr), 1, db) == 1 && hdr.magic == TLE_DB_MAGIC && hdr.version == TLE_DB_VERSION && hdr.record_size == sizeof(tle_db_record_t);
+    std::ifstream in(tle_path);
+    std::string name, l1, l2;
+    tle_db_record_t rec;
+    tle_db_record_t old;
+    uint32_t index = 0;
+    uint32_t changed = 0;
+    while (same && in.is_open() && std::getline(in, name)) {
+        if (!std::getline(in, l1) || !std::getline(in, l2)) break;
+        if (!parse(name.c_str(), l1.c_str(), l2.c_str(), rec)) continue;  // build() skips them the same way
+        long pos = hdr.records_offset + index * sizeof(tle_db_record_t);
+        same = index < hdr.count && fseek(db, pos, SEEK_SET) == 0 && fread(&old, sizeof(old), 1, db) == 1 &&
+               old.norad == rec.norad && strcmp(old.name, rec.name) == 0;
+        if (same && (strcmp(old.line1, rec.line1) != 0 || strcmp(old.line2, rec.line2) != 0)) {
+            same = fseek(db, pos, SEEK_SET) == 0 && fwrite(&rec, sizeof(rec), 1, db) == 1;
+            changed++;
+        }
+        index++;
+    }
+    same = same && in.is_open() && index == hdr.count;
+    same = (fclose(db) == 0) && same;
+    if (!same) return build(tle_path, db_path);
+    ESP_LOGI(TAG, "Updated %u of %u satellites in %s", (unsigned)changed, (unsigned)index, db_path);
+    return true;
+}
+
+bool TleDb::open(const char* db_path) {
+    close();
+    file = fopen(db_path, "rb");
+    if (!file) return false;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != TLE_DB_MAGIC || header.version != TLE_DB_VERSION || header.record_size != sizeof(tle_db_record_t)) {
+        ESP_LOGE(TAG, "Bad db file: %s", db_path);
+        close();
+        return false;
+    }
+    names.resize(header.count);
+    norads.resize(header.count);
+    bool ok = fseek(file, header.name_index_offset, SEEK_SET) == 0 && fread(names.data(), sizeof(tle_db_name_index_t), header.count, file) == header.count &&
+              fseek(file, header.norad_index_offset, SEEK_SET) == 0 && fread(norads.data(), sizeof(tle_db_norad_index_t), header.count, file) == header.count;
+    if (!ok) {
+        ESP_LOGE(TAG, "Truncated db file: %s", db_path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TleDb::close() {
+    if (file) fclose(file);
+    file = nullptr;
+    std::vector<tle_db_name_index_t>().swap(names);
+    std::vector<tle_db_norad_index_t>().swap(norads);
+}
+
+bool TleDb::read_record(uint32_t index, tle_db_record_t& out) {
+    if (!file || index >= header.count) return false;
+    if (fseek(file, header.records_offset + index * sizeof(tle_db_record_t), SEEK_SET) != 0) return false;
+    return fread(&out, sizeof(tle_db_record_t), 1, file) == 1;
+}
+
+bool TleDb::find_name(const char* name, tle_db_record_t& out) {
+    char key[TLE_DB_NAME_LEN];
+    normalize_name(name, key, sizeof(key));
+    auto it = std::lower_bound(names.begin(), names.end(), key, [](const tle_db_name_index_t& a, const char* b) { return strcmp(a.name, b) < 0; });
+    if (it == names.end() || strcmp(it->name, key) != 0) return false;
+    return read_record(it->record, out);
+}
+
+bool TleDb::find_norad(uint32_t norad, tle_db_record_t& out) {
+    auto it = std::lower_bound(norads.begin(), norads.end(), norad, [](const tle_db_norad_index_t& a, uint32_t b) { return a.norad < b; });
+    if (it == norads.end() || it->norad != norad) return false;
+    return read_record(it->record, out);
+}
+
+uint16_t TleDb::find_prefix(const char* prefix, char (*out)[TLE_DB_NAME_LEN], uint16_t max, uint16_t skip) const {
+    char key[TLE_DB_NAME_LEN];
+    normalize_name(prefix, key, sizeof(key));
+    size_t len = strlen(key);
+    auto it = std::lower_bound(names.begin(), names.end(), key, [](const tle_db_name_index_t& a, const char* b) { return strcmp(a.name, b) < 0; });
+    uint16_t count = 0;
+    for (; it != names.end() && count < max && strncmp(it->name, key, len) == 0; ++it) {
+        if (skip > 0) {
+            skip--;
+            continue;
+        }
+        strlcpy(out[count++], it->name, TLE_DB_NAME_LEN);
+    }
+    return count;
+}
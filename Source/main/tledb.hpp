@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef TLEDB_HPP
+#define TLEDB_HPP
+
+#include <stdint.h>
+#include <vector>
+#include <numbers>  // before Sgp4.h: its pi macro breaks <numbers>, that the c++20 std headers pull in later
+#include "sgp4/Sgp4.h"
+
+/*
+    Indexed binary tle store, built from the 3 line tle text after every download (or on the host with tools/tle2db.py).
+    File layout (little endian):
+        tle_db_header_t
+        tle_db_record_t[count]           in the text file's order
+        tle_db_name_index_t[count]       sorted by upper case name
+        tle_db_norad_index_t[count]      sorted by norad id
+    The indexes are loaded to ram on open(), so a lookup is a binary search plus one record read.
+*/
+
+#define TLE_DB_MAGIC 0x42444c54  // "TLDB"
+#define TLE_DB_VERSION 1
+#define TLE_DB_NAME_LEN 28  // zero terminated
+#define TLE_DB_LINE_LEN 70  // 69 chars + zero
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;  // sizeof(tle_db_record_t)
+    uint32_t count;
+    uint32_t records_offset;
+    uint32_t name_index_offset;
+    uint32_t norad_index_offset;
+} tle_db_header_t;
+
+// the elements are already in the units sgp4init() wants, like twoline2rv() leaves them in elsetrec
+typedef struct
+{
+    double jdsatepoch;
+    double epochdays;
+    double bstar;
+    double ecco;
+    double argpo;
+    double inclo;
+    double mo;
+    double no;  // rad / min
+    double nodeo;
+    double ndot;
+    double nddot;
+    uint32_t norad;
+    int32_t epochyr;
+    char name[TLE_DB_NAME_LEN];
+    char line1[TLE_DB_LINE_LEN];  // the original lines, Sgp4::init() needs them
+    char line2[TLE_DB_LINE_LEN];
+    uint8_t reserved[8];
+} tle_db_record_t;
+static_assert(sizeof(tle_db_record_t) == 272, "tle_db_record_t layout must match tools/tle2db.py");
+
+typedef struct
+{
+    char name[TLE_DB_NAME_LEN];  // upper case
+    uint32_t record;
+} tle_db_name_index_t;
+
+typedef struct
+{
+    uint32_t norad;
+    uint32_t record;
+} tle_db_norad_index_t;
+
+class TleDb {
+   public:
+    static bool build(const char* tle_path, const char* db_path);   // text -> binary, through a temp file, so a failed build keeps the old db
+    static bool update(const char* tle_path, const char* db_path);  // rewrites only the changed records if the satellite list is the same, else build(). close the db before
+    static bool parse(const char* name, const char* line1, const char* line2, tle_db_record_t& rec);
+    static void to_elsetrec(const tle_db_record_t& rec, elsetrec& satrec);  // sgp4init only, no text parsing
+
+    bool open(const char* db_path);
+    void close();
+    bool is_open() const { return file != nullptr; }
+    uint32_t size() const { return names.size(); }
+
+    bool find_name(const char* name, tle_db_record_t& out);  // exact match, case insensitive
+    bool find_norad(uint32_t norad, tle_db_record_t& out);
+    uint16_t find_prefix(const char* prefix, char (*out)[TLE_DB_NAME_LEN], uint16_t max, uint16_t skip = 0) const;  // names only, from the index. case insensitive
+    bool read_record(uint32_t index, tle_db_record_t& out);                                                           // in file order
+
+   private:
+    FILE* file = nullptr;
+    tle_db_header_t header{};
+    std::vector<tle_db_name_index_t> names;
+    std::vector<tle_db_norad_index_t> norads;
+};
+
+#endif  // TLEDB_HPP
@@ -0,0 +1,245 @@
+#include "tledownload.hpp"
+#include <inttypes.h>
+#include <string>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "esp_log.h"
+#include "sgp4/Sgp4.h"
+
+static const char* TAG = "TleDownload";
+
+void TleStreamFilter::begin(FILE* out_, uint32_t offset_, uint32_t written_) {
+    out = out_;
+    offset = offset_;
+    committed = offset_;
+    written_bytes = written_;
+    line_no = 0;
+    len = 0;
+    too_long = false;
+    valid = 0;
+    invalid = 0;
+    write_error = false;
+}
+
+void TleStreamFilter::feed(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        offset++;
+        if (c == '\n') {
+            end_line();
+        } else if (c != '\r') {
+            if (len < TLE_DOWNLOAD_LINE_LEN - 1)
+                lines[line_no][len++] = c;
+            else
+                too_long = true;
+        }
+    }
+}
+
+void TleStreamFilter::finish() {
+    if (len > 0) end_line();
+}
+
+void TleStreamFilter::end_line() {
+    lines[line_no][len] = 0;
+    bool empty = len == 0;
+    len = 0;
+    if (empty && line_no == 0) {
+        committed = offset;  // blank lines between the sets
+        return;
+    }
+    if (too_long) lines[line_no][0] = 0;  // fails the check below
+    too_long = false;
+    if (++line_no < 3) return;
+    line_no = 0;
+    check_set();
+    committed = offset;
+}
+
+void TleStreamFilter::check_set() {
+    const char* l1 = lines[1];
+    const char* l2 = lines[2];
+    bool ok = strlen(l1) >= 69 && strlen(l2) >= 69 && l1[0] == '1' && l2[0] == '2' &&
+              strncmp(&l1[2], &l2[2], 5) == 0 && twolineChecksum(l1) && twolineChecksum(l2);
+    if (!ok) {
+        ESP_LOGW(TAG, "Dropping bad tle: %s", lines[0]);
+        invalid++;
+        return;
+    }
+    if (!out || write_error) return;
+    int n = fprintf(out, "%s\n%s\n%s\n", lines[0], l1, l2);
+    if (n < 0) {
+        write_error = true;
+        return;
+    }
+    written_bytes += n;
+    valid++;
+}
+
+bool TleDownload::load_meta(const char* path, tle_download_meta_t& meta) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    bool ok = fread(&meta, sizeof(meta), 1, f) == 1 && meta.magic == TLE_DOWNLOAD_META_MAGIC;
+    fclose(f);
+    meta.url[TLE_URLS_LEN - 1] = 0;
+    meta.etag[sizeof(meta.etag) - 1] = 0;
+    meta.last_modified[sizeof(meta.last_modified) - 1] = 0;
+    return ok;
+}
+
+void TleDownload::save_meta(const char* path, const tle_download_meta_t& meta) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fwrite(&meta, sizeof(meta), 1, f);
+    fclose(f);
+}
+
+esp_err_t TleDownload::http_event_handler(esp_http_client_event_t* evt) {
+    stream_t* st = (stream_t*)evt->user_data;
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_HEADER:
+            if (strcasecmp(evt->header_key, "ETag") == 0) strlcpy(st->etag, evt->header_value, sizeof(st->etag));
+            if (strcasecmp(evt->header_key, "Last-Modified") == 0) strlcpy(st->last_modified, evt->header_value, sizeof(st->last_modified));
+            break;
+
+        case HTTP_EVENT_ON_DATA: {
+            int status = esp_http_client_get_status_code(evt->client);
+            if (status != 200 && status != 206) break;  // body of a redirect or an error page
+            if (!st->file) {
+                bool append = st->resuming && status == 206;  // 200: the server sends the whole file, start over
+                st->file = fopen(st->part_path, append ? "ab" : "wb");
+                if (!st->file) {
+                    ESP_LOGE(TAG, "Failed to open file for writing");
+                    return ESP_FAIL;
+                }
+                st->filter.begin(st->file, append ? st->resume_offset : 0, append ? st->part_size : 0);
+            }
+            st->filter.feed((const char*)evt->data, evt->data_len);
+            if (st->filter.write_error) {
+                ESP_LOGE(TAG, "File write failed!");
+                return ESP_FAIL;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+TleDownloadResult TleDownload::download(const char* url, const char* tle_path, tle_download_meta_t& meta) {
+    if (strcmp(meta.url, url) != 0) {
+        // the validators and the part file belong to an other source
+        meta = {};
+        meta.magic = TLE_DOWNLOAD_META_MAGIC;
+        strlcpy(meta.url, url, sizeof(meta.url));
+    }
+    std::string part_path = std::string(tle_path) + ".part";
+    stream_t st{};
+    st.part_path = part_path.c_str();
+    st.resume_offset = meta.resume_offset;
+    st.part_size = meta.part_size;
+    struct stat file_stat;
+    bool have_file = stat(tle_path, &file_stat) == 0;
+    // resume only if the part file is exactly as it was left, and the server can tell if it is the same version
+    st.resuming = meta.resume_offset > 0 && (meta.etag[0] || meta.last_modified[0]) &&
+                  stat(part_path.c_str(), &file_stat) == 0 && (uint32_t)file_stat.st_size == meta.part_size;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = http_event_handler,
+        .user_data = &st,
+    };
+#pragma GCC diagnostic pop
+
+    ESP_LOGI(TAG, "HTTP GET %s", url);
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) return TleDownload_FAILED;
+    if (st.resuming) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%" PRIu32 "-", meta.resume_offset);
+        esp_http_client_set_header(client, "Range", range);
+        esp_http_client_set_header(client, "If-Range", meta.etag[0] ? meta.etag : meta.last_modified);
+        ESP_LOGI(TAG, "Resuming from %" PRIu32, meta.resume_offset);
+    } else if (have_file) {
+        if (meta.etag[0]) esp_http_client_set_header(client, "If-None-Match", meta.etag);
+        if (meta.last_modified[0]) esp_http_client_set_header(client, "If-Modified-Since", meta.last_modified);
+    }
+
+    esp_err_t ret = esp_http_client_perform(client);
+    int status = esp_http_client_get_status_code(client);
+    bool complete = ret == ESP_OK && esp_http_client_is_complete_data_received(client);
+    esp_http_client_cleanup(client);
+
+    time_t now;
+    time(&now);
+    if (ret == ESP_OK && status == 304 && have_file) {
+        ESP_LOGI(TAG, "Not modified");
+        meta.checked = now;
+        return TleDownload_NOT_MODIFIED;
+    }
+    if (!st.file) {
+        ESP_LOGE(TAG, "HTTP GET failed: %s, status %d", esp_err_to_name(ret), status);
+        if (status == 416) meta.resume_offset = 0;  // nothing left to resume, start over next time
+        return TleDownload_FAILED;
+    }
+    if (complete) st.filter.finish();
+    bool write_ok = fclose(st.file) == 0 && !st.filter.write_error;
+    // the validators of this response, a 206 may not repeat them
+    if (st.etag[0] || st.last_modified[0]) {
+        strlcpy(meta.etag, st.etag, sizeof(meta.etag));
+        strlcpy(meta.last_modified, st.last_modified, sizeof(meta.last_modified));
+    }
+    if (!complete || !write_ok) {
+        // keep the finished sets for the next try
+        meta.resume_offset = write_ok ? st.filter.committed_offset() : 0;
+        meta.part_size = st.filter.written();
+        ESP_LOGE(TAG, "Download interrupted at %" PRIu32 ": %s", st.filter.committed_offset(), esp_err_to_name(ret));
+        return TleDownload_FAILED;
+    }
+    meta.resume_offset = 0;
+    meta.part_size = 0;
+    ESP_LOGI(TAG, "Downloaded %u good, %u bad tle", st.filter.valid, st.filter.invalid);
+    if (st.filter.written() == 0) {
+        remove(part_path.c_str());
+        return TleDownload_FAILED;
+    }
+    remove(tle_path);  // spiffs can't rename over an existing file
+    if (rename(part_path.c_str(), tle_path) != 0) {
+        ESP_LOGE(TAG, "Failed to rename to: %s", tle_path);
+        return TleDownload_FAILED;
+    }
+    meta.checked = now;
+    return TleDownload_UPDATED;
+}
+
+TleDownloadResult TleDownload::run(const char* urls, const char* tle_path) {
+    std::string meta_path = std::string(tle_path) + ".meta";
+    tle_download_meta_t meta;
+    if (!load_meta(meta_path.c_str(), meta)) {
+        meta = {};
+        meta.magic = TLE_DOWNLOAD_META_MAGIC;
+    }
+    time_t now;
+    time(&now);
+    struct stat file_stat;
+    if (meta.resume_offset == 0 && meta.checked != 0 && (uint32_t)now >= meta.checked && (uint32_t)now - meta.checked <= TLE_DOWNLOAD_MAX_AGE_SEC &&
+        stat(tle_path, &file_stat) == 0) {
+        ESP_LOGI(TAG, "%s is checked in the last %d hours.", tle_path, TLE_DOWNLOAD_MAX_AGE_SEC / 3600);
+        return TleDownload_NOT_MODIFIED;
+    }
+    char list[TLE_URLS_LEN];
+    strlcpy(list, urls, sizeof(list));
+    char* save = nullptr;
+    for (char* url = strtok_r(list, "; \t\r\n", &save); url; url = strtok_r(nullptr, "; \t\r\n", &save)) {
+        TleDownloadResult res = download(url, tle_path, meta);
+        save_meta(meta_path.c_str(), meta);
+        if (res != TleDownload_FAILED) return res;
+    }
+    return TleDownload_FAILED;
+}
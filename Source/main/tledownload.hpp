@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 HTotoo
+ *
+ * This file is part of ESP32-Portapack.
+ *
+ * For additional license information, see the LICENSE file.
+ */
+
+#ifndef TLEDOWNLOAD_HPP
+#define TLEDOWNLOAD_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_http_client.h"
+
+#define TLE_URLS_LEN 200  // sources, separated by ';' or space, tried in order
+#define TLE_URLS_DEFAULT "http://creativo.hu/sattrack/mini.tle"
+#define TLE_DOWNLOAD_MAX_AGE_SEC (2 * 3600)  // don't even ask the server if it was checked this recently
+#define TLE_DOWNLOAD_META_MAGIC 0x4d454c54   // "TLEM"
+#define TLE_DOWNLOAD_LINE_LEN 80
+
+typedef enum TleDownloadResult {
+    TleDownload_FAILED,
+    TleDownload_NOT_MODIFIED,  // the file is still the latest (304, or checked recently)
+    TleDownload_UPDATED,       // new file is in place
+} TleDownloadResult;
+
+// stored next to the tle file, so the next download can be conditional or resumed
+typedef struct
+{
+    uint32_t magic;
+    uint32_t checked;        // unix time of the last successful download or 304
+    uint32_t resume_offset;  // bytes of the source already processed into the part file, 0 if nothing to resume
+    uint32_t part_size;      // size of the part file at resume_offset
+    char url[TLE_URLS_LEN];  // the source the validators belong to
+    char etag[64];
+    char last_modified[32];
+} tle_download_meta_t;
+
+/*
+    Splits the downloaded bytes to lines, checks every name + 2 line set (checksums, line numbers, same norad), and writes only the good sets to the output.
+    Keeps track of the source offset after the last written set, so an interrupted download can be resumed from there.
+*/
+class TleStreamFilter {
+   public:
+    void begin(FILE* out_, uint32_t offset, uint32_t written_);  // offset: source bytes already processed, written_: bytes already in out_
+    void feed(const char* data, size_t len);
+    void finish();  // the last line may have no line ending
+
+    uint32_t committed_offset() const { return committed; }
+    uint32_t written() const { return written_bytes; }
+    uint16_t valid = 0;
+    uint16_t invalid = 0;
+    bool write_error = false;
+
+   private:
+    void end_line();
+    void check_set();
+
+    FILE* out = nullptr;
+    char lines[3][TLE_DOWNLOAD_LINE_LEN];
+    uint8_t line_no = 0;
+    uint8_t len = 0;
+    bool too_long = false;
+    uint32_t offset = 0;     // source offset of the next byte
+    uint32_t committed = 0;  // source offset after the last finished set
+    uint32_t written_bytes = 0;
+};
+
+/*
+    Downloads the tle text to a part file and renames it over the old one only when it is complete, so an interrupted download never corrupts it.
+    Uses If-None-Match / If-Modified-Since, so an unchanged file is not downloaded again, and Range / If-Range to continue an interrupted one.
+*/
+class TleDownload {
+   public:
+    static TleDownloadResult run(const char* urls, const char* tle_path);  // blocking, needs valid time and wifi
+
+   private:
+    typedef struct
+    {
+        TleStreamFilter filter;
+        FILE* file;
+        const char* part_path;
+        bool resuming;  // asked for a range
+        uint32_t resume_offset;
+        uint32_t part_size;
+        char etag[64];  // validators of this response
+        char last_modified[32];
+    } stream_t;
+
+    static TleDownloadResult download(const char* url, const char* tle_path, tle_download_meta_t& meta);
+    static esp_err_t http_event_handler(esp_http_client_event_t* evt);
+    static bool load_meta(const char* path, tle_download_meta_t& meta);
+    static void save_meta(const char* path, const tle_download_meta_t& meta);
+};
+
+#endif  // TLEDOWNLOAD_HPP
@@ -26,6 +26,13 @@
 #include "ppshellcomm.h"
 #include "pinconfig.h"
 #include "pinconfig_html.h"
+#include "tledownload.hpp"
+
+void ws_request_sat_passes();                // main loop sends the sat passes at the next sattrack
+void ws_request_sat_find(const char* prefix);  // main loop sends the matching sat names
+void ws_request_pointing(uint8_t hz);          // pointing stream at hz, 0 stops it. must be repeated within 5 sec to keep it running
+void ws_request_nmealog(char cmd);             // 'R' records the raw gps lines, 'P' replays them, 'F' replays them fast, 'S' stops
+uint8_t nmealog_files(const char* out[2]);     // the recording's files, oldest first
 
 static httpd_handle_t server = NULL;
 static bool disable_esp_async = false;  // for example while in file transfer mode, don't send anything else
@@ -35,7 +42,7 @@ static bool disable_esp_async = false;  // for example while in file transfer mo
 #define SETUP_CSS_PATH "/spiffs/setup.css"
 #define OTA_HTML_PATH "/spiffs/ota.html"
 
-static char setup_html_out[3300];
+static char setup_html_out[4608];
 extern const char index_start[] asm("_binary_index_html_start");
 extern const char index_end[] asm("_binary_index_html_end");
 extern const char setup_start[] asm("_binary_setup_html_start");
@@ -96,6 +103,13 @@ static esp_err_t get_req_handler_pinconfig(httpd_req_t* req) {
     snprintf(val_buf, sizeof(val_buf), "%ld", pinConfig.GpsRxPin());
     httpd_resp_send_chunk(req, val_buf, HTTPD_RESP_USE_STRLEN);
 
+    // Send part 2b
+    httpd_resp_send_chunk(req, PINCONFIG_HTML_PART2B, HTTPD_RESP_USE_STRLEN);
+
+    // Send variable 2b (gpsTxPin)
+    snprintf(val_buf, sizeof(val_buf), "%ld", pinConfig.GpsTxPin());
+    httpd_resp_send_chunk(req, val_buf, HTTPD_RESP_USE_STRLEN);
+
     // Send part 3
     httpd_resp_send_chunk(req, PINCONFIG_HTML_PART3, HTTPD_RESP_USE_STRLEN);
 
@@ -168,7 +182,7 @@ static esp_err_t get_req_handler_setupcss(httpd_req_t* req) {
 
 /// setup.html get handler
 static esp_err_t get_req_handler_setup(httpd_req_t* req) {
-    snprintf(setup_html_out, sizeof(setup_html_out), setup_start, WifiM::wifiHostName, WifiM::wifiAPSSID, WifiM::wifiAPPASS, WifiM::wifiStaSSID, WifiM::wifiStaPASS, LedFeedback::get_brightness(), declinationAngle, gps_baud);
+    snprintf(setup_html_out, sizeof(setup_html_out), setup_start, WifiM::wifiHostName, WifiM::wifiAPSSID, WifiM::wifiAPPASS, WifiM::wifiStaSSID, WifiM::wifiStaPASS, LedFeedback::get_brightness(), declinationAngle, tle_urls, gps_baud, gps_hz);
     int response = httpd_resp_send(req, setup_html_out, HTTPD_RESP_USE_STRLEN);
     return response;
 }
@@ -179,6 +193,33 @@ static esp_err_t get_req_handler_ota(httpd_req_t* req) {
     return response;
 }
 
+// the raw gps recording, the files concatenated (tools/nmealog.py decodes it)
+static esp_err_t get_req_handler_nmealog(httpd_req_t* req) {
+    const char* paths[2];
+    uint8_t count = nmealog_files(paths);
+    if (count == 0) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No recording");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"nmea.log\"");
+    char chunk[1024];
+    for (uint8_t i = 0; i < count; ++i) {
+        FILE* f = fopen(paths[i], "rb");
+        if (!f) continue;
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            if (httpd_resp_send_chunk(req, chunk, n) != ESP_OK) {
+                fclose(f);
+                httpd_resp_send_chunk(req, NULL, 0);
+                return ESP_FAIL;
+            }
+        }
+        fclose(f);
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 // helper function to parse the POST variables
 static int find_post_value(char* key, char* parameter, char* value) {
     // char * addr1;
@@ -224,8 +265,8 @@ static esp_err_t post_req_handler_setup(httpd_req_t* req) {
     buf[off] = '\0';
 
     // parse rets
-    char tmp[65] = {0};
-    uint8_t changeMask = 1;  // wifi
+    char tmp[TLE_URLS_LEN * 3 + 1] = {0};  // url encoded
+    uint8_t changeMask = 1;                // wifi
 
     if (find_post_value((char*)"wifiHostName=", buf, tmp) > 0) {
         std::string tmp2 = url_decode(tmp);
@@ -278,6 +319,21 @@ static esp_err_t post_req_handler_setup(httpd_req_t* req) {
             changeMask |= 2;
         }
     }
+    if (find_post_value((char*)"gps_hz=", buf, tmp) > 0) {
+        uint8_t hz_tmp = (uint8_t)atoi(tmp);
+        if (hz_tmp == 0 || hz_tmp == 1 || hz_tmp == 2 || hz_tmp == 5 || hz_tmp == 10) {
+            gps_hz = hz_tmp;
+            changeMask |= 2;
+        }
+    }
+    if (find_post_value((char*)"tle_urls=", buf, tmp) > 0) {
+        std::string tmp2 = url_decode(tmp);
+        if (tmp2.length() > TLE_URLS_LEN - 1) {
+            tmp2.resize(TLE_URLS_LEN - 1);
+        }
+        strcpy(tle_urls, tmp2.data());
+        changeMask |= 2;
+    }
     if (find_post_value((char*)"declinationAngle=", buf, tmp) > 0) {
         for (int i = 0; tmp[i] != '\0'; i++)  // replace international stuff
         {
@@ -337,6 +393,7 @@ static esp_err_t post_req_handler_pinconfig(httpd_req_t* req) {
     // This ensures that if a field is missing from the POST, the old value is kept.
     int32_t ledRgb = pinConfig.LedRgbPin();
     int32_t gpsRx = pinConfig.GpsRxPin();
+    int32_t gpsTx = pinConfig.GpsTxPin();
     int32_t i2cSda = pinConfig.I2cSdaPin();
     int32_t i2cScl = pinConfig.I2cSclPin();
     int32_t irRx = pinConfig.IrRxPin();
@@ -351,6 +408,10 @@ static esp_err_t post_req_handler_pinconfig(httpd_req_t* req) {
         gpsRx = (int32_t)atoi(tmp);
         changed = true;
     }
+    if (find_post_value((char*)"gpsTxPin=", buf, tmp) > 0) {
+        gpsTx = (int32_t)atoi(tmp);
+        changed = true;
+    }
     if (find_post_value((char*)"i2cSdaPin=", buf, tmp) > 0) {
         i2cSda = (int32_t)atoi(tmp);
         changed = true;
@@ -377,7 +438,7 @@ static esp_err_t post_req_handler_pinconfig(httpd_req_t* req) {
     }
     if (changed) {
         ESP_LOGI("WEBS", "Saving new PinConfig to NVS.");
-        pinConfig.setPins(ledRgb, gpsRx, i2cSda, i2cScl, irRx, irTx, i2cSdaSlave, i2cSclSlave);
+        pinConfig.setPins(ledRgb, gpsRx, i2cSda, i2cScl, irRx, irTx, i2cSdaSlave, i2cSclSlave, gpsTx);
         pinConfig.saveToNvs();
     } else {
         ESP_LOGI("WEBS", "No pin changes detected.");
@@ -508,6 +569,7 @@ static esp_err_t handle_ws_req(httpd_req_t* req) {
         if (strcmp((const char*)ws_pkt.payload, "#$##$$#GETINITDATA\r\n") == 0) {  // parse here, since we shouldn't sent it to pp
             // get currently running esp app
             AppManager::sendCurrentAppToWeb();
+            ws_request_sat_passes();
             // lastly: send the pp connection data
             if ((PPShellComm::getAnyConnected() & 2) == 2) {
                 ws_notify_cc_i2c();
@@ -547,13 +609,39 @@ static esp_err_t handle_ws_req(httpd_req_t* req) {
             free(buf);
             return ESP_OK;
         }
+        if (strncmp((const char*)ws_pkt.payload, "#$##$$#NMEALOG", 14) == 0 && ws_pkt.len > 14) {  // parse here, since we shouldn't sent it to pp
+            ws_request_nmealog(ws_pkt.payload[14]);
+            free(buf);
+            return ESP_OK;
+        }
+        if (strncmp((const char*)ws_pkt.payload, "#$##$$#FINDSAT", 14) == 0) {  // parse here, since we shouldn't sent it to pp
+            char prefix[32] = {0};
+            for (size_t i = 14; i < ws_pkt.len && i - 14 < sizeof(prefix) - 1 && ws_pkt.payload[i] != '\r' && ws_pkt.payload[i] != '\n'; ++i) prefix[i - 14] = ws_pkt.payload[i];
+            ws_request_sat_find(prefix);
+            free(buf);
+            return ESP_OK;
+        }
+        if (strncmp((const char*)ws_pkt.payload, "#$##$$#POINTING", 15) == 0) {
+            uint8_t hz = 0;
+            for (size_t i = 15; i < ws_pkt.len && i < 18 && ws_pkt.payload[i] >= '0' && ws_pkt.payload[i] <= '9'; ++i) hz = hz * 10 + (ws_pkt.payload[i] - '0');
+            ws_request_pointing(hz);
+            free(buf);
+            return ESP_OK;
+        }
         if (AppManager::handleWebData((const char*)ws_pkt.payload, ws_pkt.len)) {
             // handled by app
             free(buf);
             return ESP_OK;
         }
-        PPShellComm::write(ws_pkt.payload, ws_pkt.len, false, true);
+        // the shell writer task sends it, so a pp that stops polling can't hold up the web server
+        if (PPShellComm::write_queued(buf, ws_pkt.len)) return ESP_OK;
         free(buf);
+        httpd_ws_frame_t busy;
+        memset(&busy, 0, sizeof(httpd_ws_frame_t));
+        busy.payload = (uint8_t*)"#$##$$#SHELLBUSY\r\n";
+        busy.len = 18;
+        busy.type = HTTPD_WS_TYPE_BINARY;
+        httpd_ws_send_frame(req, &busy);
     }
     return ESP_OK;
 }
@@ -561,7 +649,7 @@ static esp_err_t handle_ws_req(httpd_req_t* req) {
 // config web server part
 static httpd_handle_t setup_websocket_server(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 10;
+    config.max_uri_handlers = 11;
     config.max_open_sockets = 10;
 
     httpd_uri_t uri_get = {.uri = "/",
@@ -620,6 +708,13 @@ static httpd_handle_t setup_websocket_server(void) {
                                .is_websocket = false,
                                .handle_ws_control_frames = false,
                                .supported_subprotocol = NULL};
+    httpd_uri_t uri_getnmealog = {.uri = "/nmea.log",
+                                  .method = HTTP_GET,
+                                  .handler = get_req_handler_nmealog,
+                                  .user_ctx = NULL,
+                                  .is_websocket = false,
+                                  .handle_ws_control_frames = false,
+                                  .supported_subprotocol = NULL};
     httpd_uri_t ws = {.uri = "/ws",
                       .method = HTTP_GET,
                       .handler = handle_ws_req,
@@ -637,6 +732,7 @@ static httpd_handle_t setup_websocket_server(void) {
         httpd_register_uri_handler(server, &uri_getsetupcss);
         httpd_register_uri_handler(server, &uri_getota);
         httpd_register_uri_handler(server, &update_post);
+        httpd_register_uri_handler(server, &uri_getnmealog);
         httpd_register_uri_handler(server, &ws);
     }
 
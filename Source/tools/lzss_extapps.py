@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2025 HTotoo
+#
+# This file is part of ESP32-Portapack.
+#
+# For additional license information, see the LICENSE file.
+#
+# Build step: compresses the extapps/*.h byte arrays with LZSS, and writes them to one header.
+# The format must match ppi2c/lzss_decoder.hpp:
+#   flag byte, then 8 items (LSB first). bit 1: literal byte. bit 0: 2 byte match (little endian),
+#   low 11 bits: offset - 1 (window is 2048 bytes), high 5 bits: length - 3 (3..34 bytes).
+#   the raw data is split to 4096 byte blocks, a match never reaches back or runs over a block boundary,
+#   and every block starts with a new flag byte (the unused bits of the previous one are 0), so the
+#   decoder can start at any block.
+#
+# usage: lzss_extapps.py <output.h> <extapp.h> [<extapp.h> ...]
+
+import os
+import re
+import sys
+
+WINDOW_SIZE = 2048
+MIN_MATCH = 3
+MAX_MATCH = 34
+MAX_CHAIN = 256
+BLOCK_SIZE = 4096
+
+
+def parse_c_array(path):
+    with open(path, "r") as f:
+        text = f.read()
+    m = re.search(r"unsigned\s+char\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}", text, re.S)
+    if not m:
+        raise ValueError("no byte array found in " + path)
+    data = bytes(int(v, 0) for v in m.group(2).replace("\n", " ").split(",") if v.strip())
+    return m.group(1), data
+
+
+def compress(data):
+    out = bytearray()
+    heads = {}
+    prev = [0] * len(data)
+    pos = 0
+    n = len(data)
+
+    def insert(i):
+        if i + MIN_MATCH <= n:
+            key = data[i:i + MIN_MATCH]
+            prev[i] = heads.get(key, -1)
+            heads[key] = i
+
+    while pos < n:
+        flag_pos = len(out)
+        out.append(0)
+        for bit in range(8):
+            if pos >= n or (bit > 0 and pos % BLOCK_SIZE == 0):
+                break
+            block_start = pos - pos % BLOCK_SIZE
+            block_end = min(block_start + BLOCK_SIZE, n)
+            best_len = 0
+            best_off = 0
+            if pos + MIN_MATCH <= block_end:
+                cand = heads.get(data[pos:pos + MIN_MATCH], -1)
+                chain = 0
+                max_len = min(MAX_MATCH, block_end - pos)
+                while cand >= block_start and pos - cand <= WINDOW_SIZE and chain < MAX_CHAIN:
+                    length = 0
+                    while length < max_len and data[cand + length] == data[pos + length]:
+                        length += 1
+                    if length > best_len:
+                        best_len = length
+                        best_off = pos - cand
+                        if length == max_len:
+                            break
+                    cand = prev[cand]
+                    chain += 1
+            if best_len >= MIN_MATCH:
+                v = (best_off - 1) | ((best_len - MIN_MATCH) << 11)
+                out.append(v & 0xFF)
+                out.append(v >> 8)
+                for i in range(pos, pos + best_len):
+                    insert(i)
+                pos += best_len
+            else:
+                out[flag_pos] |= 1 << bit
+                out.append(data[pos])
+                insert(pos)
+                pos += 1
+    return bytes(out)
+
+
+def decompress(src, raw_size):
+    out = bytearray()
+    p = 0
+    while len(out) < raw_size:
+        flags = src[p]
+        p += 1
+        for bit in range(8):
+            if len(out) >= raw_size or (bit > 0 and len(out) % BLOCK_SIZE == 0):
+                break
+            if flags & (1 << bit):
+                out.append(src[p])
+                p += 1
+            else:
+                v = src[p] | (src[p + 1] << 8)
+                p += 2
+                off = (v & 0x7FF) + 1
+                for _ in range((v >> 11) + MIN_MATCH):
+                    out.append(out[-off])
+    return bytes(out)
+
+
+def to_c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "const uint8_t %s[] = {\n%s\n};\n" % (name, "\n".join(lines))
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("usage: lzss_extapps.py <output.h> <extapp.h> [<extapp.h> ...]")
+        return 1
+    output = sys.argv[1]
+    parts = ["// Generated by tools/lzss_extapps.py from extapps/*.h, do not edit.\n#pragma once\n\n#include <stdint.h>\n"]
+    total_raw = 0
+    total_lz = 0
+    for path in sys.argv[2:]:
+        name, raw = parse_c_array(path)
+        lz = compress(raw)
+        if decompress(lz, len(raw)) != raw:
+            raise RuntimeError("LZSS round trip failed for " + path)
+        total_raw += len(raw)
+        total_lz += len(lz)
+        print("extapp %-14s %7d -> %7d bytes (%.1f%%)" % (name, len(raw), len(lz), 100.0 * len(lz) / len(raw)))
+        parts.append("\n" + to_c_array(name + "_lz", lz))
+        parts.append("const uint32_t %s_raw_size = %d;\n" % (name, len(raw)))
+    print("extapps total  %7d -> %7d bytes, %d bytes of flash saved" % (total_raw, total_lz, total_raw - total_lz))
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w") as f:
+        f.write("".join(parts))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
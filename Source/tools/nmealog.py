@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2025 HTotoo
+#
+# This file is part of ESP32-Portapack.
+#
+# For additional license information, see the LICENSE file.
+#
+# Host tool: converts the raw gps recording (/nmea.log from the web ui) to plain nmea text, and back.
+# The format must match main/nmealog.hpp:
+#   file header: "NMEALOG1", u32 sequence, u32 start ms. then records:
+#   varint dt ms, varint (payload length << 3 | flags), payload: slot, then the line (raw) or
+#   field count, mask of the fields equal to the slot's line, the other fields joined with ',' (delta).
+#   flags: 1 delta, 2 "\r\n" stripped, 4 "*XX" checksum stripped.
+# The encoder here writes only raw records, the esp decodes them the same.
+#
+# usage: nmealog.py decode <nmea.log> <output.nmea> [--times]
+#        nmealog.py encode <input.nmea> <output.log> [ms between lines]
+
+import struct
+import sys
+
+MAGIC = b"NMEALOG1"
+HEADER_SIZE = 16
+LINE_MAX = 128
+SLOTS = 32
+DELTA = 1
+CRLF = 2
+CRC = 4
+
+
+def get_varint(data, pos):
+    v = 0
+    for i in range(5):
+        if pos + i >= len(data):
+            return None, pos
+        b = data[pos + i]
+        v |= (b & 0x7F) << (7 * i)
+        if not b & 0x80:
+            return v, pos + i + 1
+    return None, pos
+
+
+def put_varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def checksum(body):
+    crc = 0
+    for b in body[1:]:
+        crc ^= b
+    return crc
+
+
+def decode(data):
+    """yields (ms, line bytes)"""
+    pos = 0
+    slots = [None] * SLOTS
+    ms = 0
+    while pos < len(data):
+        if data[pos:pos + len(MAGIC)] == MAGIC:
+            # a new file: the times restart from its start, the delta slots are empty
+            ms = struct.unpack_from("<I", data, pos + 12)[0]
+            slots = [None] * SLOTS
+            pos += HEADER_SIZE
+            continue
+        dt, pos = get_varint(data, pos)
+        h, pos = get_varint(data, pos)
+        if dt is None or h is None:
+            return
+        plen = h >> 3
+        flags = h & 7
+        payload = data[pos:pos + plen]
+        if plen < 1 or len(payload) < plen or payload[0] >= SLOTS:
+            return  # cut at the end
+        pos += plen
+        slot = payload[0]
+        if flags & DELTA:
+            nf = payload[1]
+            mask_len = (nf + 7) // 8
+            mask = payload[2:2 + mask_len]
+            changed = payload[2 + mask_len:].split(b",")
+            ref = slots[slot].split(b",")
+            fields = []
+            for i in range(nf):
+                if mask[i // 8] & (1 << (i % 8)):
+                    fields.append(ref[i])
+                else:
+                    fields.append(changed.pop(0))
+            body = b",".join(fields)
+        else:
+            body = bytes(payload[1:])
+        slots[slot] = body
+        line = body
+        if flags & CRC:
+            line += b"*%02X" % checksum(body)
+        if flags & CRLF:
+            line += b"\r\n"
+        ms += dt
+        yield ms, line
+
+
+def encode(lines, step_ms):
+    out = bytearray(MAGIC + struct.pack("<II", 1, 0))
+    slot = 0
+    for line in lines:
+        flags = 0
+        if line.endswith(b"\r\n"):
+            line = line[:-2]
+            flags |= CRLF
+        elif line.endswith(b"\n"):
+            line = line[:-1]
+            flags |= CRLF  # normalized to "\r\n", like a receiver sends it
+        if len(line) >= 4 and line[:1] == b"$" and line[-3:-2] == b"*" and line[-2:] == b"%02X" % checksum(line[:-3]):
+            line = line[:-3]
+            flags |= CRC
+        line = line[:LINE_MAX]
+        payload = bytes([slot]) + line
+        out += put_varint(step_ms) + put_varint((len(payload) << 3) | flags) + payload
+        slot = (slot + 1) % SLOTS
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) < 4 or sys.argv[1] not in ("decode", "encode"):
+        print("usage: nmealog.py decode <nmea.log> <output.nmea> [--times]")
+        print("       nmealog.py encode <input.nmea> <output.log> [ms between lines]")
+        sys.exit(1)
+    with open(sys.argv[2], "rb") as f:
+        data = f.read()
+    if sys.argv[1] == "decode":
+        times = "--times" in sys.argv[4:]
+        count = 0
+        with open(sys.argv[3], "wb") as f:
+            for ms, line in decode(data):
+                if times:
+                    f.write(b"%10.3f " % (ms / 1000.0))
+                f.write(line)
+                count += 1
+        print("%d lines" % count)
+    else:
+        step = int(sys.argv[4]) if len(sys.argv) > 4 else 50
+        lines = data.splitlines(keepends=True)
+        with open(sys.argv[3], "wb") as f:
+            f.write(encode(lines, step))
+        print("%d lines" % len(lines))
+
+
+if __name__ == "__main__":
+    main()
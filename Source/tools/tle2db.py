@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2025 HTotoo
+#
+# This file is part of ESP32-Portapack.
+#
+# For additional license information, see the LICENSE file.
+#
+# Host tool: converts a 3 line tle text file (celestrak format) to the indexed binary tle store.
+# The format must match main/tledb.hpp, and the element parsing main/sgp4/sgp4io.cpp twoline2rv() (wgs84),
+# so the esp can use a db built here the same way as one it built itself.
+#
+# usage: tle2db.py <input.tle> <output.db>
+
+import math
+import re
+import struct
+import sys
+
+TLE_DB_MAGIC = 0x42444C54  # "TLDB"
+TLE_DB_VERSION = 1
+TLE_DB_NAME_LEN = 28
+TLE_DB_LINE_LEN = 70
+
+HEADER_FMT = "<IHHIIII"
+RECORD_FMT = "<11dIi28s70s70s8x"
+NAME_INDEX_FMT = "<28sI"
+NORAD_INDEX_FMT = "<II"
+
+# wgs84, see getgravconst()
+MU = 398600.5
+RADIUS_EARTH_KM = 6378.137
+XKE = 60.0 / math.sqrt(RADIUS_EARTH_KM * RADIUS_EARTH_KM * RADIUS_EARTH_KM / MU)
+TUMIN = 1.0 / XKE
+DEG2RAD = math.pi / 180.0
+XPDOTP = 1440.0 / (2.0 * math.pi)
+
+_FLOAT_RE = re.compile(r"\s*[+-]?(\d+\.?\d*|\.\d+)([eE][+-]?\d+)?")
+_INT_RE = re.compile(r"\s*[+-]?\d+")
+
+
+# prefix parsing, like the c library
+def c_atof(s):
+    m = _FLOAT_RE.match(s)
+    return float(m.group(0)) if m else 0.0
+
+
+def c_atoi(s):
+    m = _INT_RE.match(s)
+    return int(m.group(0)) if m else 0
+
+
+def checksum_ok(line):
+    if len(line) < 69:
+        return False
+    cks = 0
+    for c in line[:68]:
+        if c == "-":
+            cks += 1
+        elif c.isdigit():
+            cks += int(c)
+    return str(cks % 10) == line[68]
+
+
+def days2mdhms(year, days):
+    lmonth = [31, 29 if year % 4 == 0 else 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31]
+    dayofyr = int(math.floor(days))
+    i = 1
+    inttemp = 0
+    while dayofyr > inttemp + lmonth[i - 1] and i < 12:
+        inttemp += lmonth[i - 1]
+        i += 1
+    temp = (days - dayofyr) * 24.0
+    hr = int(math.floor(temp))
+    temp = (temp - hr) * 60.0
+    minute = int(math.floor(temp))
+    sec = (temp - minute) * 60.0
+    return i, dayofyr - inttemp, hr, minute, sec
+
+
+def jday(year, mon, day, hr, minute, sec):
+    return (367.0 * year - math.floor((7 * (year + math.floor((mon + 9) / 12.0))) * 0.25) + math.floor(275 * mon / 9.0) +
+            day + 1721013.5 + ((sec / 60.0 + minute) / 60.0 + hr) / 24.0)
+
+
+# twoline2rv() without the sgp4init() part. returns None on a bad tle
+def parse(name, line1, line2):
+    if not line1.startswith("1") or not line2.startswith("2"):
+        return None
+    if not checksum_ok(line1) or not checksum_ok(line2):
+        return None
+    l1 = list(line1.ljust(69))
+    l2 = list(line2.ljust(69))
+    for j in range(10, 16):
+        if l1[j] == " ":
+            l1[j] = "_"
+    if l1[44] != " ":
+        l1[43] = l1[44]
+    l1[44] = "."
+    if l1[7] == " ":
+        l1[7] = "U"
+    if l1[9] == " ":
+        l1[9] = "."
+    for j in range(45, 50):
+        if l1[j] == " ":
+            l1[j] = "0"
+    if l1[51] == " ":
+        l1[51] = "0"
+    if l1[53] != " ":
+        l1[52] = l1[53]
+    l1[53] = "."
+    l2[25] = "."
+    for j in range(26, 33):
+        if l2[j] == " ":
+            l2[j] = "0"
+    if l1[62] == " ":
+        l1[62] = "0"
+    if l1[68] == " ":
+        l1[68] = "0"
+    l1 = "".join(l1)
+    l2 = "".join(l2)
+
+    epochyr = c_atoi(l1[18:20])
+    epochdays = c_atof(l1[20:32])
+    ndot = c_atof(l1[32:43])
+    nddot = c_atof(l1[43:50])
+    nexp = c_atoi(l1[50:52])
+    bstar = c_atof(l1[52:59])
+    ibexp = c_atoi(l1[59:61])
+    norad = c_atoi(l2[2:7])
+    inclo = c_atof(l2[7:16])
+    nodeo = c_atof(l2[16:25])
+    ecco = c_atof(l2[25:33])
+    argpo = c_atof(l2[33:42])
+    mo = c_atof(l2[42:51])
+    no = c_atof(l2[51:61])
+
+    no = no / XPDOTP
+    nddot = nddot * math.pow(10.0, nexp)
+    bstar = bstar * math.pow(10.0, ibexp)
+    ndot = ndot / (XPDOTP * 1440.0)
+    nddot = nddot / (XPDOTP * 1440.0 * 1440)
+    year = epochyr + 2000 if epochyr < 57 else epochyr + 1900
+    jdsatepoch = jday(year, *days2mdhms(year, epochdays))
+
+    return (jdsatepoch, epochdays, bstar, ecco, argpo * DEG2RAD, inclo * DEG2RAD, mo * DEG2RAD, no, nodeo * DEG2RAD,
+            ndot, nddot, norad, epochyr, name.rstrip(" \r").encode()[:TLE_DB_NAME_LEN - 1],
+            line1.encode()[:TLE_DB_LINE_LEN - 1], line2.encode()[:TLE_DB_LINE_LEN - 1])
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: tle2db.py <input.tle> <output.db>")
+        return 1
+    with open(sys.argv[1], "r") as f:
+        lines = [l.rstrip("\r\n") for l in f]
+    records = []
+    for i in range(0, len(lines) - 2, 3):
+        rec = parse(lines[i], lines[i + 1], lines[i + 2])
+        if rec is None:
+            print("Skipping bad tle: %s" % lines[i])
+            continue
+        records.append(rec)
+    if not records:
+        print("No valid tle in %s" % sys.argv[1])
+        return 1
+
+    # the esp sorts with strcmp on the upper case name, bytes compare the same way
+    name_index = sorted((r[13].upper().rstrip(b" "), i) for i, r in enumerate(records))
+    norad_index = sorted((r[11], i) for i, r in enumerate(records))
+
+    count = len(records)
+    records_offset = struct.calcsize(HEADER_FMT)
+    name_index_offset = records_offset + count * struct.calcsize(RECORD_FMT)
+    norad_index_offset = name_index_offset + count * struct.calcsize(NAME_INDEX_FMT)
+    with open(sys.argv[2], "wb") as f:
+        f.write(struct.pack(HEADER_FMT, TLE_DB_MAGIC, TLE_DB_VERSION, struct.calcsize(RECORD_FMT), count, records_offset,
+                            name_index_offset, norad_index_offset))
+        for r in records:
+            f.write(struct.pack(RECORD_FMT, *r))
+        for name, i in name_index:
+            f.write(struct.pack(NAME_INDEX_FMT, name, i))
+        for norad, i in norad_index:
+            f.write(struct.pack(NORAD_INDEX_FMT, norad, i))
+    print("Wrote %s with %d satellites" % (sys.argv[2], count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())